@@ -34,6 +34,7 @@ const CONNECT_STATE_CONNECTING = 1
 const CONNECT_STATE_CONNECTED = 2
 
 const MAX_PORT = 64 * 1024
+const PACKET_MESSAGE_BYTES = 1024 // `MESSAGE_BYTES` in `stream-relay/packets.js`
 const RECV_BUFFER = 1
 const SEND_BUFFER = 0
 
@@ -45,7 +46,8 @@ const dc = diagnostics.channels.group('udp', [
   'connect',
   'socket',
   'close',
-  'bind'
+  'bind',
+  'buffer.tune'
 ])
 
 function defaultCallback (socket) {
@@ -80,6 +82,11 @@ function createDataListener (socket) {
       dc.channel('message').publish({ socket, buffer: message, info })
     }
 
+    if (source === 'udp.setBufferTuning') {
+      socket.state.recvBufferSize = data.size
+      dc.channel('buffer.tune').publish({ socket, ...data })
+    }
+
     if (data.EOF) {
       globalThis.removeEventListener('data', ondata)
     }
@@ -146,7 +153,9 @@ async function startReading (socket, callback) {
 
   try {
     result = await ipc.send('udp.readStart', {
-      id: socket.id
+      id: socket.id,
+      decodePackets: socket.state.decodePackets === true,
+      fec: socket.state.fec === true
     })
 
     callback(result.err, result.data)
@@ -252,7 +261,11 @@ async function bind (socket, options, callback) {
       port: options.port || 0,
       address: options.address,
       ipv6Only: !!options.ipv6Only,
-      reuseAddr: !!options.reuseAddr
+      reuseAddr: !!options.reuseAddr,
+      segmentSize: socket.state.segmentSize || 0,
+      timestamps: socket.state.timestamps,
+      receivers: socket.state.receivers || 1,
+      steering: socket.state.steering || 'hash'
     })
 
     socket.state.bindState = BIND_STATE_BOUND
@@ -281,6 +294,10 @@ async function bind (socket, options, callback) {
       socket.state.recvBufferSize = result.data.size
     }
 
+    if (socket.state.recvBufferTuning) {
+      await socket.setRecvBufferTuning(socket.state.recvBufferTuning)
+    }
+
     callback(result.err, result.data)
   } catch (err) {
     socket.state.bindState = BIND_STATE_UNBOUND
@@ -530,6 +547,291 @@ async function send (socket, options, callback) {
   return result
 }
 
+async function sendMany (socket, options, callback) {
+  let result = null
+
+  if (!isFunction(callback)) {
+    callback = noop
+  }
+
+  // wait for bind to finish
+  if (socket.state.bindState === BIND_STATE_BINDING) {
+    const { err } = await new Promise((resolve, reject) => {
+      socket.once('listening', () => resolve({}))
+      socket.once('error', (err) => resolve({ err }))
+    })
+
+    if (err) {
+      callback(err)
+      return { err }
+    }
+  } else if (socket.state.bindState === BIND_STATE_UNBOUND) {
+    const { err } = await bind(socket, { port: 0 })
+    if (err) {
+      callback(err)
+      return { err }
+    }
+  }
+
+  const destinations = []
+
+  for (const destination of options.destinations) {
+    let address = destination.address || getDefaultAddress(socket)
+
+    if (!isIPv4(address)) {
+      try {
+        address = await dns.lookup(address, 4)
+      } catch (err) {
+        callback(err)
+        return { err }
+      }
+    }
+
+    destinations.push(`${address}:${destination.port}`)
+  }
+
+  try {
+    result = await ipc.write('udp.sendMany', {
+      id: socket.id,
+      destinations: destinations.join(',')
+    }, options.buffer)
+
+    callback(result.err, result.data?.results)
+  } catch (err) {
+    callback(err)
+    return { err }
+  }
+
+  for (const destination of options.destinations) {
+    dc.channel('send').publish({
+      socket,
+      port: destination.port,
+      buffer: options.buffer,
+      address: destination.address
+    })
+  }
+
+  return result
+}
+
+async function sendPacket (socket, options, callback) {
+  let result = null
+
+  if (!isFunction(callback)) {
+    callback = noop
+  }
+
+  options = { ...options }
+
+  // wait for bind to finish
+  if (socket.state.bindState === BIND_STATE_BINDING) {
+    const { err } = await new Promise((resolve, reject) => {
+      socket.once('listening', () => resolve({}))
+      socket.once('error', (err) => resolve({ err }))
+    })
+
+    if (err) {
+      callback(err)
+      return { err }
+    }
+  } else if (socket.state.bindState === BIND_STATE_UNBOUND) {
+    const { err } = await bind(socket, { port: 0 })
+    if (err) {
+      callback(err)
+      return { err }
+    }
+  }
+
+  if (!options.address) {
+    options.address = getDefaultAddress(socket)
+  } else if (!isIPv4(options.address)) {
+    try {
+      options.address = await dns.lookup(options.address, 4)
+    } catch (err) {
+      callback(err)
+      return { err }
+    }
+  }
+
+  const { packet } = options
+
+  try {
+    result = await ipc.write('udp.sendPacket', {
+      id: socket.id,
+      port: options.port,
+      address: options.address,
+      type: packet.type ?? 0,
+      hops: packet.hops ?? 0,
+      clock: packet.clock ?? 0,
+      index: packet.index ?? -1,
+      packetId: packet.packetId ?? '',
+      clusterId: packet.clusterId ?? '',
+      previousId: packet.previousId ?? '',
+      nextId: packet.nextId ?? '',
+      to: packet.to ?? '',
+      usr1: packet.usr1 ?? ''
+    }, options.buffer)
+
+    callback(result.err, result.data)
+  } catch (err) {
+    callback(err)
+    return { err }
+  }
+
+  dc.channel('send').publish({
+    socket,
+    port: options.port,
+    buffer: options.buffer,
+    address: options.address
+  })
+
+  return result
+}
+
+async function sendBlock (socket, options, callback) {
+  let result = null
+
+  if (!isFunction(callback)) {
+    callback = noop
+  }
+
+  options = { ...options }
+
+  // wait for bind to finish
+  if (socket.state.bindState === BIND_STATE_BINDING) {
+    const { err } = await new Promise((resolve, reject) => {
+      socket.once('listening', () => resolve({}))
+      socket.once('error', (err) => resolve({ err }))
+    })
+
+    if (err) {
+      callback(err)
+      return { err }
+    }
+  } else if (socket.state.bindState === BIND_STATE_UNBOUND) {
+    const { err } = await bind(socket, { port: 0 })
+    if (err) {
+      callback(err)
+      return { err }
+    }
+  }
+
+  if (!options.address) {
+    options.address = getDefaultAddress(socket)
+  } else if (!isIPv4(options.address)) {
+    try {
+      options.address = await dns.lookup(options.address, 4)
+    } catch (err) {
+      callback(err)
+      return { err }
+    }
+  }
+
+  try {
+    result = await ipc.write('udp.sendBlock', {
+      id: socket.id,
+      port: options.port,
+      address: options.address,
+      sizes: options.buffers.map((buffer) => buffer.byteLength).join(','),
+      parityCount: options.parityCount ?? 0
+    }, Buffer.concat(options.buffers))
+
+    callback(result.err, result.data)
+  } catch (err) {
+    callback(err)
+    return { err }
+  }
+
+  for (const buffer of options.buffers) {
+    dc.channel('send').publish({
+      socket,
+      port: options.port,
+      buffer,
+      address: options.address
+    })
+  }
+
+  return result
+}
+
+async function sendFile (socket, options, callback) {
+  let result = null
+
+  if (!isFunction(callback)) {
+    callback = noop
+  }
+
+  options = { ...options }
+
+  // wait for bind to finish
+  if (socket.state.bindState === BIND_STATE_BINDING) {
+    const { err } = await new Promise((resolve, reject) => {
+      socket.once('listening', () => resolve({}))
+      socket.once('error', (err) => resolve({ err }))
+    })
+
+    if (err) {
+      callback(err)
+      return { err }
+    }
+  } else if (socket.state.bindState === BIND_STATE_UNBOUND) {
+    const { err } = await bind(socket, { port: 0 })
+    if (err) {
+      callback(err)
+      return { err }
+    }
+  }
+
+  if (!options.address) {
+    options.address = getDefaultAddress(socket)
+  } else if (!isIPv4(options.address)) {
+    try {
+      options.address = await dns.lookup(options.address, 4)
+    } catch (err) {
+      callback(err)
+      return { err }
+    }
+  }
+
+  // progress is emitted natively while the file is sent
+  const onprogress = ({ detail }) => {
+    const { data, source } = detail.params
+
+    if (
+      source === 'udp.sendFile' &&
+      data && BigInt(data.id) === socket.id &&
+      data.fd === options.fd
+    ) {
+      options.onprogress(data.bytes, data.length)
+    }
+  }
+
+  if (isFunction(options.onprogress)) {
+    globalThis.addEventListener('data', onprogress)
+  }
+
+  try {
+    result = await ipc.send('udp.sendFile', {
+      id: socket.id,
+      fd: options.fd,
+      port: options.port,
+      address: options.address,
+      offset: options.offset ?? 0,
+      length: options.length ?? 0,
+      chunkSize: options.chunkSize ?? 1200
+    })
+
+    callback(result.err, result.data)
+  } catch (err) {
+    callback(err)
+    return { err }
+  } finally {
+    globalThis.removeEventListener('data', onprogress)
+  }
+
+  return result
+}
+
 async function close (socket, callback) {
   let result = null
 
@@ -616,6 +918,13 @@ function getSockName (socket, callback) {
  * @param {boolean=} [options.ipv6Only=false] - Default: false.
  * @param {number=} options.recvBufferSize - Sets the SO_RCVBUF socket value.
  * @param {number=} options.sendBufferSize - Sets the SO_SNDBUF socket value.
+ * @param {boolean|Object=} [options.recvBufferTuning=false] - Tunes the SO_RCVBUF socket value while receiving, see `socket.setRecvBufferTuning()`.
+ * @param {number=} options.segmentSize - Splits messages larger than this into datagrams of this size, using UDP segmentation offload (GSO/GRO) where supported.
+ * @param {boolean=} [options.timestamps=false] - Timestamps received messages in the kernel where supported (`rinfo.timestamp`) and answers `socket.ping()` from other sockets natively.
+ * @param {number=} [options.receivers=1] - Reads the bound port with this many sockets, each on a thread of its own, using SO_REUSEPORT on Linux. Other platforms read it with one.
+ * @param {string=} [options.steering='hash'] - How messages are spread over the receivers: 'hash' keeps a sender on one receiver, 'cpu' reads them on the CPU the kernel received them on.
+ * @param {boolean=} [options.decodePackets=false] - Decode stream-relay packets natively. The 'message' event then receives the packet message and the decoded headers as `rinfo.packet`.
+ * @param {boolean=} [options.fec=false] - Reassemble blocks sent with `socket.sendBlock()`, recovering lost messages. Their 'message' events receive `rinfo.fec` (`{ blockId, index, recovered }`).
  * @param {AbortSignal=} options.signal - An AbortSignal that may be used to close a socket.
  * @param {function=} callback - Attached as a listener for 'message' events. Optional.
  * @return {Socket}
@@ -648,6 +957,15 @@ export class Socket extends EventEmitter {
     this.state = {
       recvBufferSize: options.recvBufferSize,
       sendBufferSize: options.sendBufferSize,
+      recvBufferTuning: options.recvBufferTuning === true
+        ? {}
+        : (options.recvBufferTuning || null),
+      segmentSize: options.segmentSize,
+      timestamps: options.timestamps === true,
+      receivers: options.receivers,
+      steering: options.steering,
+      decodePackets: options.decodePackets === true,
+      fec: options.fec === true,
       bindState: BIND_STATE_UNBOUND,
       connectState: CONNECT_STATE_DISCONNECTED,
       reuseAddr: options.reuseAddr === true,
@@ -920,6 +1238,203 @@ export class Socket extends EventEmitter {
     return send(this, { id, port, address, buffer }, cb)
   }
 
+  /**
+   * Sends the same message to many destinations with a single call into
+   * the runtime, uploading the message bytes once. The callback is called
+   * with an array of per destination results (`{ address, port, status }`)
+   * once every send completed.
+   *
+   * @param {Buffer | TypedArray | DataView | string} buffer - Message to be sent.
+   * @param {Array<{ port: number, address?: string }>} destinations - Where to send the message.
+   * @param {function=} callback - Called with an error or the per destination results.
+   */
+  sendMany (buffer, destinations, callback) {
+    if (typeof buffer === 'string' || isArrayBufferView(buffer)) {
+      buffer = Buffer.from(buffer)
+    }
+
+    if (!Buffer.isBuffer(buffer)) {
+      throw new TypeError('Invalid buffer')
+    }
+
+    if (!Array.isArray(destinations)) {
+      throw new TypeError('Invalid destinations')
+    }
+
+    for (const destination of destinations) {
+      const port = parseInt(destination?.port)
+      if (!Number.isInteger(port) || port <= 0 || port > (64 * 1024)) {
+        throw new ERR_SOCKET_BAD_PORT(
+          `Port should be > 0 and < 65536. Received ${destination?.port}.`
+        )
+      }
+    }
+
+    return sendMany(this, { buffer, destinations }, callback)
+  }
+
+  /**
+   * Encodes a stream-relay packet natively and sends it. The packet fields
+   * are the ones of `Packet` in `stream-relay/packets.js`, identifiers hex
+   * encoded and `to` a base64 encoded public key. An object `message` is
+   * encoded as JSON.
+   *
+   * @param {object} packet - The packet fields and `message`.
+   * @param {number} port - Destination port.
+   * @param {string=} address - Destination host name or IP address.
+   * @param {function=} callback - Called when the packet has been sent.
+   */
+  sendPacket (packet, port, address, callback) {
+    if (typeof address === 'function') {
+      callback = address
+      address = undefined
+    }
+
+    let message = packet?.message ?? ''
+
+    if (typeof message === 'object' && !isArrayBufferView(message)) {
+      message = JSON.stringify(message)
+    }
+
+    const buffer = Buffer.from(
+      typeof message === 'number' ? String(message) : message
+    )
+
+    if (buffer.byteLength > PACKET_MESSAGE_BYTES) {
+      throw new RangeError('Packet message is too big')
+    }
+
+    port = parseInt(port)
+    if (!Number.isInteger(port) || port <= 0 || port > (64 * 1024)) {
+      throw new ERR_SOCKET_BAD_PORT(
+        `Port should be > 0 and < 65536. Received ${port}.`
+      )
+    }
+
+    return sendPacket(this, { packet, buffer, port, address }, callback)
+  }
+
+  /**
+   * Sends messages as one forward error corrected block. `parityCount`
+   * parity datagrams are sent along with the messages and a socket created
+   * with `fec: true` recovers up to that many lost messages of the block
+   * without a retransmission. A block has at most 256 datagrams.
+   *
+   * @param {Array<Buffer | TypedArray | DataView | string>} messages - Messages to be sent.
+   * @param {number} port - Destination port.
+   * @param {string=} address - Destination host name or IP address.
+   * @param {object=} options
+   * @param {number=} [options.parityCount=0] - Number of parity datagrams.
+   * @param {function=} callback - Called with an error or `{ blockId, dataCount, parityCount, bytes }`.
+   */
+  sendBlock (messages, port, address, options, callback) {
+    if (typeof address === 'function') {
+      callback = address
+      address = undefined
+      options = undefined
+    } else if (typeof address === 'object' && address !== null) {
+      callback = options
+      options = address
+      address = undefined
+    }
+
+    if (typeof options === 'function') {
+      callback = options
+      options = undefined
+    }
+
+    const buffers = Array.isArray(messages) ? fromBufferList(messages) : null
+
+    if (!buffers || buffers.length === 0) {
+      throw new TypeError('Invalid messages')
+    }
+
+    const parityCount = parseInt(options?.parityCount ?? 0)
+
+    if (
+      !Number.isInteger(parityCount) ||
+      parityCount < 0 ||
+      buffers.length + parityCount > 256
+    ) {
+      throw new RangeError('A block has at most 256 datagrams')
+    }
+
+    port = parseInt(port)
+    if (!Number.isInteger(port) || port <= 0 || port > (64 * 1024)) {
+      throw new ERR_SOCKET_BAD_PORT(
+        `Port should be > 0 and < 65536. Received ${port}.`
+      )
+    }
+
+    return sendBlock(this, {
+      buffers,
+      port,
+      address,
+      parityCount
+    }, callback)
+  }
+
+  /**
+   * Sends a file as a sequence of datagrams of `chunkSize` bytes. The file
+   * is read and sent by the runtime, so its bytes are never copied into
+   * JavaScript. Sends honor the send queue limits and pacing of the socket.
+   *
+   * @param {FileHandle|string} handle - An open `FileHandle` or its id.
+   * @param {number} port - Destination port.
+   * @param {string=} address - Destination host name or IP address.
+   * @param {object=} options
+   * @param {number=} [options.offset=0] - File offset to start from.
+   * @param {number=} options.length - Bytes to send, up to the end of the file by default.
+   * @param {number=} [options.chunkSize=1200] - Bytes per datagram.
+   * @param {function=} options.onprogress - Called with the bytes sent so far and `length`, `0` if unknown.
+   * @param {function=} callback - Called with an error or `{ bytes, datagrams }`.
+   */
+  sendFile (handle, port, address, options, callback) {
+    if (typeof address === 'function') {
+      callback = address
+      address = undefined
+      options = undefined
+    } else if (typeof address === 'object' && address !== null) {
+      callback = options
+      options = address
+      address = undefined
+    }
+
+    if (typeof options === 'function') {
+      callback = options
+      options = undefined
+    }
+
+    const fd = typeof handle === 'object' ? handle?.id : handle
+
+    if (typeof fd !== 'string' && typeof fd !== 'bigint') {
+      throw new TypeError('Invalid file handle')
+    }
+
+    const chunkSize = parseInt(options?.chunkSize ?? 1200)
+
+    if (!Number.isInteger(chunkSize) || chunkSize <= 0 || chunkSize > 65507) {
+      throw new RangeError('Chunk size must be between 1 and 65507 bytes')
+    }
+
+    port = parseInt(port)
+    if (!Number.isInteger(port) || port <= 0 || port > (64 * 1024)) {
+      throw new ERR_SOCKET_BAD_PORT(
+        `Port should be > 0 and < 65536. Received ${port}.`
+      )
+    }
+
+    return sendFile(this, {
+      fd: String(fd),
+      port,
+      address,
+      chunkSize,
+      offset: options?.offset,
+      length: options?.length,
+      onprogress: options?.onprogress
+    }, callback)
+  }
+
   /**
    * Close the underlying socket and stop listening for data on it. If a
    * callback is provided, it is added as a listener for the 'close' event.
@@ -1070,6 +1585,41 @@ export class Socket extends EventEmitter {
     }
   }
 
+  /**
+   * Tunes the SO_RCVBUF socket option while the socket receives. The receive
+   * buffer doubles when the kernel drops datagrams or the receive queue is
+   * mostly full, up to `maxSize` (or less, if the system caps it), and halves
+   * down to `minSize` after 10 samples in a row without traffic. Each change
+   * is published on the 'udp.buffer.tune' diagnostics channel. Sizes are the
+   * ones `getRecvBufferSize()` reports.
+   *
+   * @param {object|boolean} options - `false` stops tuning
+   * @param {number=} [options.minSize = 0] - Smallest receive buffer in bytes, `0` for the current size
+   * @param {number=} [options.maxSize = 0] - Largest receive buffer in bytes, `0` for 8 MiB
+   * @param {number=} [options.interval = 1000] - Milliseconds between samples
+   */
+  async setRecvBufferTuning (options) {
+    const enabled = options !== false
+
+    this.state.recvBufferTuning = enabled
+      ? (options === true ? {} : { ...options })
+      : null
+
+    const result = await ipc.send('udp.setBufferTuning', {
+      id: this.id,
+      enabled,
+      minSize: options?.minSize ?? 0,
+      maxSize: options?.maxSize ?? 0,
+      interval: options?.interval ?? 1000
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    return result.data
+  }
+
   /**
    * Sets the SO_SNDBUF socket option. Sets the maximum socket send buffer in
    * bytes.
@@ -1102,6 +1652,91 @@ export class Socket extends EventEmitter {
     return this.state.sendBufferSize
   }
 
+  /**
+   * @returns {number} the number of bytes queued for sending.
+   * @see {@link https://nodejs.org/api/dgram.html#socketgetsendqueuesize}
+   */
+  getSendQueueSize () {
+    return getSocketState(this)?.sendQueue?.size ?? 0
+  }
+
+  /**
+   * @returns {number} the number of send requests currently in the queue
+   * awaiting to be processed.
+   * @see {@link https://nodejs.org/api/dgram.html#socketgetsendqueuecount}
+   */
+  getSendQueueCount () {
+    return getSocketState(this)?.sendQueue?.count ?? 0
+  }
+
+  /**
+   * Measures the round trip time to another socket with a native probe that
+   * is answered without going through its JavaScript, so the result is not
+   * skewed by event loop or WebView scheduling. Both sockets need to be
+   * created with `timestamps: true` and bound.
+   *
+   * @param {number} port - Port of the remote socket
+   * @param {string} address - Address of the remote socket
+   * @param {object=} options
+   * @param {number=} [options.timeout = 1000] - Milliseconds to wait for an answer
+   * @return {Promise<object>} the RTT of the probe and the smoothed estimate
+   * (`srtt`, `rttvar`, `minRTT` and `samples`) in milliseconds
+   */
+  async ping (port, address, options) {
+    const result = await ipc.send('udp.rtt', {
+      id: this.id,
+      port,
+      address,
+      timeout: options?.timeout ?? 1000
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    return result.data
+  }
+
+  /**
+   * @return {Promise<object[]>} the RTT estimates of the addresses pinged
+   * with `socket.ping()`, in milliseconds
+   */
+  async getRTT () {
+    const result = await ipc.send('udp.rtt', { id: this.id })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    return result.data.rtt
+  }
+
+  /**
+   * Limits the bytes and datagrams queued for sending on this socket. Sends
+   * over the limit fail with `EAGAIN` ('reject'), are held back while the
+   * oldest held back sends are dropped ('drop-oldest'), or are held back
+   * and call their callback once sent ('block'). At most 4096 sends are
+   * held back by 'block', more fail with `EAGAIN`.
+   * @param {object} options
+   * @param {number=} [options.maxBytes = 0] - Maximum bytes queued, `0` is unlimited
+   * @param {number=} [options.maxCount = 0] - Maximum datagrams queued, `0` is unlimited
+   * @param {string=} [options.policy = 'reject'] - 'reject', 'drop-oldest' or 'block'
+   */
+  async setSendQueueLimits (options) {
+    const result = await ipc.send('udp.setSendQueueLimits', {
+      id: this.id,
+      maxBytes: options?.maxBytes ?? 0,
+      maxCount: options?.maxCount ?? 0,
+      policy: options?.policy ?? 'reject'
+    })
+
+    if (result.err) {
+      throw result.err
+    }
+
+    return result.data
+  }
+
   //
   // For now we aren't going to implement any of the multicast options,
   // mainly because 1. we don't need it in hyper and 2. if a user wants
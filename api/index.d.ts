@@ -3140,14 +3140,15 @@ declare module "socket:window" {
          * @param {number=} options.window - the window to send the message to
          * @param {boolean=} [options.backend = false] - whether to send the message to the backend
          * @param {string} options.event - the event to send
-         * @param {(string|object)=} options.value - the value to send
+         * @param {(string|object|Uint8Array)=} options.value - the value to send,
+         * bytes are sent to the backend over its channel (see `cmd_channel`)
          * @returns
          */
         send(options: {
             window?: number | undefined;
             backend?: boolean | undefined;
             event: string;
-            value?: (string | object) | undefined;
+            value?: (string | object | Uint8Array) | undefined;
         }): Promise<ipc.Result>;
         /**
          * Opens an URL in the default browser.
@@ -263,7 +263,8 @@ export class ApplicationWindow {
    * @param {number=} options.window - the window to send the message to
    * @param {boolean=} [options.backend = false] - whether to send the message to the backend
    * @param {string} options.event - the event to send
-   * @param {(string|object)=} options.value - the value to send
+   * @param {(string|object|Uint8Array)=} options.value - the value to send,
+   * bytes are sent to the backend over its channel (see `cmd_channel`)
    * @returns
    */
   async send (options) {
@@ -280,6 +281,13 @@ export class ApplicationWindow {
       throw new Error('event should be a non-empty string')
     }
 
+    if (options.backend === true && ArrayBuffer.isView(options.value)) {
+      return await ipc.write('channel.write', {
+        index: this.#senderWindowIndex,
+        event: options.event
+      }, options.value)
+    }
+
     const value = typeof options.value !== 'string' ? JSON.stringify(options.value) : options.value
 
     if (options.backend === true) {
@@ -106,6 +106,14 @@ while (( $# > 0 )); do
   shift
 done
 
+if [[ -n "$SSC_BENCHMARKS" ]]; then
+  cflags+=("-DSSC_BENCHMARKS=1")
+fi
+
+if [[ -n "$SSC_FAULT_INJECTION" ]]; then
+  cflags+=("-DSSC_FAULT_INJECTION=1")
+fi
+
 if [[ -n "$DEBUG" ]]; then
   cflags+=("-g")
   cflags+=("-O0")
@@ -120,6 +120,7 @@ extern "C" {
   /**
    * Creates a new context. The context is retained if a `parent` is not given
    * and therefor emust be disposed with `sapi_context_release()`.
+   * A context that is not retained is released with its `parent`.
    * @param parent   - An optional parent to own the new context
    * @param retained - `true` if the returned context should be retained (owned) by the caller
    * @return The new context (`sapi_context_t*`)
@@ -750,6 +751,12 @@ extern "C" {
     const sapi_ipc_router_t* router
   );
 
+  /**
+   * A callback that frees bytes handed over to the runtime, such as `free()`.
+   * @param bytes - The bytes to free
+   */
+  typedef void (*sapi_ipc_bytes_free_callback_t)(void* bytes);
+
   /**
    * Get the window index the IPC message is associated with.
    * @param message The IPC message
@@ -811,6 +818,52 @@ extern "C" {
     const char* key
   );
 
+  /**
+   * Get the bytes of the IPC message.
+   * @param message The IPC message
+   * @return The IPC message bytes (possibly `NULL`)
+   */
+  SOCKET_RUNTIME_EXTENSION_EXPORT
+  const unsigned char* sapi_ipc_message_get_bytes (
+    const sapi_ipc_message_t* message
+  );
+
+  /**
+   * Get the size of the IPC message bytes.
+   * @param message The IPC message
+   * @return The size of the IPC message bytes
+   */
+  SOCKET_RUNTIME_EXTENSION_EXPORT
+  unsigned int sapi_ipc_message_get_bytes_size (
+    const sapi_ipc_message_t* message
+  );
+
+  /**
+   * Take ownership of the bytes of the IPC message without copying them.
+   * The message has no bytes afterwards. The caller must free the returned
+   * bytes with `sapi_ipc_bytes_free()`, or hand them back to the runtime with
+   * `sapi_ipc_result_set_bytes_owned()` and `sapi_ipc_bytes_free` as the free
+   * callback. Bytes shared with a native buffer are copied. The bytes of a
+   * message can only be taken once, `NULL` is returned after that.
+   * @param context - An extension context for a IPC request
+   * @param message - The IPC message for this request
+   * @param size    - Set to the size of the returned bytes
+   * @return The IPC message bytes (possibly `NULL`)
+   */
+  SOCKET_RUNTIME_EXTENSION_EXPORT
+  unsigned char* sapi_ipc_message_take_bytes (
+    sapi_context_t* context,
+    sapi_ipc_message_t* message,
+    unsigned int* size
+  );
+
+  /**
+   * Free bytes taken with `sapi_ipc_message_take_bytes()`.
+   * @param bytes - The bytes to free
+   */
+  SOCKET_RUNTIME_EXTENSION_EXPORT
+  void sapi_ipc_bytes_free (void* bytes);
+
   /**
    * Create a new IPC result from a given `context` and IPC `message`.
    * @param context - An extension context for a IPC request
@@ -951,6 +1004,24 @@ extern "C" {
     unsigned char* bytes
   );
 
+  /**
+   * Set the IPC result bytes without copying them. The runtime owns `bytes`
+   * and calls `free_callback` with them once the response no longer needs
+   * them, possibly after the result is replied. With a `NULL` callback the
+   * bytes are never freed, which suits static data.
+   * @param result        - An IPC request result
+   * @param size          - The size of the bytes
+   * @param bytes         - The bytes
+   * @param free_callback - Frees the bytes, such as `free` (possibly `NULL`)
+   */
+  SOCKET_RUNTIME_EXTENSION_EXPORT
+  void sapi_ipc_result_set_bytes_owned (
+    sapi_ipc_result_t* result,
+    unsigned int size,
+    unsigned char* bytes,
+    sapi_ipc_bytes_free_callback_t free_callback
+  );
+
   /**
    * Get the IPC result bytes.
    * @param result - An IPC request result
@@ -1050,7 +1121,8 @@ extern "C" {
   /**
    * Map a named route to a callback with optional use data for a given
    * extension context. Routes must "reply" with a result to respond to an
-   * incoming request.
+   * incoming request. The context of a request that is not replied to within
+   * five minutes, and was not retained, is reclaimed.
    * @param context  - An extension context
    * @param route    - The route name to map
    * @param callback - The callback called when an IPC route receives a request
@@ -1249,6 +1321,90 @@ extern "C" {
     int code
   );
 
+  /**
+   * Thread Pool API
+   * The _Thread Pool API_ runs CPU heavy work on a pool of worker threads
+   * managed by the runtime, sized to the CPUs of the machine and shared by
+   * every extension.
+   */
+
+  /**
+   * Thread pool priority enumeration.
+   */
+  #define SAPI_THREAD_POOL_PRIORITY_LOW 0
+  #define SAPI_THREAD_POOL_PRIORITY_NORMAL 1
+  #define SAPI_THREAD_POOL_PRIORITY_HIGH 2
+
+  /**
+   * A scalar type that represents the thread pool priority enumeration.
+   */
+  typedef int sapi_thread_pool_priority_t;
+
+  /**
+   * A callback called on a worker thread with the work of a task.
+   * @param context - The extension context given to `sapi_thread_pool_submit()`
+   * @param data    - User data given to `sapi_thread_pool_submit()`
+   */
+  typedef void (*sapi_thread_pool_work_callback_t)(
+    sapi_context_t* context,
+    const void* data
+  );
+
+  /**
+   * A callback called on the runtime event loop after the work of a task.
+   * @param context - The extension context given to `sapi_thread_pool_submit()`
+   * @param data    - User data given to `sapi_thread_pool_submit()`
+   */
+  typedef void (*sapi_thread_pool_done_callback_t)(
+    sapi_context_t* context,
+    const void* data
+  );
+
+  /**
+   * Queues `work_callback` to be called on a worker thread with normal
+   * priority, then `done_callback` on the runtime event loop. Queues are
+   * bounded, so this fails instead of blocking when the pool is saturated.
+   * @param context       - An extension context
+   * @param data          - User data given to both callbacks
+   * @param work_callback - The work to run on a worker thread
+   * @param done_callback - An optional callback for when the work is done
+   * @return `true` if the task was queued, otherwise `false`
+   */
+  SOCKET_RUNTIME_EXTENSION_EXPORT
+  bool sapi_thread_pool_submit (
+    sapi_context_t* context,
+    const void* data,
+    sapi_thread_pool_work_callback_t work_callback,
+    sapi_thread_pool_done_callback_t done_callback
+  );
+
+  /**
+   * Like `sapi_thread_pool_submit()`, with a `priority` for the task. Queued
+   * tasks of a higher priority run first.
+   * @param context       - An extension context
+   * @param priority      - A `SAPI_THREAD_POOL_PRIORITY_*` value
+   * @param data          - User data given to both callbacks
+   * @param work_callback - The work to run on a worker thread
+   * @param done_callback - An optional callback for when the work is done
+   * @return `true` if the task was queued, otherwise `false`
+   */
+  SOCKET_RUNTIME_EXTENSION_EXPORT
+  bool sapi_thread_pool_submit_with_priority (
+    sapi_context_t* context,
+    sapi_thread_pool_priority_t priority,
+    const void* data,
+    sapi_thread_pool_work_callback_t work_callback,
+    sapi_thread_pool_done_callback_t done_callback
+  );
+
+  /**
+   * Get the number of worker threads in the pool, to split work into.
+   * @param context - An extension context
+   * @return The number of worker threads
+   */
+  SOCKET_RUNTIME_EXTENSION_EXPORT
+  unsigned int sapi_thread_pool_get_size (const sapi_context_t* context);
+
   /**
    * Config API
    * The _Config API_ provides an interface for getting and setting
@@ -0,0 +1,361 @@
+#ifndef SOCKET_RUNTIME_RING_H
+#define SOCKET_RUNTIME_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "platform.h"
+
+#if !SOCKET_RUNTIME_PLATFORM_WINDOWS
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Single producer, single consumer rings of messages in shared memory,
+ * the channel between the runtime and the backend process when
+ * `cmd_channel = "shm"` is set in `socket.ini`.
+ *
+ * The backend is started with `--channel-shm=<fd>,<notify>,<wait>`:
+ * `fd` is the shared memory holding two rings, the one the backend writes
+ * to first and the one the runtime writes to second (see `sapi_ring_map`),
+ * `notify` is written to after writing a message and `wait` becomes
+ * readable when the runtime wrote one.
+ *
+ * A message is an `ipc://` URI and a body, the same as a frame of the
+ * socket channel. Readers get pointers into the ring and release the
+ * message when done with them. Only for GCC and Clang, not on Windows.
+ */
+
+/**
+ * "SRNG"
+ */
+#define SAPI_RING_MAGIC (uint32_t) 0x53524e47
+#define SAPI_RING_VERSION (uint32_t) 1
+
+/**
+ * Size of the ring header in the shared memory, the producer and the
+ * consumer positions are on cache lines of their own.
+ */
+#define SAPI_RING_HEADER_SIZE 192
+
+/**
+ * Size of the URI length and body length in front of a message.
+ */
+#define SAPI_RING_RECORD_HEADER_SIZE 8
+
+/**
+ * Marks the end of the ring, the next message starts at the beginning.
+ */
+#define SAPI_RING_WRAP (uint32_t) 0xffffffff
+
+/**
+ * `sapi_ring_write()` results.
+ */
+#define SAPI_RING_OK 0
+#define SAPI_RING_FULL -1
+#define SAPI_RING_TOO_LARGE -2
+
+typedef struct {
+  // written once by `sapi_ring_init()`
+  uint32_t magic;
+  uint32_t version;
+  uint64_t capacity;
+  uint8_t reserved0[48];
+  // advanced by the producer
+  uint64_t head;
+  uint8_t reserved1[56];
+  // advanced by the consumer
+  uint64_t tail;
+  // set by the consumer before it waits for a notification
+  uint32_t waiting;
+  uint8_t reserved2[52];
+} sapi_ring_header_t;
+
+typedef struct {
+  sapi_ring_header_t* header;
+  unsigned char* data;
+  uint64_t capacity;
+} sapi_ring_t;
+
+typedef struct {
+  const char* uri;
+  uint32_t uri_length;
+  const unsigned char* bytes;
+  uint32_t size;
+  // position of the next message, see `sapi_ring_release()`
+  uint64_t next;
+} sapi_ring_record_t;
+
+static inline uint64_t sapi_ring_align (uint64_t size) {
+  return (size + 7) & ~(uint64_t) 7;
+}
+
+/**
+ * Bytes of shared memory for a ring of `capacity` bytes, which must be a
+ * power of two.
+ */
+static inline size_t sapi_ring_size (uint64_t capacity) {
+  return SAPI_RING_HEADER_SIZE + capacity;
+}
+
+static inline void sapi_ring_init (
+  sapi_ring_t* ring,
+  void* memory,
+  uint64_t capacity
+) {
+  ring->header = (sapi_ring_header_t*) memory;
+  ring->data = (unsigned char*) memory + SAPI_RING_HEADER_SIZE;
+  ring->capacity = capacity;
+
+  memset(memory, 0, SAPI_RING_HEADER_SIZE);
+  ring->header->magic = SAPI_RING_MAGIC;
+  ring->header->version = SAPI_RING_VERSION;
+  ring->header->capacity = capacity;
+}
+
+/**
+ * Attaches to a ring initialized by the other side, `-1` if `memory` is
+ * not a ring.
+ */
+static inline int sapi_ring_attach (sapi_ring_t* ring, void* memory, size_t size) {
+  sapi_ring_header_t* header = (sapi_ring_header_t*) memory;
+  uint64_t capacity = 0;
+
+  if (size < SAPI_RING_HEADER_SIZE) {
+    return -1;
+  }
+
+  // read once, the capacity used is the one checked
+  capacity = __atomic_load_n(&header->capacity, __ATOMIC_RELAXED);
+
+  if (
+    header->magic != SAPI_RING_MAGIC ||
+    header->version != SAPI_RING_VERSION ||
+    capacity < SAPI_RING_RECORD_HEADER_SIZE ||
+    (capacity & (capacity - 1)) != 0 ||
+    capacity > size - SAPI_RING_HEADER_SIZE
+  ) {
+    return -1;
+  }
+
+  ring->header = header;
+  ring->data = (unsigned char*) memory + SAPI_RING_HEADER_SIZE;
+  ring->capacity = capacity;
+  return 0;
+}
+
+/**
+ * Copies a message into the ring. `SAPI_RING_FULL` until the consumer
+ * released enough messages, `SAPI_RING_TOO_LARGE` for messages larger
+ * than half the ring.
+ */
+static inline int sapi_ring_write (
+  sapi_ring_t* ring,
+  const char* uri,
+  uint32_t uri_length,
+  const void* bytes,
+  uint32_t size
+) {
+  uint64_t mask = ring->capacity - 1;
+  uint64_t length = sapi_ring_align(
+    SAPI_RING_RECORD_HEADER_SIZE + (uint64_t) uri_length + size
+  );
+
+  if (length > ring->capacity / 2) {
+    return SAPI_RING_TOO_LARGE;
+  }
+
+  uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_RELAXED);
+  uint64_t tail = __atomic_load_n(&ring->header->tail, __ATOMIC_ACQUIRE);
+  uint64_t offset = head & mask;
+  uint64_t contiguous = ring->capacity - offset;
+  uint64_t needed = contiguous < length ? contiguous + length : length;
+
+  if (ring->capacity - (head - tail) < needed) {
+    return SAPI_RING_FULL;
+  }
+
+  if (contiguous < length) {
+    uint32_t wrap = SAPI_RING_WRAP;
+    memcpy(ring->data + offset, &wrap, sizeof(wrap));
+    head += contiguous;
+    offset = 0;
+  }
+
+  unsigned char* record = ring->data + offset;
+  memcpy(record, &uri_length, sizeof(uri_length));
+  memcpy(record + 4, &size, sizeof(size));
+  memcpy(record + SAPI_RING_RECORD_HEADER_SIZE, uri, uri_length);
+
+  if (size > 0) {
+    memcpy(record + SAPI_RING_RECORD_HEADER_SIZE + uri_length, bytes, size);
+  }
+
+  __atomic_store_n(&ring->header->head, head + length, __ATOMIC_RELEASE);
+  return SAPI_RING_OK;
+}
+
+/**
+ * Points `record` at the oldest message in the ring, `0` if it is empty.
+ * The message stays in the ring until `sapi_ring_release()`. The other
+ * side can write anything to the shared memory, so a message that does
+ * not lie within the ring and what was written of it is `-1` and the
+ * ring should not be read from again.
+ */
+static inline int sapi_ring_read (sapi_ring_t* ring, sapi_ring_record_t* record) {
+  uint64_t capacity = ring->capacity;
+  uint64_t mask = capacity - 1;
+  uint64_t tail = __atomic_load_n(&ring->header->tail, __ATOMIC_RELAXED);
+  uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+  uint64_t available = head - tail;
+
+  if (available == 0) {
+    return 0;
+  }
+
+  uint64_t offset = tail & mask;
+  uint32_t uri_length = 0;
+  uint32_t size = 0;
+
+  if (available > capacity || offset + SAPI_RING_RECORD_HEADER_SIZE > capacity) {
+    return -1;
+  }
+
+  memcpy(&uri_length, ring->data + offset, sizeof(uri_length));
+
+  if (uri_length == SAPI_RING_WRAP) {
+    if (available < capacity - offset) {
+      return -1;
+    }
+
+    tail += capacity - offset;
+    available -= capacity - offset;
+    __atomic_store_n(&ring->header->tail, tail, __ATOMIC_RELEASE);
+
+    if (available == 0) {
+      return 0;
+    }
+
+    offset = 0;
+    memcpy(&uri_length, ring->data, sizeof(uri_length));
+  }
+
+  // the lengths are read once, later writes to the record can not move it
+  memcpy(&size, ring->data + offset + 4, sizeof(size));
+
+  uint64_t length = sapi_ring_align(
+    SAPI_RING_RECORD_HEADER_SIZE + (uint64_t) uri_length + size
+  );
+
+  // `sapi_ring_write()` never writes more than half the ring at once
+  if (length > capacity / 2 || length > available || offset + length > capacity) {
+    return -1;
+  }
+
+  const unsigned char* bytes = ring->data + offset;
+  record->uri_length = uri_length;
+  record->size = size;
+  record->uri = (const char*) bytes + SAPI_RING_RECORD_HEADER_SIZE;
+  record->bytes = bytes + SAPI_RING_RECORD_HEADER_SIZE + uri_length;
+  record->next = tail + length;
+
+  return 1;
+}
+
+/**
+ * Gives the space of a message read with `sapi_ring_read()` back to the
+ * producer, its pointers are not valid after.
+ */
+static inline void sapi_ring_release (sapi_ring_t* ring, const sapi_ring_record_t* record) {
+  __atomic_store_n(&ring->header->tail, record->next, __ATOMIC_RELEASE);
+}
+
+/**
+ * Called by the consumer before it waits for a notification, `0` if
+ * messages arrived in the meantime and it should not wait.
+ */
+static inline int sapi_ring_prepare_wait (sapi_ring_t* ring) {
+  __atomic_store_n(&ring->header->waiting, 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  uint64_t tail = __atomic_load_n(&ring->header->tail, __ATOMIC_RELAXED);
+  uint64_t head = __atomic_load_n(&ring->header->head, __ATOMIC_ACQUIRE);
+
+  if (tail != head) {
+    __atomic_store_n(&ring->header->waiting, 0, __ATOMIC_RELAXED);
+    return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * Called by the consumer once it woke up.
+ */
+static inline void sapi_ring_end_wait (sapi_ring_t* ring) {
+  __atomic_store_n(&ring->header->waiting, 0, __ATOMIC_RELAXED);
+}
+
+/**
+ * Whether the producer has to notify the consumer of the messages it
+ * wrote, so a busy consumer costs no system calls.
+ */
+static inline int sapi_ring_should_notify (sapi_ring_t* ring) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  return __atomic_load_n(&ring->header->waiting, __ATOMIC_RELAXED) != 0;
+}
+
+#if !SOCKET_RUNTIME_PLATFORM_WINDOWS
+/**
+ * Wakes the consumer waiting on the other end of `fd`, an `eventfd` on
+ * Linux and a pipe elsewhere, if it waits.
+ */
+static inline void sapi_ring_notify (sapi_ring_t* ring, int fd) {
+  uint64_t value = 1;
+
+  if (sapi_ring_should_notify(ring)) {
+    while (write(fd, &value, sizeof(value)) < 0 && errno == EINTR);
+  }
+}
+
+/**
+ * Maps the shared memory given with `--channel-shm` and attaches to its
+ * rings, `incoming` is the one the runtime writes to. `-1` on failure.
+ */
+static inline int sapi_ring_map (
+  int fd,
+  sapi_ring_t* outgoing,
+  sapi_ring_t* incoming
+) {
+  struct stat stats;
+  void* memory = NULL;
+
+  if (fstat(fd, &stats) != 0 || stats.st_size <= 0) {
+    return -1;
+  }
+
+  memory = mmap(NULL, stats.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+  if (memory == MAP_FAILED) {
+    return -1;
+  }
+
+  size_t size = (size_t) stats.st_size / 2;
+
+  if (
+    sapi_ring_attach(outgoing, memory, size) != 0 ||
+    sapi_ring_attach(incoming, (unsigned char*) memory + size, size) != 0
+  ) {
+    munmap(memory, stats.st_size);
+    return -1;
+  }
+
+  return 0;
+}
+#endif
+
+#endif
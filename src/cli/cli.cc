@@ -654,7 +654,26 @@ void runIOSSimulator (const Path& path, Map& settings) {
     << " simctl"
     << " list devicetypes";
 
-  auto rListDeviceTypes = exec(listDeviceTypesCommand.str().c_str());
+  StringStream listDevicesCommand;
+  listDevicesCommand
+    << "xcrun"
+    << " simctl"
+    << " list devices available";
+
+  StringStream listRuntimesCommand;
+  listRuntimesCommand
+    << "xcrun"
+    << " simctl"
+    << " list runtimes available";
+
+  // independent queries, the runtimes are only needed for a new simulator VM
+  auto simctlQueries = exec(Vector<String> {
+    listDeviceTypesCommand.str(),
+    listDevicesCommand.str(),
+    listRuntimesCommand.str()
+  });
+
+  auto rListDeviceTypes = simctlQueries[0];
   if (rListDeviceTypes.exitCode != 0) {
     log("failed to list device types using \"" + listDeviceTypesCommand.str() + "\"");
     if (rListDeviceTypes.output.size() > 0) {
@@ -682,12 +701,7 @@ void runIOSSimulator (const Path& path, Map& settings) {
     exit(rListDevices.exitCode);
   }
 
-  StringStream listDevicesCommand;
-  listDevicesCommand
-    << "xcrun"
-    << " simctl"
-    << " list devices available";
-  auto rListDevices = exec(listDevicesCommand.str().c_str());
+  auto rListDevices = simctlQueries[1];
   if (rListDevices.exitCode != 0) {
     log("failed to list available devices using \"" + listDevicesCommand.str() + "\"");
     if (rListDevices.output.size() > 0) {
@@ -716,12 +730,7 @@ void runIOSSimulator (const Path& path, Map& settings) {
   } else {
     log("creating a new iOS simulator VM for " + settings["ios_simulator_device"]);
 
-    StringStream listRuntimesCommand;
-    listRuntimesCommand
-      << "xcrun"
-      << " simctl"
-      << " list runtimes available";
-    auto rListRuntimes = exec(listRuntimesCommand.str().c_str());
+    auto rListRuntimes = simctlQueries[2];
     if (rListRuntimes.exitCode != 0) {
       log("failed to list available runtimes using \"" + listRuntimesCommand.str() + "\"");
       if (rListRuntimes.output.size() > 0) {
@@ -3591,6 +3600,10 @@ int main (const int argc, const char* argv[]) {
             }
           }
 
+          // objects of an extension are compiled at the same time
+          Vector<String> compileExtensionObjectCommands;
+          Vector<Path> compiledExtensionObjects;
+
           for (const auto& source : sources) {
             if (getEnv("DEBUG") == "1" || getEnv("VERBOSE") == "1") {
               log("extension source: " + source);
@@ -3678,16 +3691,21 @@ int main (const int argc, const char* argv[]) {
               log(compileExtensionObjectCommand.str());
             }
 
-            do {
-              auto r = exec(compileExtensionObjectCommand.str());
+            compileExtensionObjectCommands.push_back(compileExtensionObjectCommand.str());
+            compiledExtensionObjects.push_back(object);
+          }
+
+          do {
+            auto results = exec(compileExtensionObjectCommands);
 
-              if (r.exitCode != 0) {
-                log("Unable to build extension object (" + object.string() + ")");
-                log(r.output);
-                exit(r.exitCode);
+            for (size_t i = 0; i < results.size(); ++i) {
+              if (results[i].exitCode != 0) {
+                log("Unable to build extension object (" + compiledExtensionObjects[i].string() + ")");
+                log(results[i].output);
+                exit(results[i].exitCode);
               }
-            } while (0);
-          }
+            }
+          } while (0);
 
           auto linkerFlags = (
             settings["build_extensions_linker_flags"] + " " +
@@ -4482,6 +4500,10 @@ int main (const int argc, const char* argv[]) {
             trim(prefixFile("src/init.cc"))
           );
 
+          // objects of an extension are compiled at the same time
+          Vector<String> compileExtensionObjectCommands;
+          Vector<Path> compiledExtensionObjects;
+
           for (auto source : sources) {
             if (getEnv("DEBUG") == "1" || getEnv("VERBOSE") == "1") {
               log("extension source: " + source);
@@ -4624,16 +4646,21 @@ int main (const int argc, const char* argv[]) {
               log(compileExtensionObjectCommand.str());
             }
 
-            do {
-              auto r = exec(compileExtensionObjectCommand.str());
+            compileExtensionObjectCommands.push_back(compileExtensionObjectCommand.str());
+            compiledExtensionObjects.push_back(object);
+          }
+
+          do {
+            auto results = exec(compileExtensionObjectCommands);
 
-              if (r.exitCode != 0) {
-                log("Unable to build extension object (" + object.string() + ")");
-                log(r.output);
-                exit(r.exitCode);
+            for (size_t i = 0; i < results.size(); ++i) {
+              if (results[i].exitCode != 0) {
+                log("Unable to build extension object (" + compiledExtensionObjects[i].string() + ")");
+                log(results[i].output);
+                exit(results[i].exitCode);
               }
-            } while (0);
-          }
+            }
+          } while (0);
 
           auto linkerFlags = (
             settings["build_extensions_linker_flags"] + " " +
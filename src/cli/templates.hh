@@ -1479,6 +1479,12 @@ categories = "Developer Tools"
 ; The command to execute to spawn the "back-end" process.
 cmd = "beepboop"
 
+; Set to "socket" (or true) to also connect the "back-end" process with a Unix domain socket, its descriptor is given with `--channel-fd`, or to "shm" for shared memory rings given with `--channel-shm` (see `include/socket/ring.h`).
+cmd_channel = false
+
+; Keep a spare "back-end" process started and waiting on its stdin, so a restart swaps it in instead of starting a new one. Has no effect with `cmd_channel`.
+cmd_prewarm = false
+
 ; The icon to use for identifying your app in Linux desktop environments.
 icon = "src/icon.png"
 
@@ -1494,6 +1500,12 @@ category = ""
 ; The command to execute to spawn the "back-end" process.
 cmd = ""
 
+; Set to "socket" (or true) to also connect the "back-end" process with a Unix domain socket, its descriptor is given with `--channel-fd`, or to "shm" for shared memory rings given with `--channel-shm` (see `include/socket/ring.h`).
+cmd_channel = false
+
+; Keep a spare "back-end" process started and waiting on its stdin, so a restart swaps it in instead of starting a new one. Has no effect with `cmd_channel`.
+cmd_prewarm = false
+
 ; The icon to use for identifying your app on MacOS.
 icon = ""
 
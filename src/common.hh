@@ -126,20 +126,26 @@ static os_log_t SSC_OS_LOG_DEBUG_BUNDLE = nullptr;
 #include <any>
 #include <array>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <iostream>
 #include <exception>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <list>
 #include <map>
 #include <mutex>
 #include <queue>
 #include <regex>
+#include <set>
+#include <shared_mutex>
 #include <span>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #ifndef DEBUG
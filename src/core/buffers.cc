@@ -0,0 +1,259 @@
+#include "core.hh"
+
+namespace SSC {
+  static JSON::Object::Entries ERR_BUFFER_NOT_FOUND (
+    const String& source,
+    uint64_t id
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"code", "NOT_FOUND_ERR"},
+        {"type", "NotFoundError"},
+        {"message", "No buffer with specified id"}
+      }}
+    };
+  }
+
+  static JSON::Object::Entries ERR_BUFFER_TOO_BIG (
+    const String& source,
+    uint64_t id
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"code", "ENOBUFS"},
+        {"message", "Buffer is larger than the buffer limits"}
+      }}
+    };
+  }
+
+  void Core::Buffers::insert (uint64_t id, const Handle &handle) {
+    this->recent.push_front(id);
+    this->entries[id] = Entry { handle, this->recent.begin() };
+
+    if (this->storages[handle.storage.get()]++ == 0) {
+      this->totalBytes += handle.storage->size();
+    }
+  }
+
+  void Core::Buffers::erase (uint64_t id) {
+    auto it = this->entries.find(id);
+
+    if (it == this->entries.end()) {
+      return;
+    }
+
+    auto storage = it->second.handle.storage.get();
+
+    if (--this->storages[storage] == 0) {
+      this->storages.erase(storage);
+      this->totalBytes -= storage->size();
+    }
+
+    this->recent.erase(it->second.recent);
+    this->entries.erase(it);
+  }
+
+  void Core::Buffers::evict (uint64_t keep) {
+    // bytes still referenced by pending calls stay alive with them
+    while (this->totalBytes > this->maxBytes && this->recent.size() > 0) {
+      auto id = this->recent.back();
+
+      if (id == keep) {
+        if (this->recent.size() == 1) {
+          break;
+        }
+
+        // `keep` is the most recently used, it is only last when alone
+        id = *std::prev(this->recent.end(), 2);
+      }
+
+      this->erase(id);
+      this->evictions++;
+    }
+  }
+
+  bool Core::Buffers::get (uint64_t id, Handle &handle) {
+    Lock lock(this->mutex);
+    auto it = this->entries.find(id);
+
+    if (it == this->entries.end()) {
+      return false;
+    }
+
+    this->recent.splice(this->recent.begin(), this->recent, it->second.recent);
+    handle = it->second.handle;
+    return true;
+  }
+
+  void Core::Buffers::create (
+    const String seq,
+    uint64_t id,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    Lock lock(this->mutex);
+
+    if (size > this->maxBytes) {
+      return cb(seq, ERR_BUFFER_TOO_BIG("buffer.alloc", id), Post{});
+    }
+
+    auto storage = std::make_shared<Vector<char>>(bytes, bytes + size);
+
+    this->erase(id);
+    this->insert(id, Handle { storage, 0, size });
+    this->evict(id);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "buffer.alloc"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"size", (uint64_t) size}
+      }}
+    }, Post{});
+  }
+
+  void Core::Buffers::append (
+    const String seq,
+    uint64_t id,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    Lock lock(this->mutex);
+    auto it = this->entries.find(id);
+
+    if (it == this->entries.end()) {
+      return cb(seq, ERR_BUFFER_NOT_FOUND("buffer.append", id), Post{});
+    }
+
+    auto handle = it->second.handle;
+
+    if (handle.size + size > this->maxBytes) {
+      return cb(seq, ERR_BUFFER_TOO_BIG("buffer.append", id), Post{});
+    }
+
+    // bytes shared with slices or pending calls, or a slice itself, are
+    // copied so nothing else sees them change
+    if (
+      handle.storage.use_count() > 2 ||
+      handle.offset > 0 ||
+      handle.size < handle.storage->size()
+    ) {
+      auto storage = std::make_shared<Vector<char>>();
+      storage->reserve(handle.size + size);
+      storage->insert(storage->end(), handle.data(), handle.data() + handle.size);
+      handle = Handle { storage, 0, handle.size };
+      this->erase(id);
+      this->insert(id, handle);
+      it = this->entries.find(id);
+    }
+
+    handle.storage->insert(handle.storage->end(), bytes, bytes + size);
+    handle.size += size;
+    it->second.handle.size = handle.size;
+    this->totalBytes += size;
+    this->recent.splice(this->recent.begin(), this->recent, it->second.recent);
+    this->evict(id);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "buffer.append"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"size", (uint64_t) handle.size}
+      }}
+    }, Post{});
+  }
+
+  void Core::Buffers::slice (
+    const String seq,
+    uint64_t id,
+    uint64_t sourceId,
+    size_t offset,
+    size_t size,
+    Module::Callback cb
+  ) {
+    Lock lock(this->mutex);
+    auto it = this->entries.find(sourceId);
+
+    if (it == this->entries.end()) {
+      return cb(seq, ERR_BUFFER_NOT_FOUND("buffer.slice", sourceId), Post{});
+    }
+
+    auto source = it->second.handle;
+
+    if (offset > source.size || size > source.size - offset) {
+      return cb(seq, JSON::Object::Entries {
+        {"source", "buffer.slice"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"code", "ERR_OUT_OF_RANGE"},
+          {"type", "RangeError"},
+          {"message", "Slice is out of the bounds of the buffer"}
+        }}
+      }, Post{});
+    }
+
+    // `source` holds the bytes while a buffer is replaced with its slice
+    auto handle = Handle { source.storage, source.offset + offset, size };
+    this->erase(id);
+    this->insert(id, handle);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "buffer.slice"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"size", (uint64_t) size}
+      }}
+    }, Post{});
+  }
+
+  void Core::Buffers::release (const String seq, uint64_t id, Module::Callback cb) {
+    Lock lock(this->mutex);
+
+    if (!this->entries.contains(id)) {
+      return cb(seq, ERR_BUFFER_NOT_FOUND("buffer.release", id), Post{});
+    }
+
+    this->erase(id);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "buffer.release"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)}
+      }}
+    }, Post{});
+  }
+
+  void Core::Buffers::getState (const String seq, Module::Callback cb) {
+    Lock lock(this->mutex);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "buffer.getState"},
+      {"data", JSON::Object::Entries {
+        {"count", (uint64_t) this->entries.size()},
+        {"bytes", (uint64_t) this->totalBytes},
+        {"maxBytes", (uint64_t) this->maxBytes},
+        {"evictions", (uint64_t) this->evictions}
+      }}
+    }, Post{});
+  }
+
+  void Core::Buffers::setLimits (const String seq, size_t maxBytes, Module::Callback cb) {
+    Lock lock(this->mutex);
+
+    this->maxBytes = maxBytes;
+    this->evict(0);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "buffer.setLimits"},
+      {"data", JSON::Object::Entries {
+        {"maxBytes", (uint64_t) this->maxBytes}
+      }}
+    }, Post{});
+  }
+}
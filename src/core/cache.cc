@@ -0,0 +1,480 @@
+#include "core.hh"
+
+#include <cstring>
+
+namespace SSC::StreamRelay {
+  // FNV-1a, split into two halves for double hashing
+  static inline uint64_t hashPacketID (const String &packetId) {
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (auto c : packetId) {
+      hash ^= (unsigned char) c;
+      hash *= 0x100000001b3;
+    }
+
+    return hash;
+  }
+
+  PacketBloomFilter::PacketBloomFilter (size_t capacity) {
+    size_t size = 64;
+
+    while (size < capacity * COUNTERS_PER_ENTRY) {
+      size <<= 1;
+    }
+
+    this->counters.resize(size, 0);
+    this->mask = size - 1;
+  }
+
+  template <typename F>
+  void PacketBloomFilter::forEachCounter (const String &packetId, F fn) const {
+    auto hash = hashPacketID(packetId);
+    auto h1 = (uint32_t) hash;
+    auto h2 = (uint32_t) (hash >> 32) | 1;
+
+    for (int i = 0; i < HASHES; ++i) {
+      fn((h1 + i * h2) & this->mask);
+    }
+  }
+
+  void PacketBloomFilter::add (const String &packetId) {
+    this->forEachCounter(packetId, [this](size_t index) {
+      // a saturated counter sticks, it can't tell how many entries it holds
+      if (this->counters[index] < 0xff) {
+        this->counters[index]++;
+      }
+    });
+  }
+
+  void PacketBloomFilter::remove (const String &packetId) {
+    this->forEachCounter(packetId, [this](size_t index) {
+      if (this->counters[index] > 0 && this->counters[index] < 0xff) {
+        this->counters[index]--;
+      }
+    });
+  }
+
+  void PacketBloomFilter::clear () {
+    std::fill(this->counters.begin(), this->counters.end(), 0);
+  }
+
+  bool PacketBloomFilter::mayContain (const String &packetId) const {
+    bool found = true;
+
+    this->forEachCounter(packetId, [&](size_t index) {
+      if (this->counters[index] == 0) {
+        found = false;
+      }
+    });
+
+    return found;
+  }
+
+  PacketCache::PacketCache (const Options &options)
+    : options(options),
+      filter(options.maxCount > 0 ? options.maxCount : DEFAULT_MAX_COUNT)
+  {}
+
+  void PacketCache::link (Entry *entry) {
+    auto& bucket = this->buckets[entry->clock];
+
+    entry->prev = bucket.tail;
+    entry->next = nullptr;
+
+    if (bucket.tail != nullptr) {
+      bucket.tail->next = entry;
+    } else {
+      bucket.head = entry;
+    }
+
+    bucket.tail = entry;
+  }
+
+  void PacketCache::unlink (Entry *entry) {
+    auto it = this->buckets.find(entry->clock);
+
+    if (it == this->buckets.end()) {
+      return;
+    }
+
+    auto& bucket = it->second;
+
+    if (entry->prev != nullptr) {
+      entry->prev->next = entry->next;
+    } else {
+      bucket.head = entry->next;
+    }
+
+    if (entry->next != nullptr) {
+      entry->next->prev = entry->prev;
+    } else {
+      bucket.tail = entry->prev;
+    }
+
+    entry->prev = nullptr;
+    entry->next = nullptr;
+
+    if (bucket.head == nullptr) {
+      this->buckets.erase(it);
+    }
+  }
+
+  void PacketCache::erase (const String &packetId) {
+    auto it = this->entries.find(packetId);
+
+    if (it == this->entries.end()) {
+      return;
+    }
+
+    auto entry = it->second.get();
+    this->unlink(entry);
+    this->filter.remove(packetId);
+    this->totalBytes -= entry->bytes.size();
+    this->entries.erase(it);
+  }
+
+  void PacketCache::evict () {
+    if (this->buckets.size() == 0) {
+      return;
+    }
+
+    // `[...values].sort(defaultSiblingResolver).pop()` takes the highest
+    // clock and, as the sort is stable, the last inserted of those
+    auto tail = this->buckets.rbegin()->second.tail;
+    this->erase(tail->packetId);
+  }
+
+  bool PacketCache::insert (const Packet &packet, const char *bytes, size_t size) {
+    if (packet.type != PACKET_TYPE_PUBLISH) {
+      return false;
+    }
+
+    auto packetId = encodePacketID(packet.packetId);
+
+    if (packetId.size() == 0) {
+      return false;
+    }
+
+    Lock lock(this->mutex);
+
+    if (this->entries.contains(packetId)) {
+      return true;
+    }
+
+    if (this->options.maxBytes > 0 && size > this->options.maxBytes) {
+      return false;
+    }
+
+    while (
+      this->entries.size() > 0 && (
+        (this->options.maxCount > 0 && this->entries.size() >= this->options.maxCount) ||
+        (this->options.maxBytes > 0 && this->totalBytes + size > this->options.maxBytes)
+      )
+    ) {
+      this->evict();
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->packetId = packetId;
+    entry->clock = packet.clock;
+    entry->timestamp = (uint64_t) std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+    entry->bytes.assign(bytes, bytes + size);
+
+    this->link(entry.get());
+    this->filter.add(packetId);
+    this->totalBytes += size;
+    this->entries.emplace(packetId, std::move(entry));
+    return true;
+  }
+
+  bool PacketCache::get (const String &packetId, Entry &entry) {
+    Lock lock(this->mutex);
+
+    if (!this->filter.mayContain(packetId)) {
+      return false;
+    }
+
+    auto it = this->entries.find(packetId);
+
+    if (it == this->entries.end()) {
+      return false;
+    }
+
+    entry.packetId = it->second->packetId;
+    entry.clock = it->second->clock;
+    entry.timestamp = it->second->timestamp;
+    entry.bytes = it->second->bytes;
+    return true;
+  }
+
+  bool PacketCache::has (const String &packetId) {
+    Lock lock(this->mutex);
+
+    // most gossip is new, the filter answers those without a map lookup
+    if (!this->filter.mayContain(packetId)) {
+      return false;
+    }
+
+    return this->entries.contains(packetId);
+  }
+
+  bool PacketCache::remove (const String &packetId) {
+    Lock lock(this->mutex);
+
+    if (!this->entries.contains(packetId)) {
+      return false;
+    }
+
+    this->erase(packetId);
+    return true;
+  }
+
+  void PacketCache::clear () {
+    Lock lock(this->mutex);
+    this->entries.clear();
+    this->buckets.clear();
+    this->filter.clear();
+    this->totalBytes = 0;
+  }
+
+  size_t PacketCache::size () {
+    Lock lock(this->mutex);
+    return this->entries.size();
+  }
+
+  size_t PacketCache::bytes () {
+    Lock lock(this->mutex);
+    return this->totalBytes;
+  }
+}
+
+namespace SSC {
+  static JSON::Object::Entries ERR_CACHE_NOT_FOUND (
+    const String& source,
+    uint64_t id
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"code", "NOT_FOUND_ERR"},
+        {"type", "NotFoundError"},
+        {"message", "No cache with specified id"}
+      }}
+    };
+  }
+
+  static JSON::Object::Entries getCacheState (
+    uint64_t id,
+    std::shared_ptr<StreamRelay::PacketCache> cache
+  ) {
+    return JSON::Object::Entries {
+      {"id", std::to_string(id)},
+      {"size", (uint64_t) cache->size()},
+      {"bytes", (uint64_t) cache->bytes()},
+      {"maxBytes", (uint64_t) cache->options.maxBytes},
+      {"maxCount", (uint64_t) cache->options.maxCount}
+    };
+  }
+
+  std::shared_ptr<StreamRelay::PacketCache> Core::Cache::getCache (uint64_t id) {
+    Lock lock(this->mutex);
+
+    if (!this->caches.contains(id)) {
+      return nullptr;
+    }
+
+    return this->caches.at(id);
+  }
+
+  void Core::Cache::create (
+    const String seq,
+    uint64_t id,
+    StreamRelay::PacketCache::Options options,
+    Module::Callback cb
+  ) {
+    std::shared_ptr<StreamRelay::PacketCache> cache;
+
+    do {
+      Lock lock(this->mutex);
+
+      if (!this->caches.contains(id)) {
+        this->caches[id] = std::make_shared<StreamRelay::PacketCache>(options);
+      }
+
+      cache = this->caches.at(id);
+    } while (0);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "cache.create"},
+      {"data", getCacheState(id, cache)}
+    }, Post{});
+  }
+
+  void Core::Cache::destroy (const String seq, uint64_t id, Module::Callback cb) {
+    Lock lock(this->mutex);
+
+    if (!this->caches.contains(id)) {
+      return cb(seq, ERR_CACHE_NOT_FOUND("cache.destroy", id), Post{});
+    }
+
+    this->caches.erase(id);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "cache.destroy"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)}
+      }}
+    }, Post{});
+  }
+
+  void Core::Cache::insert (
+    const String seq,
+    uint64_t id,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    auto cache = this->getCache(id);
+
+    if (cache == nullptr) {
+      return cb(seq, ERR_CACHE_NOT_FOUND("cache.insert", id), Post{});
+    }
+
+    StreamRelay::Packet packet;
+
+    if (!StreamRelay::decodePacket(bytes, size, packet)) {
+      auto json = JSON::Object::Entries {
+        {"source", "cache.insert"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"message", "Bytes given are not a packet"}
+        }}
+      };
+
+      return cb(seq, json, Post{});
+    }
+
+    auto inserted = cache->insert(packet, bytes, size);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "cache.insert"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"packetId", StreamRelay::encodePacketID(packet.packetId)},
+        {"inserted", inserted}
+      }}
+    }, Post{});
+  }
+
+  void Core::Cache::get (
+    const String seq,
+    uint64_t id,
+    const String packetId,
+    Module::Callback cb
+  ) {
+    auto cache = this->getCache(id);
+
+    if (cache == nullptr) {
+      return cb(seq, ERR_CACHE_NOT_FOUND("cache.get", id), Post{});
+    }
+
+    StreamRelay::PacketCache::Entry entry;
+
+    if (!cache->get(packetId, entry)) {
+      auto json = JSON::Object::Entries {
+        {"source", "cache.get"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"code", "NOT_FOUND_ERR"},
+          {"type", "NotFoundError"},
+          {"message", "No packet with specified packetId"}
+        }}
+      };
+
+      return cb(seq, json, Post{});
+    }
+
+    auto size = entry.bytes.size();
+    auto headers = Headers {{
+      {"content-type" ,"application/octet-stream"},
+      {"content-length", (uint64_t) size}
+    }};
+
+    Post post;
+    post.id = rand64();
+    post.body = new char[size]{0};
+    post.length = (int) size;
+    post.headers = headers.str();
+    memcpy(post.body, entry.bytes.data(), size);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "cache.get"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"packetId", entry.packetId},
+        {"clock", entry.clock},
+        {"timestamp", entry.timestamp}
+      }}
+    }, post);
+  }
+
+  void Core::Cache::has (
+    const String seq,
+    uint64_t id,
+    const String packetId,
+    Module::Callback cb
+  ) {
+    auto cache = this->getCache(id);
+
+    if (cache == nullptr) {
+      return cb(seq, ERR_CACHE_NOT_FOUND("cache.has", id), Post{});
+    }
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "cache.has"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"packetId", packetId},
+        {"has", cache->has(packetId)}
+      }}
+    }, Post{});
+  }
+
+  void Core::Cache::remove (
+    const String seq,
+    uint64_t id,
+    const String packetId,
+    Module::Callback cb
+  ) {
+    auto cache = this->getCache(id);
+
+    if (cache == nullptr) {
+      return cb(seq, ERR_CACHE_NOT_FOUND("cache.delete", id), Post{});
+    }
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "cache.delete"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"packetId", packetId},
+        {"deleted", cache->remove(packetId)}
+      }}
+    }, Post{});
+  }
+
+  void Core::Cache::getState (const String seq, uint64_t id, Module::Callback cb) {
+    auto cache = this->getCache(id);
+
+    if (cache == nullptr) {
+      return cb(seq, ERR_CACHE_NOT_FOUND("cache.getState", id), Post{});
+    }
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "cache.getState"},
+      {"data", getCacheState(id, cache)}
+    }, Post{});
+  }
+}
@@ -0,0 +1,1267 @@
+#include "core.hh"
+#include "../../include/socket/ring.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/eventfd.h>
+#endif
+
+namespace SSC {
+  static JSON::Object::Entries ERR_CHANNEL (const String& source, int status) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"code", String(uv_err_name(status))},
+        {"message", String(uv_strerror(status))}
+      }}
+    };
+  }
+
+  static inline uint32_t readUInt32BE (const unsigned char *bytes) {
+    return
+      ((uint32_t) bytes[0] << 24) |
+      ((uint32_t) bytes[1] << 16) |
+      ((uint32_t) bytes[2] << 8) |
+      ((uint32_t) bytes[3]);
+  }
+
+  static inline void writeUInt32BE (unsigned char *bytes, uint32_t value) {
+    bytes[0] = (value >> 24) & 0xff;
+    bytes[1] = (value >> 16) & 0xff;
+    bytes[2] = (value >> 8) & 0xff;
+    bytes[3] = value & 0xff;
+  }
+
+  struct Core::Channel::Connection {
+    uv_pipe_t pipe;
+    Channel *channel = nullptr;
+    FramesCallback onFrames = nullptr;
+    Decoder decoder;
+    char *buffer = nullptr;
+    bool opened = false;
+    bool closing = false;
+
+    // only called on the Core loop
+    void close () {
+      if (this->closing) return;
+      this->closing = true;
+
+      do {
+        Lock lock(this->channel->mutex);
+        if (this->channel->connection == this) {
+          this->channel->connection = nullptr;
+        }
+      } while (0);
+
+      if (!this->opened) {
+        delete [] this->buffer;
+        delete this;
+        return;
+      }
+
+      uv_read_stop((uv_stream_t *) &this->pipe);
+      uv_close((uv_handle_t *) &this->pipe, [](uv_handle_t *handle) {
+        auto connection = reinterpret_cast<Connection *>(handle->data);
+        delete [] connection->buffer;
+        delete connection;
+      });
+    }
+  };
+
+  struct Core::Channel::WriteBatch {
+    uv_write_t req;
+    Channel *channel = nullptr;
+    Vector<WriteRequest> requests;
+
+    void complete (int status) {
+      if (status == 0) {
+        Lock lock(this->channel->mutex);
+        this->channel->stats.batches++;
+        this->channel->stats.framesWritten += this->requests.size();
+
+        for (const auto& request : this->requests) {
+          this->channel->stats.bytesWritten += request.headerSize + request.bodySize;
+        }
+      }
+
+      for (auto& request : this->requests) {
+        delete [] request.header;
+
+        if (request.ownsBody) {
+          delete [] request.body;
+        }
+
+        if (request.cb != nullptr) {
+          request.cb(status);
+        }
+      }
+
+      delete this;
+    }
+  };
+
+  struct Core::Channel::SharedMemory {
+    uv_poll_t poll;
+    uv_timer_t timer;
+    Channel *channel = nullptr;
+    FramesCallback onFrames = nullptr;
+    void *memory = nullptr;
+    size_t size = 0;
+    // written by the backend
+    sapi_ring_t incoming;
+    // written by the runtime
+    sapi_ring_t outgoing;
+    // readable when the backend wrote to `incoming`
+    int waitDescriptor = -1;
+    // wakes the backend up after writing to `outgoing`
+    int notifyDescriptor = -1;
+    // writes waiting for space in `outgoing`
+    Vector<WriteRequest> pending;
+    int handles = 0;
+    bool opened = false;
+    bool closing = false;
+
+    void complete (WriteRequest& request, int status) {
+      if (status == 0) {
+        Lock lock(this->channel->mutex);
+        this->channel->stats.framesWritten++;
+        this->channel->stats.bytesWritten += (
+          SAPI_RING_RECORD_HEADER_SIZE +
+          request.headerSize - FRAME_HEADER_SIZE +
+          request.bodySize
+        );
+      }
+
+      delete [] request.header;
+
+      if (request.ownsBody) {
+        delete [] request.body;
+      }
+
+      if (request.cb != nullptr) {
+        request.cb(status);
+      }
+    }
+
+    // only called on the Core loop
+    void read () {
+      Vector<Frame> frames;
+      sapi_ring_record_t record;
+      uint64_t bytes = 0;
+      bool corrupt = false;
+      int status = 0;
+
+      do {
+        while ((status = sapi_ring_read(&this->incoming, &record)) > 0) {
+          // the same limit as frames read from the socket
+          if ((size_t) record.uri_length + record.size > MAX_FRAME_SIZE) {
+            status = -1;
+            break;
+          }
+
+          Frame frame;
+          frame.uri = String(record.uri, record.uri_length);
+          frame.size = record.size;
+
+          // the only copy of the body, out of the ring so its space can
+          // be given back right away
+          if (record.size > 0) {
+            frame.bytes = std::shared_ptr<char[]>(new char[record.size]);
+            memcpy(frame.bytes.get(), record.bytes, record.size);
+          }
+
+          bytes += SAPI_RING_RECORD_HEADER_SIZE + record.uri_length + record.size;
+          sapi_ring_release(&this->incoming, &record);
+          frames.push_back(std::move(frame));
+        }
+
+        // the backend wrote a message outside of the ring
+        if (status < 0) {
+          corrupt = true;
+          break;
+        }
+      } while (!sapi_ring_prepare_wait(&this->incoming));
+
+      if (frames.size() > 0) {
+        do {
+          Lock lock(this->channel->mutex);
+          this->channel->stats.framesRead += frames.size();
+          this->channel->stats.bytesRead += bytes;
+        } while (0);
+
+        if (this->onFrames != nullptr) {
+          this->onFrames(frames);
+        }
+      }
+
+      if (corrupt) {
+        this->close();
+      }
+    }
+
+    // only called on the Core loop
+    void flush () {
+      size_t written = 0;
+
+      for (; written < this->pending.size(); ++written) {
+        auto& request = this->pending[written];
+        auto err = sapi_ring_write(
+          &this->outgoing,
+          request.header + FRAME_HEADER_SIZE,
+          request.headerSize - FRAME_HEADER_SIZE,
+          request.body,
+          request.bodySize
+        );
+
+        if (err == SAPI_RING_FULL) {
+          break;
+        }
+
+        this->complete(request, err == SAPI_RING_OK ? 0 : UV_EMSGSIZE);
+      }
+
+      if (written > 0) {
+        this->pending.erase(this->pending.begin(), this->pending.begin() + written);
+      #if !defined(_WIN32)
+        sapi_ring_notify(&this->outgoing, this->notifyDescriptor);
+      #endif
+      }
+
+      // the backend does not say when it made space, try again shortly
+      if (this->pending.size() > 0 && !uv_is_active((uv_handle_t *) &this->timer)) {
+        uv_timer_start(&this->timer, [](uv_timer_t *timer) {
+          reinterpret_cast<SharedMemory *>(timer->data)->flush();
+        }, RING_RETRY_INTERVAL, 0);
+      }
+    }
+
+    // only called on the Core loop
+    void close () {
+      if (this->closing) return;
+      this->closing = true;
+
+      do {
+        Lock lock(this->channel->mutex);
+        if (this->channel->sharedMemory == this) {
+          this->channel->sharedMemory = nullptr;
+        }
+      } while (0);
+
+      for (auto& request : this->pending) {
+        this->complete(request, UV_EPIPE);
+      }
+
+      this->pending.clear();
+
+      if (!this->opened) {
+        return this->release();
+      }
+
+      uv_poll_stop(&this->poll);
+      uv_timer_stop(&this->timer);
+
+      for (auto handle : { (uv_handle_t *) &this->poll, (uv_handle_t *) &this->timer }) {
+        uv_close(handle, [](uv_handle_t *handle) {
+          auto sharedMemory = reinterpret_cast<SharedMemory *>(handle->data);
+          if (--sharedMemory->handles == 0) {
+            sharedMemory->release();
+          }
+        });
+      }
+    }
+
+    void release () {
+    #if !defined(_WIN32)
+      if (this->memory != nullptr) {
+        munmap(this->memory, this->size);
+      }
+
+      if (this->waitDescriptor >= 0) {
+        ::close(this->waitDescriptor);
+      }
+
+      if (this->notifyDescriptor >= 0) {
+        ::close(this->notifyDescriptor);
+      }
+    #endif
+
+      delete this;
+    }
+  };
+
+  bool Core::Channel::Decoder::decode (
+    const char *bytes,
+    size_t size,
+    Vector<Frame>& frames
+  ) {
+    if (this->failed) {
+      return false;
+    }
+
+    auto data = bytes;
+    auto length = size;
+
+    // a frame split across reads is completed in `pending`, whole frames
+    // are decoded from `bytes` directly
+    if (this->pending.size() > 0) {
+      this->pending.insert(this->pending.end(), bytes, bytes + size);
+      data = this->pending.data();
+      length = this->pending.size();
+    }
+
+    size_t offset = 0;
+
+    while (length - offset >= FRAME_HEADER_SIZE) {
+      auto header = reinterpret_cast<const unsigned char *>(data + offset);
+      auto uriSize = (size_t) readUInt32BE(header);
+      auto bodySize = (size_t) readUInt32BE(header + 4);
+
+      if (uriSize + bodySize > MAX_FRAME_SIZE) {
+        this->failed = true;
+        this->pending.clear();
+        return false;
+      }
+
+      if (length - offset < FRAME_HEADER_SIZE + uriSize + bodySize) {
+        break;
+      }
+
+      Frame frame;
+      auto uri = data + offset + FRAME_HEADER_SIZE;
+      frame.uri = String(uri, uriSize);
+      frame.size = bodySize;
+
+      if (bodySize > 0) {
+        frame.bytes = std::shared_ptr<char[]>(new char[bodySize]);
+        memcpy(frame.bytes.get(), uri + uriSize, bodySize);
+      }
+
+      frames.push_back(std::move(frame));
+      offset += FRAME_HEADER_SIZE + uriSize + bodySize;
+    }
+
+    if (this->pending.size() > 0) {
+      this->pending.erase(this->pending.begin(), this->pending.begin() + offset);
+    } else if (offset < length) {
+      this->pending.assign(data + offset, data + length);
+    }
+
+    return true;
+  }
+
+  char * Core::Channel::encodeFrameHeader (
+    const String& uri,
+    size_t size,
+    size_t *length
+  ) {
+    auto header = new char[FRAME_HEADER_SIZE + uri.size()];
+    writeUInt32BE(reinterpret_cast<unsigned char *>(header), uri.size());
+    writeUInt32BE(reinterpret_cast<unsigned char *>(header + 4), size);
+    memcpy(header + FRAME_HEADER_SIZE, uri.data(), uri.size());
+    *length = FRAME_HEADER_SIZE + uri.size();
+    return header;
+  }
+
+  int Core::Channel::open (FramesCallback onFrames) {
+  #if defined(_WIN32)
+    return UV_ENOTSUP;
+  #else
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      return uv_translate_sys_error(errno);
+    }
+
+    // only the backend end is inherited by the process
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+  #if defined(SO_NOSIGPIPE)
+    int on = 1;
+    setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+  #endif
+
+    this->close();
+
+    auto connection = new Connection;
+    connection->channel = this;
+    connection->onFrames = onFrames;
+    connection->buffer = new char[READ_BUFFER_SIZE];
+
+    do {
+      Lock lock(this->mutex);
+      this->connection = connection;
+      this->remoteDescriptors = { fds[1] };
+      this->backendArguments = " --channel-fd=" + std::to_string(fds[1]);
+    } while (0);
+
+    auto descriptor = fds[0];
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = this->core->getEventLoop();
+
+      uv_pipe_init(loop, &connection->pipe, 0);
+      connection->pipe.data = connection;
+      connection->opened = true;
+
+      auto err = uv_pipe_open(&connection->pipe, descriptor);
+
+      if (err == 0) {
+        err = uv_read_start(
+          (uv_stream_t *) &connection->pipe,
+          [](uv_handle_t *handle, size_t size, uv_buf_t *buf) {
+            auto connection = reinterpret_cast<Connection *>(handle->data);
+            buf->base = connection->buffer;
+            buf->len = READ_BUFFER_SIZE;
+          },
+          [](uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+            auto connection = reinterpret_cast<Connection *>(stream->data);
+            auto channel = connection->channel;
+
+            if (nread <= 0) {
+              if (nread < 0) {
+                connection->close();
+              }
+
+              return;
+            }
+
+            Vector<Frame> frames;
+            auto decoded = connection->decoder.decode(buf->base, nread, frames);
+
+            do {
+              Lock lock(channel->mutex);
+              channel->stats.framesRead += frames.size();
+              channel->stats.bytesRead += nread;
+            } while (0);
+
+            if (frames.size() > 0) {
+              if (connection->onFrames != nullptr) {
+                connection->onFrames(frames);
+              }
+            }
+
+            if (!decoded) {
+              connection->close();
+            }
+          }
+        );
+      } else {
+        ::close(descriptor);
+      }
+
+      if (err != 0) {
+        connection->close();
+      }
+    });
+
+    return fds[1];
+  #endif
+  }
+
+  int Core::Channel::openSharedMemory (FramesCallback onFrames, size_t capacity) {
+  #if defined(_WIN32)
+    return UV_ENOTSUP;
+  #else
+    if (capacity < 4096 || (capacity & (capacity - 1)) != 0) {
+      return UV_EINVAL;
+    }
+
+    auto ringSize = sapi_ring_size(capacity);
+    auto size = ringSize * 2;
+    int memoryDescriptor = -1;
+    // [runtime end, backend end] of the wakeups in each direction
+    int incomingEvents[2] = { -1, -1 };
+    int outgoingEvents[2] = { -1, -1 };
+    int err = 0;
+
+  #if defined(__linux__) && !defined(__ANDROID__)
+    memoryDescriptor = memfd_create("socket-runtime-channel", 0);
+  #else
+    auto name = "/ssc-" + std::to_string(rand64() % 1000000000000);
+    memoryDescriptor = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (memoryDescriptor >= 0) {
+      shm_unlink(name.c_str());
+    }
+  #endif
+
+    if (memoryDescriptor < 0 || ftruncate(memoryDescriptor, size) != 0) {
+      err = uv_translate_sys_error(errno);
+
+      if (memoryDescriptor >= 0) {
+        ::close(memoryDescriptor);
+      }
+
+      return err;
+    }
+
+    auto memory = mmap(
+      nullptr,
+      size,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED,
+      memoryDescriptor,
+      0
+    );
+
+    if (memory == MAP_FAILED) {
+      err = uv_translate_sys_error(errno);
+      ::close(memoryDescriptor);
+      return err;
+    }
+
+  #if defined(__linux__) && !defined(__ANDROID__)
+    // one eventfd per direction, the runtime keeps copies of its own
+    incomingEvents[1] = eventfd(0, 0);
+    outgoingEvents[1] = eventfd(0, 0);
+
+    if (incomingEvents[1] >= 0 && outgoingEvents[1] >= 0) {
+      incomingEvents[0] = fcntl(incomingEvents[1], F_DUPFD_CLOEXEC, 0);
+      outgoingEvents[0] = fcntl(outgoingEvents[1], F_DUPFD_CLOEXEC, 0);
+    }
+  #else
+    int fds[2];
+
+    if (pipe(fds) == 0) {
+      incomingEvents[0] = fds[0];
+      incomingEvents[1] = fds[1];
+    }
+
+    if (pipe(fds) == 0) {
+      outgoingEvents[0] = fds[1];
+      outgoingEvents[1] = fds[0];
+    }
+
+    for (auto fd : { incomingEvents[0], outgoingEvents[0] }) {
+      if (fd >= 0) {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      }
+    }
+  #endif
+
+    if (
+      incomingEvents[0] < 0 || incomingEvents[1] < 0 ||
+      outgoingEvents[0] < 0 || outgoingEvents[1] < 0
+    ) {
+      err = uv_translate_sys_error(errno);
+
+      for (auto fd : {
+        memoryDescriptor,
+        incomingEvents[0], incomingEvents[1],
+        outgoingEvents[0], outgoingEvents[1]
+      }) {
+        if (fd >= 0) ::close(fd);
+      }
+
+      munmap(memory, size);
+      return err;
+    }
+
+    this->close();
+
+    auto sharedMemory = new SharedMemory;
+    sharedMemory->channel = this;
+    sharedMemory->onFrames = onFrames;
+    sharedMemory->memory = memory;
+    sharedMemory->size = size;
+    sharedMemory->waitDescriptor = incomingEvents[0];
+    sharedMemory->notifyDescriptor = outgoingEvents[0];
+
+    sapi_ring_init(&sharedMemory->incoming, memory, capacity);
+    sapi_ring_init(
+      &sharedMemory->outgoing,
+      reinterpret_cast<unsigned char *>(memory) + ringSize,
+      capacity
+    );
+
+    do {
+      Lock lock(this->mutex);
+      this->sharedMemory = sharedMemory;
+      this->remoteDescriptors = {
+        memoryDescriptor,
+        incomingEvents[1],
+        outgoingEvents[1]
+      };
+
+      this->backendArguments = (
+        " --channel-shm=" + std::to_string(memoryDescriptor) +
+        "," + std::to_string(incomingEvents[1]) +
+        "," + std::to_string(outgoingEvents[1])
+      );
+    } while (0);
+
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = this->core->getEventLoop();
+
+      uv_poll_init(loop, &sharedMemory->poll, sharedMemory->waitDescriptor);
+      uv_timer_init(loop, &sharedMemory->timer);
+      sharedMemory->poll.data = sharedMemory;
+      sharedMemory->timer.data = sharedMemory;
+      sharedMemory->handles = 2;
+      sharedMemory->opened = true;
+
+      // the backend wakes the loop up only while it waits
+      if (!sapi_ring_prepare_wait(&sharedMemory->incoming)) {
+        sharedMemory->read();
+      }
+
+      auto err = uv_poll_start(
+        &sharedMemory->poll,
+        UV_READABLE,
+        [](uv_poll_t *poll, int status, int events) {
+          auto sharedMemory = reinterpret_cast<SharedMemory *>(poll->data);
+          char buffer[64];
+
+          if (status < 0) {
+            return sharedMemory->close();
+          }
+
+          // an eventfd is reset by one read, a pipe is drained
+          auto n = ::read(sharedMemory->waitDescriptor, buffer, sizeof(buffer));
+
+          if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+            return sharedMemory->close();
+          }
+
+        #if !defined(__linux__) || defined(__ANDROID__)
+          while (n == sizeof(buffer)) {
+            n = ::read(sharedMemory->waitDescriptor, buffer, sizeof(buffer));
+          }
+        #endif
+
+          sapi_ring_end_wait(&sharedMemory->incoming);
+          sharedMemory->read();
+        }
+      );
+
+      if (err != 0) {
+        sharedMemory->close();
+      }
+    });
+
+    return 0;
+  #endif
+  }
+
+  String Core::Channel::getBackendArguments () {
+    Lock lock(this->mutex);
+    return this->backendArguments;
+  }
+
+  void Core::Channel::closeRemoteDescriptors () {
+  #if !defined(_WIN32)
+    Lock lock(this->mutex);
+    for (auto fd : this->remoteDescriptors) {
+      ::close(fd);
+    }
+
+    this->remoteDescriptors.clear();
+  #endif
+  }
+
+  void Core::Channel::close () {
+    Connection *connection = nullptr;
+    SharedMemory *sharedMemory = nullptr;
+
+    do {
+      Lock lock(this->mutex);
+      connection = this->connection;
+      sharedMemory = this->sharedMemory;
+      this->connection = nullptr;
+      this->sharedMemory = nullptr;
+      this->backendArguments = "";
+    } while (0);
+
+    this->closeRemoteDescriptors();
+
+    if (connection != nullptr) {
+      this->core->dispatchEventLoop([connection]() {
+        connection->close();
+      });
+    }
+
+    if (sharedMemory != nullptr) {
+      this->core->dispatchEventLoop([sharedMemory]() {
+        sharedMemory->close();
+      });
+    }
+  }
+
+  bool Core::Channel::isOpen () {
+    Lock lock(this->mutex);
+    return this->connection != nullptr || this->sharedMemory != nullptr;
+  }
+
+  void Core::Channel::write (
+    const String& uri,
+    const char *bytes,
+    size_t size
+  ) {
+    this->write(uri, bytes, size, true, nullptr);
+  }
+
+  void Core::Channel::write (
+    const String& uri,
+    const char *bytes,
+    size_t size,
+    bool copy,
+    WriteCallback cb
+  ) {
+    if (uri.size() + size > MAX_FRAME_SIZE) {
+      if (cb != nullptr) cb(UV_EMSGSIZE);
+      return;
+    }
+
+    WriteRequest request;
+    request.header = encodeFrameHeader(uri, size, &request.headerSize);
+    request.bodySize = size;
+    request.cb = cb;
+
+    if (size > 0 && copy) {
+      auto body = new char[size];
+      memcpy(body, bytes, size);
+      request.body = body;
+      request.ownsBody = true;
+    } else if (size > 0) {
+      request.body = bytes;
+    }
+
+    auto schedule = false;
+
+    do {
+      Lock lock(this->mutex);
+      this->writeQueue.push_back(request);
+
+      if (!this->flushScheduled) {
+        this->flushScheduled = true;
+        schedule = true;
+      }
+    } while (0);
+
+    // writes queued until the Core loop gets to them go out together
+    if (schedule) {
+      this->core->dispatchEventLoop([this]() {
+        this->flushWrites();
+      });
+    }
+  }
+
+  void Core::Channel::flushWrites () {
+    Vector<WriteRequest> requests;
+    Connection *connection = nullptr;
+    SharedMemory *sharedMemory = nullptr;
+
+    do {
+      Lock lock(this->mutex);
+      requests.swap(this->writeQueue);
+      connection = this->connection;
+      sharedMemory = this->sharedMemory;
+      this->flushScheduled = false;
+    } while (0);
+
+    if (requests.size() == 0) {
+      return;
+    }
+
+    if (sharedMemory != nullptr && sharedMemory->opened && !sharedMemory->closing) {
+      for (auto& request : requests) {
+        sharedMemory->pending.push_back(request);
+      }
+
+      return sharedMemory->flush();
+    }
+
+    auto connected = (
+      connection != nullptr &&
+      connection->opened &&
+      !connection->closing
+    );
+
+    for (size_t i = 0; i < requests.size(); i += MAX_WRITE_BATCH) {
+      auto count = std::min(MAX_WRITE_BATCH, requests.size() - i);
+      auto batch = new WriteBatch;
+      Vector<uv_buf_t> buffers;
+
+      batch->channel = this;
+      batch->req.data = batch;
+
+      for (size_t j = i; j < i + count; ++j) {
+        auto& request = requests[j];
+        buffers.push_back(uv_buf_init(request.header, request.headerSize));
+
+        if (request.bodySize > 0) {
+          buffers.push_back(uv_buf_init(
+            const_cast<char *>(request.body),
+            request.bodySize
+          ));
+        }
+
+        batch->requests.push_back(request);
+      }
+
+      if (!connected) {
+        batch->complete(UV_EPIPE);
+        continue;
+      }
+
+      auto err = uv_write(
+        &batch->req,
+        (uv_stream_t *) &connection->pipe,
+        buffers.data(),
+        buffers.size(),
+        [](uv_write_t *req, int status) {
+          reinterpret_cast<WriteBatch *>(req->data)->complete(status);
+        }
+      );
+
+      if (err != 0) {
+        batch->complete(err);
+      }
+    }
+  }
+
+  void Core::Channel::getState (const String seq, Module::Callback cb) {
+    Lock lock(this->mutex);
+    JSON::Any transport = nullptr;
+
+    if (this->sharedMemory != nullptr) {
+      transport = "shm";
+    } else if (this->connection != nullptr) {
+      transport = "socket";
+    }
+
+    auto json = JSON::Object::Entries {
+      {"source", "channel.getState"},
+      {"data", JSON::Object::Entries {
+        {"open", transport.isNull() == false},
+        {"transport", transport},
+        {"framesRead", this->stats.framesRead},
+        {"framesWritten", this->stats.framesWritten},
+        {"bytesRead", this->stats.bytesRead},
+        {"bytesWritten", this->stats.bytesWritten},
+        {"batches", this->stats.batches}
+      }}
+    };
+
+    cb(seq, json, Post{});
+  }
+
+  void Core::Channel::write (
+    const String seq,
+    const String uri,
+    char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    if (!this->isOpen()) {
+      return cb(seq, ERR_CHANNEL("channel.write", UV_ENOTCONN), Post{});
+    }
+
+    // `bytes` are written in place, they outlive the reply
+    this->write(uri, bytes, size, false, [=](int status) {
+      if (status < 0) {
+        return cb(seq, ERR_CHANNEL("channel.write", status), Post{});
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "channel.write"},
+        {"data", JSON::Object::Entries {
+          {"bytes", (uint64_t) size}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+#if SSC_BENCHMARKS
+  /**
+   * One run of `channel.benchmark()`. A thread writes the messages to a
+   * pipe as `ipc://` lines with URI encoded values, the way the backend
+   * writes to stdout, to a socket pair as frames or to a shared memory
+   * ring, and the Core loop reads and decodes them until it has them all.
+   */
+  struct ChannelBenchmarkRun {
+    enum Transport {
+      STDIO,
+      SOCKET,
+      SHM
+    };
+
+    uv_pipe_t pipe;
+    uv_poll_t poll;
+    Transport transport = STDIO;
+    char *buffer = nullptr;
+    Core::Channel::Decoder decoder;
+    String line;
+    sapi_ring_t ring = {};
+    void *memory = nullptr;
+    size_t size = 0;
+    int fds[2] = { -1, -1 };
+    std::thread writer;
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t wireBytes = 0;
+    uint64_t started = 0;
+    uint64_t finished = 0;
+  };
+
+  struct ChannelBenchmarkContext {
+    Core *core = nullptr;
+    Core::Channel::BenchmarkOptions options;
+    String seq;
+    Core::Module::Callback cb;
+    String payload;
+    JSON::Object::Entries results;
+    ChannelBenchmarkRun *run = nullptr;
+  };
+
+#if !defined(_WIN32)
+  static const String CHANNEL_BENCHMARK_URI = "ipc://send?event=benchmark&index=-1";
+
+  static void writeChannelBenchmark (
+    int fd,
+    ChannelBenchmarkRun::Transport transport,
+    sapi_ring_t ring,
+    const String& payload,
+    size_t messages
+  ) {
+    String chunk;
+
+    for (size_t i = 0; i < messages; ++i) {
+      if (transport == ChannelBenchmarkRun::SHM) {
+        while (sapi_ring_write(
+          &ring,
+          CHANNEL_BENCHMARK_URI.data(),
+          CHANNEL_BENCHMARK_URI.size(),
+          payload.data(),
+          payload.size()
+        ) == SAPI_RING_FULL) {
+          std::this_thread::yield();
+        }
+
+        sapi_ring_notify(&ring, fd);
+        continue;
+      }
+
+      if (transport == ChannelBenchmarkRun::SOCKET) {
+        size_t length = 0;
+        auto header = Core::Channel::encodeFrameHeader(
+          CHANNEL_BENCHMARK_URI,
+          payload.size(),
+          &length
+        );
+
+        chunk.append(header, length);
+        chunk.append(payload);
+        delete [] header;
+      } else {
+        chunk.append(CHANNEL_BENCHMARK_URI);
+        chunk.append("&value=");
+        chunk.append(encodeURIComponent(payload));
+        chunk.append("\n");
+      }
+
+      if (chunk.size() >= Core::Channel::READ_BUFFER_SIZE || i + 1 == messages) {
+        size_t offset = 0;
+
+        while (offset < chunk.size()) {
+          auto n = ::write(fd, chunk.data() + offset, chunk.size() - offset);
+
+          if (n < 0 && errno == EINTR) {
+            continue;
+          } else if (n <= 0) {
+            ::close(fd);
+            return;
+          }
+
+          offset += n;
+        }
+
+        chunk.clear();
+      }
+    }
+
+    if (transport != ChannelBenchmarkRun::SHM) {
+      ::close(fd);
+    }
+  }
+
+  static void startChannelBenchmarkRun (
+    ChannelBenchmarkContext *ctx,
+    ChannelBenchmarkRun::Transport transport
+  );
+
+  static void finishChannelBenchmarkRun (ChannelBenchmarkContext *ctx) {
+    static const char *names[] = { "stdio", "channel", "shm" };
+    auto run = ctx->run;
+    auto elapsed = run->finished > run->started
+      ? (double) (run->finished - run->started) / 1e9
+      : 0.0;
+
+    if (run->writer.joinable()) {
+      run->writer.join();
+    }
+
+    ctx->results[names[run->transport]] = JSON::Object::Entries {
+      {"messages", run->messages},
+      {"bytes", run->bytes},
+      {"wireBytes", run->wireBytes},
+      {"elapsed", elapsed * 1000},
+      {"messagesPerSecond", elapsed > 0 ? run->messages / elapsed : 0.0},
+      {"bytesPerSecond", elapsed > 0 ? run->bytes / elapsed : 0.0}
+    };
+
+    auto handle = run->transport == ChannelBenchmarkRun::SHM
+      ? (uv_handle_t *) &run->poll
+      : (uv_handle_t *) &run->pipe;
+
+    uv_close(handle, [](uv_handle_t *handle) {
+      auto ctx = reinterpret_cast<ChannelBenchmarkContext *>(handle->data);
+      auto run = ctx->run;
+      auto transport = run->transport;
+
+      if (run->memory != nullptr) {
+        munmap(run->memory, run->size);
+      }
+
+      for (auto fd : run->fds) {
+        if (fd >= 0) ::close(fd);
+      }
+
+      delete [] run->buffer;
+      delete run;
+      ctx->run = nullptr;
+
+      if (transport != ChannelBenchmarkRun::SHM) {
+        return startChannelBenchmarkRun(
+          ctx,
+          (ChannelBenchmarkRun::Transport) (transport + 1)
+        );
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "channel.benchmark"},
+        {"data", JSON::Object::Entries {
+          {"messages", (uint64_t) ctx->options.messages},
+          {"size", (uint64_t) ctx->options.size},
+          {"runs", ctx->results}
+        }}
+      };
+
+      ctx->cb(ctx->seq, json, Post{});
+      delete ctx;
+    });
+  }
+
+  static void startChannelBenchmarkRun (
+    ChannelBenchmarkContext *ctx,
+    ChannelBenchmarkRun::Transport transport
+  ) {
+    auto loop = ctx->core->getEventLoop();
+    auto run = new ChannelBenchmarkRun;
+    int fds[2];
+    int err = transport == ChannelBenchmarkRun::SOCKET
+      ? socketpair(AF_UNIX, SOCK_STREAM, 0, fds)
+      : pipe(fds);
+
+    if (err == 0 && transport == ChannelBenchmarkRun::SHM) {
+      // a ring with room for a few messages of the payload size
+      size_t capacity = Core::Channel::DEFAULT_RING_CAPACITY;
+      while (capacity < (ctx->options.size + CHANNEL_BENCHMARK_URI.size()) * 4) {
+        capacity *= 2;
+      }
+
+      run->size = sapi_ring_size(capacity);
+      run->memory = mmap(
+        nullptr,
+        run->size,
+        PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS,
+        -1,
+        0
+      );
+
+      if (run->memory == MAP_FAILED) {
+        run->memory = nullptr;
+        ::close(fds[0]);
+        ::close(fds[1]);
+        err = -1;
+      } else {
+        sapi_ring_init(&run->ring, run->memory, capacity);
+        run->fds[0] = fds[0];
+        run->fds[1] = fds[1];
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+      }
+    }
+
+    if (err != 0) {
+      err = uv_translate_sys_error(errno);
+      delete run;
+      ctx->cb(ctx->seq, ERR_CHANNEL("channel.benchmark", err), Post{});
+      delete ctx;
+      return;
+    }
+
+    run->transport = transport;
+    run->buffer = new char[Core::Channel::READ_BUFFER_SIZE];
+    ctx->run = run;
+
+    if (transport == ChannelBenchmarkRun::SHM) {
+      uv_poll_init(loop, &run->poll, fds[0]);
+      run->poll.data = ctx;
+      sapi_ring_prepare_wait(&run->ring);
+    } else {
+      uv_pipe_init(loop, &run->pipe, 0);
+      run->pipe.data = ctx;
+      uv_pipe_open(&run->pipe, fds[0]);
+    }
+
+    run->started = uv_hrtime();
+    run->writer = std::thread(
+      writeChannelBenchmark,
+      fds[1],
+      transport,
+      run->ring,
+      ctx->payload,
+      ctx->options.messages
+    );
+
+    if (transport == ChannelBenchmarkRun::SHM) {
+      uv_poll_start(&run->poll, UV_READABLE, [](uv_poll_t *poll, int status, int events) {
+        auto ctx = reinterpret_cast<ChannelBenchmarkContext *>(poll->data);
+        auto run = ctx->run;
+        sapi_ring_record_t record;
+
+        while (::read(run->fds[0], run->buffer, Core::Channel::READ_BUFFER_SIZE) > 0);
+        sapi_ring_end_wait(&run->ring);
+
+        // the same copy out of the ring as the channel makes
+        do {
+          while (sapi_ring_read(&run->ring, &record) > 0) {
+            auto bytes = new char[record.size];
+            memcpy(bytes, record.bytes, record.size);
+            run->messages++;
+            run->bytes += record.size;
+            run->wireBytes += record.next - run->ring.header->tail;
+            sapi_ring_release(&run->ring, &record);
+            delete [] bytes;
+          }
+        } while (
+          run->messages < ctx->options.messages &&
+          !sapi_ring_prepare_wait(&run->ring)
+        );
+
+        if (status < 0 || run->messages == ctx->options.messages) {
+          run->finished = uv_hrtime();
+          uv_poll_stop(poll);
+          finishChannelBenchmarkRun(ctx);
+        }
+      });
+
+      return;
+    }
+
+    uv_read_start(
+      (uv_stream_t *) &run->pipe,
+      [](uv_handle_t *handle, size_t size, uv_buf_t *buf) {
+        auto ctx = reinterpret_cast<ChannelBenchmarkContext *>(handle->data);
+        buf->base = ctx->run->buffer;
+        buf->len = Core::Channel::READ_BUFFER_SIZE;
+      },
+      [](uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+        auto ctx = reinterpret_cast<ChannelBenchmarkContext *>(stream->data);
+        auto run = ctx->run;
+
+        if (nread < 0) {
+          run->finished = uv_hrtime();
+          uv_read_stop(stream);
+          return finishChannelBenchmarkRun(ctx);
+        }
+
+        run->wireBytes += nread;
+
+        if (run->transport == ChannelBenchmarkRun::SOCKET) {
+          Vector<Core::Channel::Frame> frames;
+          run->decoder.decode(buf->base, nread, frames);
+
+          for (auto& frame : frames) {
+            run->messages++;
+            run->bytes += frame.size;
+          }
+
+          return;
+        }
+
+        // split lines the way `Process::read()` does for stdout
+        run->line.append(buf->base, nread);
+        size_t offset = 0;
+        size_t end = 0;
+
+        while ((end = run->line.find('\n', offset)) != String::npos) {
+          auto line = run->line.substr(offset, end - offset);
+          auto value = line.find("&value=");
+
+          if (value != String::npos) {
+            auto decoded = decodeURIComponent(line.substr(value + 7));
+            run->messages++;
+            run->bytes += decoded.size();
+          }
+
+          offset = end + 1;
+        }
+
+        run->line.erase(0, offset);
+      }
+    );
+  }
+#endif
+
+  void Core::Channel::benchmark (
+    const String seq,
+    BenchmarkOptions options,
+    Module::Callback cb
+  ) {
+  #if defined(_WIN32)
+    return cb(seq, ERR_CHANNEL("channel.benchmark", UV_ENOTSUP), Post{});
+  #else
+    if (
+      options.messages == 0 ||
+      options.size == 0 ||
+      options.size > MAX_BENCHMARK_SIZE
+    ) {
+      auto json = JSON::Object::Entries {
+        {"source", "channel.benchmark"},
+        {"err", JSON::Object::Entries {
+          {"code", "EINVAL"},
+          {"message", "Invalid benchmark parameters"}
+        }}
+      };
+
+      return cb(seq, json, Post{});
+    }
+
+    this->core->dispatchEventLoop([=, this]() {
+      auto ctx = new ChannelBenchmarkContext;
+
+      // binary payloads, which the stdio lines have to URI encode
+      for (size_t i = 0; i < options.size; ++i) {
+        ctx->payload.push_back((char) (rand64() & 0xff));
+      }
+
+      ctx->core = this->core;
+      ctx->options = options;
+      ctx->seq = seq;
+      ctx->cb = cb;
+      startChannelBenchmarkRun(ctx, ChannelBenchmarkRun::STDIO);
+    });
+  #endif
+  }
+#endif
+}
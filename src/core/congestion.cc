@@ -0,0 +1,166 @@
+#include "congestion.hh"
+
+namespace SSC {
+  void CongestionController::reset () {
+    this->cwnd = INITIAL_WINDOW;
+    this->ssthresh = MAX_WINDOW;
+    this->bytesInFlight = 0;
+    this->srtt = 0;
+    this->rttvar = 0;
+    this->latestRTT = 0;
+    this->baseDelay = 0;
+    this->baseDelayUpdatedAt = 0;
+    this->lastReductionAt = 0;
+    this->tokens = 0;
+    this->tokensUpdatedAt = 0;
+  }
+
+  bool CongestionController::canSend (size_t size) const {
+    if (!this->enabled || this->bytesInFlight == 0) {
+      return true;
+    }
+
+    return this->bytesInFlight + size <= this->cwnd;
+  }
+
+  void CongestionController::onSend (size_t size) {
+    this->bytesInFlight += size;
+  }
+
+  void CongestionController::onDiscard (size_t size) {
+    this->bytesInFlight -= std::min(size, this->bytesInFlight);
+  }
+
+  void CongestionController::onAck (size_t size, uint64_t rtt, uint64_t now) {
+    this->onDiscard(size);
+
+    // `0` when the acknowledgement is ambiguous and was not sampled
+    if (rtt > 0) {
+      this->latestRTT = rtt;
+
+      if (this->srtt == 0) {
+        this->srtt = rtt;
+        this->rttvar = rtt / 2;
+      } else {
+        auto delta = this->srtt > rtt ? this->srtt - rtt : rtt - this->srtt;
+        this->rttvar = (3 * this->rttvar + delta) / 4;
+        this->srtt = (7 * this->srtt + rtt) / 8;
+      }
+
+      // the base delay follows route changes, a stale minimum would
+      // read every later sample as queuing delay
+      if (
+        this->baseDelay == 0 ||
+        rtt < this->baseDelay ||
+        now - this->baseDelayUpdatedAt > BASE_DELAY_WINDOW
+      ) {
+        this->baseDelay = rtt;
+        this->baseDelayUpdatedAt = now;
+      }
+    }
+
+    auto queuingDelay = this->getQueuingDelay();
+    auto cwnd = (double) this->cwnd;
+
+    if (this->cwnd < this->ssthresh) {
+      // slow start ends before the queue reaches the target
+      if (queuingDelay > TARGET_DELAY * 3 / 4) {
+        this->ssthresh = this->cwnd;
+      } else {
+        cwnd += size;
+      }
+    }
+
+    if (this->cwnd >= this->ssthresh) {
+      auto offTarget = ((double) TARGET_DELAY - (double) queuingDelay) / TARGET_DELAY;
+      cwnd += std::max(-1.0, offTarget) * size * MSS / cwnd;
+    }
+
+    this->cwnd = (size_t) std::clamp(cwnd, (double) MIN_WINDOW, (double) MAX_WINDOW);
+  }
+
+  void CongestionController::onLoss (size_t size, uint64_t now) {
+    this->onDiscard(size);
+    this->losses++;
+
+    // losses from the same window are one congestion event
+    if (this->lastReductionAt > 0 && now - this->lastReductionAt < this->srtt) {
+      return;
+    }
+
+    this->cwnd = std::max(MIN_WINDOW, this->cwnd / 2);
+    this->ssthresh = this->cwnd;
+    this->lastReductionAt = now;
+  }
+
+  uint64_t CongestionController::getQueuingDelay () const {
+    return this->latestRTT > this->baseDelay ? this->latestRTT - this->baseDelay : 0;
+  }
+
+  double CongestionController::getPacingRate () const {
+    double rate = 0;
+
+    if (!this->enabled) {
+      return 0;
+    }
+
+    if (this->srtt > 0) {
+      rate = PACING_GAIN * this->cwnd * 1e6 / this->srtt;
+    }
+
+    if (this->maxPacingRate > 0) {
+      rate = rate > 0 ? std::min(rate, this->maxPacingRate) : this->maxPacingRate;
+    }
+
+    return rate;
+  }
+
+  double CongestionController::getPacingBurst (double rate) const {
+    return std::max((double) (2 * MSS), rate * PACING_BURST / 1e6);
+  }
+
+  void CongestionController::refillPacingTokens (double rate, uint64_t now) {
+    auto burst = this->getPacingBurst(rate);
+
+    if (this->tokensUpdatedAt == 0) {
+      this->tokens = burst;
+    } else if (now > this->tokensUpdatedAt) {
+      auto elapsed = (double) (now - this->tokensUpdatedAt);
+      this->tokens = std::min(burst, this->tokens + rate * elapsed / 1e6);
+    }
+
+    this->tokensUpdatedAt = now;
+  }
+
+  bool CongestionController::consumePacingTokens (size_t size, uint64_t now) {
+    auto rate = this->getPacingRate();
+
+    if (rate <= 0) {
+      return true;
+    }
+
+    this->refillPacingTokens(rate, now);
+
+    // a send larger than the bucket goes out once the bucket is full and
+    // leaves it in debt, so the average rate still holds
+    if (this->tokens < std::min((double) size, this->getPacingBurst(rate))) {
+      return false;
+    }
+
+    this->tokens -= size;
+    return true;
+  }
+
+  uint64_t CongestionController::getPacingDelay (size_t size, uint64_t now) {
+    auto rate = this->getPacingRate();
+
+    if (rate <= 0) {
+      return 0;
+    }
+
+    this->refillPacingTokens(rate, now);
+
+    auto needed = std::min((double) size, this->getPacingBurst(rate)) - this->tokens;
+    return needed > 0 ? (uint64_t) std::ceil(needed * 1e6 / rate) : 0;
+  }
+}
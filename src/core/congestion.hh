@@ -0,0 +1,76 @@
+#ifndef SSC_CORE_CONGESTION_HH
+#define SSC_CORE_CONGESTION_HH
+
+#include "../common.hh"
+
+namespace SSC {
+  /**
+   * Congestion window and send pacing for a peer. The window is delay
+   * based like LEDBAT (RFC 6817): it grows while the queuing delay (the RTT
+   * above the lowest RTT seen recently) is below `TARGET_DELAY`, shrinks
+   * while it is above, and halves at most once per RTT on loss. Sends are
+   * released by a token bucket filled at `PACING_GAIN` windows per RTT,
+   * capped by `maxPacingRate`.
+   *
+   * RTT samples and losses come from transports that see acknowledgements
+   * (`Core::Stream`), plain datagram sends are only paced by
+   * `maxPacingRate`. Times are in microseconds and sizes in bytes. Not
+   * synchronized, callers hold the lock of the owning peer.
+   */
+  class CongestionController {
+    public:
+      static constexpr size_t MSS = 1200;
+      static constexpr size_t INITIAL_WINDOW = 10 * MSS;
+      static constexpr size_t MIN_WINDOW = 2 * MSS;
+      static constexpr size_t MAX_WINDOW = 16 * 1024 * 1024;
+      static constexpr uint64_t TARGET_DELAY = 25000;
+      // how long the lowest RTT seen is trusted as the base delay
+      static constexpr uint64_t BASE_DELAY_WINDOW = 60 * 1000 * 1000;
+      static constexpr double PACING_GAIN = 1.25;
+      // the token bucket holds this much time worth of sends, bounding bursts
+      static constexpr uint64_t PACING_BURST = 2000;
+
+      bool enabled = false;
+      // bytes per second, `0` is unlimited
+      double maxPacingRate = 0;
+
+      size_t cwnd = INITIAL_WINDOW;
+      size_t ssthresh = MAX_WINDOW;
+      size_t bytesInFlight = 0;
+      uint64_t srtt = 0;
+      uint64_t rttvar = 0;
+      uint64_t latestRTT = 0;
+      uint64_t baseDelay = 0;
+      uint64_t losses = 0;
+
+      void reset ();
+      bool canSend (size_t size) const;
+      void onSend (size_t size);
+      void onAck (size_t size, uint64_t rtt, uint64_t now);
+      void onLoss (size_t size, uint64_t now);
+      // in flight bytes that are neither acknowledged nor lost anymore
+      void onDiscard (size_t size);
+
+      // bytes per second, `0` when sends are not paced
+      double getPacingRate () const;
+      uint64_t getQueuingDelay () const;
+
+      /**
+       * Takes tokens for a send of `size` bytes. Returns `false` when the
+       * send has to wait, `getPacingDelay()` tells how long.
+       */
+      bool consumePacingTokens (size_t size, uint64_t now);
+      uint64_t getPacingDelay (size_t size, uint64_t now);
+
+    private:
+      uint64_t baseDelayUpdatedAt = 0;
+      uint64_t lastReductionAt = 0;
+      double tokens = 0;
+      uint64_t tokensUpdatedAt = 0;
+
+      double getPacingBurst (double rate) const;
+      void refillPacingTokens (double rate, uint64_t now);
+  };
+}
+
+#endif
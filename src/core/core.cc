@@ -103,7 +103,7 @@ namespace SSC {
     if (posts->find(id) == posts->end()) return;
     auto post = getPost(id);
 
-    if (post.body) {
+    if (post.body && post.storage == nullptr) {
       delete [] post.body;
     }
 
@@ -40,8 +40,28 @@
 #pragma comment(lib, "uv_a.lib")
 #endif
 
+#include "congestion.hh"
+#include "crypto.hh"
+#include "fec.hh"
 #include "json.hh"
+#include "packets.hh"
+#include "rtt.hh"
 #include "runtime-preload.hh"
+#include "tuner.hh"
+
+// benchmarks and their routes are only defined in runtime libraries built
+// with `SSC_BENCHMARKS=1` set (see `bin/cflags.sh`), the declarations stay
+// so the classes are the same in every build
+#ifndef SSC_BENCHMARKS
+#define SSC_BENCHMARKS 0
+#endif
+
+// simulated loss, reordering and delay (`dropRate`, `reorderRate` and
+// `delay`) are only applied by runtime libraries built with
+// `SSC_FAULT_INJECTION=1` set, other runtimes reject the options
+#ifndef SSC_FAULT_INJECTION
+#define SSC_FAULT_INJECTION 0
+#endif
 
 #if defined(__APPLE__)
 @interface SSCBluetoothController : NSObject<
@@ -156,6 +176,8 @@ namespace SSC {
     char* body = nullptr;
     size_t length = 0;
     String headers = "";
+    // when set, owns `body` and frees it with the last copy of the post
+    std::shared_ptr<char> storage = nullptr;
   };
 
   using Posts = std::map<uint64_t, Post>;
@@ -195,9 +217,31 @@ namespace SSC {
     PEER_STATE_TCP_BOUND = 1 << 20,
     PEER_STATE_TCP_CONNECTED = 1 << 21,
     PEER_STATE_TCP_PAUSED = 1 << 13,
+    PEER_STATE_TCP_LISTENING = 1 << 22,
+    PEER_STATE_TCP_READ_STARTED = 1 << 23,
+    PEER_STATE_TCP_SHUTDOWN = 1 << 24,
     PEER_STATE_MAX = 1 << 0xF
   } peer_state_t;
 
+  typedef enum {
+    // fail the send with `UV_EAGAIN`
+    PEER_SEND_QUEUE_POLICY_REJECT = 0,
+    // hold the send back, dropping the oldest held back sends
+    PEER_SEND_QUEUE_POLICY_DROP_OLDEST = 1,
+    // hold the send back, its callback is called once it was sent, at most
+    // `UDP_MAX_BLOCKED_SENDS` are held back
+    PEER_SEND_QUEUE_POLICY_BLOCK = 2
+  } peer_send_queue_policy_t;
+
+  typedef enum {
+    // the kernel picks a socket by a hash of the addresses and ports of
+    // a datagram, so datagrams of a flow are read by the same socket
+    PEER_RECEIVE_STEERING_HASH = 0,
+    // the socket is picked by the CPU that received the datagram, which
+    // keeps a flow on one core where the NIC spreads flows (RSS)
+    PEER_RECEIVE_STEERING_CPU = 1
+  } peer_receive_steering_t;
+
   struct LocalPeerInfo {
     struct sockaddr_storage addr;
     String address = "";
@@ -226,6 +270,18 @@ namespace SSC {
     void init (const struct sockaddr_storage *addr);
   };
 
+  // The largest UDP payload a single (possibly segmented) send may carry
+  constexpr size_t UDP_MAX_PAYLOAD_SIZE = 65507;
+  // The maximum number of segments the kernel accepts per GSO send
+  constexpr size_t UDP_MAX_SEGMENTS = 64;
+  // The maximum number of sockets reading a bound port, see `Peer::Receiver`
+  constexpr size_t UDP_MAX_RECEIVERS = 64;
+  // The maximum number of queued TCP writes submitted in one `uv_write()`
+  constexpr size_t TCP_MAX_WRITE_BATCH = 256;
+  // The maximum number of sends the `BLOCK` send queue policy holds back,
+  // more fail with `UV_EAGAIN` like the `REJECT` policy
+  constexpr size_t UDP_MAX_BLOCKED_SENDS = 4096;
+
   /**
    * A generic structure for a bound or connected peer.
    */
@@ -235,26 +291,100 @@ namespace SSC {
         using Callback = std::function<void(int, Post)>;
         Callback cb;
         Peer *peer = nullptr;
+        // number of outstanding `uv_udp_send_t` requests for a
+        // (possibly segmented) send and the first error status seen
+        size_t pending = 1;
+        int status = 0;
+        // bytes and datagrams of the send, counted once it completed
+        size_t size = 0;
+        size_t datagrams = 1;
         RequestContext (Callback cb) { this->cb = cb; }
       };
 
+      // a send held back because the send queue is at its limits
+      struct SendRequest {
+        char *buf = nullptr;
+        size_t size = 0;
+        int port = 0;
+        String address = "";
+        RequestContext::Callback cb;
+      };
+
+      // a TCP write waiting for the writes in flight, see `write()`
+      struct WriteRequest {
+        char *buf = nullptr;
+        size_t size = 0;
+        RequestContext::Callback cb;
+      };
+
+      // the status of an incoming connection on a listening TCP peer,
+      // accepted with `accept()`
+      using TCPConnectionCallback = std::function<void(int)>;
+      // bytes read, `UV_EOF` or an error, and the read buffer, which the
+      // callback owns, see `Core::TCP::acquireBuffer()`
+      using TCPReadCallback = std::function<void(ssize_t, const uv_buf_t*)>;
+
+      // the last argument is the receive time in nanoseconds since the
+      // epoch, taken by the kernel when receive timestamps are enabled
       using UDPReceiveCallback = std::function<void(
         ssize_t,
         const uv_buf_t*,
-        const struct sockaddr*
+        const struct sockaddr*,
+        uint64_t
       )>;
 
+      // an extra socket bound to the port of the peer with `SO_REUSEPORT`
+      // and read on a thread of its own, see `initReceivers()`
+      struct Receiver {
+        Peer *peer = nullptr;
+        uv_loop_t loop;
+        uv_udp_t handle;
+        uv_async_t control;
+        std::atomic<bool> reading = false;
+        std::atomic<bool> closing = false;
+        std::thread thread;
+        // datagrams are read here and copied out at their size
+        char buffer[UDP_MAX_PAYLOAD_SIZE];
+      };
+
+      // a datagram read by a receiver, delivered on the Core loop
+      struct ReceivedDatagram {
+        ssize_t nread = 0;
+        uv_buf_t buf;
+        struct sockaddr_storage addr;
+        uint64_t timestamp = 0;
+      };
+
+      // a status, the RTT sample in microseconds and the updated estimate
+      using PingCallback = std::function<void(int, uint64_t, RTTEstimator)>;
+
+      // a ping waiting for its pong, see `ping()`
+      struct PendingPing {
+        Peer *peer = nullptr;
+        uint64_t nonce = 0;
+        uv_timer_t timer;
+        PingCallback cb;
+      };
+
+      using BufferTuningCallback = std::function<void(JSON::Object::Entries)>;
+
       // uv handles
       union {
         uv_udp_t udp;
-        uv_tcp_t tcp; // XXX: FIXME
+        uv_tcp_t tcp;
       } handle;
 
+      // polls a duplicate of the UDP socket descriptor when receive
+      // offload (GRO) is enabled, so coalesced datagrams can be split
+      uv_poll_t *receiveOffloadPoll = nullptr;
+
       // sockaddr
       struct sockaddr_in addr;
 
       // callbacks
       UDPReceiveCallback receiveCallback;
+      TCPConnectionCallback connectionCallback;
+      TCPReadCallback readCallback;
       std::vector<std::function<void()>> onclose;
 
       // instance state
@@ -266,9 +396,88 @@ namespace SSC {
         struct {
           bool reuseAddr = false;
           bool ipv6Only = false; // @TODO
+          // when greater than `0`, sends larger than this are split into
+          // datagrams of this size (with UDP_SEGMENT on Linux)
+          size_t segmentSize = 0;
+          // receive timestamps (`SO_TIMESTAMPNS` on Linux) and native
+          // RTT probes, see `ping()`
+          bool timestamps = false;
+          // sockets reading the bound port, more than `1` fans datagrams
+          // out over threads with `SO_REUSEPORT` (Linux only)
+          size_t receivers = 1;
+          peer_receive_steering_t steering = PEER_RECEIVE_STEERING_HASH;
+          // limits on bytes and datagrams queued for sending, `0` is
+          // unlimited, see `peer_send_queue_policy_t` for what happens
+          // to sends over the limit
+          struct {
+            size_t maxBytes = 0;
+            size_t maxCount = 0;
+            peer_send_queue_policy_t policy = PEER_SEND_QUEUE_POLICY_REJECT;
+          } sendQueue;
         } udp;
+
+        struct {
+          bool noDelay = false;
+          bool keepAlive = false;
+          // seconds a connection is idle before the first keepalive probe
+          unsigned int keepAliveDelay = 60;
+        } tcp;
       } options;
 
+      // sends held back by the `BLOCK` and `DROP_OLDEST` policies or pacing
+      std::deque<SendRequest> sendQueue;
+      size_t sendQueueBytes = 0;
+
+      // TCP writes queued while a batch is in flight, written together
+      // in one `uv_write()` once it completed
+      std::deque<WriteRequest> writeQueue;
+      size_t writeQueueBytes = 0;
+      size_t writesInFlight = 0;
+
+      // congestion window and send pacing, off unless enabled with
+      // `setCongestionControl()`, the timer releases paced sends
+      CongestionController congestion;
+      uv_timer_t *pacingTimer = nullptr;
+
+      // receive buffer auto-tuning, off unless enabled with
+      // `setBufferTuning()`, the timer samples the socket
+      ReceiveBufferTuner bufferTuner;
+      BufferTuningCallback onBufferTuning = nullptr;
+      uv_timer_t *bufferTuningTimer = nullptr;
+
+      // kernel offload state, see `initSegmentationOffload()`
+      bool hasSegmentationOffload = false;
+      bool hasReceiveOffload = false;
+      bool hasReceiveTimestamps = false;
+
+      // receivers of the bound port besides this peer and the datagrams
+      // they read, waiting for the Core loop
+      Vector<Receiver*> receivers;
+      std::mutex receivedMutex;
+      std::deque<ReceivedDatagram> received;
+      uv_async_t *receivedAsync = nullptr;
+      bool hasReceiveSteering = false;
+
+      // RTT estimates by remote "address:port" and unanswered pings by nonce
+      std::map<String, RTTEstimator> rtt;
+      std::map<uint64_t, PendingPing*> pings;
+
+      // traffic counters, read without the peer lock by `udp.stats`
+      struct {
+        std::atomic<uint64_t> packetsSent = 0;
+        std::atomic<uint64_t> bytesSent = 0;
+        std::atomic<uint64_t> packetsReceived = 0;
+        std::atomic<uint64_t> bytesReceived = 0;
+        // failed sends, including sends rejected or cancelled by the
+        // send queue policy
+        std::atomic<uint64_t> sendErrors = 0;
+        std::atomic<uint64_t> receiveErrors = 0;
+        // last `SO_RXQ_OVFL` count seen on a received datagram
+        std::atomic<uint64_t> receiveOverflows = 0;
+        // datagrams of receivers dropped while the Core loop fell behind
+        std::atomic<uint64_t> receiveQueueDrops = 0;
+      } counters;
+
       // peer state
       LocalPeerInfo local;
       RemotePeerInfo remote;
@@ -280,7 +489,6 @@ namespace SSC {
       * Private `Peer` class constructor
       */
       Peer (Core *core, peer_type_t peerType, uint64_t peerId, bool isEphemeral);
-      ~Peer ();
 
       int init ();
       int initRemotePeerInfo ();
@@ -304,7 +512,49 @@ namespace SSC {
       int bind (String address, int port, bool reuseAddr);
       int rebind ();
       int connect (String address, int port);
+      int connect (String address, int port, RequestContext::Callback cb);
       int disconnect ();
+      int listen (int backlog, TCPConnectionCallback cb);
+      int accept (Peer *client);
+      int setNoDelay (bool enabled);
+      int setKeepAlive (bool enabled, unsigned int delay);
+      void write (char *buf, size_t size, RequestContext::Callback cb);
+      void flushWrites ();
+      void cancelWrites ();
+      int readstart (TCPReadCallback onread);
+      int readstop ();
+      int shutdown (RequestContext::Callback cb);
+      int initSegmentationOffload ();
+      int setSegmentSize (size_t segmentSize);
+      int initReceiveTimestamps ();
+      int initReceivers ();
+      void closeReceivers ();
+      int setReceiveTimestamps (bool enabled);
+      int ping (const String address, int port, uint64_t timeout, PingCallback cb);
+      void onProbe (
+        const RTTProbe& probe,
+        const struct sockaddr *addr,
+        uint64_t timestamp
+      );
+      size_t getSendQueueSize ();
+      size_t getSendQueueCount ();
+      bool isSendQueueFull (size_t size);
+      void flushSendQueue ();
+      void cancelSendQueue ();
+      uint64_t getReceiveDrops ();
+      size_t getReceiveQueueSize ();
+      size_t getReceiveBufferSize ();
+      size_t setReceiveBufferSize (size_t size);
+      void setBufferTuning (
+        bool enabled,
+        size_t minSize,
+        size_t maxSize,
+        uint64_t interval,
+        BufferTuningCallback cb
+      );
+      void tuneReceiveBuffer ();
+      void setCongestionControl (bool enabled, double maxPacingRate);
+      void schedulePacing ();
       void send (
         char *buf,
         size_t size,
@@ -312,6 +562,13 @@ namespace SSC {
         const String address,
         Peer::RequestContext::Callback cb
       );
+      void submitSend (
+        char *buf,
+        size_t size,
+        int port,
+        const String address,
+        Peer::RequestContext::Callback cb
+      );
       int recvstart ();
       int recvstart (UDPReceiveCallback onrecv);
       int recvstop ();
@@ -321,6 +578,46 @@ namespace SSC {
       void close (std::function<void()> onclose);
   };
 
+  /**
+   * A sharded, concurrent registry of peers keyed by peer id. Each shard
+   * has its own lock so operations on unrelated peers do not contend and
+   * every operation is a single hash lookup under a single lock. Entries
+   * are reference counted: a peer returned from `get()` stays alive until
+   * the caller drops it, even if it is removed from the registry meanwhile.
+   */
+  class PeerRegistry {
+    public:
+      using Entry = std::shared_ptr<Peer>;
+      using Factory = std::function<Entry()>;
+      using Visitor = std::function<void(const Entry&)>;
+
+      static constexpr size_t SHARD_BITS = 4;
+      static constexpr size_t SHARDS = 1 << SHARD_BITS;
+
+      Entry get (uint64_t id);
+      Entry getOrCreate (uint64_t id, Factory create);
+      Entry remove (uint64_t id);
+      bool remove (uint64_t id, const Peer* peer);
+      bool has (uint64_t id);
+      size_t size ();
+      void forEach (Visitor visitor);
+
+    private:
+      struct Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<uint64_t, Entry> entries;
+      };
+
+      std::array<Shard, SHARDS> shards;
+
+      Shard& shard (uint64_t id) {
+        // peer ids are mostly random, but mix them anyway so sequential
+        // ids from other sources spread evenly over the shards
+        auto hash = (id ^ (id >> 32)) * 0x9E3779B97F4A7C15ULL;
+        return this->shards[hash >> (64 - SHARD_BITS)];
+      }
+  };
+
   static inline String addrToIPv4 (struct sockaddr_in* sin) {
     char buf[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &sin->sin_addr, buf, INET_ADDRSTRLEN);
@@ -401,9 +698,345 @@ namespace SSC {
           }
       };
 
+      /**
+       * Native buffers referenced by id across IPC calls, so bytes sent or
+       * written many times are uploaded once. A route given a `bufferId`
+       * instead of message bytes reads the buffer in place. Slices share
+       * the bytes of their buffer, which are copied on write while shared,
+       * and the least recently used buffers are evicted beyond `maxBytes`.
+       */
+      class Buffers : public Module {
+        public:
+          static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+          using Storage = std::shared_ptr<Vector<char>>;
+
+          struct Handle {
+            Storage storage = nullptr;
+            size_t offset = 0;
+            size_t size = 0;
+
+            char * data () const {
+              return this->storage->data() + this->offset;
+            }
+          };
+
+          Buffers (auto core) : Module(core) {}
+
+          // the bytes of buffer `id`, valid while `handle` is held even if
+          // the buffer is released or evicted meanwhile
+          bool get (uint64_t id, Handle &handle);
+
+          void create (
+            const String seq,
+            uint64_t id,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void append (
+            const String seq,
+            uint64_t id,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void slice (
+            const String seq,
+            uint64_t id,
+            uint64_t sourceId,
+            size_t offset,
+            size_t size,
+            Module::Callback cb
+          );
+          void release (const String seq, uint64_t id, Module::Callback cb);
+          void getState (const String seq, Module::Callback cb);
+          void setLimits (const String seq, size_t maxBytes, Module::Callback cb);
+
+        private:
+          struct Entry {
+            Handle handle;
+            std::list<uint64_t>::iterator recent;
+          };
+
+          Mutex mutex;
+          std::map<uint64_t, Entry> entries;
+          // most recently used first
+          std::list<uint64_t> recent;
+          // buffers referencing each storage, shared bytes count once
+          std::map<const Vector<char> *, size_t> storages;
+          size_t totalBytes = 0;
+          size_t maxBytes = DEFAULT_MAX_BYTES;
+          size_t evictions = 0;
+
+          void insert (uint64_t id, const Handle &handle);
+          void erase (uint64_t id);
+          void evict (uint64_t keep);
+      };
+
+      class Cache : public Module {
+        public:
+          Cache (auto core) : Module(core) {}
+
+          void create (
+            const String seq,
+            uint64_t id,
+            StreamRelay::PacketCache::Options options,
+            Module::Callback cb
+          );
+          void destroy (const String seq, uint64_t id, Module::Callback cb);
+          void insert (
+            const String seq,
+            uint64_t id,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void get (
+            const String seq,
+            uint64_t id,
+            const String packetId,
+            Module::Callback cb
+          );
+          void has (
+            const String seq,
+            uint64_t id,
+            const String packetId,
+            Module::Callback cb
+          );
+          void remove (
+            const String seq,
+            uint64_t id,
+            const String packetId,
+            Module::Callback cb
+          );
+          void getState (const String seq, uint64_t id, Module::Callback cb);
+
+        private:
+          Mutex mutex;
+          std::map<uint64_t, std::shared_ptr<StreamRelay::PacketCache>> caches;
+          std::shared_ptr<StreamRelay::PacketCache> getCache (uint64_t id);
+      };
+
+      /**
+       * Binary channel to the backend process over a Unix domain socket
+       * pair, next to its stdio. The backend inherits one end and is given
+       * its descriptor with `--channel-fd`. Both directions carry frames of
+       * a 4 byte URI length and a 4 byte body length, big endian, followed
+       * by the `ipc://` URI and the body bytes, so payloads are neither
+       * line framed nor URI encoded. Frames are read and written on the
+       * Core loop and handed over once per read. Not available on Windows.
+       *
+       * With `openSharedMemory()` the frames go through a pair of shared
+       * memory rings instead (see `include/socket/ring.h`), given to the
+       * backend with `--channel-shm`, and the socket is only woken up when
+       * the reading side waits for messages.
+       */
+      class Channel : public Module {
+        public:
+          static constexpr size_t FRAME_HEADER_SIZE = 8;
+          static constexpr size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+          static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+          // frames per `uv_write()`
+          static constexpr size_t MAX_WRITE_BATCH = 256;
+          // bytes per shared memory ring, a power of two
+          static constexpr size_t DEFAULT_RING_CAPACITY = 4 * 1024 * 1024;
+          // milliseconds until writes to a full ring are tried again
+          static constexpr uint64_t RING_RETRY_INTERVAL = 1;
+
+          struct Frame {
+            String uri;
+            // shared with the posts the body is given to
+            std::shared_ptr<char[]> bytes = nullptr;
+            size_t size = 0;
+          };
+
+          using FramesCallback = std::function<void(Vector<Frame>&)>;
+          using WriteCallback = std::function<void(int)>;
+
+          // incremental frame decoder for a byte stream
+          class Decoder {
+            public:
+              // appends the frames completed by `bytes`, false once the
+              // stream is malformed and can not be decoded any further
+              bool decode (const char *bytes, size_t size, Vector<Frame>& frames);
+
+            private:
+              Vector<char> pending;
+              bool failed = false;
+          };
+
+          static constexpr size_t MAX_BENCHMARK_SIZE = 16 * 1024 * 1024;
+
+          struct BenchmarkOptions {
+            size_t messages = 10000;
+            size_t size = 256;
+          };
+
+          struct Stats {
+            uint64_t framesRead = 0;
+            uint64_t framesWritten = 0;
+            uint64_t bytesRead = 0;
+            uint64_t bytesWritten = 0;
+            uint64_t batches = 0;
+          };
+
+          Channel (auto core) : Module(core) {}
+
+          // header and URI of a frame, the body follows it on the wire
+          static char * encodeFrameHeader (
+            const String& uri,
+            size_t size,
+            size_t *length
+          );
+
+          // creates the socket pair and starts reading frames, returns the
+          // descriptor for the backend or a negative error
+          int open (FramesCallback onFrames);
+          // creates the shared memory rings and starts reading frames,
+          // `0` or a negative error
+          int openSharedMemory (
+            FramesCallback onFrames,
+            size_t capacity = DEFAULT_RING_CAPACITY
+          );
+          // command line arguments giving the backend its descriptors
+          String getBackendArguments ();
+          // the parent's copies of the backend descriptors, once passed on
+          void closeRemoteDescriptors ();
+          void close ();
+          bool isOpen ();
+          // copies `bytes`, callable from any thread
+          void write (const String& uri, const char *bytes, size_t size);
+          void write (
+            const String& uri,
+            const char *bytes,
+            size_t size,
+            bool copy,
+            WriteCallback cb
+          );
+
+          void benchmark (
+            const String seq,
+            BenchmarkOptions options,
+            Module::Callback cb
+          );
+          void getState (const String seq, Module::Callback cb);
+          void write (
+            const String seq,
+            const String uri,
+            char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+
+          // only called on the Core loop
+          void flushWrites ();
+
+        private:
+          struct WriteRequest {
+            char *header = nullptr;
+            size_t headerSize = 0;
+            const char *body = nullptr;
+            size_t bodySize = 0;
+            bool ownsBody = false;
+            WriteCallback cb = nullptr;
+          };
+
+          struct Connection;
+          struct SharedMemory;
+          struct WriteBatch;
+
+          Mutex mutex;
+          Connection *connection = nullptr;
+          SharedMemory *sharedMemory = nullptr;
+          Vector<int> remoteDescriptors;
+          String backendArguments;
+          Vector<WriteRequest> writeQueue;
+          bool flushScheduled = false;
+          Stats stats;
+      };
+
+      class Crypto : public Module {
+        public:
+          // signatures checked per threadpool work item in `verifyMany()`
+          static constexpr size_t VERIFY_MANY_BATCH_SIZE = 32;
+
+          struct VerifyOptions {
+            SSC::Crypto::Bytes publicKey;
+            SSC::Crypto::Bytes signature;
+            // slice of the message bytes the signature is over
+            size_t offset = 0;
+            size_t size = 0;
+          };
+
+          Crypto (auto core) : Module(core) {}
+
+          void sign (
+            const String seq,
+            SSC::Crypto::Bytes secretKey,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void verify (
+            const String seq,
+            VerifyOptions options,
+            const char *bytes,
+            Module::Callback cb
+          );
+          void verifyMany (
+            const String seq,
+            Vector<VerifyOptions> options,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void seal (
+            const String seq,
+            SSC::Crypto::Bytes publicKey,
+            SSC::Crypto::Bytes secretKey,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void open (
+            const String seq,
+            SSC::Crypto::Bytes publicKey,
+            SSC::Crypto::Bytes secretKey,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void sha256 (
+            const String seq,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+
+        private:
+          void queueWork (std::function<void()> work, std::function<void()> done);
+      };
+
       class Diagnostics : public Module {
         public:
+          static constexpr size_t MAX_BENCHMARK_SIZE = 16 * 1024 * 1024;
+
+          struct ProcessOutputBenchmarkOptions {
+            // bytes of output written by the child process
+            uint64_t bytes = 1024 * 1024 * 1024;
+            // bytes per line or frame, without the newline or frame header
+            size_t size = 1024;
+            bool binary = false;
+          };
+
           Diagnostics (auto core) : Module(core) {}
+
+          void benchmarkProcessOutput (
+            const String seq,
+            ProcessOutputBenchmarkOptions options,
+            Module::Callback cb
+          );
       };
 
       class DNS : public Module {
@@ -424,6 +1057,49 @@ namespace SSC {
           );
       };
 
+      class FEC : public Module {
+        public:
+          struct EncodeOptions {
+            // sizes of the data packets given back to back
+            Vector<size_t> sizes;
+            size_t parityCount = 0;
+          };
+
+          struct ReconstructOptions {
+            size_t dataCount = 0;
+            size_t parityCount = 0;
+            // block indices and sizes of the packets given back to back
+            Vector<size_t> indices;
+            Vector<size_t> sizes;
+          };
+
+          struct BenchmarkOptions {
+            size_t dataCount = 32;
+            size_t parityCount = 8;
+            size_t shardSize = 1200;
+            // milliseconds spent per kernel and operation
+            uint64_t duration = 200;
+          };
+
+          FEC (auto core) : Module(core) {}
+
+          void encode (
+            const String seq,
+            EncodeOptions options,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void reconstruct (
+            const String seq,
+            ReconstructOptions options,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void benchmark (const String seq, BenchmarkOptions options, Module::Callback cb);
+      };
+
       class FS : public Module {
         public:
           FS (auto core) : Module(core) {}
@@ -651,14 +1327,223 @@ namespace SSC {
           );
       };
 
+      /**
+       * Reliable, ordered byte streams between two UDP peers. Data is split
+       * into numbered segments which are acknowledged cumulatively and
+       * selectively (SACK) and retransmitted from timers on the Core loop.
+       * Both ends open a stream with the same `streamId` and each other's
+       * address, there is no handshake.
+       */
+      class Stream : public Module {
+        public:
+          static constexpr unsigned char FRAME_MAGIC_BYTES_PREFIX[] = { 0x02, 0x0d, 0x13, 0x17 };
+
+          // magic, type, flags, stream id, sequence (or acknowledgement),
+          // receive window, and the payload length
+          static constexpr size_t FRAME_HEADER_BYTES = 4 + 1 + 1 + 8 + 4 + 4 + 2;
+          // keeps a frame within the minimum IPv6 MTU
+          static constexpr size_t SEGMENT_BYTES = 1152;
+          static constexpr size_t FRAME_BYTES = FRAME_HEADER_BYTES + SEGMENT_BYTES;
+
+          // segments in flight and segments buffered by a receiver
+          static constexpr uint32_t SEND_WINDOW = 128;
+          static constexpr uint32_t RECEIVE_WINDOW = 1024;
+
+          // retransmission timeouts in milliseconds, see RFC 6298
+          static constexpr uint64_t INITIAL_RTO = 1000;
+          static constexpr uint64_t MIN_RTO = 100;
+          static constexpr uint64_t MAX_RTO = 10000;
+          static constexpr int MAX_TRANSMISSIONS = 12;
+          // a segment is lost once this many segments sent after it are acked
+          static constexpr uint64_t REORDER_THRESHOLD = 3;
+          static constexpr uint64_t DELAYED_ACK_TIMEOUT = 5;
+          // how long a closed stream waits for the remote end to close
+          static constexpr uint64_t LINGER_TIMEOUT = 30000;
+
+          static constexpr size_t MAX_POOLED_BUFFERS = 4096;
+
+          struct OpenOptions {
+            uint64_t peerId = 0;
+            // identifies the stream on the wire, both ends use the same
+            uint64_t streamId = 0;
+            String address = "";
+            int port = 0;
+            // shares of outgoing data frames dropped or swapped with the
+            // next one and milliseconds incoming frames are held back, to
+            // simulate lossy and longer links on loopback
+            double dropRate = 0;
+            double reorderRate = 0;
+            uint64_t delay = 0;
+          };
+
+          struct Segment;
+          struct Connection;
+
+          Stream (auto core) : Module(core) {}
+
+          void open (
+            const String seq,
+            uint64_t id,
+            OpenOptions options,
+            Module::Callback cb
+          );
+          void write (
+            const String seq,
+            uint64_t id,
+            const char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+          void read (
+            const String seq,
+            uint64_t id,
+            size_t size,
+            Module::Callback cb
+          );
+          void close (const String seq, uint64_t id, Module::Callback cb);
+          void getState (const String seq, uint64_t id, Module::Callback cb);
+
+        private:
+          // only touched on the Core loop
+          std::map<uint64_t, std::shared_ptr<Connection>> connections;
+          // connection ids by the peer and stream id frames arrive with
+          std::map<std::pair<uint64_t, uint64_t>, uint64_t> routes;
+          // streams opened per peer, the peer receives while there are any
+          std::map<uint64_t, size_t> peers;
+          Vector<char *> buffers;
+
+          char * acquireBuffer ();
+          void releaseBuffer (char *buffer);
+          std::shared_ptr<Connection> getConnection (uint64_t id);
+          void receive (
+            uint64_t peerId,
+            ssize_t nread,
+            const uv_buf_t *buf,
+            const struct sockaddr *addr,
+            uint64_t timestamp
+          );
+          void remove (Connection *connection);
+      };
+
+      class TCP : public Module {
+        public:
+          // reads land in pooled buffers of this size
+          static constexpr size_t READ_BUFFER_SIZE = 64 * 1024;
+          static constexpr size_t MAX_POOLED_BUFFERS = 16;
+
+          struct SocketOptions {
+            bool noDelay = false;
+            bool keepAlive = false;
+            unsigned int keepAliveDelay = 60;
+          };
+
+          struct ConnectOptions {
+            String address;
+            int port;
+            SocketOptions socket;
+          };
+
+          struct ListenOptions {
+            String address;
+            int port;
+            int backlog = 511;
+            // applied to every accepted connection
+            SocketOptions socket;
+          };
+
+          TCP (auto core) : Module(core) {}
+          ~TCP ();
+
+          void accept (
+            const String seq,
+            uint64_t serverId,
+            uint64_t id,
+            Module::Callback cb
+          );
+          void close (const String seq, uint64_t id, Module::Callback cb);
+          void connect (
+            const String seq,
+            uint64_t id,
+            ConnectOptions options,
+            Module::Callback cb
+          );
+          void getState (const String seq, uint64_t id, Module::Callback cb);
+          void listen (
+            const String seq,
+            uint64_t id,
+            ListenOptions options,
+            Module::Callback cb
+          );
+          void readStart (const String seq, uint64_t id, Module::Callback cb);
+          void readStop (const String seq, uint64_t id, Module::Callback cb);
+          void setKeepAlive (
+            const String seq,
+            uint64_t id,
+            bool enabled,
+            unsigned int delay,
+            Module::Callback cb
+          );
+          void setNoDelay (
+            const String seq,
+            uint64_t id,
+            bool enabled,
+            Module::Callback cb
+          );
+          void shutdown (const String seq, uint64_t id, Module::Callback cb);
+          void write (
+            const String seq,
+            uint64_t id,
+            char *bytes,
+            size_t size,
+            Module::Callback cb
+          );
+
+          // only called on the Core loop
+          char * acquireBuffer ();
+          void releaseBuffer (char *buffer);
+
+        private:
+          Vector<char *> buffers;
+      };
+
       class UDP : public Module {
         public:
           UDP (auto core) : Module(core) {}
 
+          struct BenchmarkOptions {
+            // sockets reading the port in the second run, the first
+            // run reads it with one
+            size_t receivers = 4;
+            // threads flooding the port, each from a port of its own
+            size_t senders = 4;
+            size_t size = 1200;
+            // datagrams per send in the two runs comparing sends with and
+            // without GSO, 0 skips them
+            size_t segments = 16;
+            // milliseconds per run
+            uint64_t duration = 1000;
+          };
+
+          struct PeersBenchmarkOptions {
+            // peers looked up at random
+            size_t peers = 1024;
+            // threads looking peers up in the second run, the first run
+            // looks them up from one
+            size_t threads = 8;
+            // lookups per peer removed and created again
+            size_t lookups = 16;
+            // milliseconds per run
+            uint64_t duration = 200;
+          };
+
           struct BindOptions {
             String address;
             int port;
             bool reuseAddr = false;
+            size_t segmentSize = 0;
+            bool timestamps = false;
+            size_t receivers = 1;
+            peer_receive_steering_t steering = PEER_RECEIVE_STEERING_HASH;
           };
 
           struct ConnectOptions {
@@ -666,6 +1551,13 @@ namespace SSC {
             int port;
           };
 
+          struct ReadStartOptions {
+            bool decodePackets = false;
+            // reassembles FEC blocks sent with `sendBlock()` and recovers
+            // lost packets, other datagrams are delivered untouched
+            bool fec = false;
+          };
+
           struct SendOptions {
             String address = "";
             int port = 0;
@@ -674,6 +1566,93 @@ namespace SSC {
             bool ephemeral = false;
           };
 
+          struct Destination {
+            String address = "";
+            int port = 0;
+          };
+
+          struct SendManyOptions {
+            Vector<Destination> destinations;
+            char *bytes = nullptr;
+            size_t size = 0;
+            bool ephemeral = false;
+          };
+
+          struct SendBlockOptions {
+            String address = "";
+            int port = 0;
+            // the data packets, back to back
+            char *bytes = nullptr;
+            Vector<size_t> sizes;
+            size_t parityCount = 0;
+            // share of frames not sent, to simulate lossy links on loopback
+            double dropRate = 0;
+            bool ephemeral = false;
+          };
+
+          struct SendFileOptions {
+            String address = "";
+            int port = 0;
+            // an open `FS` descriptor id
+            uint64_t fd = 0;
+            size_t offset = 0;
+            // `0` sends up to the end of the file
+            size_t length = 0;
+            // bytes per datagram
+            size_t chunkSize = 1200;
+            bool ephemeral = false;
+          };
+
+          struct SendPacketOptions {
+            String address = "";
+            int port = 0;
+            StreamRelay::Packet packet;
+            bool ephemeral = false;
+          };
+
+          struct BufferTuningOptions {
+            bool enabled = false;
+            // bytes as reported for `SO_RCVBUF`, `0` for the current
+            // size and `ReceiveBufferTuner::DEFAULT_MAX_SIZE`
+            size_t minSize = 0;
+            size_t maxSize = 0;
+            // milliseconds between samples
+            uint64_t interval = ReceiveBufferTuner::DEFAULT_INTERVAL;
+          };
+
+          struct CongestionControlOptions {
+            bool enabled = false;
+            // bytes per second, `0` is unlimited
+            double maxPacingRate = 0;
+          };
+
+          struct RTTOptions {
+            // an empty address reports the estimates without probing
+            String address = "";
+            int port = 0;
+            // milliseconds to wait for the pong
+            uint64_t timeout = 1000;
+          };
+
+          struct StatsOptions {
+            // "bytes", "packets", "errors" or "drops"
+            String sort = "bytes";
+            // `0` reports every peer
+            size_t limit = 0;
+          };
+
+          struct SendQueueOptions {
+            size_t maxBytes = 0;
+            size_t maxCount = 0;
+            peer_send_queue_policy_t policy = PEER_SEND_QUEUE_POLICY_REJECT;
+          };
+
+          void benchmark (const String seq, BenchmarkOptions options, Module::Callback cb);
+          void benchmarkPeers (
+            const String seq,
+            PeersBenchmarkOptions options,
+            Module::Callback cb
+          );
           void bind (
             const String seq,
             uint64_t id,
@@ -691,28 +1670,149 @@ namespace SSC {
           void getPeerName (const String seq, uint64_t id, Module::Callback cb);
           void getSockName (const String seq, uint64_t id, Module::Callback cb);
           void getState (const String seq, uint64_t id,  Module::Callback cb);
-          void readStart (const String seq, uint64_t id, Module::Callback cb);
+          void readStart (
+            const String seq,
+            uint64_t id,
+            ReadStartOptions options,
+            Module::Callback cb
+          );
           void readStop (const String seq, uint64_t id, Module::Callback cb);
+          void rtt (
+            const String seq,
+            uint64_t id,
+            RTTOptions options,
+            Module::Callback cb
+          );
           void send (
             const String seq,
             uint64_t id,
             SendOptions options,
             Module::Callback cb
           );
+          void sendBlock (
+            const String seq,
+            uint64_t id,
+            SendBlockOptions options,
+            Module::Callback cb
+          );
+          void sendFile (
+            const String seq,
+            uint64_t id,
+            SendFileOptions options,
+            Module::Callback cb
+          );
+          void sendMany (
+            const String seq,
+            uint64_t id,
+            SendManyOptions options,
+            Module::Callback cb
+          );
+          void sendPacket (
+            const String seq,
+            uint64_t id,
+            SendPacketOptions options,
+            Module::Callback cb
+          );
+          void setBufferTuning (
+            const String seq,
+            uint64_t id,
+            BufferTuningOptions options,
+            Module::Callback cb
+          );
+          void setCongestionControl (
+            const String seq,
+            uint64_t id,
+            CongestionControlOptions options,
+            Module::Callback cb
+          );
+          void setSendQueueLimits (
+            const String seq,
+            uint64_t id,
+            SendQueueOptions options,
+            Module::Callback cb
+          );
+          void stats (const String seq, StatsOptions options, Module::Callback cb);
+
+        private:
+          // FEC block ids, starting at random so restarts do not
+          // collide with blocks a receiver still remembers
+          std::atomic<uint32_t> nextBlockId = (uint32_t) rand64();
       };
 
+      /**
+       * A fixed pool of worker threads, one fewer than the number of CPUs,
+       * for CPU heavy work that would otherwise block the loop or a UI
+       * thread. Every worker has a bounded queue per priority and steals
+       * from the others before going idle. The `done` callback of a task
+       * runs on the Core loop.
+       */
+      class Workers : public Module {
+        public:
+          static constexpr size_t MAX_QUEUED_TASKS = 1024; // per worker
+
+          enum class Priority { Low = 0, Normal = 1, High = 2 };
+
+          using Work = std::function<void()>;
+
+          Workers (auto core) : Module(core) {}
+          ~Workers ();
+
+          // `false` if every queue is full or the pool is stopping
+          bool submit (
+            Work work,
+            EventLoopDispatchCallback done,
+            Priority priority = Priority::Normal
+          );
+
+          size_t size () const;
+          void stop ();
+
+        private:
+          static constexpr size_t PRIORITIES = 3;
+
+          struct Task {
+            Work work;
+            EventLoopDispatchCallback done;
+          };
+
+          struct Worker {
+            std::deque<Task> queues[PRIORITIES];
+            size_t queued = 0;
+            Mutex mutex;
+          };
+
+          std::vector<std::unique_ptr<Worker>> workers;
+          std::vector<std::thread> threads;
+          std::once_flag started;
+          std::mutex mutex;
+          std::condition_variable condition;
+          std::atomic<size_t> pending = 0;
+          std::atomic<size_t> next = 0;
+          std::atomic<bool> stopping = false;
+
+          void start ();
+          void run (size_t index);
+          bool take (size_t index, Task& task);
+      };
+
+      Buffers buffers;
+      Cache cache;
+      Channel channel;
+      Crypto crypto;
       Diagnostics diagnostics;
       DNS dns;
+      FEC fec;
       FS fs;
       OS os;
       Platform platform;
+      Stream stream;
+      TCP tcp;
       UDP udp;
 
       std::shared_ptr<Posts> posts;
-      std::map<uint64_t, Peer*> peers;
+      PeerRegistry peers;
 
       std::recursive_mutex loopMutex;
-      std::recursive_mutex peersMutex;
       std::recursive_mutex postsMutex;
       std::recursive_mutex timersMutex;
 
@@ -741,13 +1841,25 @@ namespace SSC {
       std::thread *eventLoopThread = nullptr;
 #endif
 
+      // declared last so it is destroyed first, the workers are stopped
+      // while the loop their `done` callbacks are dispatched to is alive
+      Workers workers;
+
       Core () :
+        buffers(this),
+        cache(this),
+        channel(this),
+        crypto(this),
         diagnostics(this),
         dns(this),
+        fec(this),
         fs(this),
         os(this),
         platform(this),
-        udp(this)
+        stream(this),
+        tcp(this),
+        udp(this),
+        workers(this)
       {
         this->posts = std::shared_ptr<Posts>(new Posts());
         initEventLoop();
@@ -758,9 +1870,13 @@ namespace SSC {
       bool hasPeer (uint64_t id);
       void removePeer (uint64_t id);
       void removePeer (uint64_t id, bool autoClose);
-      Peer* getPeer (uint64_t id);
-      Peer* createPeer (peer_type_t type, uint64_t id);
-      Peer* createPeer (peer_type_t type, uint64_t id, bool isEphemeral);
+      std::shared_ptr<Peer> getPeer (uint64_t id);
+      std::shared_ptr<Peer> createPeer (peer_type_t type, uint64_t id);
+      std::shared_ptr<Peer> createPeer (
+        peer_type_t type,
+        uint64_t id,
+        bool isEphemeral
+      );
 
       Post getPost (uint64_t id);
       bool hasPost (uint64_t id);
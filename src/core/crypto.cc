@@ -0,0 +1,1995 @@
+#include "core.hh"
+
+#include <cstring>
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <fcntl.h>
+#endif
+
+#if defined(_WIN32)
+#include <bcrypt.h>
+#endif
+
+// The Curve25519, Ed25519, XSalsa20 and Poly1305 code follows TweetNaCl
+// (public domain), with libsodium's key conversion and sealed box layout
+// on top of it.
+namespace SSC::Crypto {
+  static const unsigned char ZERO[16] = {0};
+  static const unsigned char NINE[32] = {9};
+  static const unsigned char SIGMA[16] = {
+    'e', 'x', 'p', 'a', 'n', 'd', ' ', '3', '2', '-', 'b', 'y', 't', 'e', ' ', 'k'
+  };
+
+#if defined(__SIZEOF_INT128__)
+  // radix 2^51, products fit in 128 bits
+  using gf = uint64_t[5];
+  using uint128_t = unsigned __int128;
+
+  static constexpr uint64_t MASK51 = (1ULL << 51) - 1;
+
+  static const gf GF0 = {0};
+  static const gf GF1 = {1};
+  static const gf GF121665 = {121665};
+
+  static const gf D = {
+    0x34dca135978a3, 0x1a8283b156ebd, 0x5e7a26001c029, 0x739c663a03cbb, 0x52036cee2b6ff
+  };
+
+  static const gf D2 = {
+    0x69b9426b2f159, 0x35050762add7a, 0x3cf44c0038052, 0x6738cc7407977, 0x2406d9dc56dff
+  };
+
+  static const gf X = {
+    0x62d608f25d51a, 0x412a4b4f6592a, 0x75b7171a4b31d, 0x1ff60527118fe, 0x216936d3cd6e5
+  };
+
+  static const gf Y = {
+    0x6666666666658, 0x4cccccccccccc, 0x1999999999999, 0x3333333333333, 0x6666666666666
+  };
+
+  static const gf I = {
+    0x61b274a0ea0b0, 0x0d5a5fc8f189d, 0x7ef5e9cbd0c60, 0x78595a6804c9e, 0x2b8324804fc1d
+  };
+#else
+  // radix 2^16, portable to compilers without 128 bit integers
+  using gf = int64_t[16];
+
+  static const gf GF0 = {0};
+  static const gf GF1 = {1};
+  static const gf GF121665 = {0xdb41, 1};
+
+  static const gf D = {
+    0x78a3, 0x1359, 0x4dca, 0x75eb, 0xd8ab, 0x4141, 0x0a4d, 0x0070,
+    0xe898, 0x7779, 0x4079, 0x8cc7, 0xfe73, 0x2b6f, 0x6cee, 0x5203
+  };
+
+  static const gf D2 = {
+    0xf159, 0x26b2, 0x9b94, 0xebd6, 0xb156, 0x8283, 0x149a, 0x00e0,
+    0xd130, 0xeef3, 0x80f2, 0x198e, 0xfce7, 0x56df, 0xd9dc, 0x2406
+  };
+
+  static const gf X = {
+    0xd51a, 0x8f25, 0x2d60, 0xc956, 0xa7b2, 0x9525, 0xc760, 0x692c,
+    0xdc5c, 0xfdd6, 0xe231, 0xc0a4, 0x53fe, 0xcd6e, 0x36d3, 0x2169
+  };
+
+  static const gf Y = {
+    0x6658, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666,
+    0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666, 0x6666
+  };
+
+  static const gf I = {
+    0xa0b0, 0x4a0e, 0x1b27, 0xc4ee, 0xe478, 0xad2f, 0x1806, 0x2f43,
+    0xd7a7, 0x3dfb, 0x0099, 0x2b4d, 0xdf0b, 0x4fc1, 0x2480, 0x2b83
+  };
+#endif
+
+  // the order of the Ed25519 base point
+  static const int64_t L[32] = {
+    0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58,
+    0xd6, 0x9c, 0xf7, 0xa2, 0xde, 0xf9, 0xde, 0x14,
+    0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0x10
+  };
+
+  static const uint64_t SHA512_K[80] = {
+    0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc,
+    0x3956c25bf348b538, 0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118,
+    0xd807aa98a3030242, 0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+    0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235, 0xc19bf174cf692694,
+    0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+    0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+    0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4,
+    0xc6e00bf33da88fc2, 0xd5a79147930aa725, 0x06ca6351e003826f, 0x142929670a0e6e70,
+    0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+    0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+    0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30,
+    0xd192e819d6ef5218, 0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+    0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8,
+    0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3,
+    0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+    0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b,
+    0xca273eceea26619c, 0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178,
+    0x06f067aa72176fba, 0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+    0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc, 0x431d67c49c100d4c,
+    0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817
+  };
+
+  static const uint64_t SHA512_IV[8] = {
+    0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+    0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+  };
+
+  static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+  static const uint32_t SHA256_IV[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+  };
+
+  static const uint8_t BLAKE2B_SIGMA[12][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 },
+    { 11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4 },
+    { 7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8 },
+    { 9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13 },
+    { 2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9 },
+    { 12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11 },
+    { 13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10 },
+    { 6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5 },
+    { 10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0 },
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3 }
+  };
+
+  static const char BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  static inline uint32_t rotl32 (uint32_t x, int c) {
+    return (x << c) | (x >> (32 - c));
+  }
+
+  static inline uint32_t rotr32 (uint32_t x, int c) {
+    return (x >> c) | (x << (32 - c));
+  }
+
+  static inline uint64_t rotr64 (uint64_t x, int c) {
+    return (x >> c) | (x << (64 - c));
+  }
+
+  static inline uint32_t load32LE (const unsigned char *x) {
+    return (
+      (uint32_t) x[0] |
+      ((uint32_t) x[1] << 8) |
+      ((uint32_t) x[2] << 16) |
+      ((uint32_t) x[3] << 24)
+    );
+  }
+
+  static inline void store32LE (unsigned char *x, uint32_t u) {
+    for (int i = 0; i < 4; ++i) {
+      x[i] = (unsigned char) u;
+      u >>= 8;
+    }
+  }
+
+  static inline uint32_t load32BE (const unsigned char *x) {
+    return (
+      ((uint32_t) x[0] << 24) |
+      ((uint32_t) x[1] << 16) |
+      ((uint32_t) x[2] << 8) |
+      (uint32_t) x[3]
+    );
+  }
+
+  static inline void store32BE (unsigned char *x, uint32_t u) {
+    for (int i = 3; i >= 0; --i) {
+      x[i] = (unsigned char) u;
+      u >>= 8;
+    }
+  }
+
+  static inline uint64_t load64LE (const unsigned char *x) {
+    uint64_t u = 0;
+
+    for (int i = 7; i >= 0; --i) {
+      u = (u << 8) | x[i];
+    }
+
+    return u;
+  }
+
+  static inline uint64_t load64BE (const unsigned char *x) {
+    uint64_t u = 0;
+
+    for (int i = 0; i < 8; ++i) {
+      u = (u << 8) | x[i];
+    }
+
+    return u;
+  }
+
+  static inline void store64BE (unsigned char *x, uint64_t u) {
+    for (int i = 7; i >= 0; --i) {
+      x[i] = (unsigned char) u;
+      u >>= 8;
+    }
+  }
+
+  // constant time comparison, `0` when equal
+  static int verifyBytes (const unsigned char *x, const unsigned char *y, size_t n) {
+    uint32_t d = 0;
+
+    for (size_t i = 0; i < n; ++i) {
+      d |= x[i] ^ y[i];
+    }
+
+    return (1 & ((d - 1) >> 8)) - 1;
+  }
+
+  static void wipe (void *bytes, size_t size) {
+    volatile unsigned char *p = (volatile unsigned char *) bytes;
+
+    while (size--) {
+      *p++ = 0;
+    }
+  }
+
+  void randomBytes (unsigned char *bytes, size_t size) {
+  #if defined(__APPLE__)
+    arc4random_buf(bytes, size);
+  #elif defined(_WIN32)
+    auto status = BCryptGenRandom(nullptr, bytes, (ULONG) size, BCRYPT_USE_SYSTEM_PREFERRED_RNG);
+
+    // never hand out predictable keys
+    if (!BCRYPT_SUCCESS(status)) {
+      abort();
+    }
+  #else
+    static int fd = -1;
+    static std::once_flag once;
+
+    std::call_once(once, []() {
+      fd = ::open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    });
+
+    while (size > 0 && fd >= 0) {
+      auto n = ::read(fd, bytes, size);
+
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        break;
+      }
+
+      bytes += n;
+      size -= (size_t) n;
+    }
+
+    // never hand out predictable keys
+    if (size > 0) {
+      abort();
+    }
+  #endif
+  }
+
+  //
+  // SHA-256
+  //
+  static void sha256Blocks (uint32_t *h, const unsigned char *m, size_t blocks) {
+    uint32_t w[64];
+
+    while (blocks--) {
+      for (int i = 0; i < 16; ++i) {
+        w[i] = load32BE(m + 4 * i);
+      }
+
+      for (int i = 16; i < 64; ++i) {
+        auto s0 = rotr32(w[i - 15], 7) ^ rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        auto s1 = rotr32(w[i - 2], 17) ^ rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+      }
+
+      uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+      uint32_t e = h[4], f = h[5], g = h[6], k = h[7];
+
+      for (int i = 0; i < 64; ++i) {
+        auto s1 = rotr32(e, 6) ^ rotr32(e, 11) ^ rotr32(e, 25);
+        auto ch = (e & f) ^ (~e & g);
+        auto t1 = k + s1 + ch + SHA256_K[i] + w[i];
+        auto s0 = rotr32(a, 2) ^ rotr32(a, 13) ^ rotr32(a, 22);
+        auto maj = (a & b) ^ (a & c) ^ (b & c);
+        auto t2 = s0 + maj;
+
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+      }
+
+      h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+      h[4] += e; h[5] += f; h[6] += g; h[7] += k;
+      m += 64;
+    }
+  }
+
+  void sha256 (const unsigned char *bytes, size_t size, unsigned char *output) {
+    uint32_t h[8];
+    unsigned char tail[128] = {0};
+    auto blocks = size / 64;
+    auto rest = size % 64;
+
+    memcpy(h, SHA256_IV, sizeof(h));
+    sha256Blocks(h, bytes, blocks);
+
+    if (rest > 0) {
+      memcpy(tail, bytes + blocks * 64, rest);
+    }
+
+    tail[rest] = 0x80;
+
+    auto tailSize = rest < 56 ? 64 : 128;
+    auto bits = (uint64_t) size << 3;
+    store64BE(tail + tailSize - 8, bits);
+    sha256Blocks(h, tail, tailSize / 64);
+
+    for (int i = 0; i < 8; ++i) {
+      store32BE(output + 4 * i, h[i]);
+    }
+  }
+
+  //
+  // SHA-512, incremental as Ed25519 hashes messages with a prefix
+  //
+  struct SHA512State {
+    uint64_t h[8];
+    unsigned char buffer[128];
+    size_t bufferSize = 0;
+    uint64_t total = 0;
+  };
+
+  static void sha512Blocks (uint64_t *z, const unsigned char *m, size_t blocks) {
+    uint64_t a[8], b[8], w[16];
+
+    while (blocks--) {
+      for (int i = 0; i < 8; ++i) {
+        a[i] = z[i];
+      }
+
+      for (int i = 0; i < 16; ++i) {
+        w[i] = load64BE(m + 8 * i);
+      }
+
+      for (int i = 0; i < 80; ++i) {
+        for (int j = 0; j < 8; ++j) {
+          b[j] = a[j];
+        }
+
+        auto S1 = rotr64(a[4], 14) ^ rotr64(a[4], 18) ^ rotr64(a[4], 41);
+        auto ch = (a[4] & a[5]) ^ (~a[4] & a[6]);
+        auto t = a[7] + S1 + ch + SHA512_K[i] + w[i % 16];
+        auto S0 = rotr64(a[0], 28) ^ rotr64(a[0], 34) ^ rotr64(a[0], 39);
+        auto maj = (a[0] & a[1]) ^ (a[0] & a[2]) ^ (a[1] & a[2]);
+
+        b[7] = t + S0 + maj;
+        b[3] += t;
+
+        for (int j = 0; j < 8; ++j) {
+          a[(j + 1) % 8] = b[j];
+        }
+
+        if (i % 16 == 15) {
+          for (int j = 0; j < 16; ++j) {
+            auto x = w[(j + 1) % 16];
+            auto y = w[(j + 14) % 16];
+            auto s0 = rotr64(x, 1) ^ rotr64(x, 8) ^ (x >> 7);
+            auto s1 = rotr64(y, 19) ^ rotr64(y, 61) ^ (y >> 6);
+            w[j] += w[(j + 9) % 16] + s0 + s1;
+          }
+        }
+      }
+
+      for (int i = 0; i < 8; ++i) {
+        z[i] += a[i];
+      }
+
+      m += 128;
+    }
+  }
+
+  static void sha512Init (SHA512State &state) {
+    memcpy(state.h, SHA512_IV, sizeof(state.h));
+    state.bufferSize = 0;
+    state.total = 0;
+  }
+
+  static void sha512Update (SHA512State &state, const unsigned char *m, size_t n) {
+    // `m` may be null for an empty message
+    if (n == 0) {
+      return;
+    }
+
+    state.total += n;
+
+    if (state.bufferSize > 0) {
+      auto take = std::min(n, sizeof(state.buffer) - state.bufferSize);
+      memcpy(state.buffer + state.bufferSize, m, take);
+      state.bufferSize += take;
+      m += take;
+      n -= take;
+
+      if (state.bufferSize < sizeof(state.buffer)) {
+        return;
+      }
+
+      sha512Blocks(state.h, state.buffer, 1);
+      state.bufferSize = 0;
+    }
+
+    sha512Blocks(state.h, m, n / 128);
+    m += n - (n % 128);
+    n %= 128;
+
+    memcpy(state.buffer, m, n);
+    state.bufferSize = n;
+  }
+
+  static void sha512Final (SHA512State &state, unsigned char *output) {
+    unsigned char tail[256] = {0};
+    auto rest = state.bufferSize;
+
+    memcpy(tail, state.buffer, rest);
+    tail[rest] = 0x80;
+
+    auto tailSize = rest < 112 ? 128 : 256;
+    store64BE(tail + tailSize - 16, state.total >> 61);
+    store64BE(tail + tailSize - 8, state.total << 3);
+    sha512Blocks(state.h, tail, tailSize / 128);
+
+    for (int i = 0; i < 8; ++i) {
+      store64BE(output + 8 * i, state.h[i]);
+    }
+  }
+
+  void sha512 (const unsigned char *bytes, size_t size, unsigned char *output) {
+    SHA512State state;
+    sha512Init(state);
+    sha512Update(state, bytes, size);
+    sha512Final(state, output);
+  }
+
+  //
+  // BLAKE2b, unkeyed, used to derive sealed box nonces
+  //
+  static void blake2bCompress (
+    uint64_t *h,
+    const unsigned char *block,
+    uint64_t counter,
+    bool last
+  ) {
+    uint64_t v[16], m[16];
+
+    for (int i = 0; i < 16; ++i) {
+      m[i] = load64LE(block + 8 * i);
+    }
+
+    for (int i = 0; i < 8; ++i) {
+      v[i] = h[i];
+      v[i + 8] = SHA512_IV[i];
+    }
+
+    v[12] ^= counter;
+
+    if (last) {
+      v[14] = ~v[14];
+    }
+
+    auto G = [&](int a, int b, int c, int d, uint64_t x, uint64_t y) {
+      v[a] = v[a] + v[b] + x;
+      v[d] = rotr64(v[d] ^ v[a], 32);
+      v[c] = v[c] + v[d];
+      v[b] = rotr64(v[b] ^ v[c], 24);
+      v[a] = v[a] + v[b] + y;
+      v[d] = rotr64(v[d] ^ v[a], 16);
+      v[c] = v[c] + v[d];
+      v[b] = rotr64(v[b] ^ v[c], 63);
+    };
+
+    for (int r = 0; r < 12; ++r) {
+      auto s = BLAKE2B_SIGMA[r];
+      G(0, 4, 8, 12, m[s[0]], m[s[1]]);
+      G(1, 5, 9, 13, m[s[2]], m[s[3]]);
+      G(2, 6, 10, 14, m[s[4]], m[s[5]]);
+      G(3, 7, 11, 15, m[s[6]], m[s[7]]);
+      G(0, 5, 10, 15, m[s[8]], m[s[9]]);
+      G(1, 6, 11, 12, m[s[10]], m[s[11]]);
+      G(2, 7, 8, 13, m[s[12]], m[s[13]]);
+      G(3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+
+    for (int i = 0; i < 8; ++i) {
+      h[i] ^= v[i] ^ v[i + 8];
+    }
+  }
+
+  void blake2b (
+    unsigned char *output,
+    size_t outputSize,
+    const unsigned char *bytes,
+    size_t size
+  ) {
+    // BLAKE2b shares its IV with SHA-512
+    uint64_t h[8];
+    unsigned char block[128];
+    unsigned char digest[64];
+    uint64_t counter = 0;
+
+    memcpy(h, SHA512_IV, sizeof(h));
+    h[0] ^= 0x01010000 ^ (uint64_t) outputSize;
+
+    while (size > 128) {
+      counter += 128;
+      blake2bCompress(h, bytes, counter, false);
+      bytes += 128;
+      size -= 128;
+    }
+
+    memset(block, 0, sizeof(block));
+
+    if (size > 0) {
+      memcpy(block, bytes, size);
+    }
+
+    counter += size;
+    blake2bCompress(h, block, counter, true);
+
+    for (int i = 0; i < 8; ++i) {
+      for (int j = 0; j < 8; ++j) {
+        digest[8 * i + j] = (unsigned char) (h[i] >> (8 * j));
+      }
+    }
+
+    memcpy(output, digest, outputSize);
+  }
+
+  //
+  // Salsa20, XSalsa20 and Poly1305
+  //
+  static void salsa20Core (
+    unsigned char *out,
+    const unsigned char *in,
+    const unsigned char *k,
+    const unsigned char *c,
+    bool hsalsa
+  ) {
+    uint32_t w[16], x[16], y[16], t[4];
+
+    for (int i = 0; i < 4; ++i) {
+      x[5 * i] = load32LE(c + 4 * i);
+      x[1 + i] = load32LE(k + 4 * i);
+      x[6 + i] = load32LE(in + 4 * i);
+      x[11 + i] = load32LE(k + 16 + 4 * i);
+    }
+
+    for (int i = 0; i < 16; ++i) {
+      y[i] = x[i];
+    }
+
+    for (int i = 0; i < 20; ++i) {
+      for (int j = 0; j < 4; ++j) {
+        for (int m = 0; m < 4; ++m) {
+          t[m] = x[(5 * j + 4 * m) % 16];
+        }
+
+        t[1] ^= rotl32(t[0] + t[3], 7);
+        t[2] ^= rotl32(t[1] + t[0], 9);
+        t[3] ^= rotl32(t[2] + t[1], 13);
+        t[0] ^= rotl32(t[3] + t[2], 18);
+
+        for (int m = 0; m < 4; ++m) {
+          w[4 * j + (j + m) % 4] = t[m];
+        }
+      }
+
+      for (int m = 0; m < 16; ++m) {
+        x[m] = w[m];
+      }
+    }
+
+    if (hsalsa) {
+      for (int i = 0; i < 16; ++i) {
+        x[i] += y[i];
+      }
+
+      for (int i = 0; i < 4; ++i) {
+        x[5 * i] -= load32LE(c + 4 * i);
+        x[6 + i] -= load32LE(in + 4 * i);
+      }
+
+      for (int i = 0; i < 4; ++i) {
+        store32LE(out + 4 * i, x[5 * i]);
+        store32LE(out + 16 + 4 * i, x[6 + i]);
+      }
+    } else {
+      for (int i = 0; i < 16; ++i) {
+        store32LE(out + 4 * i, x[i] + y[i]);
+      }
+    }
+  }
+
+  static void salsa20Xor (
+    unsigned char *c,
+    const unsigned char *m,
+    size_t b,
+    const unsigned char *n,
+    const unsigned char *k
+  ) {
+    unsigned char z[16] = {0};
+    unsigned char x[64];
+
+    for (int i = 0; i < 8; ++i) {
+      z[i] = n[i];
+    }
+
+    while (b >= 64) {
+      salsa20Core(x, z, k, SIGMA, false);
+
+      for (int i = 0; i < 64; ++i) {
+        c[i] = (m ? m[i] : 0) ^ x[i];
+      }
+
+      uint32_t u = 1;
+
+      for (int i = 8; i < 16; ++i) {
+        u += (uint32_t) z[i];
+        z[i] = (unsigned char) u;
+        u >>= 8;
+      }
+
+      b -= 64;
+      c += 64;
+
+      if (m) {
+        m += 64;
+      }
+    }
+
+    if (b > 0) {
+      salsa20Core(x, z, k, SIGMA, false);
+
+      for (size_t i = 0; i < b; ++i) {
+        c[i] = (m ? m[i] : 0) ^ x[i];
+      }
+    }
+  }
+
+  static void xsalsa20Xor (
+    unsigned char *c,
+    const unsigned char *m,
+    size_t d,
+    const unsigned char *n,
+    const unsigned char *k
+  ) {
+    unsigned char s[32];
+    salsa20Core(s, n, k, SIGMA, true);
+    salsa20Xor(c, m, d, n + 16, s);
+    wipe(s, sizeof(s));
+  }
+
+  static void poly1305Add (uint32_t *h, const uint32_t *c) {
+    uint32_t u = 0;
+
+    for (int j = 0; j < 17; ++j) {
+      u += h[j] + c[j];
+      h[j] = u & 255;
+      u >>= 8;
+    }
+  }
+
+  static void poly1305 (
+    unsigned char *out,
+    const unsigned char *m,
+    size_t n,
+    const unsigned char *k
+  ) {
+    static const uint32_t minusp[17] = {
+      5, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 252
+    };
+
+    uint32_t x[17], r[17], h[17], c[17], g[17];
+
+    for (int j = 0; j < 17; ++j) {
+      r[j] = h[j] = 0;
+    }
+
+    for (int j = 0; j < 16; ++j) {
+      r[j] = k[j];
+    }
+
+    r[3] &= 15; r[4] &= 252; r[7] &= 15; r[8] &= 252;
+    r[11] &= 15; r[12] &= 252; r[15] &= 15;
+
+    while (n > 0) {
+      size_t j = 0;
+
+      for (int i = 0; i < 17; ++i) {
+        c[i] = 0;
+      }
+
+      for (; j < 16 && j < n; ++j) {
+        c[j] = m[j];
+      }
+
+      c[j] = 1;
+      m += j;
+      n -= j;
+      poly1305Add(h, c);
+
+      for (int i = 0; i < 17; ++i) {
+        x[i] = 0;
+
+        for (int l = 0; l < 17; ++l) {
+          x[i] += h[l] * ((l <= i) ? r[i - l] : 320 * r[i + 17 - l]);
+        }
+      }
+
+      for (int i = 0; i < 17; ++i) {
+        h[i] = x[i];
+      }
+
+      uint32_t u = 0;
+
+      for (int l = 0; l < 16; ++l) {
+        u += h[l];
+        h[l] = u & 255;
+        u >>= 8;
+      }
+
+      u += h[16];
+      h[16] = u & 3;
+      u = 5 * (u >> 2);
+
+      for (int l = 0; l < 16; ++l) {
+        u += h[l];
+        h[l] = u & 255;
+        u >>= 8;
+      }
+
+      u += h[16];
+      h[16] = u;
+    }
+
+    for (int j = 0; j < 17; ++j) {
+      g[j] = h[j];
+    }
+
+    poly1305Add(h, minusp);
+    uint32_t s = -(h[16] >> 7);
+
+    for (int j = 0; j < 17; ++j) {
+      h[j] ^= s & (g[j] ^ h[j]);
+    }
+
+    for (int j = 0; j < 16; ++j) {
+      c[j] = k[j + 16];
+    }
+
+    c[16] = 0;
+    poly1305Add(h, c);
+
+    for (int j = 0; j < 16; ++j) {
+      out[j] = (unsigned char) h[j];
+    }
+  }
+
+  // `c` and `m` are prefixed with 32 zero bytes of padding
+  static void secretbox (
+    unsigned char *c,
+    const unsigned char *m,
+    size_t d,
+    const unsigned char *n,
+    const unsigned char *k
+  ) {
+    xsalsa20Xor(c, m, d, n, k);
+    poly1305(c + 16, c + 32, d - 32, c);
+    memset(c, 0, 16);
+  }
+
+  static bool secretboxOpen (
+    unsigned char *m,
+    const unsigned char *c,
+    size_t d,
+    const unsigned char *n,
+    const unsigned char *k
+  ) {
+    unsigned char x[32];
+    unsigned char mac[16];
+
+    if (d < 32) {
+      return false;
+    }
+
+    xsalsa20Xor(x, nullptr, 32, n, k);
+    poly1305(mac, c + 32, d - 32, x);
+
+    if (verifyBytes(c + 16, mac, 16) != 0) {
+      return false;
+    }
+
+    xsalsa20Xor(m, c, d, n, k);
+    memset(m, 0, 32);
+    return true;
+  }
+
+  //
+  // Curve25519 field arithmetic
+  //
+#if defined(__SIZEOF_INT128__)
+  static void set25519 (gf r, const gf a) {
+    for (int i = 0; i < 5; ++i) r[i] = a[i];
+  }
+
+  static void car25519 (gf o) {
+    uint64_t c = 0;
+
+    for (int i = 0; i < 5; ++i) {
+      o[i] += c;
+      c = o[i] >> 51;
+      o[i] &= MASK51;
+    }
+
+    o[0] += c * 19;
+    o[1] += o[0] >> 51;
+    o[0] &= MASK51;
+  }
+
+  static void sel25519 (gf p, gf q, int b) {
+    uint64_t c = -(uint64_t) b;
+
+    for (int i = 0; i < 5; ++i) {
+      uint64_t t = c & (p[i] ^ q[i]);
+      p[i] ^= t;
+      q[i] ^= t;
+    }
+  }
+
+  static void pack25519 (unsigned char *o, const gf n) {
+    uint64_t t[5];
+
+    for (int i = 0; i < 5; ++i) t[i] = n[i];
+
+    car25519(t);
+    car25519(t);
+
+    // subtract p if t >= p
+    uint64_t q = (t[0] + 19) >> 51;
+    q = (t[1] + q) >> 51;
+    q = (t[2] + q) >> 51;
+    q = (t[3] + q) >> 51;
+    q = (t[4] + q) >> 51;
+
+    t[0] += 19 * q;
+
+    for (int i = 0; i < 4; ++i) {
+      t[i + 1] += t[i] >> 51;
+      t[i] &= MASK51;
+    }
+
+    t[4] &= MASK51;
+
+    uint64_t w[4] = {
+      t[0] | (t[1] << 51),
+      (t[1] >> 13) | (t[2] << 38),
+      (t[2] >> 26) | (t[3] << 25),
+      (t[3] >> 39) | (t[4] << 12)
+    };
+
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 8; ++j) {
+        o[8 * i + j] = (unsigned char) (w[i] >> (8 * j));
+      }
+    }
+  }
+
+  static void unpack25519 (gf o, const unsigned char *n) {
+    o[0] = load64LE(n) & MASK51;
+    o[1] = (load64LE(n + 6) >> 3) & MASK51;
+    o[2] = (load64LE(n + 12) >> 6) & MASK51;
+    o[3] = (load64LE(n + 19) >> 1) & MASK51;
+    o[4] = (load64LE(n + 24) >> 12) & MASK51;
+  }
+
+  static void A (gf o, const gf a, const gf b) {
+    for (int i = 0; i < 5; ++i) o[i] = a[i] + b[i];
+  }
+
+  // adds 2p first so limbs never go negative, `b` is always reduced
+  static void Z (gf o, const gf a, const gf b) {
+    o[0] = a[0] + 0xfffffffffffda - b[0];
+
+    for (int i = 1; i < 5; ++i) {
+      o[i] = a[i] + 0xffffffffffffe - b[i];
+    }
+  }
+
+  static void M (gf o, const gf a, const gf b) {
+    uint64_t b1 = b[1] * 19;
+    uint64_t b2 = b[2] * 19;
+    uint64_t b3 = b[3] * 19;
+    uint64_t b4 = b[4] * 19;
+
+    uint128_t t0 =
+      (uint128_t) a[0] * b[0] + (uint128_t) a[1] * b4 + (uint128_t) a[2] * b3 +
+      (uint128_t) a[3] * b2 + (uint128_t) a[4] * b1;
+
+    uint128_t t1 =
+      (uint128_t) a[0] * b[1] + (uint128_t) a[1] * b[0] + (uint128_t) a[2] * b4 +
+      (uint128_t) a[3] * b3 + (uint128_t) a[4] * b2;
+
+    uint128_t t2 =
+      (uint128_t) a[0] * b[2] + (uint128_t) a[1] * b[1] + (uint128_t) a[2] * b[0] +
+      (uint128_t) a[3] * b4 + (uint128_t) a[4] * b3;
+
+    uint128_t t3 =
+      (uint128_t) a[0] * b[3] + (uint128_t) a[1] * b[2] + (uint128_t) a[2] * b[1] +
+      (uint128_t) a[3] * b[0] + (uint128_t) a[4] * b4;
+
+    uint128_t t4 =
+      (uint128_t) a[0] * b[4] + (uint128_t) a[1] * b[3] + (uint128_t) a[2] * b[2] +
+      (uint128_t) a[3] * b[1] + (uint128_t) a[4] * b[0];
+
+    t1 += t0 >> 51;
+    t2 += t1 >> 51;
+    t3 += t2 >> 51;
+    t4 += t3 >> 51;
+
+    uint64_t r0 = (uint64_t) t0 & MASK51;
+    uint64_t c = (uint64_t) (t4 >> 51);
+
+    r0 += c * 19;
+    o[1] = ((uint64_t) t1 & MASK51) + (r0 >> 51);
+    o[0] = r0 & MASK51;
+    o[2] = (uint64_t) t2 & MASK51;
+    o[3] = (uint64_t) t3 & MASK51;
+    o[4] = (uint64_t) t4 & MASK51;
+  }
+#else
+  static void set25519 (gf r, const gf a) {
+    for (int i = 0; i < 16; ++i) r[i] = a[i];
+  }
+
+  static void car25519 (gf o) {
+    for (int i = 0; i < 16; ++i) {
+      o[i] += (1LL << 16);
+      int64_t c = o[i] >> 16;
+      o[(i + 1) * (i < 15)] += c - 1 + 37 * (c - 1) * (i == 15);
+      o[i] -= c * (1LL << 16);
+    }
+  }
+
+  static void sel25519 (gf p, gf q, int b) {
+    int64_t c = ~(b - 1);
+
+    for (int i = 0; i < 16; ++i) {
+      int64_t t = c & (p[i] ^ q[i]);
+      p[i] ^= t;
+      q[i] ^= t;
+    }
+  }
+
+  static void pack25519 (unsigned char *o, const gf n) {
+    gf m, t;
+
+    for (int i = 0; i < 16; ++i) t[i] = n[i];
+
+    car25519(t);
+    car25519(t);
+    car25519(t);
+
+    for (int j = 0; j < 2; ++j) {
+      m[0] = t[0] - 0xffed;
+
+      for (int i = 1; i < 15; ++i) {
+        m[i] = t[i] - 0xffff - ((m[i - 1] >> 16) & 1);
+        m[i - 1] &= 0xffff;
+      }
+
+      m[15] = t[15] - 0x7fff - ((m[14] >> 16) & 1);
+      int b = (m[15] >> 16) & 1;
+      m[14] &= 0xffff;
+      sel25519(t, m, 1 - b);
+    }
+
+    for (int i = 0; i < 16; ++i) {
+      o[2 * i] = t[i] & 0xff;
+      o[2 * i + 1] = (unsigned char) (t[i] >> 8);
+    }
+  }
+
+  static void unpack25519 (gf o, const unsigned char *n) {
+    for (int i = 0; i < 16; ++i) {
+      o[i] = n[2 * i] + ((int64_t) n[2 * i + 1] << 8);
+    }
+
+    o[15] &= 0x7fff;
+  }
+
+  static void A (gf o, const gf a, const gf b) {
+    for (int i = 0; i < 16; ++i) o[i] = a[i] + b[i];
+  }
+
+  static void Z (gf o, const gf a, const gf b) {
+    for (int i = 0; i < 16; ++i) o[i] = a[i] - b[i];
+  }
+
+  static void M (gf o, const gf a, const gf b) {
+    int64_t t[31] = {0};
+
+    for (int i = 0; i < 16; ++i) {
+      for (int j = 0; j < 16; ++j) {
+        t[i + j] += a[i] * b[j];
+      }
+    }
+
+    for (int i = 0; i < 15; ++i) {
+      t[i] += 38 * t[i + 16];
+    }
+
+    for (int i = 0; i < 16; ++i) o[i] = t[i];
+
+    car25519(o);
+    car25519(o);
+  }
+
+#endif
+
+  static int neq25519 (const gf a, const gf b) {
+    unsigned char c[32], d[32];
+    pack25519(c, a);
+    pack25519(d, b);
+    return verifyBytes(c, d, 32);
+  }
+
+  static unsigned char par25519 (const gf a) {
+    unsigned char d[32];
+    pack25519(d, a);
+    return d[0] & 1;
+  }
+
+  static void S (gf o, const gf a) {
+    M(o, a, a);
+  }
+
+  static void inv25519 (gf o, const gf i) {
+    gf c;
+
+    set25519(c, i);
+
+    for (int a = 253; a >= 0; --a) {
+      S(c, c);
+      if (a != 2 && a != 4) M(c, c, i);
+    }
+
+    set25519(o, c);
+  }
+
+  static void pow2523 (gf o, const gf i) {
+    gf c;
+
+    set25519(c, i);
+
+    for (int a = 250; a >= 0; --a) {
+      S(c, c);
+      if (a != 1) M(c, c, i);
+    }
+
+    set25519(o, c);
+  }
+
+  static void scalarmult25519 (
+    unsigned char *q,
+    const unsigned char *n,
+    const unsigned char *p
+  ) {
+    unsigned char z[32];
+    gf x, a, b, c, d, e, f;
+
+    for (int i = 0; i < 31; ++i) z[i] = n[i];
+
+    z[31] = (n[31] & 127) | 64;
+    z[0] &= 248;
+
+    unpack25519(x, p);
+    set25519(b, x);
+    set25519(a, GF1);
+    set25519(c, GF0);
+    set25519(d, GF1);
+
+    for (int i = 254; i >= 0; --i) {
+      int r = (z[i >> 3] >> (i & 7)) & 1;
+      sel25519(a, b, r);
+      sel25519(c, d, r);
+      A(e, a, c);
+      Z(a, a, c);
+      A(c, b, d);
+      Z(b, b, d);
+      S(d, e);
+      S(f, a);
+      M(a, c, a);
+      M(c, b, e);
+      A(e, a, c);
+      Z(a, a, c);
+      S(b, a);
+      Z(c, d, f);
+      M(a, c, GF121665);
+      A(a, a, d);
+      M(c, c, a);
+      M(a, d, f);
+      M(d, b, x);
+      S(b, e);
+      sel25519(a, b, r);
+      sel25519(c, d, r);
+    }
+
+    inv25519(c, c);
+    M(a, a, c);
+    pack25519(q, a);
+    wipe(z, sizeof(z));
+  }
+
+  //
+  // Ed25519
+  //
+  static void edAdd (gf p[4], gf q[4]) {
+    gf a, b, c, d, t, e, f, g, h;
+
+    Z(a, p[1], p[0]);
+    Z(t, q[1], q[0]);
+    M(a, a, t);
+    A(b, p[0], p[1]);
+    A(t, q[0], q[1]);
+    M(b, b, t);
+    M(c, p[3], q[3]);
+    M(c, c, D2);
+    M(d, p[2], q[2]);
+    A(d, d, d);
+    Z(e, b, a);
+    Z(f, d, c);
+    A(g, d, c);
+    A(h, b, a);
+
+    M(p[0], e, f);
+    M(p[1], h, g);
+    M(p[2], g, f);
+    M(p[3], e, h);
+  }
+
+  static void edSwap (gf p[4], gf q[4], unsigned char b) {
+    for (int i = 0; i < 4; ++i) {
+      sel25519(p[i], q[i], b);
+    }
+  }
+
+  static void edPack (unsigned char *r, gf p[4]) {
+    gf tx, ty, zi;
+    inv25519(zi, p[2]);
+    M(tx, p[0], zi);
+    M(ty, p[1], zi);
+    pack25519(r, ty);
+    r[31] ^= par25519(tx) << 7;
+  }
+
+  static void edScalarmult (gf p[4], gf q[4], const unsigned char *s) {
+    set25519(p[0], GF0);
+    set25519(p[1], GF1);
+    set25519(p[2], GF1);
+    set25519(p[3], GF0);
+
+    for (int i = 255; i >= 0; --i) {
+      unsigned char b = (s[i / 8] >> (i & 7)) & 1;
+      edSwap(p, q, b);
+      edAdd(q, p);
+      edAdd(p, p);
+      edSwap(p, q, b);
+    }
+  }
+
+  static void edScalarbase (gf p[4], const unsigned char *s) {
+    gf q[4];
+    set25519(q[0], X);
+    set25519(q[1], Y);
+    set25519(q[2], GF1);
+    M(q[3], X, Y);
+    edScalarmult(p, q, s);
+  }
+
+  static void modL (unsigned char *r, int64_t x[64]) {
+    int64_t carry;
+
+    for (int i = 63; i >= 32; --i) {
+      int j;
+      carry = 0;
+
+      for (j = i - 32; j < i - 12; ++j) {
+        x[j] += carry - 16 * x[i] * L[j - (i - 32)];
+        carry = (x[j] + 128) >> 8;
+        x[j] -= carry * 256;
+      }
+
+      x[j] += carry;
+      x[i] = 0;
+    }
+
+    carry = 0;
+
+    for (int j = 0; j < 32; ++j) {
+      x[j] += carry - (x[31] >> 4) * L[j];
+      carry = x[j] >> 8;
+      x[j] &= 255;
+    }
+
+    for (int j = 0; j < 32; ++j) {
+      x[j] -= carry * L[j];
+    }
+
+    for (int i = 0; i < 32; ++i) {
+      x[i + 1] += x[i] >> 8;
+      r[i] = x[i] & 255;
+    }
+  }
+
+  static void reduce (unsigned char *r) {
+    int64_t x[64];
+
+    for (int i = 0; i < 64; ++i) {
+      x[i] = (uint64_t) r[i];
+    }
+
+    memset(r, 0, 64);
+    modL(r, x);
+  }
+
+  static bool unpackNegative (gf r[4], const unsigned char p[32]) {
+    gf t, chk, num, den, den2, den4, den6;
+
+    set25519(r[2], GF1);
+    unpack25519(r[1], p);
+    S(num, r[1]);
+    M(den, num, D);
+    Z(num, num, r[2]);
+    A(den, r[2], den);
+
+    S(den2, den);
+    S(den4, den2);
+    M(den6, den4, den2);
+    M(t, den6, num);
+    M(t, t, den);
+
+    pow2523(t, t);
+    M(t, t, num);
+    M(t, t, den);
+    M(t, t, den);
+    M(r[0], t, den);
+
+    S(chk, r[0]);
+    M(chk, chk, den);
+
+    if (neq25519(chk, num)) {
+      M(r[0], r[0], I);
+    }
+
+    S(chk, r[0]);
+    M(chk, chk, den);
+
+    if (neq25519(chk, num)) {
+      return false;
+    }
+
+    if (par25519(r[0]) == (p[31] >> 7)) {
+      Z(r[0], GF0, r[0]);
+    }
+
+    M(r[3], r[0], r[1]);
+    return true;
+  }
+
+  // rejects malleable signatures, `s` must be below the group order
+  static bool isCanonicalScalar (const unsigned char *s) {
+    for (int i = 31; i >= 0; --i) {
+      if (s[i] < L[i]) return true;
+      if (s[i] > L[i]) return false;
+    }
+
+    return false;
+  }
+
+  void signKeyPair (unsigned char *publicKey, unsigned char *secretKey) {
+    unsigned char d[64];
+    gf p[4];
+
+    randomBytes(secretKey, 32);
+    sha512(secretKey, 32, d);
+    d[0] &= 248;
+    d[31] &= 127;
+    d[31] |= 64;
+
+    edScalarbase(p, d);
+    edPack(publicKey, p);
+    memcpy(secretKey + 32, publicKey, 32);
+    wipe(d, sizeof(d));
+  }
+
+  void signDetached (
+    unsigned char *signature,
+    const unsigned char *bytes,
+    size_t size,
+    const unsigned char *secretKey
+  ) {
+    unsigned char d[64], h[64], r[64];
+    int64_t x[64] = {0};
+    SHA512State state;
+    gf p[4];
+
+    sha512(secretKey, 32, d);
+    d[0] &= 248;
+    d[31] &= 127;
+    d[31] |= 64;
+
+    // r = H(prefix || m)
+    sha512Init(state);
+    sha512Update(state, d + 32, 32);
+    sha512Update(state, bytes, size);
+    sha512Final(state, r);
+    reduce(r);
+
+    // R = rB
+    edScalarbase(p, r);
+    edPack(signature, p);
+
+    // h = H(R || A || m)
+    sha512Init(state);
+    sha512Update(state, signature, 32);
+    sha512Update(state, secretKey + 32, 32);
+    sha512Update(state, bytes, size);
+    sha512Final(state, h);
+    reduce(h);
+
+    // S = r + ha
+    for (int i = 0; i < 32; ++i) {
+      x[i] = (uint64_t) r[i];
+    }
+
+    for (int i = 0; i < 32; ++i) {
+      for (int j = 0; j < 32; ++j) {
+        x[i + j] += h[i] * (uint64_t) d[j];
+      }
+    }
+
+    modL(signature + 32, x);
+    wipe(d, sizeof(d));
+    wipe(r, sizeof(r));
+  }
+
+  bool verifyDetached (
+    const unsigned char *signature,
+    const unsigned char *bytes,
+    size_t size,
+    const unsigned char *publicKey
+  ) {
+    unsigned char t[32], h[64];
+    SHA512State state;
+    gf p[4], q[4];
+
+    if (!isCanonicalScalar(signature + 32)) {
+      return false;
+    }
+
+    if (!unpackNegative(q, publicKey)) {
+      return false;
+    }
+
+    sha512Init(state);
+    sha512Update(state, signature, 32);
+    sha512Update(state, publicKey, 32);
+    sha512Update(state, bytes, size);
+    sha512Final(state, h);
+    reduce(h);
+
+    edScalarmult(p, q, h);
+    edScalarbase(q, signature + 32);
+    edAdd(p, q);
+    edPack(t, p);
+
+    return verifyBytes(signature, t, 32) == 0;
+  }
+
+  bool signPublicKeyToBoxPublicKey (
+    unsigned char *output,
+    const unsigned char *publicKey
+  ) {
+    gf p[4], a, b, c;
+
+    // the key must be a point on the curve
+    if (!unpackNegative(p, publicKey)) {
+      return false;
+    }
+
+    // u = (1 + y) / (1 - y)
+    unpack25519(a, publicKey);
+    A(b, GF1, a);
+    Z(c, GF1, a);
+    inv25519(c, c);
+    M(b, b, c);
+    pack25519(output, b);
+    return true;
+  }
+
+  void signSecretKeyToBoxSecretKey (
+    unsigned char *output,
+    const unsigned char *secretKey
+  ) {
+    unsigned char h[64];
+
+    sha512(secretKey, 32, h);
+    h[0] &= 248;
+    h[31] &= 127;
+    h[31] |= 64;
+
+    memcpy(output, h, 32);
+    wipe(h, sizeof(h));
+  }
+
+  //
+  // Sealed boxes: ephemeral public key || MAC || ciphertext, the nonce is
+  // BLAKE2b(ephemeral public key || recipient public key)
+  //
+  static void getSealNonce (
+    unsigned char *nonce,
+    const unsigned char *ephemeralPublicKey,
+    const unsigned char *publicKey
+  ) {
+    unsigned char input[64];
+    memcpy(input, ephemeralPublicKey, 32);
+    memcpy(input + 32, publicKey, 32);
+    blake2b(nonce, 24, input, sizeof(input));
+  }
+
+  static void getSharedKey (
+    unsigned char *key,
+    const unsigned char *publicKey,
+    const unsigned char *secretKey
+  ) {
+    unsigned char s[32];
+    scalarmult25519(s, secretKey, publicKey);
+    salsa20Core(key, ZERO, s, SIGMA, true);
+    wipe(s, sizeof(s));
+  }
+
+  void boxSeal (
+    unsigned char *output,
+    const unsigned char *bytes,
+    size_t size,
+    const unsigned char *publicKey
+  ) {
+    unsigned char ephemeralSecretKey[32];
+    unsigned char nonce[24];
+    unsigned char key[32];
+    Bytes padded(size + 32, 0);
+    Bytes sealed(size + 32, 0);
+
+    randomBytes(ephemeralSecretKey, sizeof(ephemeralSecretKey));
+    scalarmult25519(output, ephemeralSecretKey, NINE);
+    getSealNonce(nonce, output, publicKey);
+    getSharedKey(key, publicKey, ephemeralSecretKey);
+
+    if (size > 0) {
+      memcpy(padded.data() + 32, bytes, size);
+    }
+
+    secretbox(sealed.data(), padded.data(), padded.size(), nonce, key);
+    memcpy(output + 32, sealed.data() + 16, size + 16);
+
+    wipe(ephemeralSecretKey, sizeof(ephemeralSecretKey));
+    wipe(key, sizeof(key));
+  }
+
+  bool boxSealOpen (
+    unsigned char *output,
+    const unsigned char *bytes,
+    size_t size,
+    const unsigned char *publicKey,
+    const unsigned char *secretKey
+  ) {
+    unsigned char nonce[24];
+    unsigned char key[32];
+
+    if (size < BOX_SEAL_BYTES) {
+      return false;
+    }
+
+    auto messageSize = size - BOX_SEAL_BYTES;
+    Bytes padded(messageSize + 32, 0);
+    Bytes opened(messageSize + 32, 0);
+
+    getSealNonce(nonce, bytes, publicKey);
+    getSharedKey(key, bytes, secretKey);
+
+    memcpy(padded.data() + 16, bytes + 32, size - 32);
+
+    auto ok = secretboxOpen(opened.data(), padded.data(), padded.size(), nonce, key);
+    wipe(key, sizeof(key));
+
+    if (!ok) {
+      return false;
+    }
+
+    if (messageSize > 0) {
+      memcpy(output, opened.data() + 32, messageSize);
+    }
+
+    return true;
+  }
+
+  //
+  // Encodings
+  //
+  String encodeBase64 (const unsigned char *bytes, size_t size) {
+    String output;
+    size_t i = 0;
+
+    output.reserve(((size + 2) / 3) * 4);
+
+    for (; i + 2 < size; i += 3) {
+      uint32_t n = (bytes[i] << 16) | (bytes[i + 1] << 8) | bytes[i + 2];
+      output += BASE64_ALPHABET[(n >> 18) & 0x3f];
+      output += BASE64_ALPHABET[(n >> 12) & 0x3f];
+      output += BASE64_ALPHABET[(n >> 6) & 0x3f];
+      output += BASE64_ALPHABET[n & 0x3f];
+    }
+
+    if (i < size) {
+      uint32_t n = bytes[i] << 16;
+
+      if (i + 1 < size) {
+        n |= bytes[i + 1] << 8;
+      }
+
+      output += BASE64_ALPHABET[(n >> 18) & 0x3f];
+      output += BASE64_ALPHABET[(n >> 12) & 0x3f];
+      output += i + 1 < size ? BASE64_ALPHABET[(n >> 6) & 0x3f] : '=';
+      output += '=';
+    }
+
+    return output;
+  }
+
+  bool decodeBase64 (const String &input, Bytes &output) {
+    uint32_t n = 0;
+    int bits = 0;
+
+    output.clear();
+    output.reserve((input.size() / 4) * 3);
+
+    for (auto c : input) {
+      int value = -1;
+
+      if (c >= 'A' && c <= 'Z') value = c - 'A';
+      else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+      else if (c >= '0' && c <= '9') value = c - '0' + 52;
+      else if (c == '+' || c == '-') value = 62;
+      else if (c == '/' || c == '_') value = 63;
+      else if (c == '=') break;
+      else return false;
+
+      n = (n << 6) | (uint32_t) value;
+      bits += 6;
+
+      if (bits >= 8) {
+        bits -= 8;
+        output.push_back((unsigned char) (n >> bits));
+      }
+    }
+
+    return true;
+  }
+
+  String encodeHex (const unsigned char *bytes, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    String output;
+
+    output.reserve(size * 2);
+
+    for (size_t i = 0; i < size; ++i) {
+      output += digits[bytes[i] >> 4];
+      output += digits[bytes[i] & 0x0f];
+    }
+
+    return output;
+  }
+}
+
+namespace SSC {
+  struct CryptoWorkContext {
+    uv_work_t req;
+    std::function<void()> work;
+    std::function<void()> done;
+  };
+
+  static JSON::Object::Entries ERR_CRYPTO_INVALID_KEY (
+    const String& source,
+    const String& name
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"code", "EINVAL"},
+        {"type", "TypeError"},
+        {"message", "Invalid '" + name + "' key given"}
+      }}
+    };
+  }
+
+  static JSON::Object::Entries ERR_CRYPTO (
+    const String& source,
+    const String& code,
+    const String& message
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"code", code},
+        {"message", message}
+      }}
+    };
+  }
+
+  static Post createBytesPost (const Crypto::Bytes& bytes) {
+    auto size = bytes.size();
+    auto headers = Headers {{
+      {"content-type" ,"application/octet-stream"},
+      {"content-length", (uint64_t) size}
+    }};
+
+    Post post;
+    post.id = rand64();
+    post.body = new char[size]{0};
+    post.length = (int) size;
+    post.headers = headers.str();
+    memcpy(post.body, bytes.data(), size);
+    return post;
+  }
+
+  static bool isValidVerifyOptions (
+    const Core::Crypto::VerifyOptions& options,
+    size_t size
+  ) {
+    return (
+      options.publicKey.size() == Crypto::SIGN_PUBLIC_KEY_BYTES &&
+      options.signature.size() == Crypto::SIGN_BYTES &&
+      options.offset <= size &&
+      options.size <= size - options.offset
+    );
+  }
+
+  void Core::Crypto::queueWork (
+    std::function<void()> work,
+    std::function<void()> done
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = this->core->getEventLoop();
+      auto ctx = new CryptoWorkContext;
+
+      ctx->req.data = ctx;
+      ctx->work = work;
+      ctx->done = done;
+
+      auto err = uv_queue_work(loop, &ctx->req, [](uv_work_t *req) {
+        auto ctx = reinterpret_cast<CryptoWorkContext*>(req->data);
+        ctx->work();
+      }, [](uv_work_t *req, int status) {
+        auto ctx = reinterpret_cast<CryptoWorkContext*>(req->data);
+        ctx->done();
+        delete ctx;
+      });
+
+      // fall back to doing the work on the loop if it cannot be queued
+      if (err < 0) {
+        ctx->work();
+        ctx->done();
+        delete ctx;
+      }
+    });
+  }
+
+  void Core::Crypto::sign (
+    const String seq,
+    SSC::Crypto::Bytes secretKey,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    if (secretKey.size() != SSC::Crypto::SIGN_SECRET_KEY_BYTES) {
+      return cb(seq, ERR_CRYPTO_INVALID_KEY("crypto.sign", "secretKey"), Post{});
+    }
+
+    auto signature = std::make_shared<SSC::Crypto::Bytes>(SSC::Crypto::SIGN_BYTES);
+
+    this->queueWork([=]() {
+      SSC::Crypto::signDetached(
+        signature->data(),
+        (const unsigned char *) bytes,
+        size,
+        secretKey.data()
+      );
+    }, [=]() {
+      cb(seq, JSON::Object::Entries {
+        {"source", "crypto.sign"},
+        {"data", JSON::Object::Entries {
+          {"signature", SSC::Crypto::encodeBase64(signature->data(), signature->size())}
+        }}
+      }, Post{});
+    });
+  }
+
+  void Core::Crypto::verify (
+    const String seq,
+    VerifyOptions options,
+    const char *bytes,
+    Module::Callback cb
+  ) {
+    if (options.publicKey.size() != SSC::Crypto::SIGN_PUBLIC_KEY_BYTES) {
+      return cb(seq, ERR_CRYPTO_INVALID_KEY("crypto.verify", "publicKey"), Post{});
+    }
+
+    auto verified = std::make_shared<bool>(false);
+
+    this->queueWork([=]() {
+      *verified = (
+        options.signature.size() == SSC::Crypto::SIGN_BYTES &&
+        SSC::Crypto::verifyDetached(
+          options.signature.data(),
+          (const unsigned char *) bytes + options.offset,
+          options.size,
+          options.publicKey.data()
+        )
+      );
+    }, [=]() {
+      cb(seq, JSON::Object::Entries {
+        {"source", "crypto.verify"},
+        {"data", JSON::Object::Entries {
+          {"verified", *verified}
+        }}
+      }, Post{});
+    });
+  }
+
+  void Core::Crypto::verifyMany (
+    const String seq,
+    Vector<VerifyOptions> options,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    auto count = options.size();
+    auto batches = (count + VERIFY_MANY_BATCH_SIZE - 1) / VERIFY_MANY_BATCH_SIZE;
+    auto requests = std::make_shared<const Vector<VerifyOptions>>(std::move(options));
+    // not `Vector<bool>`, batches write their results concurrently
+    auto results = std::make_shared<Vector<uint8_t>>(count, 0);
+    // only touched in `done` callbacks, which all run on the loop
+    auto pending = std::make_shared<size_t>(batches);
+
+    auto reply = [=]() {
+      JSON::Array::Entries entries;
+
+      for (auto result : *results) {
+        entries.push_back(result == 1);
+      }
+
+      cb(seq, JSON::Object::Entries {
+        {"source", "crypto.verifyMany"},
+        {"data", JSON::Object::Entries {
+          {"results", entries}
+        }}
+      }, Post{});
+    };
+
+    if (batches == 0) {
+      return reply();
+    }
+
+    // batches spread the signatures over the threadpool while keeping
+    // the per work item overhead small next to the verifications
+    for (size_t batch = 0; batch < batches; ++batch) {
+      auto start = batch * VERIFY_MANY_BATCH_SIZE;
+      auto end = std::min(count, start + VERIFY_MANY_BATCH_SIZE);
+
+      this->queueWork([=]() {
+        for (auto i = start; i < end; ++i) {
+          const auto& request = requests->at(i);
+
+          if (!isValidVerifyOptions(request, size)) {
+            continue;
+          }
+
+          (*results)[i] = SSC::Crypto::verifyDetached(
+            request.signature.data(),
+            (const unsigned char *) bytes + request.offset,
+            request.size,
+            request.publicKey.data()
+          );
+        }
+      }, [=]() {
+        if (--(*pending) == 0) {
+          reply();
+        }
+      });
+    }
+  }
+
+  void Core::Crypto::seal (
+    const String seq,
+    SSC::Crypto::Bytes publicKey,
+    SSC::Crypto::Bytes secretKey,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    if (publicKey.size() != SSC::Crypto::SIGN_PUBLIC_KEY_BYTES) {
+      return cb(seq, ERR_CRYPTO_INVALID_KEY("crypto.seal", "publicKey"), Post{});
+    }
+
+    if (secretKey.size() != SSC::Crypto::SIGN_SECRET_KEY_BYTES) {
+      return cb(seq, ERR_CRYPTO_INVALID_KEY("crypto.seal", "secretKey"), Post{});
+    }
+
+    auto output = std::make_shared<SSC::Crypto::Bytes>();
+
+    // encrypt-sign-encrypt, see `seal()` in `api/stream-relay/encryption.js`
+    this->queueWork([=]() {
+      using namespace SSC::Crypto;
+      unsigned char boxPublicKey[BOX_PUBLIC_KEY_BYTES];
+
+      if (!signPublicKeyToBoxPublicKey(boxPublicKey, publicKey.data())) {
+        return;
+      }
+
+      Bytes envelope(SIGN_BYTES + size + BOX_SEAL_BYTES);
+      auto ciphertext = envelope.data() + SIGN_BYTES;
+
+      boxSeal(ciphertext, (const unsigned char *) bytes, size, boxPublicKey);
+      signDetached(envelope.data(), ciphertext, size + BOX_SEAL_BYTES, secretKey.data());
+
+      output->resize(envelope.size() + BOX_SEAL_BYTES);
+      boxSeal(output->data(), envelope.data(), envelope.size(), boxPublicKey);
+    }, [=]() {
+      if (output->size() == 0) {
+        return cb(seq, ERR_CRYPTO_INVALID_KEY("crypto.seal", "publicKey"), Post{});
+      }
+
+      cb(seq, JSON::Object::Entries {
+        {"source", "crypto.seal"},
+        {"data", JSON::Object::Entries {
+          {"bytes", (uint64_t) output->size()}
+        }}
+      }, createBytesPost(*output));
+    });
+  }
+
+  void Core::Crypto::open (
+    const String seq,
+    SSC::Crypto::Bytes publicKey,
+    SSC::Crypto::Bytes secretKey,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    if (publicKey.size() != SSC::Crypto::SIGN_PUBLIC_KEY_BYTES) {
+      return cb(seq, ERR_CRYPTO_INVALID_KEY("crypto.open", "publicKey"), Post{});
+    }
+
+    if (secretKey.size() != SSC::Crypto::SIGN_SECRET_KEY_BYTES) {
+      return cb(seq, ERR_CRYPTO_INVALID_KEY("crypto.open", "secretKey"), Post{});
+    }
+
+    auto output = std::make_shared<SSC::Crypto::Bytes>();
+    auto error = std::make_shared<String>();
+
+    // decrypt-verify-decrypt, see `open()` in `api/stream-relay/encryption.js`
+    this->queueWork([=]() {
+      using namespace SSC::Crypto;
+      unsigned char boxPublicKey[BOX_PUBLIC_KEY_BYTES];
+      unsigned char boxSecretKey[BOX_SECRET_KEY_BYTES];
+
+      if (!signPublicKeyToBoxPublicKey(boxPublicKey, publicKey.data())) {
+        *error = "EINVAL";
+        return;
+      }
+
+      signSecretKeyToBoxSecretKey(boxSecretKey, secretKey.data());
+
+      if (size < BOX_SEAL_BYTES) {
+        *error = "EMALFORMED";
+        return;
+      }
+
+      Bytes envelope(size - BOX_SEAL_BYTES);
+
+      if (!boxSealOpen(envelope.data(), (const unsigned char *) bytes, size, boxPublicKey, boxSecretKey)) {
+        *error = "EDECRYPT";
+        return;
+      }
+
+      if (envelope.size() <= SIGN_BYTES) {
+        *error = "EMALFORMED";
+        return;
+      }
+
+      auto ciphertext = envelope.data() + SIGN_BYTES;
+      auto ciphertextSize = envelope.size() - SIGN_BYTES;
+
+      if (!verifyDetached(envelope.data(), ciphertext, ciphertextSize, publicKey.data())) {
+        *error = "ENOTVERIFIED";
+        return;
+      }
+
+      if (ciphertextSize < BOX_SEAL_BYTES) {
+        *error = "EDECRYPT";
+        return;
+      }
+
+      output->resize(ciphertextSize - BOX_SEAL_BYTES);
+
+      if (!boxSealOpen(output->data(), ciphertext, ciphertextSize, boxPublicKey, boxSecretKey)) {
+        *error = "EDECRYPT";
+      }
+    }, [=]() {
+      if (*error == "EINVAL") {
+        return cb(seq, ERR_CRYPTO_INVALID_KEY("crypto.open", "publicKey"), Post{});
+      } else if (*error == "EMALFORMED") {
+        return cb(seq, ERR_CRYPTO("crypto.open", *error, "Sealed message is malformed"), Post{});
+      } else if (*error == "EDECRYPT") {
+        return cb(seq, ERR_CRYPTO("crypto.open", *error, "Sealed message could not be decrypted"), Post{});
+      } else if (*error == "ENOTVERIFIED") {
+        return cb(seq, ERR_CRYPTO("crypto.open", *error, "Sealed message signature is not valid"), Post{});
+      }
+
+      cb(seq, JSON::Object::Entries {
+        {"source", "crypto.open"},
+        {"data", JSON::Object::Entries {
+          {"bytes", (uint64_t) output->size()}
+        }}
+      }, createBytesPost(*output));
+    });
+  }
+
+  void Core::Crypto::sha256 (
+    const String seq,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    auto digest = std::make_shared<SSC::Crypto::Bytes>(SSC::Crypto::SHA256_BYTES);
+
+    this->queueWork([=]() {
+      SSC::Crypto::sha256((const unsigned char *) bytes, size, digest->data());
+    }, [=]() {
+      cb(seq, JSON::Object::Entries {
+        {"source", "crypto.sha256"},
+        {"data", JSON::Object::Entries {
+          {"hash", SSC::Crypto::encodeHex(digest->data(), digest->size())}
+        }}
+      }, Post{});
+    });
+  }
+}
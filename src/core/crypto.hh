@@ -0,0 +1,80 @@
+#ifndef SSC_CORE_CRYPTO_HH
+#define SSC_CORE_CRYPTO_HH
+
+#include "../common.hh"
+
+/**
+ * Native crypto primitives used by stream-relay encryption. Keys, signatures
+ * and sealed boxes are compatible with the libsodium functions the JS side
+ * uses (`crypto_sign_*`, `crypto_box_seal*`, `crypto_hash_sha256`), so
+ * either side can open what the other produced.
+ *
+ * Everything here is synchronous and thread safe, callers are expected to
+ * run it off the Core loop.
+ */
+namespace SSC::Crypto {
+  using Bytes = Vector<unsigned char>;
+
+  constexpr size_t SIGN_PUBLIC_KEY_BYTES = 32;
+  constexpr size_t SIGN_SECRET_KEY_BYTES = 64;
+  constexpr size_t SIGN_BYTES = 64;
+  constexpr size_t BOX_PUBLIC_KEY_BYTES = 32;
+  constexpr size_t BOX_SECRET_KEY_BYTES = 32;
+  // ephemeral public key and MAC prefixed to every sealed box
+  constexpr size_t BOX_SEAL_BYTES = 48;
+  constexpr size_t SHA256_BYTES = 32;
+  constexpr size_t SHA512_BYTES = 64;
+
+  void randomBytes (unsigned char *bytes, size_t size);
+
+  void sha256 (const unsigned char *bytes, size_t size, unsigned char *output);
+  void sha512 (const unsigned char *bytes, size_t size, unsigned char *output);
+  void blake2b (
+    unsigned char *output,
+    size_t outputSize,
+    const unsigned char *bytes,
+    size_t size
+  );
+
+  // Ed25519, `secretKey` is the 32 byte seed followed by the public key
+  void signKeyPair (unsigned char *publicKey, unsigned char *secretKey);
+  void signDetached (
+    unsigned char *signature,
+    const unsigned char *bytes,
+    size_t size,
+    const unsigned char *secretKey
+  );
+  bool verifyDetached (
+    const unsigned char *signature,
+    const unsigned char *bytes,
+    size_t size,
+    const unsigned char *publicKey
+  );
+
+  // converts Ed25519 keys to X25519 keys for sealed boxes
+  bool signPublicKeyToBoxPublicKey (unsigned char *output, const unsigned char *publicKey);
+  void signSecretKeyToBoxSecretKey (unsigned char *output, const unsigned char *secretKey);
+
+  // anonymous X25519 + XSalsa20-Poly1305 boxes, `output` holds
+  // `size + BOX_SEAL_BYTES` bytes for `boxSeal()` and `size - BOX_SEAL_BYTES`
+  // bytes for `boxSealOpen()`
+  void boxSeal (
+    unsigned char *output,
+    const unsigned char *bytes,
+    size_t size,
+    const unsigned char *publicKey
+  );
+  bool boxSealOpen (
+    unsigned char *output,
+    const unsigned char *bytes,
+    size_t size,
+    const unsigned char *publicKey,
+    const unsigned char *secretKey
+  );
+
+  String encodeBase64 (const unsigned char *bytes, size_t size);
+  bool decodeBase64 (const String &input, Bytes &output);
+  String encodeHex (const unsigned char *bytes, size_t size);
+}
+
+#endif
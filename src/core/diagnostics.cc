@@ -0,0 +1,190 @@
+#include "core.hh"
+#include "../process/process.hh"
+
+#include <future>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+namespace SSC {
+#if SSC_BENCHMARKS
+#if !defined(_WIN32) && !TARGET_OS_IPHONE && !TARGET_IPHONE_SIMULATOR
+  // output the benchmark child process writes `blocks` times
+  struct ProcessOutputBenchmarkBlock {
+    String bytes;
+    uint64_t messages = 0;
+    uint64_t blocks = 0;
+  };
+
+  static JSON::Object::Entries runProcessOutputBenchmark (
+    const ProcessOutputBenchmarkBlock& block,
+    ProcessConfig::Framing framing,
+    bool views
+  ) {
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    std::promise<void> exited;
+    ProcessConfig config;
+    MessageCallback onStdout = nullptr;
+
+    config.framing = framing;
+
+    // a copy of every message into a string is what `read_stdout` costs
+    if (views) {
+      config.read_stdout_view = [&](auto message) {
+        messages++;
+        bytes += message.size();
+      };
+    } else {
+      onStdout = [&](const String message) {
+        messages++;
+        bytes += message.size();
+      };
+    }
+
+    auto started = uv_hrtime();
+    auto process = new Process(
+      [&block]() -> int {
+        for (uint64_t i = 0; i < block.blocks; ++i) {
+          size_t offset = 0;
+
+          while (offset < block.bytes.size()) {
+            auto n = ::write(1, block.bytes.data() + offset, block.bytes.size() - offset);
+
+            if (n < 0 && errno == EINTR) {
+              continue;
+            } else if (n <= 0) {
+              return 1;
+            }
+
+            offset += n;
+          }
+        }
+
+        return 0;
+      },
+      onStdout,
+      nullptr,
+      [&](auto code) { exited.set_value(); },
+      false,
+      config
+    );
+
+    if (process->getPID() <= 0) {
+      delete process;
+      return JSON::Object::Entries {
+        {"code", "ECHILD"},
+        {"message", "Failed to start benchmark process"}
+      };
+    }
+
+    exited.get_future().wait();
+    // joins the thread reading what is left of the output
+    delete process;
+
+    auto elapsed = (double) (uv_hrtime() - started) / 1e9;
+
+    return JSON::Object::Entries {
+      {"messages", messages},
+      {"bytes", bytes},
+      {"wireBytes", (uint64_t) block.bytes.size() * block.blocks},
+      {"expectedMessages", block.messages * block.blocks},
+      {"elapsed", elapsed * 1000},
+      {"messagesPerSecond", elapsed > 0 ? messages / elapsed : 0.0},
+      {"bytesPerSecond", elapsed > 0 ? bytes / elapsed : 0.0}
+    };
+  }
+#endif
+
+  void Core::Diagnostics::benchmarkProcessOutput (
+    const String seq,
+    ProcessOutputBenchmarkOptions options,
+    Module::Callback cb
+  ) {
+  #if defined(_WIN32) || TARGET_OS_IPHONE || TARGET_IPHONE_SIMULATOR
+    auto json = JSON::Object::Entries {
+      {"source", "diagnostics.benchmarkProcessOutput"},
+      {"err", JSON::Object::Entries {
+        {"code", "ENOTSUP"},
+        {"message", "Process output benchmarks are not supported on this platform"}
+      }}
+    };
+
+    cb(seq, json, Post{});
+  #else
+    if (
+      options.bytes == 0 ||
+      options.size == 0 ||
+      options.size > MAX_BENCHMARK_SIZE
+    ) {
+      auto json = JSON::Object::Entries {
+        {"source", "diagnostics.benchmarkProcessOutput"},
+        {"err", JSON::Object::Entries {
+          {"code", "EINVAL"},
+          {"message", "Invalid benchmark parameters"}
+        }}
+      };
+
+      return cb(seq, json, Post{});
+    }
+
+    // the reads block, so the runs happen off the Core loop
+    std::thread([=, this]() {
+      auto framing = options.binary
+        ? ProcessConfig::Framing::binary
+        : ProcessConfig::Framing::lines;
+      auto header = options.binary ? ProcessOutputReader::FRAME_HEADER_SIZE : 1;
+      auto length = options.size + header;
+      ProcessOutputBenchmarkBlock block;
+
+      // about a megabyte of messages per `write()` in the child process
+      block.messages = std::max((size_t) 1, (size_t) (1024 * 1024) / length);
+      block.blocks = std::max(
+        (uint64_t) 1,
+        (options.bytes + block.messages * length - 1) / (block.messages * length)
+      );
+
+      block.bytes.reserve(block.messages * length);
+
+      for (uint64_t i = 0; i < block.messages; ++i) {
+        if (options.binary) {
+          block.bytes.push_back((char) ((options.size >> 24) & 0xff));
+          block.bytes.push_back((char) ((options.size >> 16) & 0xff));
+          block.bytes.push_back((char) ((options.size >> 8) & 0xff));
+          block.bytes.push_back((char) (options.size & 0xff));
+
+          for (size_t j = 0; j < options.size; ++j) {
+            block.bytes.push_back((char) (rand64() & 0xff));
+          }
+        } else {
+          for (size_t j = 0; j < options.size; ++j) {
+            block.bytes.push_back((char) ('a' + (rand64() % 26)));
+          }
+
+          block.bytes.push_back('\n');
+        }
+      }
+
+      JSON::Object::Entries runs;
+      runs["views"] = runProcessOutputBenchmark(block, framing, true);
+      runs["strings"] = runProcessOutputBenchmark(block, framing, false);
+
+      auto json = JSON::Object::Entries {
+        {"source", "diagnostics.benchmarkProcessOutput"},
+        {"data", JSON::Object::Entries {
+          {"bytes", (uint64_t) block.bytes.size() * block.blocks},
+          {"size", (uint64_t) options.size},
+          {"framing", options.binary ? "binary" : "lines"},
+          {"runs", runs}
+        }}
+      };
+
+      this->core->dispatchEventLoop([=]() {
+        cb(seq, json, Post{});
+      });
+    }).detach();
+  #endif
+  }
+#endif
+}
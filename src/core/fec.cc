@@ -0,0 +1,1013 @@
+#include "core.hh"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SSC_FEC_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define SSC_FEC_NEON_KERNEL 1
+#include <arm_neon.h>
+#endif
+
+namespace SSC::FEC {
+  using MulAdd = void (*)(unsigned char *, const unsigned char *, uint8_t, size_t);
+
+  /**
+   * Arithmetic tables for GF(2^8) with the polynomial 0x11d. `nibbles`
+   * holds the products of every coefficient with the 16 low and the 16 high
+   * nibble values, which the shuffle kernels look up 16 or 32 bytes at once.
+   */
+  struct Tables {
+    uint8_t exp[512];
+    uint8_t log[256];
+    uint8_t mul[256][256];
+    alignas(32) uint8_t nibbles[256][32];
+
+    Tables () {
+      unsigned int x = 1;
+
+      for (int i = 0; i < 255; ++i) {
+        this->exp[i] = (uint8_t) x;
+        this->exp[i + 255] = (uint8_t) x;
+        this->log[x] = (uint8_t) i;
+        x <<= 1;
+
+        if (x & 0x100) {
+          x ^= 0x11d;
+        }
+      }
+
+      this->exp[510] = this->exp[0];
+      this->exp[511] = this->exp[1];
+      this->log[0] = 0;
+
+      for (int a = 0; a < 256; ++a) {
+        for (int b = 0; b < 256; ++b) {
+          this->mul[a][b] = (a == 0 || b == 0)
+            ? 0
+            : this->exp[this->log[a] + this->log[b]];
+        }
+
+        for (int n = 0; n < 16; ++n) {
+          this->nibbles[a][n] = this->mul[a][n];
+          this->nibbles[a][n + 16] = this->mul[a][n << 4];
+        }
+      }
+    }
+  };
+
+  static const Tables& getTables () {
+    static const Tables tables;
+    return tables;
+  }
+
+  static inline uint8_t mul (uint8_t a, uint8_t b) {
+    return getTables().mul[a][b];
+  }
+
+  static inline uint8_t inv (uint8_t a) {
+    const auto& tables = getTables();
+    return tables.exp[255 - tables.log[a]];
+  }
+
+  // coefficient of data shard `column` in parity shard `row`, the Cauchy
+  // matrix `1 / (x_i + y_j)` with `x_i = dataCount + i` and `y_j = j`
+  static inline uint8_t getCoefficient (size_t dataCount, size_t row, size_t column) {
+    return inv((uint8_t) ((dataCount + row) ^ column));
+  }
+
+  // `dst[i] += c * src[i]` for `size` bytes
+  static void mulAddScalar (
+    unsigned char *dst,
+    const unsigned char *src,
+    uint8_t c,
+    size_t size
+  ) {
+    if (c == 0) {
+      return;
+    }
+
+    if (c == 1) {
+      for (size_t i = 0; i < size; ++i) {
+        dst[i] ^= src[i];
+      }
+      return;
+    }
+
+    const auto row = getTables().mul[c];
+    size_t i = 0;
+
+    for (; i + 4 <= size; i += 4) {
+      dst[i] ^= row[src[i]];
+      dst[i + 1] ^= row[src[i + 1]];
+      dst[i + 2] ^= row[src[i + 2]];
+      dst[i + 3] ^= row[src[i + 3]];
+    }
+
+    for (; i < size; ++i) {
+      dst[i] ^= row[src[i]];
+    }
+  }
+
+#if SSC_FEC_X86_KERNELS
+  __attribute__((target("ssse3")))
+  static void mulAddSSSE3 (
+    unsigned char *dst,
+    const unsigned char *src,
+    uint8_t c,
+    size_t size
+  ) {
+    if (c == 0) {
+      return;
+    }
+
+    const auto table = getTables().nibbles[c];
+    const auto lo = _mm_load_si128((const __m128i *) table);
+    const auto hi = _mm_load_si128((const __m128i *) (table + 16));
+    const auto mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+      auto s = _mm_loadu_si128((const __m128i *) (src + i));
+      auto d = _mm_loadu_si128((const __m128i *) (dst + i));
+      auto l = _mm_shuffle_epi8(lo, _mm_and_si128(s, mask));
+      auto h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(s, 4), mask));
+      _mm_storeu_si128((__m128i *) (dst + i), _mm_xor_si128(d, _mm_xor_si128(l, h)));
+    }
+
+    mulAddScalar(dst + i, src + i, c, size - i);
+  }
+
+  __attribute__((target("avx2")))
+  static void mulAddAVX2 (
+    unsigned char *dst,
+    const unsigned char *src,
+    uint8_t c,
+    size_t size
+  ) {
+    if (c == 0) {
+      return;
+    }
+
+    const auto table = getTables().nibbles[c];
+    const auto lo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *) table));
+    const auto hi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *) (table + 16)));
+    const auto mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+
+    for (; i + 64 <= size; i += 64) {
+      auto s0 = _mm256_loadu_si256((const __m256i *) (src + i));
+      auto s1 = _mm256_loadu_si256((const __m256i *) (src + i + 32));
+      auto d0 = _mm256_loadu_si256((const __m256i *) (dst + i));
+      auto d1 = _mm256_loadu_si256((const __m256i *) (dst + i + 32));
+      auto l0 = _mm256_shuffle_epi8(lo, _mm256_and_si256(s0, mask));
+      auto l1 = _mm256_shuffle_epi8(lo, _mm256_and_si256(s1, mask));
+      auto h0 = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(s0, 4), mask));
+      auto h1 = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(s1, 4), mask));
+      _mm256_storeu_si256((__m256i *) (dst + i), _mm256_xor_si256(d0, _mm256_xor_si256(l0, h0)));
+      _mm256_storeu_si256((__m256i *) (dst + i + 32), _mm256_xor_si256(d1, _mm256_xor_si256(l1, h1)));
+    }
+
+    for (; i + 32 <= size; i += 32) {
+      auto s = _mm256_loadu_si256((const __m256i *) (src + i));
+      auto d = _mm256_loadu_si256((const __m256i *) (dst + i));
+      auto l = _mm256_shuffle_epi8(lo, _mm256_and_si256(s, mask));
+      auto h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask));
+      _mm256_storeu_si256((__m256i *) (dst + i), _mm256_xor_si256(d, _mm256_xor_si256(l, h)));
+    }
+
+    mulAddScalar(dst + i, src + i, c, size - i);
+  }
+#endif
+
+#if SSC_FEC_NEON_KERNEL
+  static void mulAddNEON (
+    unsigned char *dst,
+    const unsigned char *src,
+    uint8_t c,
+    size_t size
+  ) {
+    if (c == 0) {
+      return;
+    }
+
+    const auto table = getTables().nibbles[c];
+    const auto lo = vld1q_u8(table);
+    const auto hi = vld1q_u8(table + 16);
+    const auto mask = vdupq_n_u8(0x0f);
+    size_t i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+      auto s = vld1q_u8(src + i);
+      auto d = vld1q_u8(dst + i);
+      auto l = vqtbl1q_u8(lo, vandq_u8(s, mask));
+      auto h = vqtbl1q_u8(hi, vshrq_n_u8(s, 4));
+      vst1q_u8(dst + i, veorq_u8(d, veorq_u8(l, h)));
+    }
+
+    mulAddScalar(dst + i, src + i, c, size - i);
+  }
+#endif
+
+  static bool isKernelSupported (Kernel kernel) {
+    switch (kernel) {
+      case Kernel::Scalar: return true;
+    #if SSC_FEC_X86_KERNELS
+      case Kernel::SSSE3: return __builtin_cpu_supports("ssse3");
+      case Kernel::AVX2: return __builtin_cpu_supports("avx2");
+    #endif
+    #if SSC_FEC_NEON_KERNEL
+      case Kernel::NEON: return true;
+    #endif
+      default: return false;
+    }
+  }
+
+  static MulAdd getMulAdd (Kernel kernel) {
+    if (!isKernelSupported(kernel)) {
+      return mulAddScalar;
+    }
+
+    switch (kernel) {
+    #if SSC_FEC_X86_KERNELS
+      case Kernel::SSSE3: return mulAddSSSE3;
+      case Kernel::AVX2: return mulAddAVX2;
+    #endif
+    #if SSC_FEC_NEON_KERNEL
+      case Kernel::NEON: return mulAddNEON;
+    #endif
+      default: return mulAddScalar;
+    }
+  }
+
+  String getKernelName (Kernel kernel) {
+    switch (kernel) {
+      case Kernel::SSSE3: return "ssse3";
+      case Kernel::AVX2: return "avx2";
+      case Kernel::NEON: return "neon";
+      default: return "scalar";
+    }
+  }
+
+  Vector<Kernel> getSupportedKernels () {
+    Vector<Kernel> kernels;
+
+    for (auto kernel : { Kernel::Scalar, Kernel::SSSE3, Kernel::AVX2, Kernel::NEON }) {
+      if (isKernelSupported(kernel)) {
+        kernels.push_back(kernel);
+      }
+    }
+
+    return kernels;
+  }
+
+  Kernel getDefaultKernel () {
+    static const auto kernel = getSupportedKernels().back();
+    return kernel;
+  }
+
+  bool encode (
+    unsigned char **shards,
+    size_t dataCount,
+    size_t parityCount,
+    size_t size,
+    Kernel kernel
+  ) {
+    auto mulAdd = getMulAdd(kernel);
+
+    if (dataCount == 0 || dataCount + parityCount > MAX_SHARDS) {
+      return false;
+    }
+
+    for (size_t row = 0; row < parityCount; ++row) {
+      auto parity = shards[dataCount + row];
+
+      memset(parity, 0, size);
+
+      for (size_t column = 0; column < dataCount; ++column) {
+        mulAdd(parity, shards[column], getCoefficient(dataCount, row, column), size);
+      }
+    }
+
+    return true;
+  }
+
+  // inverts the `n` by `n` matrix in place with Gauss-Jordan elimination
+  static bool invert (Vector<uint8_t> &matrix, size_t n) {
+    Vector<uint8_t> inverse(n * n, 0);
+
+    for (size_t i = 0; i < n; ++i) {
+      inverse[i * n + i] = 1;
+    }
+
+    for (size_t column = 0; column < n; ++column) {
+      auto pivot = column;
+
+      while (pivot < n && matrix[pivot * n + column] == 0) {
+        pivot++;
+      }
+
+      if (pivot == n) {
+        return false;
+      }
+
+      if (pivot != column) {
+        for (size_t i = 0; i < n; ++i) {
+          std::swap(matrix[pivot * n + i], matrix[column * n + i]);
+          std::swap(inverse[pivot * n + i], inverse[column * n + i]);
+        }
+      }
+
+      auto scale = inv(matrix[column * n + column]);
+
+      for (size_t i = 0; i < n; ++i) {
+        matrix[column * n + i] = mul(matrix[column * n + i], scale);
+        inverse[column * n + i] = mul(inverse[column * n + i], scale);
+      }
+
+      for (size_t row = 0; row < n; ++row) {
+        auto factor = matrix[row * n + column];
+
+        if (row == column || factor == 0) {
+          continue;
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+          matrix[row * n + i] ^= mul(factor, matrix[column * n + i]);
+          inverse[row * n + i] ^= mul(factor, inverse[column * n + i]);
+        }
+      }
+    }
+
+    matrix = std::move(inverse);
+    return true;
+  }
+
+  bool reconstruct (
+    unsigned char **shards,
+    const bool *present,
+    size_t dataCount,
+    size_t parityCount,
+    size_t size,
+    Kernel kernel
+  ) {
+    auto mulAdd = getMulAdd(kernel);
+    Vector<size_t> missing;
+    Vector<size_t> rows;
+
+    if (dataCount == 0 || dataCount + parityCount > MAX_SHARDS) {
+      return false;
+    }
+
+    for (size_t i = 0; i < dataCount; ++i) {
+      if (!present[i]) {
+        missing.push_back(i);
+      }
+    }
+
+    for (size_t i = 0; i < parityCount && rows.size() < missing.size(); ++i) {
+      if (present[dataCount + i]) {
+        rows.push_back(i);
+      }
+    }
+
+    if (missing.size() == 0) {
+      return true;
+    }
+
+    if (rows.size() < missing.size()) {
+      return false;
+    }
+
+    // each parity row is a linear equation in the missing data shards once
+    // the present data shards are subtracted out, solved with the inverse
+    // of the (always invertible) Cauchy submatrix of the missing columns
+    auto count = missing.size();
+    Vector<uint8_t> matrix(count * count);
+    Vector<unsigned char> syndromes(count * size);
+
+    for (size_t r = 0; r < count; ++r) {
+      auto syndrome = syndromes.data() + r * size;
+
+      memcpy(syndrome, shards[dataCount + rows[r]], size);
+
+      for (size_t column = 0; column < dataCount; ++column) {
+        if (present[column]) {
+          mulAdd(syndrome, shards[column], getCoefficient(dataCount, rows[r], column), size);
+        }
+      }
+
+      for (size_t c = 0; c < count; ++c) {
+        matrix[r * count + c] = getCoefficient(dataCount, rows[r], missing[c]);
+      }
+    }
+
+    if (!invert(matrix, count)) {
+      return false;
+    }
+
+    for (size_t c = 0; c < count; ++c) {
+      auto shard = shards[missing[c]];
+
+      memset(shard, 0, size);
+
+      for (size_t r = 0; r < count; ++r) {
+        mulAdd(shard, syndromes.data() + r * size, matrix[c * count + r], size);
+      }
+    }
+
+    return true;
+  }
+
+  static void encodeFrameHeader (char *bytes, const Frame &frame) {
+    auto header = (unsigned char *) bytes;
+
+    memcpy(header, FRAME_MAGIC_BYTES_PREFIX, 4);
+    header[4] = (unsigned char) (frame.blockId >> 24);
+    header[5] = (unsigned char) (frame.blockId >> 16);
+    header[6] = (unsigned char) (frame.blockId >> 8);
+    header[7] = (unsigned char) frame.blockId;
+    header[8] = frame.index;
+    header[9] = frame.dataCount;
+    header[10] = frame.parityCount;
+    header[11] = (unsigned char) (frame.shardSize >> 8);
+    header[12] = (unsigned char) frame.shardSize;
+  }
+
+  static inline size_t getShardLength (const unsigned char *shard) {
+    return ((size_t) shard[0] << 8) | shard[1];
+  }
+
+  static inline void writeDataShard (unsigned char *shard, const char *bytes, size_t size) {
+    shard[0] = (unsigned char) (size >> 8);
+    shard[1] = (unsigned char) size;
+
+    if (size > 0) {
+      memcpy(shard + SHARD_LENGTH_BYTES, bytes, size);
+    }
+  }
+
+  bool isFrame (const char *bytes, size_t size) {
+    return (
+      bytes != nullptr &&
+      size >= FRAME_HEADER_BYTES &&
+      memcmp(bytes, FRAME_MAGIC_BYTES_PREFIX, 4) == 0
+    );
+  }
+
+  bool decodeFrame (const char *bytes, size_t size, Frame &frame) {
+    auto header = (const unsigned char *) bytes;
+
+    if (!isFrame(bytes, size)) {
+      return false;
+    }
+
+    frame.blockId = (
+      ((uint32_t) header[4] << 24) |
+      ((uint32_t) header[5] << 16) |
+      ((uint32_t) header[6] << 8) |
+      (uint32_t) header[7]
+    );
+
+    frame.index = header[8];
+    frame.dataCount = header[9];
+    frame.parityCount = header[10];
+    frame.shardSize = (uint16_t) ((header[11] << 8) | header[12]);
+    frame.shard = header + FRAME_HEADER_BYTES;
+    frame.size = size - FRAME_HEADER_BYTES;
+
+    if (
+      frame.dataCount == 0 ||
+      (size_t) frame.dataCount + frame.parityCount > MAX_SHARDS ||
+      frame.index >= frame.dataCount + frame.parityCount ||
+      frame.shardSize < SHARD_LENGTH_BYTES ||
+      frame.size > frame.shardSize
+    ) {
+      return false;
+    }
+
+    // parity shards are sent whole, data shards at least up to their end
+    if (frame.index >= frame.dataCount) {
+      return frame.size == frame.shardSize;
+    }
+
+    return (
+      frame.size >= SHARD_LENGTH_BYTES &&
+      SHARD_LENGTH_BYTES + getShardLength(frame.shard) <= frame.size
+    );
+  }
+
+  bool encodeBlock (
+    uint32_t blockId,
+    const Vector<Packet> &packets,
+    size_t parityCount,
+    Vector<char> &output,
+    Vector<size_t> &sizes,
+    Kernel kernel
+  ) {
+    auto dataCount = packets.size();
+    size_t maxPacketSize = 0;
+    size_t outputSize = 0;
+
+    if (dataCount == 0 || dataCount + parityCount > MAX_SHARDS) {
+      return false;
+    }
+
+    for (const auto& packet : packets) {
+      maxPacketSize = std::max(maxPacketSize, packet.size);
+      outputSize += FRAME_HEADER_BYTES + SHARD_LENGTH_BYTES + packet.size;
+    }
+
+    if (maxPacketSize > MAX_PACKET_BYTES) {
+      return false;
+    }
+
+    auto shardSize = SHARD_LENGTH_BYTES + maxPacketSize;
+    Vector<unsigned char> block((dataCount + parityCount) * shardSize, 0);
+    Vector<unsigned char *> shards;
+
+    for (size_t i = 0; i < dataCount + parityCount; ++i) {
+      shards.push_back(block.data() + i * shardSize);
+    }
+
+    for (size_t i = 0; i < dataCount; ++i) {
+      writeDataShard(shards[i], packets[i].bytes, packets[i].size);
+    }
+
+    encode(shards.data(), dataCount, parityCount, shardSize, kernel);
+
+    outputSize += parityCount * (FRAME_HEADER_BYTES + shardSize);
+    output.resize(outputSize);
+    sizes.clear();
+
+    auto bytes = output.data();
+
+    for (size_t i = 0; i < dataCount + parityCount; ++i) {
+      auto size = i < dataCount ? SHARD_LENGTH_BYTES + packets[i].size : shardSize;
+
+      encodeFrameHeader(bytes, Frame {
+        blockId,
+        (uint8_t) i,
+        (uint8_t) dataCount,
+        (uint8_t) parityCount,
+        (uint16_t) shardSize
+      });
+
+      memcpy(bytes + FRAME_HEADER_BYTES, shards[i], size);
+      sizes.push_back(FRAME_HEADER_BYTES + size);
+      bytes += FRAME_HEADER_BYTES + size;
+    }
+
+    return true;
+  }
+
+  static Vector<char> getShardPacket (const Vector<unsigned char> &shard) {
+    auto length = getShardLength(shard.data());
+    auto bytes = (const char *) shard.data() + SHARD_LENGTH_BYTES;
+    return Vector<char>(bytes, bytes + length);
+  }
+
+  void BlockDecoder::receive (
+    const String &source,
+    const Frame &frame,
+    Vector<Output> &output
+  ) {
+    auto key = std::make_pair(source, frame.blockId);
+    auto entry = this->blocks.find(key);
+
+    if (entry == this->blocks.end()) {
+      Block block;
+      auto count = (size_t) frame.dataCount + frame.parityCount;
+
+      block.params = frame;
+      block.shards.resize(count);
+      block.present.resize(count, false);
+
+      entry = this->blocks.emplace(key, std::move(block)).first;
+      this->order.push_back(key);
+
+      while (this->order.size() > MAX_BLOCKS) {
+        this->blocks.erase(this->order.front());
+        this->order.pop_front();
+      }
+    }
+
+    auto& block = entry->second;
+    auto& params = block.params;
+
+    if (
+      block.complete ||
+      block.present[frame.index] ||
+      params.dataCount != frame.dataCount ||
+      params.parityCount != frame.parityCount ||
+      params.shardSize != frame.shardSize
+    ) {
+      return;
+    }
+
+    auto& shard = block.shards[frame.index];
+
+    shard.resize(frame.shardSize, 0);
+    memcpy(shard.data(), frame.shard, frame.size);
+    block.present[frame.index] = true;
+    block.received++;
+
+    if (frame.index < frame.dataCount) {
+      output.push_back(Output { frame.blockId, frame.index, false, getShardPacket(shard) });
+    }
+
+    if (block.received < frame.dataCount) {
+      return;
+    }
+
+    Vector<unsigned char *> shards;
+    Vector<uint8_t> missing;
+    // `Vector<bool>` has no `data()`
+    auto present = std::make_unique<bool[]>(block.present.size());
+
+    for (size_t i = 0; i < block.shards.size(); ++i) {
+      present[i] = block.present[i];
+
+      if (!present[i]) {
+        block.shards[i].resize(frame.shardSize, 0);
+
+        if (i < frame.dataCount) {
+          missing.push_back((uint8_t) i);
+        }
+      }
+
+      shards.push_back(block.shards[i].data());
+    }
+
+    if (
+      missing.size() > 0 &&
+      reconstruct(shards.data(), present.get(), frame.dataCount, frame.parityCount, frame.shardSize)
+    ) {
+      for (auto index : missing) {
+        auto& recovered = block.shards[index];
+
+        // a corrupted block can decode to lengths beyond the shard
+        if (SHARD_LENGTH_BYTES + getShardLength(recovered.data()) <= recovered.size()) {
+          output.push_back(Output { frame.blockId, index, true, getShardPacket(recovered) });
+        }
+      }
+    }
+
+    // kept without its shards so late frames of the block are ignored
+    block.complete = true;
+    block.shards.clear();
+  }
+}
+
+namespace SSC {
+  static JSON::Object::Entries ERR_FEC (
+    const String& source,
+    const String& code,
+    const String& message
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"code", code},
+        {"message", message}
+      }}
+    };
+  }
+
+  static Post createBytesPost (const Vector<unsigned char>& bytes) {
+    auto size = bytes.size();
+    auto headers = Headers {{
+      {"content-type" ,"application/octet-stream"},
+      {"content-length", (uint64_t) size}
+    }};
+
+    Post post;
+    post.id = rand64();
+    post.body = new char[size]{0};
+    post.length = (int) size;
+    post.headers = headers.str();
+
+    if (size > 0) {
+      memcpy(post.body, bytes.data(), size);
+    }
+
+    return post;
+  }
+
+  static JSON::Array::Entries toArrayEntries (const Vector<size_t> &values) {
+    JSON::Array::Entries entries;
+
+    for (auto value : values) {
+      entries.push_back((uint64_t) value);
+    }
+
+    return entries;
+  }
+
+  void Core::FEC::encode (
+    const String seq,
+    EncodeOptions options,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    auto dataCount = options.sizes.size();
+    size_t offset = 0;
+    size_t maxPacketSize = 0;
+
+    for (auto packetSize : options.sizes) {
+      offset += packetSize;
+      maxPacketSize = std::max(maxPacketSize, packetSize);
+    }
+
+    if (offset != size || dataCount == 0) {
+      return cb(seq, ERR_FEC("fec.encode", "EINVAL", "Packet sizes do not match the given bytes"), Post{});
+    }
+
+    if (
+      maxPacketSize > SSC::FEC::MAX_PACKET_BYTES ||
+      dataCount + options.parityCount > SSC::FEC::MAX_SHARDS
+    ) {
+      return cb(seq, ERR_FEC("fec.encode", "EINVAL", "Block is too large"), Post{});
+    }
+
+    auto shardSize = SSC::FEC::SHARD_LENGTH_BYTES + maxPacketSize;
+    auto count = dataCount + options.parityCount;
+    Vector<unsigned char> block(count * shardSize, 0);
+    Vector<unsigned char *> shards;
+    Vector<size_t> sizes(options.parityCount, shardSize);
+
+    offset = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+      shards.push_back(block.data() + i * shardSize);
+    }
+
+    for (size_t i = 0; i < dataCount; ++i) {
+      SSC::FEC::writeDataShard(shards[i], bytes + offset, options.sizes[i]);
+      offset += options.sizes[i];
+    }
+
+    SSC::FEC::encode(shards.data(), dataCount, options.parityCount, shardSize);
+
+    // only the parity shards are sent back
+    block.erase(block.begin(), block.begin() + dataCount * shardSize);
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "fec.encode"},
+      {"data", JSON::Object::Entries {
+        {"dataCount", (uint64_t) dataCount},
+        {"parityCount", (uint64_t) options.parityCount},
+        {"shardSize", (uint64_t) shardSize},
+        {"sizes", toArrayEntries(sizes)}
+      }}
+    }, createBytesPost(block));
+  }
+
+  void Core::FEC::reconstruct (
+    const String seq,
+    ReconstructOptions options,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    auto count = options.dataCount + options.parityCount;
+    size_t shardSize = 0;
+    size_t offset = 0;
+
+    if (
+      options.dataCount == 0 ||
+      count > SSC::FEC::MAX_SHARDS ||
+      options.indices.size() != options.sizes.size()
+    ) {
+      return cb(seq, ERR_FEC("fec.reconstruct", "EINVAL", "Invalid block parameters"), Post{});
+    }
+
+    for (size_t i = 0; i < options.indices.size(); ++i) {
+      offset += options.sizes[i];
+
+      if (options.indices[i] >= count) {
+        return cb(seq, ERR_FEC("fec.reconstruct", "EINVAL", "Packet index is out of range"), Post{});
+      }
+
+      // every parity packet is a whole shard
+      if (options.indices[i] >= options.dataCount) {
+        if (shardSize > 0 && shardSize != options.sizes[i]) {
+          return cb(seq, ERR_FEC("fec.reconstruct", "EINVAL", "Parity packets differ in size"), Post{});
+        }
+
+        shardSize = options.sizes[i];
+      }
+    }
+
+    if (offset != size) {
+      return cb(seq, ERR_FEC("fec.reconstruct", "EINVAL", "Packet sizes do not match the given bytes"), Post{});
+    }
+
+    Vector<unsigned char> block;
+    Vector<unsigned char *> shards;
+    auto present = std::make_unique<bool[]>(count);
+
+    for (size_t i = 0; i < count; ++i) {
+      present[i] = false;
+    }
+
+    for (auto index : options.indices) {
+      present[index] = true;
+    }
+
+    Vector<size_t> missing;
+
+    for (size_t i = 0; i < options.dataCount; ++i) {
+      if (!present[i]) {
+        missing.push_back(i);
+      }
+    }
+
+    if (missing.size() == 0) {
+      return cb(seq, JSON::Object::Entries {
+        {"source", "fec.reconstruct"},
+        {"data", JSON::Object::Entries {
+          {"indices", JSON::Array::Entries {}},
+          {"sizes", JSON::Array::Entries {}}
+        }}
+      }, createBytesPost(block));
+    }
+
+    if (shardSize < SSC::FEC::SHARD_LENGTH_BYTES) {
+      return cb(seq, ERR_FEC("fec.reconstruct", "ENOTRECOVERABLE", "Not enough packets to reconstruct the block"), Post{});
+    }
+
+    block.resize(count * shardSize, 0);
+    offset = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+      shards.push_back(block.data() + i * shardSize);
+    }
+
+    for (size_t i = 0; i < options.indices.size(); ++i) {
+      auto index = options.indices[i];
+      auto packetSize = options.sizes[i];
+      auto shard = shards[index];
+
+      if (index < options.dataCount) {
+        if (packetSize > shardSize - SSC::FEC::SHARD_LENGTH_BYTES) {
+          return cb(seq, ERR_FEC("fec.reconstruct", "EINVAL", "Packet is larger than the parity packets"), Post{});
+        }
+
+        SSC::FEC::writeDataShard(shard, bytes + offset, packetSize);
+      } else {
+        memcpy(shard, bytes + offset, packetSize);
+      }
+
+      offset += packetSize;
+    }
+
+    if (!SSC::FEC::reconstruct(shards.data(), present.get(), options.dataCount, options.parityCount, shardSize)) {
+      return cb(seq, ERR_FEC("fec.reconstruct", "ENOTRECOVERABLE", "Not enough packets to reconstruct the block"), Post{});
+    }
+
+    Vector<unsigned char> packets;
+    Vector<size_t> sizes;
+
+    for (auto index : missing) {
+      auto shard = shards[index];
+      auto packetSize = SSC::FEC::getShardLength(shard);
+
+      if (packetSize > shardSize - SSC::FEC::SHARD_LENGTH_BYTES) {
+        return cb(seq, ERR_FEC("fec.reconstruct", "EBADMSG", "Block does not decode, packets are corrupt"), Post{});
+      }
+
+      packets.insert(packets.end(), shard + SSC::FEC::SHARD_LENGTH_BYTES, shard + SSC::FEC::SHARD_LENGTH_BYTES + packetSize);
+      sizes.push_back(packetSize);
+    }
+
+    cb(seq, JSON::Object::Entries {
+      {"source", "fec.reconstruct"},
+      {"data", JSON::Object::Entries {
+        {"indices", toArrayEntries(missing)},
+        {"sizes", toArrayEntries(sizes)}
+      }}
+    }, createBytesPost(packets));
+  }
+
+#if SSC_BENCHMARKS
+  struct FECBenchmarkContext {
+    uv_work_t req;
+    Core::FEC::BenchmarkOptions options;
+    JSON::Array::Entries results;
+    String seq;
+    Core::Module::Callback cb;
+  };
+
+  // megabytes of data shards per second `fn` processes in about `duration`
+  template <typename F>
+  static double measureThroughput (size_t bytes, uint64_t duration, F fn) {
+    auto start = uv_hrtime();
+    uint64_t elapsed = 0;
+    size_t iterations = 0;
+
+    do {
+      fn();
+      iterations++;
+      elapsed = uv_hrtime() - start;
+    } while (elapsed < duration * 1000000);
+
+    return (double) (bytes * iterations) / ((double) elapsed / 1e9) / 1e6;
+  }
+
+  static void runBenchmark (FECBenchmarkContext *ctx) {
+    auto& options = ctx->options;
+    auto count = options.dataCount + options.parityCount;
+    auto size = options.shardSize;
+    Vector<unsigned char> block(count * size);
+    Vector<unsigned char *> shards;
+    auto present = std::make_unique<bool[]>(count);
+
+    for (size_t i = 0; i < block.size(); ++i) {
+      block[i] = (unsigned char) rand64();
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      shards.push_back(block.data() + i * size);
+    }
+
+    // the worst case, as many data shards lost as there are parity shards
+    for (size_t i = 0; i < count; ++i) {
+      present[i] = i >= std::min(options.parityCount, options.dataCount);
+    }
+
+    for (auto kernel : SSC::FEC::getSupportedKernels()) {
+      auto bytes = options.dataCount * size;
+
+      auto encode = measureThroughput(bytes, options.duration, [&]() {
+        SSC::FEC::encode(shards.data(), options.dataCount, options.parityCount, size, kernel);
+      });
+
+      auto reconstruct = measureThroughput(bytes, options.duration, [&]() {
+        SSC::FEC::reconstruct(shards.data(), present.get(), options.dataCount, options.parityCount, size, kernel);
+      });
+
+      ctx->results.push_back(JSON::Object::Entries {
+        {"kernel", SSC::FEC::getKernelName(kernel)},
+        {"encode", encode},
+        {"reconstruct", reconstruct}
+      });
+    }
+  }
+
+  void Core::FEC::benchmark (
+    const String seq,
+    BenchmarkOptions options,
+    Module::Callback cb
+  ) {
+    if (
+      options.dataCount == 0 ||
+      options.shardSize == 0 ||
+      options.dataCount + options.parityCount > SSC::FEC::MAX_SHARDS
+    ) {
+      return cb(seq, ERR_FEC("fec.benchmark", "EINVAL", "Invalid block parameters"), Post{});
+    }
+
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = this->core->getEventLoop();
+      auto ctx = new FECBenchmarkContext;
+
+      ctx->req.data = ctx;
+      ctx->options = options;
+      ctx->seq = seq;
+      ctx->cb = cb;
+
+      auto done = [](uv_work_t *req, int status) {
+        auto ctx = reinterpret_cast<FECBenchmarkContext*>(req->data);
+
+        ctx->cb(ctx->seq, JSON::Object::Entries {
+          {"source", "fec.benchmark"},
+          {"data", JSON::Object::Entries {
+            {"dataCount", (uint64_t) ctx->options.dataCount},
+            {"parityCount", (uint64_t) ctx->options.parityCount},
+            {"shardSize", (uint64_t) ctx->options.shardSize},
+            {"kernel", SSC::FEC::getKernelName(SSC::FEC::getDefaultKernel())},
+            {"results", ctx->results}
+          }}
+        }, Post{});
+
+        delete ctx;
+      };
+
+      // benchmarks take a while, keep them off the loop
+      auto err = uv_queue_work(loop, &ctx->req, [](uv_work_t *req) {
+        runBenchmark(reinterpret_cast<FECBenchmarkContext*>(req->data));
+      }, done);
+
+      if (err < 0) {
+        runBenchmark(ctx);
+        done(&ctx->req, 0);
+      }
+    });
+  }
+#endif
+}
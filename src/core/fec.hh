@@ -0,0 +1,139 @@
+#ifndef SSC_CORE_FEC_HH
+#define SSC_CORE_FEC_HH
+
+#include "../common.hh"
+
+/**
+ * Forward error correction for bulk UDP transfers. A block of up to 255
+ * data packets is sent with parity packets computed by a systematic
+ * Reed-Solomon code over GF(2^8) (Cauchy matrix, polynomial 0x11d), so a
+ * receiver recovers lost packets from any `dataCount` packets of the block
+ * without a retransmission round trip.
+ *
+ * Data shards are the packet with a 2 byte length prefix, zero padded to
+ * the shard size of the block, so packets of different sizes share a block
+ * and recover with their original length. The multiply-accumulate kernels
+ * use SSSE3 or AVX2 on x86 and NEON on arm64 when available, with a table
+ * driven scalar fallback.
+ */
+namespace SSC::FEC {
+  // the 3rd, 7th, 10th, and 13th, prime numbers
+  constexpr unsigned char FRAME_MAGIC_BYTES_PREFIX[] = { 0x05, 0x11, 0x1d, 0x29 };
+
+  // magic, block id, shard index, data and parity shard counts, shard size
+  constexpr size_t FRAME_HEADER_BYTES = 4 + 4 + 1 + 1 + 1 + 2;
+  constexpr size_t SHARD_LENGTH_BYTES = 2;
+  constexpr size_t MAX_SHARDS = 256;
+  // shards and their frame header fit the largest UDP payload
+  constexpr size_t MAX_SHARD_BYTES = 65507 - FRAME_HEADER_BYTES;
+  constexpr size_t MAX_PACKET_BYTES = MAX_SHARD_BYTES - SHARD_LENGTH_BYTES;
+
+  enum class Kernel {
+    Scalar,
+    SSSE3,
+    AVX2,
+    NEON
+  };
+
+  String getKernelName (Kernel kernel);
+  // kernels this CPU runs, fastest last
+  Vector<Kernel> getSupportedKernels ();
+  Kernel getDefaultKernel ();
+
+  /**
+   * Computes the parity shards of a block. `shards` holds `dataCount` data
+   * shards followed by `parityCount` parity shards, each `size` bytes.
+   * Returns `false` if there are more than `MAX_SHARDS` shards.
+   */
+  bool encode (
+    unsigned char **shards,
+    size_t dataCount,
+    size_t parityCount,
+    size_t size,
+    Kernel kernel = getDefaultKernel()
+  );
+
+  /**
+   * Recomputes the data shards not `present` in a block laid out like for
+   * `encode()`. Returns `false` if fewer than `dataCount` shards are present.
+   * Missing parity shards are left untouched.
+   */
+  bool reconstruct (
+    unsigned char **shards,
+    const bool *present,
+    size_t dataCount,
+    size_t parityCount,
+    size_t size,
+    Kernel kernel = getDefaultKernel()
+  );
+
+  struct Frame {
+    uint32_t blockId = 0;
+    uint8_t index = 0;
+    uint8_t dataCount = 0;
+    uint8_t parityCount = 0;
+    uint16_t shardSize = 0;
+    // not owned, points into the decoded bytes after `decodeFrame()`,
+    // data shards may be sent without their zero padding
+    const unsigned char *shard = nullptr;
+    size_t size = 0;
+  };
+
+  bool isFrame (const char *bytes, size_t size);
+  bool decodeFrame (const char *bytes, size_t size, Frame &frame);
+
+  struct Packet {
+    const char *bytes = nullptr;
+    size_t size = 0;
+  };
+
+  /**
+   * Encodes `packets` and `parityCount` parity packets into the frames of
+   * one block, written back to back to `output` with their sizes in
+   * `sizes`. Returns `false` if a packet is larger than `MAX_PACKET_BYTES`
+   * or the block has more than `MAX_SHARDS` shards.
+   */
+  bool encodeBlock (
+    uint32_t blockId,
+    const Vector<Packet> &packets,
+    size_t parityCount,
+    Vector<char> &output,
+    Vector<size_t> &sizes,
+    Kernel kernel = getDefaultKernel()
+  );
+
+  /**
+   * Reassembles blocks from received frames. Data packets are passed
+   * through as they arrive, lost ones are recovered once any `dataCount`
+   * frames of their block arrived. Frames of a block are only matched
+   * against frames from the same `source`, and the oldest blocks are
+   * forgotten beyond `MAX_BLOCKS`.
+   */
+  class BlockDecoder {
+    public:
+      static constexpr size_t MAX_BLOCKS = 64;
+
+      struct Output {
+        uint32_t blockId = 0;
+        uint8_t index = 0;
+        bool recovered = false;
+        Vector<char> bytes;
+      };
+
+      void receive (const String &source, const Frame &frame, Vector<Output> &output);
+
+    private:
+      struct Block {
+        Frame params;
+        Vector<Vector<unsigned char>> shards;
+        Vector<bool> present;
+        size_t received = 0;
+        bool complete = false;
+      };
+
+      std::map<std::pair<String, uint32_t>, Block> blocks;
+      std::deque<std::pair<String, uint32_t>> order;
+  };
+}
+
+#endif
@@ -17,14 +17,14 @@ namespace SSC::JSON {
     auto output = std::to_string(value);
     auto decimal = output.find(".");
 
-    // trim trailing zeros
-    if (decimal >= 0) {
+    // trim trailing zeros, and the point if nothing is left after it
+    if (decimal != std::string::npos) {
       auto i = output.size() - 1;
-      while (output[i] == '0' && i >= decimal) {
+      while (output[i] == '0' && i > decimal) {
         i--;
       }
 
-      return output.substr(0, i);
+      return output.substr(0, i == decimal ? i : i + 1);
     }
 
     return output;
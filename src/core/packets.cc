@@ -0,0 +1,288 @@
+#include "packets.hh"
+
+#include <cstring>
+
+namespace SSC::StreamRelay {
+  static const char BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  static inline uint32_t readUInt32BE (const unsigned char *bytes) {
+    return (
+      ((uint32_t) bytes[0] << 24) |
+      ((uint32_t) bytes[1] << 16) |
+      ((uint32_t) bytes[2] << 8) |
+      ((uint32_t) bytes[3])
+    );
+  }
+
+  static inline void writeUInt32BE (unsigned char *bytes, uint32_t value) {
+    bytes[0] = (unsigned char) (value >> 24);
+    bytes[1] = (unsigned char) (value >> 16);
+    bytes[2] = (unsigned char) (value >> 8);
+    bytes[3] = (unsigned char) value;
+  }
+
+  static inline int getHexValue (char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  static inline int getBase64Value (char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+  }
+
+  static bool isZero (const Packet::ID &id) {
+    for (auto byte : id) {
+      if (byte != 0) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  String encodePacketID (const Packet::ID &id) {
+    static const char digits[] = "0123456789abcdef";
+    String output;
+
+    // matches `normalizeBuffer()`, all zeroes is "no identifier"
+    if (isZero(id)) {
+      return output;
+    }
+
+    output.reserve(id.size() * 2);
+
+    for (auto byte : id) {
+      output += digits[byte >> 4];
+      output += digits[byte & 0x0f];
+    }
+
+    return output;
+  }
+
+  static String toBase64 (const Packet::ID &id) {
+    String output;
+    size_t i = 0;
+
+    output.reserve(((id.size() + 2) / 3) * 4);
+
+    for (; i + 2 < id.size(); i += 3) {
+      uint32_t n = (id[i] << 16) | (id[i + 1] << 8) | id[i + 2];
+      output += BASE64_ALPHABET[(n >> 18) & 0x3f];
+      output += BASE64_ALPHABET[(n >> 12) & 0x3f];
+      output += BASE64_ALPHABET[(n >> 6) & 0x3f];
+      output += BASE64_ALPHABET[n & 0x3f];
+    }
+
+    if (i < id.size()) {
+      uint32_t n = id[i] << 16;
+
+      if (i + 1 < id.size()) {
+        n |= id[i + 1] << 8;
+      }
+
+      output += BASE64_ALPHABET[(n >> 18) & 0x3f];
+      output += BASE64_ALPHABET[(n >> 12) & 0x3f];
+      output += i + 1 < id.size() ? BASE64_ALPHABET[(n >> 6) & 0x3f] : '=';
+      output += '=';
+    }
+
+    return output;
+  }
+
+  bool isPacket (const char *bytes, size_t size) {
+    if (bytes == nullptr || size < PACKET_MAGIC_BYTES) {
+      return false;
+    }
+
+    return memcmp(bytes, PACKET_MAGIC_BYTES_PREFIX, PACKET_MAGIC_BYTES) == 0;
+  }
+
+  bool decodePacket (const char *bytes, size_t size, Packet &packet) {
+    if (size < PACKET_FRAME_BYTES || !isPacket(bytes, size)) {
+      return false;
+    }
+
+    auto frame = (const unsigned char *) bytes;
+    size_t offset = PACKET_MAGIC_BYTES;
+
+    packet.type = std::max(0, (int) (int8_t) frame[offset]);
+    offset += PACKET_TYPE_BYTES;
+
+    packet.version = std::max(PACKET_VERSION, (int) (int8_t) frame[offset]);
+    offset += PACKET_VERSION_BYTES;
+
+    packet.hops = readUInt32BE(frame + offset);
+    offset += PACKET_HOPS_BYTES;
+
+    packet.clock = readUInt32BE(frame + offset);
+    offset += PACKET_CLOCK_BYTES;
+
+    packet.index = std::max(-1, (int32_t) readUInt32BE(frame + offset));
+    offset += PACKET_INDEX_BYTES;
+
+    for (auto id : {
+      &packet.packetId,
+      &packet.clusterId,
+      &packet.previousId,
+      &packet.nextId,
+      &packet.to,
+      &packet.usr1
+    }) {
+      memcpy(id->data(), frame + offset, PACKET_ID_BYTES);
+      offset += PACKET_ID_BYTES;
+    }
+
+    auto messageLength = (size_t) ((frame[offset] << 8) | frame[offset + 1]);
+    offset += PACKET_MESSAGE_LENGTH_BYTES;
+
+    // a truncated datagram only carries what is left after the frame
+    packet.messageLength = std::min({
+      messageLength,
+      PACKET_MESSAGE_BYTES,
+      size - offset
+    });
+
+    packet.message = bytes + offset;
+    return true;
+  }
+
+  size_t encodePacket (const Packet &packet, char *bytes, size_t size) {
+    if (
+      bytes == nullptr ||
+      size < PACKET_BYTES ||
+      packet.messageLength > PACKET_MESSAGE_BYTES
+    ) {
+      return 0;
+    }
+
+    auto frame = (unsigned char *) bytes;
+    size_t offset = 0;
+
+    memset(frame, 0, PACKET_BYTES);
+    memcpy(frame, PACKET_MAGIC_BYTES_PREFIX, PACKET_MAGIC_BYTES);
+    offset += PACKET_MAGIC_BYTES;
+
+    frame[offset] = (unsigned char) (int8_t) packet.type;
+    offset += PACKET_TYPE_BYTES;
+
+    frame[offset] = (unsigned char) (int8_t) packet.version;
+    offset += PACKET_VERSION_BYTES;
+
+    writeUInt32BE(frame + offset, packet.hops);
+    offset += PACKET_HOPS_BYTES;
+
+    // the clock wraps before overflowing an `int32_t`
+    writeUInt32BE(frame + offset, packet.clock == 2e9 ? 0 : packet.clock);
+    offset += PACKET_CLOCK_BYTES;
+
+    writeUInt32BE(frame + offset, (uint32_t) packet.index);
+    offset += PACKET_INDEX_BYTES;
+
+    for (auto id : {
+      &packet.packetId,
+      &packet.clusterId,
+      &packet.previousId,
+      &packet.nextId,
+      &packet.to,
+      &packet.usr1
+    }) {
+      memcpy(frame + offset, id->data(), PACKET_ID_BYTES);
+      offset += PACKET_ID_BYTES;
+    }
+
+    frame[offset] = (unsigned char) (packet.messageLength >> 8);
+    frame[offset + 1] = (unsigned char) packet.messageLength;
+    offset += PACKET_MESSAGE_LENGTH_BYTES;
+
+    if (packet.message != nullptr && packet.messageLength > 0) {
+      memcpy(frame + offset, packet.message, packet.messageLength);
+    }
+
+    return PACKET_BYTES;
+  }
+
+  JSON::Object getPacketHeaders (const Packet &packet) {
+    auto usr1 = (const char *) packet.usr1.data();
+
+    return JSON::Object::Entries {
+      {"type", packet.type},
+      {"version", packet.version},
+      {"hops", packet.hops},
+      {"clock", packet.clock},
+      {"index", packet.index},
+      {"packetId", encodePacketID(packet.packetId)},
+      {"clusterId", encodePacketID(packet.clusterId)},
+      {"previousId", encodePacketID(packet.previousId)},
+      {"nextId", encodePacketID(packet.nextId)},
+      {"to", toBase64(packet.to)},
+      {"usr1", String(usr1, strnlen(usr1, PACKET_ID_BYTES))},
+      {"messageLength", (uint64_t) packet.messageLength}
+    };
+  }
+
+  bool parsePacketID (const String &hex, Packet::ID &id) {
+    id.fill(0);
+
+    if (hex.size() % 2 != 0 || hex.size() > id.size() * 2) {
+      return false;
+    }
+
+    for (size_t i = 0; i < hex.size(); i += 2) {
+      auto hi = getHexValue(hex[i]);
+      auto lo = getHexValue(hex[i + 1]);
+
+      if (hi < 0 || lo < 0) {
+        id.fill(0);
+        return false;
+      }
+
+      id[i / 2] = (unsigned char) ((hi << 4) | lo);
+    }
+
+    return true;
+  }
+
+  bool parsePacketPublicKey (const String &base64, Packet::ID &id) {
+    id.fill(0);
+
+    if (base64.size() == 0) {
+      return true;
+    }
+
+    // a 32 byte key is always 44 characters with a single '=' of padding
+    if (base64.size() != 44 || base64[43] != '=') {
+      return false;
+    }
+
+    size_t offset = 0;
+    uint32_t n = 0;
+    int bits = 0;
+
+    for (size_t i = 0; i < 43; ++i) {
+      auto value = getBase64Value(base64[i]);
+
+      if (value < 0) {
+        id.fill(0);
+        return false;
+      }
+
+      n = (n << 6) | (uint32_t) value;
+      bits += 6;
+
+      if (bits >= 8) {
+        bits -= 8;
+        id[offset++] = (unsigned char) (n >> bits);
+      }
+    }
+
+    return offset == id.size();
+  }
+}
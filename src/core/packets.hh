@@ -0,0 +1,181 @@
+#ifndef SSC_CORE_PACKETS_HH
+#define SSC_CORE_PACKETS_HH
+
+#include "../common.hh"
+#include "json.hh"
+
+/**
+ * Native codec for the stream-relay packet format. The layout mirrors
+ * `api/stream-relay/packets.js` (protocol version 2) byte for byte, so
+ * packets encoded on either side decode on the other.
+ */
+namespace SSC::StreamRelay {
+  // the 2nd, 3rd, 5th, and 7th, prime numbers
+  constexpr unsigned char PACKET_MAGIC_BYTES_PREFIX[] = { 0x03, 0x05, 0x0b, 0x11 };
+
+  constexpr int PACKET_VERSION = 2;
+
+  constexpr size_t PACKET_MAGIC_BYTES = 4;
+  constexpr size_t PACKET_TYPE_BYTES = 1;
+  constexpr size_t PACKET_VERSION_BYTES = 1;
+  constexpr size_t PACKET_HOPS_BYTES = 4;
+  constexpr size_t PACKET_CLOCK_BYTES = 4;
+  constexpr size_t PACKET_INDEX_BYTES = 4;
+  constexpr size_t PACKET_ID_BYTES = 32;
+  constexpr size_t PACKET_MESSAGE_LENGTH_BYTES = 2;
+  constexpr size_t PACKET_MESSAGE_BYTES = 1024;
+
+  // magic, header, 6 identifiers (packetId, clusterId, previousId,
+  // nextId, to, usr1) and the message length
+  constexpr size_t PACKET_FRAME_BYTES =
+    PACKET_MAGIC_BYTES +
+    PACKET_TYPE_BYTES +
+    PACKET_VERSION_BYTES +
+    PACKET_HOPS_BYTES +
+    PACKET_CLOCK_BYTES +
+    PACKET_INDEX_BYTES +
+    PACKET_ID_BYTES * 6 +
+    PACKET_MESSAGE_LENGTH_BYTES;
+
+  constexpr size_t PACKET_BYTES = PACKET_FRAME_BYTES + PACKET_MESSAGE_BYTES;
+
+  struct Packet {
+    using ID = std::array<unsigned char, PACKET_ID_BYTES>;
+
+    int type = 0;
+    int version = PACKET_VERSION;
+    uint32_t hops = 0;
+    uint32_t clock = 0;
+    int32_t index = -1;
+
+    ID packetId {};
+    ID clusterId {};
+    ID previousId {};
+    ID nextId {};
+    ID to {};
+    ID usr1 {};
+
+    // not owned, points into the encoded bytes after `decodePacket()`
+    const char *message = nullptr;
+    size_t messageLength = 0;
+  };
+
+  bool isPacket (const char *bytes, size_t size);
+
+  /**
+   * Decodes `bytes` into `packet`. Returns `false` if `bytes` are too
+   * short to hold a frame or do not start with the magic bytes prefix.
+   */
+  bool decodePacket (const char *bytes, size_t size, Packet &packet);
+
+  /**
+   * Encodes `packet` into `bytes`, which must hold at least `PACKET_BYTES`.
+   * Returns the number of bytes written or `0` if the message is too big.
+   */
+  size_t encodePacket (const Packet &packet, char *bytes, size_t size);
+
+  /**
+   * Returns the packet headers in the representation `decode()` in
+   * `api/stream-relay/packets.js` uses: hex identifiers (empty when all
+   * zeroes), a base64 `to` public key, and a NUL trimmed `usr1`.
+   */
+  JSON::Object getPacketHeaders (const Packet &packet);
+
+  // `PacketPublish.type` in `api/stream-relay/packets.js`
+  constexpr int PACKET_TYPE_PUBLISH = 5;
+
+  /**
+   * A counting Bloom filter over packet IDs. Counters make removal
+   * possible, which a cache evicting entries needs.
+   */
+  class PacketBloomFilter {
+    public:
+      static constexpr int HASHES = 4;
+      static constexpr size_t COUNTERS_PER_ENTRY = 8;
+
+      PacketBloomFilter (size_t capacity);
+      void add (const String &packetId);
+      void remove (const String &packetId);
+      void clear ();
+
+      // `false` means definitely absent, `true` means maybe present
+      bool mayContain (const String &packetId) const;
+
+    private:
+      Vector<uint8_t> counters;
+      size_t mask = 0;
+      template <typename F> void forEachCounter (const String &packetId, F fn) const;
+  };
+
+  /**
+   * A bounded cache of encoded packets keyed by packet ID with the
+   * semantics of `Cache` in `api/stream-relay/cache.js`: only publish
+   * packets are inserted, existing entries are kept, and when full the
+   * entry `defaultSiblingResolver` sorts last (highest clock, most recently
+   * inserted on ties) is evicted.
+   *
+   * Entries are linked into per clock buckets ordered by clock, so eviction
+   * is the tail of the last bucket and never scans or sorts the cache.
+   */
+  class PacketCache {
+    public:
+      // `DEFAULT_MAX_SIZE` in `api/stream-relay/cache.js`
+      static constexpr size_t DEFAULT_MAX_BYTES = 16 * 1024 * 1024;
+      static constexpr size_t DEFAULT_MAX_COUNT = (DEFAULT_MAX_BYTES + 1157) / 1158;
+
+      struct Options {
+        size_t maxBytes = DEFAULT_MAX_BYTES;
+        size_t maxCount = DEFAULT_MAX_COUNT;
+      };
+
+      struct Entry {
+        String packetId;
+        uint32_t clock = 0;
+        uint64_t timestamp = 0;
+        Vector<char> bytes;
+
+        // intrusive links in the bucket of entries with the same clock
+        Entry *prev = nullptr;
+        Entry *next = nullptr;
+      };
+
+      const Options options;
+
+      PacketCache (const Options &options);
+
+      bool insert (const Packet &packet, const char *bytes, size_t size);
+      bool get (const String &packetId, Entry &entry);
+      bool has (const String &packetId);
+      bool remove (const String &packetId);
+      void clear ();
+      size_t size ();
+      size_t bytes ();
+
+    private:
+      struct Bucket {
+        Entry *head = nullptr;
+        Entry *tail = nullptr;
+      };
+
+      Mutex mutex;
+      std::unordered_map<String, std::unique_ptr<Entry>> entries;
+      std::map<uint32_t, Bucket> buckets;
+      PacketBloomFilter filter;
+      size_t totalBytes = 0;
+
+      void link (Entry *entry);
+      void unlink (Entry *entry);
+      void erase (const String &packetId);
+      void evict ();
+  };
+
+  // hex encodes an identifier, an all zeroes identifier is an empty string
+  String encodePacketID (const Packet::ID &id);
+
+  // parses hex (`packetId`, `clusterId`, ...) and base64 (`to`) encoded
+  // identifiers, an empty string leaves `id` zeroed
+  bool parsePacketID (const String &hex, Packet::ID &id);
+  bool parsePacketPublicKey (const String &base64, Packet::ID &id);
+}
+
+#endif
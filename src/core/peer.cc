@@ -1,33 +1,637 @@
 #include "core.hh"
 
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/filter.h>
+#include <netinet/udp.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+#ifndef SO_RXQ_OVFL
+#define SO_RXQ_OVFL 40
+#endif
+
+#ifndef SO_MEMINFO
+#define SO_MEMINFO 55
+#endif
+
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
+#ifndef SK_MEMINFO_DROPS
+#define SK_MEMINFO_RMEM_ALLOC 0
+#define SK_MEMINFO_DROPS 8
+#define SK_MEMINFO_VARS 9
+#endif
+#elif defined(__APPLE__)
+#include <sys/ioctl.h>
+#endif
+
 namespace SSC {
+  // large enough for a full GRO super-datagram
+  static constexpr size_t UDP_RECEIVE_OFFLOAD_BUFFER_SIZE = 64 * 1024;
+  // datagrams read by receivers waiting for the Core loop, more are dropped
+  static constexpr size_t UDP_RECEIVED_QUEUE_SIZE = 16 * 1024;
+
+  static void onSendRequestComplete (Peer::RequestContext *ctx, int status) {
+    auto peer = ctx->peer;
+
+    if (status < 0 && ctx->status == 0) {
+      ctx->status = status;
+    }
+
+    // a request left the send queue, sends held back may fit now
+    peer->flushSendQueue();
+
+  #if defined(__linux__)
+    // some drivers only reject GSO at send time with `EIO`, so turn the
+    // offload off and let later sends go out one datagram per segment
+    if (status == UV_EIO && peer->hasSegmentationOffload) {
+      uv_os_fd_t fd;
+      int size = 0;
+      if (uv_fileno((uv_handle_t *) &peer->handle, &fd) == 0) {
+        setsockopt(fd, SOL_UDP, UDP_SEGMENT, &size, sizeof(size));
+      }
+
+      peer->hasSegmentationOffload = false;
+    }
+  #endif
+
+    if (--ctx->pending > 0) {
+      return;
+    }
+
+    if (ctx->status < 0) {
+      peer->counters.sendErrors++;
+    } else {
+      peer->counters.packetsSent += ctx->datagrams;
+      peer->counters.bytesSent += ctx->size;
+    }
+
+    ctx->cb(ctx->status, Post{});
+
+    if (peer->isEphemeral()) {
+      peer->close();
+    }
+
+    delete ctx;
+  }
+
+  static void closeTimer (uv_timer_t *&timer) {
+    auto handle = timer;
+
+    if (handle == nullptr) {
+      return;
+    }
+
+    timer = nullptr;
+    uv_close((uv_handle_t *) handle, [](uv_handle_t *handle) {
+      delete (uv_timer_t *) handle;
+    });
+  }
+
+  // nanoseconds since the epoch, on the clock of `SO_TIMESTAMPNS`
+  static inline uint64_t getRealtime () {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch()).count();
+  }
+
+  static void closePendingPing (Peer::PendingPing *ping) {
+    uv_close((uv_handle_t *) &ping->timer, [](uv_handle_t *handle) {
+      delete (Peer::PendingPing *) handle->data;
+    });
+  }
+
+  static void failPendingPing (Peer *peer, uint64_t nonce, int status) {
+    Peer::PingCallback cb = nullptr;
+
+    do {
+      Lock lock(peer->mutex);
+      auto it = peer->pings.find(nonce);
+
+      if (it == peer->pings.end()) {
+        return;
+      }
+
+      auto ping = it->second;
+      peer->pings.erase(it);
+      cb = ping->cb;
+      closePendingPing(ping);
+    } while (0);
+
+    cb(status, 0, RTTEstimator {});
+  }
+
+  static ReceiveBufferTuner::Sample getReceiveBufferSample (Peer *peer) {
+    ReceiveBufferTuner::Sample sample;
+    sample.drops = peer->getReceiveDrops();
+    sample.packets = peer->counters.packetsReceived;
+    sample.queued = peer->getReceiveQueueSize();
+    sample.size = peer->getReceiveBufferSize();
+    return sample;
+  }
+
+  static void closeReceiveOffloadPoll (Peer *peer) {
+  #if defined(__linux__)
+    auto poll = peer->receiveOffloadPoll;
+    uv_os_fd_t fd = -1;
+
+    if (poll == nullptr) {
+      return;
+    }
+
+    peer->receiveOffloadPoll = nullptr;
+    uv_fileno((uv_handle_t *) poll, &fd);
+    uv_close((uv_handle_t *) poll, [](uv_handle_t *handle) {
+      delete (uv_poll_t *) handle;
+    });
+
+    // the duplicate descriptor is owned by the poll handle and can only be
+    // closed after `uv_close()` has removed it from the loop backend
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  #endif
+  }
+
+  static void onReceive (
+    Peer *peer,
+    ssize_t nread,
+    const uv_buf_t *buf,
+    const struct sockaddr *addr,
+    uint64_t timestamp
+  ) {
+    RTTProbe probe;
+
+    if (nread > 0) {
+      peer->counters.packetsReceived++;
+      peer->counters.bytesReceived += nread;
+    } else if (nread < 0 && nread != UV_EOF) {
+      peer->counters.receiveErrors++;
+    }
+
+    if (timestamp == 0) {
+      timestamp = getRealtime();
+    }
+
+    // probes are answered and measured here, never seen by the receiver
+    if (
+      nread > 0 &&
+      addr != nullptr &&
+      peer->options.udp.timestamps &&
+      RTTProbe::decode(buf->base, (size_t) nread, probe)
+    ) {
+      peer->onProbe(probe, addr, timestamp);
+      delete [] buf->base;
+      return;
+    }
+
+    peer->receiveCallback(nread, buf, addr, timestamp);
+  }
+
+  // called on the Core loop with the datagrams receivers read meanwhile
+  static void onReceived (uv_async_t *async) {
+    auto peer = (Peer *) async->data;
+    std::deque<Peer::ReceivedDatagram> received;
+
+    do {
+      std::lock_guard lock(peer->receivedMutex);
+      received.swap(peer->received);
+    } while (0);
+
+    for (auto& datagram : received) {
+      if (
+        peer->isClosing() ||
+        peer->isClosed() ||
+        !peer->hasState(PEER_STATE_UDP_RECV_STARTED)
+      ) {
+        delete [] datagram.buf.base;
+        continue;
+      }
+
+      onReceive(
+        peer,
+        datagram.nread,
+        &datagram.buf,
+        (const struct sockaddr *) &datagram.addr,
+        datagram.timestamp
+      );
+    }
+  }
+
+  static void setReceiversReading (Peer *peer, bool reading) {
+    for (auto receiver : peer->receivers) {
+      receiver->reading = reading;
+      uv_async_send(&receiver->control);
+    }
+  }
+
+#if defined(__linux__)
+  // a socket sharing its port with the other sockets of the group
+  static int openReusePortSocket (uv_udp_t *handle, int family) {
+    auto fd = socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int enabled = 1;
+    int err = 0;
+
+    if (fd < 0) {
+      return uv_translate_sys_error(errno);
+    }
+
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enabled, sizeof(enabled)) < 0) {
+      err = uv_translate_sys_error(errno);
+    } else {
+      err = uv_udp_open(handle, fd);
+    }
+
+    if (err < 0) {
+      ::close(fd);
+    }
+
+    return err;
+  }
+
+  // picks the socket of the group by the CPU that received the datagram,
+  // the group has a socket per receiver in the order they were bound
+  static bool attachReceiveSteering (uv_udp_t *handle, size_t count) {
+    uv_os_fd_t fd;
+    struct sock_filter code[] = {
+      { BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t) (SKF_AD_OFF + SKF_AD_CPU) },
+      { BPF_ALU | BPF_MOD | BPF_K, 0, 0, (uint32_t) count },
+      { BPF_RET | BPF_A, 0, 0, 0 }
+    };
+
+    struct sock_fprog program = {
+      (unsigned short) (sizeof(code) / sizeof(code[0])),
+      code
+    };
+
+    return (
+      uv_fileno((uv_handle_t *) handle, &fd) == 0 &&
+      setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program)) == 0
+    );
+  }
+
+  static bool addSocketDrops (uv_handle_t *handle, uint64_t &drops) {
+    uv_os_fd_t fd;
+    uint32_t meminfo[SK_MEMINFO_VARS] = {0};
+    socklen_t size = sizeof(meminfo);
+
+    if (
+      uv_fileno(handle, &fd) == 0 &&
+      getsockopt(fd, SOL_SOCKET, SO_MEMINFO, meminfo, &size) == 0 &&
+      size > SK_MEMINFO_DROPS * sizeof(uint32_t)
+    ) {
+      drops += meminfo[SK_MEMINFO_DROPS];
+      return true;
+    }
+
+    return false;
+  }
+
+  // called on the thread of the receiver
+  static void onReceiverRead (
+    uv_udp_t *handle,
+    ssize_t nread,
+    const uv_buf_t *buf,
+    const struct sockaddr *addr,
+    unsigned flags
+  ) {
+    auto receiver = (Peer::Receiver *) handle->data;
+    auto peer = receiver->peer;
+    Peer::ReceivedDatagram datagram;
+
+    if (nread < 0) {
+      peer->counters.receiveErrors++;
+      return;
+    }
+
+    if (nread == 0 || addr == nullptr) {
+      return;
+    }
+
+    datagram.nread = nread;
+    datagram.timestamp = getRealtime();
+    datagram.buf = uv_buf_init(new char[nread], (unsigned int) nread);
+    memcpy(datagram.buf.base, buf->base, nread);
+    memcpy(
+      &datagram.addr,
+      addr,
+      addr->sa_family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in)
+    );
+
+    do {
+      std::lock_guard lock(peer->receivedMutex);
+
+      if (peer->received.size() >= UDP_RECEIVED_QUEUE_SIZE) {
+        peer->counters.receiveQueueDrops++;
+        delete [] datagram.buf.base;
+        return;
+      }
+
+      peer->received.push_back(datagram);
+    } while (0);
+
+    uv_async_send(peer->receivedAsync);
+  }
+
+  // called on the thread of the receiver when it should start or stop
+  // reading or close
+  static void onReceiverControl (uv_async_t *async) {
+    auto receiver = (Peer::Receiver *) async->data;
+    auto handle = &receiver->handle;
+
+    if (receiver->closing) {
+      uv_close((uv_handle_t *) handle, nullptr);
+      uv_close((uv_handle_t *) async, nullptr);
+      return;
+    }
+
+    if (!receiver->reading) {
+      uv_udp_recv_stop(handle);
+      return;
+    }
+
+    if (!uv_is_active((uv_handle_t *) handle)) {
+      uv_udp_recv_start(handle, [](uv_handle_t *handle, size_t size, uv_buf_t *buf) {
+        auto receiver = (Peer::Receiver *) handle->data;
+        *buf = uv_buf_init(receiver->buffer, sizeof(receiver->buffer));
+      }, onReceiverRead);
+    }
+  }
+
+  static void closeReceiver (Peer::Receiver *receiver) {
+    receiver->closing = true;
+    uv_async_send(&receiver->control);
+
+    if (receiver->thread.joinable()) {
+      receiver->thread.join();
+    } else {
+      // never started, the handles are closed here
+      uv_run(&receiver->loop, UV_RUN_DEFAULT);
+    }
+
+    uv_loop_close(&receiver->loop);
+    delete receiver;
+  }
+#endif
+
+#if defined(__linux__)
+  static void onReceiveOffloadPoll (uv_poll_t *poll, int status, int events) {
+    auto peer = (Peer *) poll->data;
+    uv_os_fd_t fd;
+
+    if (status < 0) {
+      onReceive(peer, status, nullptr, nullptr, 0);
+      return;
+    }
+
+    if (uv_fileno((uv_handle_t *) poll, &fd)) {
+      return;
+    }
+
+    // bounded like the libuv receive loop so a busy peer
+    // cannot starve the rest of the event loop
+    for (int i = 0; i < 32 && peer->receiveOffloadPoll == poll; ++i) {
+      char control[
+        CMSG_SPACE(sizeof(int)) +
+        CMSG_SPACE(sizeof(uint32_t)) +
+        CMSG_SPACE(sizeof(struct timespec))
+      ] = {0};
+      struct sockaddr_storage addr = {0};
+      struct msghdr msg = {0};
+      struct iovec iov;
+      auto base = new char[UDP_RECEIVE_OFFLOAD_BUFFER_SIZE];
+      int segmentSize = 0;
+      uint64_t timestamp = 0;
+
+      iov.iov_base = base;
+      iov.iov_len = UDP_RECEIVE_OFFLOAD_BUFFER_SIZE;
+      msg.msg_name = &addr;
+      msg.msg_namelen = sizeof(addr);
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+
+      auto nread = recvmsg(fd, &msg, MSG_DONTWAIT);
+
+      if (nread <= 0) {
+        delete [] base;
+
+        if (nread == 0) {
+          continue;
+        }
+
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+          onReceive(peer, uv_translate_sys_error(errno), nullptr, nullptr, 0);
+        }
+
+        return;
+      }
+
+      for (
+        auto cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg != nullptr;
+        cmsg = CMSG_NXTHDR(&msg, cmsg)
+      ) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+          memcpy(&segmentSize, CMSG_DATA(cmsg), sizeof(segmentSize));
+        }
+
+        // datagrams dropped on the socket so far, sent along once they are
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+          uint32_t drops = 0;
+          memcpy(&drops, CMSG_DATA(cmsg), sizeof(drops));
+          peer->counters.receiveOverflows = drops;
+        }
+
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+          struct timespec ts;
+          memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+          timestamp = (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+        }
+      }
+
+      if (segmentSize <= 0 || segmentSize >= nread) {
+        auto buf = uv_buf_init(base, (unsigned int) nread);
+        onReceive(peer, nread, &buf, (const struct sockaddr *) &addr, timestamp);
+        continue;
+      }
+
+      // split the coalesced datagram, each segment gets its own
+      // allocation because the receiver takes ownership of `buf->base`
+      for (ssize_t offset = 0; offset < nread; offset += segmentSize) {
+        auto length = std::min((ssize_t) segmentSize, nread - offset);
+        auto buf = uv_buf_init(new char[length], (unsigned int) length);
+        memcpy(buf.base, base + offset, length);
+        onReceive(peer, length, &buf, (const struct sockaddr *) &addr, timestamp);
+      }
+
+      delete [] base;
+    }
+  }
+#endif
+
+  // libuv references the handle of a peer until it closed, so a peer
+  // dropped from the registry is closed first and its close callback holds
+  // the last reference until then
+  static void closeRemovedPeer (PeerRegistry::Entry entry) {
+    if (entry != nullptr && !entry->isClosed()) {
+      entry->close([entry]() {});
+    }
+  }
+
+  PeerRegistry::Entry PeerRegistry::get (uint64_t id) {
+    auto& shard = this->shard(id);
+    std::shared_lock lock(shard.mutex);
+    auto it = shard.entries.find(id);
+    return it != shard.entries.end() ? it->second : nullptr;
+  }
+
+  PeerRegistry::Entry PeerRegistry::getOrCreate (uint64_t id, Factory create) {
+    auto& shard = this->shard(id);
+    Entry existing = nullptr;
+
+    do {
+      std::shared_lock lock(shard.mutex);
+      auto it = shard.entries.find(id);
+
+      if (it != shard.entries.end()) {
+        return it->second;
+      }
+    } while (0);
+
+    // created outside of the lock so a slow factory doesn't hold up the
+    // other peers of the shard
+    auto entry = create();
+
+    do {
+      std::unique_lock lock(shard.mutex);
+      auto result = shard.entries.try_emplace(id, entry);
+
+      if (result.second) {
+        return entry;
+      }
+
+      existing = result.first->second;
+    } while (0);
+
+    // another thread created the peer meanwhile
+    closeRemovedPeer(entry);
+    return existing;
+  }
+
+  PeerRegistry::Entry PeerRegistry::remove (uint64_t id) {
+    Entry entry = nullptr;
+
+    do {
+      auto& shard = this->shard(id);
+      std::unique_lock lock(shard.mutex);
+      auto it = shard.entries.find(id);
+
+      if (it == shard.entries.end()) {
+        return nullptr;
+      }
+
+      entry = std::move(it->second);
+      shard.entries.erase(it);
+    } while (0);
+
+    closeRemovedPeer(entry);
+    return entry;
+  }
+
+  bool PeerRegistry::remove (uint64_t id, const Peer* peer) {
+    Entry entry = nullptr;
+
+    do {
+      auto& shard = this->shard(id);
+      std::unique_lock lock(shard.mutex);
+      auto it = shard.entries.find(id);
+
+      // only remove `peer` itself, not a newer peer that reused its id
+      if (it == shard.entries.end() || it->second.get() != peer) {
+        return false;
+      }
+
+      entry = std::move(it->second);
+      shard.entries.erase(it);
+    } while (0);
+
+    // `entry` may hold the last reference, release it outside of the lock
+    return true;
+  }
+
+  bool PeerRegistry::has (uint64_t id) {
+    auto& shard = this->shard(id);
+    std::shared_lock lock(shard.mutex);
+    return shard.entries.contains(id);
+  }
+
+  size_t PeerRegistry::size () {
+    size_t size = 0;
+
+    for (auto& shard : this->shards) {
+      std::shared_lock lock(shard.mutex);
+      size += shard.entries.size();
+    }
+
+    return size;
+  }
+
+  void PeerRegistry::forEach (Visitor visitor) {
+    // visit a snapshot of each shard so `visitor` may use the registry
+    for (auto& shard : this->shards) {
+      Vector<Entry> entries;
+
+      do {
+        std::shared_lock lock(shard.mutex);
+        entries.reserve(shard.entries.size());
+        for (const auto& tuple : shard.entries) {
+          entries.push_back(tuple.second);
+        }
+      } while (0);
+
+      for (const auto& entry : entries) {
+        visitor(entry);
+      }
+    }
+  }
+
   void Core::resumeAllPeers () {
     dispatchEventLoop([=, this]() {
-      Lock lock(this->peersMutex);
-      for (auto const &tuple : this->peers) {
-        auto peer = tuple.second;
+      this->peers.forEach([](auto peer) {
         if (peer != nullptr && (peer->isBound() || peer->isConnected())) {
           peer->resume();
         }
-      }
+      });
     });
   }
 
   void Core::pauseAllPeers () {
     dispatchEventLoop([=, this]() {
-      Lock lock(this->peersMutex);
-      for (auto const &tuple : this->peers) {
-        auto peer = tuple.second;
+      this->peers.forEach([](auto peer) {
         if (peer != nullptr && (peer->isBound() || peer->isConnected())) {
           peer->pause();
         }
-      }
+      });
     });
   }
 
   bool Core::hasPeer (uint64_t peerId) {
-    Lock lock(this->peersMutex);
-    return this->peers.find(peerId) != this->peers.end();
+    return this->peers.has(peerId);
   }
 
   void Core::removePeer (uint64_t peerId) {
@@ -35,49 +639,107 @@ namespace SSC {
   }
 
   void Core::removePeer (uint64_t peerId, bool autoClose) {
-    if (this->hasPeer(peerId)) {
-      if (autoClose) {
-        auto peer = this->getPeer(peerId);
-        if (peer != nullptr) {
-          peer->close();
-        }
+    if (autoClose) {
+      // the peer removes itself from the registry once its handle closed
+      if (auto peer = this->peers.get(peerId)) {
+        peer->close();
       }
 
-      Lock lock(this->peersMutex);
-      this->peers.erase(peerId);
+      return;
+    }
+
+    // the id is free right away, the handle is still closed
+    this->peers.remove(peerId);
+  }
+
+  std::shared_ptr<Peer> Core::getPeer (uint64_t peerId) {
+    return this->peers.get(peerId);
+  }
+
+  // queued TCP writes submitted together with `uv_write()`
+  struct WriteBatch {
+    uv_write_t req;
+    Peer *peer = nullptr;
+    Vector<Peer::WriteRequest> writes;
+    Vector<uv_buf_t> bufs;
+    size_t size = 0;
+  };
+
+  static void onWriteBatchComplete (uv_write_t *req, int status) {
+    auto batch = (WriteBatch *) req->data;
+    auto peer = batch->peer;
+
+    peer->writesInFlight--;
+
+    if (status < 0) {
+      peer->counters.sendErrors += batch->writes.size();
+    } else {
+      peer->counters.packetsSent += batch->writes.size();
+      peer->counters.bytesSent += batch->size;
+    }
+
+    for (const auto& write : batch->writes) {
+      write.cb(status, Post{});
+    }
+
+    delete batch;
+
+    // writes queued meanwhile go out in the next batch
+    if (peer->writesInFlight == 0) {
+      peer->flushWrites();
+    }
+  }
+
+  static void onTCPConnection (uv_stream_t *server, int status) {
+    auto peer = (Peer *) server->data;
+
+    if (peer->connectionCallback != nullptr) {
+      peer->connectionCallback(status);
     }
   }
 
-  Peer* Core::getPeer (uint64_t peerId) {
-    if (!this->hasPeer(peerId)) return nullptr;
-    Lock lock(this->peersMutex);
-    return this->peers.at(peerId);
+  static void onTCPRead (uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
+    auto peer = (Peer *) stream->data;
+
+    if (nread > 0) {
+      peer->counters.packetsReceived++;
+      peer->counters.bytesReceived += nread;
+    } else if (nread < 0) {
+      // libuv stopped reading
+      peer->removeState(PEER_STATE_TCP_READ_STARTED);
+
+      if (nread != UV_EOF) {
+        peer->counters.receiveErrors++;
+      }
+    }
+
+    if (peer->readCallback != nullptr) {
+      peer->readCallback(nread, buf);
+    } else if (buf != nullptr && buf->base != nullptr) {
+      peer->core->tcp.releaseBuffer(buf->base);
+    }
   }
 
-  Peer* Core::createPeer (peer_type_t peerType, uint64_t peerId) {
+  std::shared_ptr<Peer> Core::createPeer (peer_type_t peerType, uint64_t peerId) {
     return this->createPeer(peerType, peerId, false);
   }
 
-  Peer* Core::createPeer (
+  std::shared_ptr<Peer> Core::createPeer (
     peer_type_t peerType,
     uint64_t peerId,
     bool isEphemeral
   ) {
-    if (this->hasPeer(peerId)) {
-      auto peer = this->getPeer(peerId);
-      if (peer != nullptr) {
-        if (isEphemeral) {
-          Lock lock(peer->mutex);
-          peer->flags = (peer_flag_t) (peer->flags | PEER_FLAG_EPHEMERAL);
-        }
-      }
+    std::shared_ptr<Peer> created = nullptr;
+    auto peer = this->peers.getOrCreate(peerId, [&]() {
+      created = std::make_shared<Peer>(this, peerType, peerId, isEphemeral);
+      return created;
+    });
 
-      return peer;
+    if (peer != created && isEphemeral) {
+      Lock lock(peer->mutex);
+      peer->flags = (peer_flag_t) (peer->flags | PEER_FLAG_EPHEMERAL);
     }
 
-    auto peer = new Peer(this, peerType, peerId, isEphemeral);
-    Lock lock(this->peersMutex);
-    this->peers[peer->id] = peer;
     return peer;
   }
 
@@ -190,10 +852,6 @@ namespace SSC {
     this->init();
   }
 
-  Peer::~Peer () {
-    this->core->removePeer(this->id, true); // auto close
-  }
-
   int Peer::init () {
     Lock lock(this->mutex);
     auto loop = this->core->getEventLoop();
@@ -213,6 +871,7 @@ namespace SSC {
       this->handle.tcp.data = (void *) this;
     }
 
+    this->removeState(PEER_STATE_CLOSED);
     return err;
   }
 
@@ -342,20 +1001,54 @@ namespace SSC {
         return err;
       }
 
+    #if defined(__linux__)
+      // receivers join the port with `SO_REUSEPORT`, this socket too
+      if (this->options.udp.receivers > 1) {
+        if ((err = openReusePortSocket((uv_udp_t *) &this->handle, sockaddr->sa_family))) {
+          return err;
+        }
+      }
+    #endif
+
       // @TODO(jwerle): support flags in `bind()`
       if ((err = uv_udp_bind((uv_udp_t *) &this->handle, sockaddr, flags))) {
         return err;
       }
 
       this->addState(PEER_STATE_UDP_BOUND);
+
+      if (this->options.udp.segmentSize > 0) {
+        this->initSegmentationOffload();
+      }
+
+      if (this->options.udp.timestamps) {
+        this->initReceiveTimestamps();
+      }
     }
 
     if (this->isTCP()) {
-      // @TODO: `bind()` + `listen()?`
-    }
+      if ((err = uv_ip4_addr((char *) address.c_str(), port, &this->addr))) {
+        return err;
+      }
 
-    return this->initLocalPeerInfo();
-  }
+      // libuv sets `SO_REUSEADDR` on TCP sockets
+      if ((err = uv_tcp_bind((uv_tcp_t *) &this->handle, sockaddr, 0))) {
+        return err;
+      }
+
+      this->addState(PEER_STATE_TCP_BOUND);
+    }
+
+    if ((err = this->initLocalPeerInfo())) {
+      return err;
+    }
+
+    if (this->isUDP() && this->options.udp.receivers > 1) {
+      return this->initReceivers();
+    }
+
+    return 0;
+  }
 
   int Peer::rebind () {
     int err = 0;
@@ -397,11 +1090,70 @@ namespace SSC {
       }
 
       this->addState(PEER_STATE_UDP_CONNECTED);
+
+      if (this->options.udp.segmentSize > 0) {
+        this->initSegmentationOffload();
+      }
+
+      if (this->options.udp.timestamps) {
+        this->initReceiveTimestamps();
+      }
     }
 
     return this->initRemotePeerInfo();
   }
 
+  int Peer::connect (
+    const String address,
+    int port,
+    RequestContext::Callback cb
+  ) {
+    Lock lock(this->mutex);
+    auto sockaddr = (struct sockaddr*) &this->addr;
+    int err = 0;
+
+    if (!this->isTCP()) {
+      return UV_EINVAL;
+    }
+
+    if ((err = uv_ip4_addr((char *) address.c_str(), port, &this->addr))) {
+      return err;
+    }
+
+    // libuv applies both once the socket exists, before the handshake
+    this->setNoDelay(this->options.tcp.noDelay);
+    this->setKeepAlive(this->options.tcp.keepAlive, this->options.tcp.keepAliveDelay);
+
+    auto req = new uv_connect_t;
+    auto ctx = new RequestContext(cb);
+
+    ctx->peer = this;
+    req->data = (void *) ctx;
+
+    err = uv_tcp_connect(req, (uv_tcp_t *) &this->handle, sockaddr, [](uv_connect_t *req, int status) {
+      auto ctx = (RequestContext *) req->data;
+      auto peer = ctx->peer;
+
+      if (status == 0) {
+        peer->addState(PEER_STATE_TCP_CONNECTED);
+        peer->initLocalPeerInfo();
+        peer->initRemotePeerInfo();
+      }
+
+      ctx->cb(status, Post{});
+
+      delete ctx;
+      delete req;
+    });
+
+    if (err < 0) {
+      delete ctx;
+      delete req;
+    }
+
+    return err;
+  }
+
   int Peer::disconnect () {
     int err = 0;
 
@@ -421,12 +1173,903 @@ namespace SSC {
     return err;
   }
 
+  int Peer::listen (int backlog, TCPConnectionCallback cb) {
+    Lock lock(this->mutex);
+    int err = 0;
+
+    if (!this->isTCP() || !this->isBound()) {
+      return UV_EINVAL;
+    }
+
+    this->connectionCallback = cb;
+
+    if ((err = uv_listen((uv_stream_t *) &this->handle, backlog, onTCPConnection))) {
+      this->connectionCallback = nullptr;
+      return err;
+    }
+
+    this->addState(PEER_STATE_TCP_LISTENING);
+    return 0;
+  }
+
+  int Peer::accept (Peer *client) {
+    Lock lock(this->mutex);
+    Lock clientLock(client->mutex);
+    int err = 0;
+
+    if (!this->hasState(PEER_STATE_TCP_LISTENING) || !client->isTCP()) {
+      return UV_EINVAL;
+    }
+
+    if ((err = uv_accept((uv_stream_t *) &this->handle, (uv_stream_t *) &client->handle))) {
+      return err;
+    }
+
+    // accepted connections inherit the socket options of the listener
+    client->options.tcp = this->options.tcp;
+    client->setNoDelay(client->options.tcp.noDelay);
+    client->setKeepAlive(client->options.tcp.keepAlive, client->options.tcp.keepAliveDelay);
+    client->addState(PEER_STATE_TCP_CONNECTED);
+    client->initLocalPeerInfo();
+    client->initRemotePeerInfo();
+    return 0;
+  }
+
+  int Peer::setNoDelay (bool enabled) {
+    Lock lock(this->mutex);
+
+    if (!this->isTCP()) {
+      return UV_EINVAL;
+    }
+
+    this->options.tcp.noDelay = enabled;
+    return uv_tcp_nodelay((uv_tcp_t *) &this->handle, enabled);
+  }
+
+  int Peer::setKeepAlive (bool enabled, unsigned int delay) {
+    Lock lock(this->mutex);
+
+    if (!this->isTCP() || (enabled && delay == 0)) {
+      return UV_EINVAL;
+    }
+
+    this->options.tcp.keepAlive = enabled;
+    this->options.tcp.keepAliveDelay = delay;
+    return uv_tcp_keepalive((uv_tcp_t *) &this->handle, enabled, delay);
+  }
+
+  void Peer::write (char *buf, size_t size, RequestContext::Callback cb) {
+    Lock lock(this->mutex);
+
+    if (!this->isTCP() || !this->isConnected()) {
+      this->counters.sendErrors++;
+      return cb(UV_ENOTCONN, Post{});
+    }
+
+    if (this->isClosing() || this->hasState(PEER_STATE_TCP_SHUTDOWN)) {
+      this->counters.sendErrors++;
+      return cb(UV_EPIPE, Post{});
+    }
+
+    this->writeQueue.push_back(WriteRequest { buf, size, cb });
+    this->writeQueueBytes += size;
+
+    // otherwise the write waits for the batch in flight and goes out
+    // with the other writes queued meanwhile
+    if (this->writesInFlight == 0) {
+      this->flushWrites();
+    }
+  }
+
+  void Peer::flushWrites () {
+    Lock lock(this->mutex);
+
+    if (this->writeQueue.size() == 0 || this->isClosing()) {
+      return;
+    }
+
+    auto batch = new WriteBatch;
+    auto count = std::min(this->writeQueue.size(), TCP_MAX_WRITE_BATCH);
+
+    batch->peer = this;
+    batch->req.data = (void *) batch;
+    batch->writes.reserve(count);
+    batch->bufs.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+      auto& write = this->writeQueue.front();
+      batch->bufs.push_back(uv_buf_init(write.buf, (unsigned int) write.size));
+      batch->size += write.size;
+      batch->writes.push_back(std::move(write));
+      this->writeQueue.pop_front();
+    }
+
+    this->writeQueueBytes -= batch->size;
+    this->writesInFlight++;
+
+    auto err = uv_write(
+      &batch->req,
+      (uv_stream_t *) &this->handle,
+      batch->bufs.data(),
+      (unsigned int) batch->bufs.size(),
+      onWriteBatchComplete
+    );
+
+    if (err < 0) {
+      this->writesInFlight--;
+      this->counters.sendErrors += batch->writes.size();
+
+      for (const auto& write : batch->writes) {
+        write.cb(err, Post{});
+      }
+
+      delete batch;
+    }
+  }
+
+  void Peer::cancelWrites () {
+    Lock lock(this->mutex);
+    auto writes = std::move(this->writeQueue);
+
+    this->writeQueue.clear();
+    this->writeQueueBytes = 0;
+    this->counters.sendErrors += writes.size();
+
+    for (const auto& write : writes) {
+      write.cb(UV_ECANCELED, Post{});
+    }
+  }
+
+  int Peer::readstart (TCPReadCallback onread) {
+    Lock lock(this->mutex);
+    int err = 0;
+
+    if (!this->isTCP() || !this->isConnected()) {
+      return UV_ENOTCONN;
+    }
+
+    this->readCallback = onread;
+
+    if (this->hasState(PEER_STATE_TCP_READ_STARTED)) {
+      return 0;
+    }
+
+    err = uv_read_start(
+      (uv_stream_t *) &this->handle,
+      [](uv_handle_t *handle, size_t size, uv_buf_t *buf) {
+        auto peer = (Peer *) handle->data;
+        auto base = peer->core->tcp.acquireBuffer();
+        *buf = uv_buf_init(base, Core::TCP::READ_BUFFER_SIZE);
+      },
+      onTCPRead
+    );
+
+    if (err < 0) {
+      this->readCallback = nullptr;
+      return err;
+    }
+
+    this->addState(PEER_STATE_TCP_READ_STARTED);
+    return 0;
+  }
+
+  int Peer::readstop () {
+    Lock lock(this->mutex);
+    int err = 0;
+
+    if (!this->isTCP()) {
+      return UV_EINVAL;
+    }
+
+    if (this->hasState(PEER_STATE_TCP_READ_STARTED)) {
+      if ((err = uv_read_stop((uv_stream_t *) &this->handle))) {
+        return err;
+      }
+
+      this->removeState(PEER_STATE_TCP_READ_STARTED);
+    }
+
+    this->readCallback = nullptr;
+    return 0;
+  }
+
+  int Peer::shutdown (RequestContext::Callback cb) {
+    Lock lock(this->mutex);
+    int err = 0;
+
+    if (!this->isTCP() || !this->isConnected()) {
+      return UV_ENOTCONN;
+    }
+
+    if (this->isClosing() || this->hasState(PEER_STATE_TCP_SHUTDOWN)) {
+      return UV_EPIPE;
+    }
+
+    // `uv_shutdown()` waits for submitted writes, queued writes are
+    // submitted now so they go out before the FIN
+    while (this->writeQueue.size() > 0) {
+      this->flushWrites();
+    }
+
+    auto req = new uv_shutdown_t;
+    auto ctx = new RequestContext(cb);
+
+    ctx->peer = this;
+    req->data = (void *) ctx;
+
+    err = uv_shutdown(req, (uv_stream_t *) &this->handle, [](uv_shutdown_t *req, int status) {
+      auto ctx = (RequestContext *) req->data;
+      ctx->cb(status, Post{});
+      delete ctx;
+      delete req;
+    });
+
+    if (err < 0) {
+      delete ctx;
+      delete req;
+      return err;
+    }
+
+    this->addState(PEER_STATE_TCP_SHUTDOWN);
+    return 0;
+  }
+
+  int Peer::initSegmentationOffload () {
+    Lock lock(this->mutex);
+    auto segmentSize = this->options.udp.segmentSize;
+
+    if (!this->isUDP()) {
+      return UV_EINVAL;
+    }
+
+  #if defined(__linux__)
+    uv_os_fd_t fd;
+    int enabled = segmentSize > 0 ? 1 : 0;
+    int size = (int) segmentSize;
+    int err = 0;
+
+    if ((err = uv_fileno((uv_handle_t *) &this->handle, &fd))) {
+      return err;
+    }
+
+    // kernels without UDP_SEGMENT (< 4.18) or UDP_GRO (< 5.0) reject these
+    // options, sends then fall back to one `uv_udp_send()` per segment and
+    // receives go through `uv_udp_recv_start()` as usual
+    this->hasSegmentationOffload = (
+      setsockopt(fd, SOL_UDP, UDP_SEGMENT, &size, sizeof(size)) == 0 &&
+      enabled
+    );
+
+    this->hasReceiveOffload = (
+      setsockopt(fd, SOL_UDP, UDP_GRO, &enabled, sizeof(enabled)) == 0 &&
+      enabled
+    );
+
+    // the receive offload path reads the drop count from every datagram
+    int overflows = 1;
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &overflows, sizeof(overflows));
+  #endif
+
+    return 0;
+  }
+
+  int Peer::setSegmentSize (size_t segmentSize) {
+    Lock lock(this->mutex);
+
+    if (segmentSize > UDP_MAX_PAYLOAD_SIZE) {
+      return UV_EINVAL;
+    }
+
+    this->options.udp.segmentSize = segmentSize;
+
+    // applied in `bind()` or `connect()` when the socket is not open yet
+    if (this->isBound() || this->isConnected()) {
+      return this->initSegmentationOffload();
+    }
+
+    return 0;
+  }
+
+  int Peer::initReceivers () {
+    Lock lock(this->mutex);
+
+  #if defined(__linux__)
+    auto count = std::min(this->options.udp.receivers, UDP_MAX_RECEIVERS);
+    struct sockaddr_storage addr;
+    int namelen = sizeof(addr);
+    int err = 0;
+
+    this->closeReceivers();
+
+    if ((err = uv_udp_getsockname((uv_udp_t *) &this->handle, (struct sockaddr *) &addr, &namelen))) {
+      return err;
+    }
+
+    this->receivedAsync = new uv_async_t;
+    uv_async_init(this->core->getEventLoop(), this->receivedAsync, onReceived);
+    this->receivedAsync->data = (void *) this;
+
+    // the address this peer was bound to, with the port the kernel picked
+    // when it was bound to port `0`
+    for (size_t i = 1; i < count; ++i) {
+      auto receiver = new Receiver;
+
+      receiver->peer = this;
+      uv_loop_init(&receiver->loop);
+      uv_udp_init(&receiver->loop, &receiver->handle);
+      uv_async_init(&receiver->loop, &receiver->control, onReceiverControl);
+      receiver->handle.data = (void *) receiver;
+      receiver->control.data = (void *) receiver;
+
+      if (
+        (err = openReusePortSocket(&receiver->handle, addr.ss_family)) ||
+        (err = uv_udp_bind(&receiver->handle, (struct sockaddr *) &addr, 0))
+      ) {
+        // fewer receivers than asked for, the peer still reads the port
+        closeReceiver(receiver);
+        break;
+      }
+
+      receiver->thread = std::thread([receiver]() {
+        uv_run(&receiver->loop, UV_RUN_DEFAULT);
+      });
+
+      this->receivers.push_back(receiver);
+    }
+
+    if (this->options.udp.steering == PEER_RECEIVE_STEERING_CPU && this->receivers.size() > 0) {
+      this->hasReceiveSteering = attachReceiveSteering(
+        (uv_udp_t *) &this->handle,
+        this->receivers.size() + 1
+      );
+    }
+
+    if (this->hasState(PEER_STATE_UDP_RECV_STARTED)) {
+      setReceiversReading(this, true);
+    }
+  #endif
+
+    return 0;
+  }
+
+  void Peer::closeReceivers () {
+    Lock lock(this->mutex);
+
+  #if defined(__linux__)
+    for (auto receiver : this->receivers) {
+      closeReceiver(receiver);
+    }
+  #endif
+
+    this->receivers.clear();
+    this->hasReceiveSteering = false;
+
+    if (this->receivedAsync != nullptr) {
+      auto async = this->receivedAsync;
+      this->receivedAsync = nullptr;
+      uv_close((uv_handle_t *) async, [](uv_handle_t *handle) {
+        delete (uv_async_t *) handle;
+      });
+    }
+
+    std::lock_guard receivedLock(this->receivedMutex);
+
+    for (auto& datagram : this->received) {
+      delete [] datagram.buf.base;
+    }
+
+    this->received.clear();
+  }
+
+  int Peer::initReceiveTimestamps () {
+    Lock lock(this->mutex);
+
+    if (!this->isUDP()) {
+      return UV_EINVAL;
+    }
+
+  #if defined(__linux__)
+    uv_os_fd_t fd;
+    int enabled = this->options.udp.timestamps ? 1 : 0;
+    int err = 0;
+
+    if ((err = uv_fileno((uv_handle_t *) &this->handle, &fd))) {
+      return err;
+    }
+
+    // elsewhere datagrams are timestamped when they are read
+    this->hasReceiveTimestamps = (
+      setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enabled, sizeof(enabled)) == 0 &&
+      enabled
+    );
+  #endif
+
+    return 0;
+  }
+
+  int Peer::setReceiveTimestamps (bool enabled) {
+    Lock lock(this->mutex);
+    auto receiving = this->hasState(PEER_STATE_UDP_RECV_STARTED);
+    int err = 0;
+
+    this->options.udp.timestamps = enabled;
+
+    // applied in `bind()` or `connect()` when the socket is not open yet
+    if (!this->isBound() && !this->isConnected()) {
+      return 0;
+    }
+
+    // timestamps change how the socket is read
+    if (receiving && (err = this->recvstop())) {
+      return err;
+    }
+
+    if ((err = this->initReceiveTimestamps())) {
+      return err;
+    }
+
+    if (receiving) {
+      return this->recvstart();
+    }
+
+    return 0;
+  }
+
+  int Peer::ping (const String address, int port, uint64_t timeout, PingCallback cb) {
+    Lock lock(this->mutex);
+    RTTProbe probe;
+
+    if (!this->options.udp.timestamps) {
+      return UV_EINVAL;
+    }
+
+    auto ping = new PendingPing;
+    auto bytes = new char[RTTProbe::BYTES];
+
+    ping->peer = this;
+    ping->nonce = rand64();
+    ping->cb = cb;
+
+    uv_timer_init(this->core->getEventLoop(), &ping->timer);
+    ping->timer.data = (void *) ping;
+    uv_timer_start(&ping->timer, [](uv_timer_t *handle) {
+      auto ping = (PendingPing *) handle->data;
+      failPendingPing(ping->peer, ping->nonce, UV_ETIMEDOUT);
+    }, timeout, 0);
+
+    this->pings[ping->nonce] = ping;
+
+    probe.type = RTTProbe::PING;
+    probe.nonce = ping->nonce;
+    probe.timestamp = getRealtime();
+    probe.encode(bytes);
+
+    // not held back by the send queue or pacing, that would be measured
+    auto nonce = ping->nonce;
+    this->submitSend(bytes, RTTProbe::BYTES, port, address, [this, bytes, nonce](int status, auto post) {
+      delete [] bytes;
+
+      if (status < 0) {
+        failPendingPing(this, nonce, status);
+      }
+    });
+
+    return 0;
+  }
+
+  void Peer::onProbe (
+    const RTTProbe& probe,
+    const struct sockaddr *addr,
+    uint64_t timestamp
+  ) {
+    char address[17] = {0};
+    int port = 0;
+
+    parseAddress((struct sockaddr *) addr, &port, address);
+
+    if (probe.type == RTTProbe::PING) {
+      auto bytes = new char[RTTProbe::BYTES];
+      auto now = getRealtime();
+      auto pong = probe;
+
+      // how long the ping waited to be read, left out of the RTT
+      pong.type = RTTProbe::PONG;
+      pong.delay = now > timestamp ? now - timestamp : 0;
+      pong.encode(bytes);
+
+      this->submitSend(bytes, RTTProbe::BYTES, port, address, [bytes](int status, auto post) {
+        delete [] bytes;
+      });
+
+      return;
+    }
+
+    PingCallback cb = nullptr;
+    RTTEstimator estimate;
+    uint64_t rtt = 0;
+
+    do {
+      Lock lock(this->mutex);
+      auto it = this->pings.find(probe.nonce);
+
+      if (it == this->pings.end()) {
+        return;
+      }
+
+      // a sample from a clock that stepped back is not usable
+      if (timestamp < probe.timestamp + probe.delay) {
+        return;
+      }
+
+      auto ping = it->second;
+      auto& estimator = this->rtt[String(address) + ":" + std::to_string(port)];
+
+      rtt = (timestamp - probe.timestamp - probe.delay) / 1000;
+      estimator.update(rtt, uv_hrtime() / 1000);
+      estimate = estimator;
+
+      this->pings.erase(it);
+      cb = ping->cb;
+      closePendingPing(ping);
+    } while (0);
+
+    cb(0, rtt, estimate);
+  }
+
+  uint64_t Peer::getReceiveDrops () {
+    Lock lock(this->mutex);
+    uint64_t drops = this->counters.receiveQueueDrops;
+
+  #if defined(__linux__)
+    // `SO_RXQ_OVFL` only reports on received datagrams and
+    // `uv_udp_recv_start()` does not surface control messages, the socket
+    // memory info has the same count at any time on recent kernels
+    if (addSocketDrops((uv_handle_t *) &this->handle, drops)) {
+      for (auto receiver : this->receivers) {
+        addSocketDrops((uv_handle_t *) &receiver->handle, drops);
+      }
+
+      return drops;
+    }
+  #endif
+
+    return drops + this->counters.receiveOverflows;
+  }
+
+  size_t Peer::getReceiveQueueSize () {
+  #if defined(__linux__)
+    uv_os_fd_t fd;
+    uint32_t meminfo[SK_MEMINFO_VARS] = {0};
+    socklen_t size = sizeof(meminfo);
+
+    if (
+      uv_fileno((uv_handle_t *) &this->handle, &fd) == 0 &&
+      getsockopt(fd, SOL_SOCKET, SO_MEMINFO, meminfo, &size) == 0 &&
+      size > SK_MEMINFO_RMEM_ALLOC * sizeof(uint32_t)
+    ) {
+      return meminfo[SK_MEMINFO_RMEM_ALLOC];
+    }
+  #elif defined(__APPLE__)
+    uv_os_fd_t fd;
+    int queued = 0;
+
+    // all queued datagrams, where on Linux `FIONREAD` is just the next one
+    if (
+      uv_fileno((uv_handle_t *) &this->handle, &fd) == 0 &&
+      ioctl(fd, FIONREAD, &queued) == 0
+    ) {
+      return queued;
+    }
+  #endif
+
+    return 0;
+  }
+
+  size_t Peer::getReceiveBufferSize () {
+    int value = 0;
+
+    if (uv_recv_buffer_size((uv_handle_t *) &this->handle, &value) != 0) {
+      return 0;
+    }
+
+    return value;
+  }
+
+  size_t Peer::setReceiveBufferSize (size_t size) {
+  #if defined(__linux__)
+    // the kernel doubles the requested size for its bookkeeping and
+    // reports the doubled size back
+    int value = (int) ((size + 1) / 2);
+  #else
+    int value = (int) size;
+  #endif
+
+    if (value > 0) {
+      uv_recv_buffer_size((uv_handle_t *) &this->handle, &value);
+    }
+
+    return this->getReceiveBufferSize();
+  }
+
+  size_t Peer::getSendQueueSize () {
+    Lock lock(this->mutex);
+    return uv_udp_get_send_queue_size((uv_udp_t *) &this->handle) + this->sendQueueBytes;
+  }
+
+  size_t Peer::getSendQueueCount () {
+    Lock lock(this->mutex);
+    return uv_udp_get_send_queue_count((uv_udp_t *) &this->handle) + this->sendQueue.size();
+  }
+
+  bool Peer::isSendQueueFull (size_t size) {
+    Lock lock(this->mutex);
+    auto& limits = this->options.udp.sendQueue;
+    auto count = this->getSendQueueCount();
+
+    // a single datagram larger than `maxBytes` still goes out on its own
+    if (limits.maxBytes > 0 && count > 0) {
+      if (this->getSendQueueSize() + size > limits.maxBytes) {
+        return true;
+      }
+    }
+
+    return limits.maxCount > 0 && count + 1 > limits.maxCount;
+  }
+
+  void Peer::flushSendQueue () {
+    Lock lock(this->mutex);
+
+    if (this->isClosing() || this->isClosed() || this->isPaused()) {
+      return;
+    }
+
+    while (this->sendQueue.size() > 0) {
+      auto request = std::move(this->sendQueue.front());
+      this->sendQueue.pop_front();
+      this->sendQueueBytes -= request.size;
+
+      // held back by the send queue limits, a completed send flushes
+      if (this->isSendQueueFull(request.size)) {
+        this->sendQueueBytes += request.size;
+        this->sendQueue.push_front(std::move(request));
+        break;
+      }
+
+      if (!this->congestion.consumePacingTokens(request.size, uv_hrtime() / 1000)) {
+        this->sendQueueBytes += request.size;
+        this->sendQueue.push_front(std::move(request));
+        this->schedulePacing();
+        break;
+      }
+
+      this->submitSend(
+        request.buf,
+        request.size,
+        request.port,
+        request.address,
+        request.cb
+      );
+    }
+  }
+
+  void Peer::cancelSendQueue () {
+    Lock lock(this->mutex);
+    auto requests = std::move(this->sendQueue);
+
+    this->sendQueue.clear();
+    this->sendQueueBytes = 0;
+
+    for (const auto& request : requests) {
+      this->counters.sendErrors++;
+      request.cb(UV_ECANCELED, Post{});
+    }
+  }
+
+  void Peer::setCongestionControl (bool enabled, double maxPacingRate) {
+    Lock lock(this->mutex);
+
+    if (enabled && !this->congestion.enabled) {
+      this->congestion.reset();
+    }
+
+    this->congestion.enabled = enabled;
+    this->congestion.maxPacingRate = maxPacingRate;
+
+    // sends held back at the old rate go out at the new one
+    if (this->pacingTimer != nullptr) {
+      uv_timer_stop(this->pacingTimer);
+    }
+
+    this->flushSendQueue();
+  }
+
+  void Peer::setBufferTuning (
+    bool enabled,
+    size_t minSize,
+    size_t maxSize,
+    uint64_t interval,
+    BufferTuningCallback cb
+  ) {
+    Lock lock(this->mutex);
+    auto& tuner = this->bufferTuner;
+
+    if (!enabled) {
+      tuner.enabled = false;
+      this->onBufferTuning = nullptr;
+
+      if (this->bufferTuningTimer != nullptr) {
+        uv_timer_stop(this->bufferTuningTimer);
+      }
+
+      return;
+    }
+
+    auto sample = getReceiveBufferSample(this);
+
+    if (!tuner.enabled) {
+      tuner.reset(sample);
+      tuner.minSize = sample.size;
+    }
+
+    if (minSize > 0) {
+      tuner.minSize = minSize;
+    }
+
+    tuner.maxSize = maxSize > 0 ? maxSize : ReceiveBufferTuner::DEFAULT_MAX_SIZE;
+    tuner.interval = interval > 0 ? interval : ReceiveBufferTuner::DEFAULT_INTERVAL;
+    tuner.enabled = true;
+    this->onBufferTuning = cb;
+
+    if (this->bufferTuningTimer == nullptr) {
+      this->bufferTuningTimer = new uv_timer_t;
+      uv_timer_init(this->core->getEventLoop(), this->bufferTuningTimer);
+      this->bufferTuningTimer->data = (void *) this;
+    }
+
+    // restarts with the new interval when already running
+    uv_timer_start(this->bufferTuningTimer, [](uv_timer_t *handle) {
+      auto peer = (Peer *) handle->data;
+      peer->tuneReceiveBuffer();
+    }, tuner.interval, tuner.interval);
+  }
+
+  void Peer::tuneReceiveBuffer () {
+    BufferTuningCallback cb = nullptr;
+    JSON::Object::Entries data;
+
+    do {
+      Lock lock(this->mutex);
+      auto& tuner = this->bufferTuner;
+
+      if (!tuner.enabled || this->isClosing() || this->isClosed()) {
+        return;
+      }
+
+      auto sample = getReceiveBufferSample(this);
+      auto decision = tuner.update(sample);
+
+      if (decision.action == ReceiveBufferTuner::NONE) {
+        return;
+      }
+
+      auto size = this->setReceiveBufferSize(decision.size);
+      auto capped = decision.action == ReceiveBufferTuner::GROW && size < decision.size;
+
+      if (capped) {
+        tuner.onCapped(size);
+      }
+
+      data = JSON::Object::Entries {
+        {"id", std::to_string(this->id)},
+        {"action", ReceiveBufferTuner::getActionName(decision.action)},
+        {"size", (uint64_t) size},
+        {"previousSize", (uint64_t) sample.size},
+        {"limit", (uint64_t) tuner.getLimit()},
+        {"capped", capped},
+        {"drops", decision.drops},
+        {"occupancy", decision.occupancy}
+      };
+
+      cb = this->onBufferTuning;
+    } while (0);
+
+    // called without the peer lock, it may reconfigure the tuner
+    if (cb != nullptr) {
+      cb(data);
+    }
+  }
+
+  void Peer::schedulePacing () {
+    Lock lock(this->mutex);
+
+    if (this->sendQueue.size() == 0 || this->isClosing() || this->isClosed()) {
+      return;
+    }
+
+    auto now = uv_hrtime() / 1000;
+    auto delay = this->congestion.getPacingDelay(this->sendQueue.front().size, now);
+
+    // the tokens refilled since the send was held back, or it is held
+    // back by the send queue limits and a completed send flushes
+    if (delay == 0) {
+      return this->flushSendQueue();
+    }
+
+    if (this->pacingTimer == nullptr) {
+      this->pacingTimer = new uv_timer_t;
+      uv_timer_init(this->core->getEventLoop(), this->pacingTimer);
+      this->pacingTimer->data = (void *) this;
+    }
+
+    if (!uv_is_active((uv_handle_t *) this->pacingTimer)) {
+      // timers have millisecond resolution, the token bucket makes up
+      // for the rounding by releasing more sends per tick
+      uv_timer_start(this->pacingTimer, [](uv_timer_t *handle) {
+        auto peer = (Peer *) handle->data;
+        peer->flushSendQueue();
+      }, (delay + 999) / 1000, 0);
+    }
+  }
+
   void Peer::send (
     char *buf,
     size_t size,
     int port,
     const String address,
     Peer::RequestContext::Callback cb
+  ) {
+    Lock lock(this->mutex);
+    auto& limits = this->options.udp.sendQueue;
+
+    this->flushSendQueue();
+
+    if (this->isSendQueueFull(size)) {
+      if (
+        limits.policy == PEER_SEND_QUEUE_POLICY_REJECT ||
+        (
+          limits.policy == PEER_SEND_QUEUE_POLICY_BLOCK &&
+          this->sendQueue.size() >= UDP_MAX_BLOCKED_SENDS
+        )
+      ) {
+        this->counters.sendErrors++;
+        return cb(UV_EAGAIN, Post{});
+      }
+
+      if (limits.policy == PEER_SEND_QUEUE_POLICY_DROP_OLDEST) {
+        while (this->sendQueue.size() > 0 && this->isSendQueueFull(size)) {
+          auto request = std::move(this->sendQueue.front());
+          this->sendQueue.pop_front();
+          this->sendQueueBytes -= request.size;
+          this->counters.sendErrors++;
+          request.cb(UV_ECANCELED, Post{});
+        }
+      }
+
+      this->sendQueueBytes += size;
+      this->sendQueue.push_back(SendRequest { buf, size, port, address, cb });
+      return;
+    }
+
+    // keep sends in order behind any that are already held back
+    if (
+      this->sendQueue.size() > 0 ||
+      !this->congestion.consumePacingTokens(size, uv_hrtime() / 1000)
+    ) {
+      this->sendQueueBytes += size;
+      this->sendQueue.push_back(SendRequest { buf, size, port, address, cb });
+      this->schedulePacing();
+      return;
+    }
+
+    this->submitSend(buf, size, port, address, cb);
+  }
+
+  void Peer::submitSend (
+    char *buf,
+    size_t size,
+    int port,
+    const String address,
+    Peer::RequestContext::Callback cb
   ) {
     Lock lock(this->mutex);
     int err = 0;
@@ -442,36 +2085,49 @@ namespace SSC {
       }
     }
 
-    auto buffer = uv_buf_init(buf, (int) size);
-    auto ctx = new Peer::RequestContext(cb);
-    auto req = new uv_udp_send_t;
-
-    req->data = (void *) ctx;
-    ctx->peer = this;
-
-    err = uv_udp_send(req, (uv_udp_t *) &this->handle, &buffer, 1, sockaddr, [](uv_udp_send_t *req, int status) {
-      auto ctx = reinterpret_cast<Peer::RequestContext*>(req->data);
-      auto peer = ctx->peer;
+    // a send larger than the segment size is split into batches: with GSO
+    // the kernel segments up to `UDP_MAX_SEGMENTS` per `sendmsg()`,
+    // otherwise every segment is a datagram of its own
+    auto segmentSize = this->options.udp.segmentSize;
+    auto batchSize = size;
 
-      ctx->cb(status, Post{});
+    if (segmentSize > 0 && size > segmentSize) {
+      batchSize = segmentSize;
 
-      if (peer->isEphemeral()) {
-        peer->close();
+      if (this->hasSegmentationOffload) {
+        batchSize *= std::min(UDP_MAX_SEGMENTS, UDP_MAX_PAYLOAD_SIZE / segmentSize);
       }
+    }
 
-      delete ctx;
-      delete req;
-    });
+    auto batches = batchSize > 0 ? (size + batchSize - 1) / batchSize : 1;
+    auto ctx = new Peer::RequestContext(cb);
 
-    if (err < 0) {
-      ctx->cb(err, Post{});
+    ctx->peer = this;
+    ctx->pending = batches;
+    ctx->size = size;
+    ctx->datagrams = segmentSize > 0 ? (size + segmentSize - 1) / segmentSize : 1;
+
+    for (size_t i = 0; i < batches; ++i) {
+      auto offset = i * batchSize;
+      auto length = std::min(batchSize, size - offset);
+      auto buffer = uv_buf_init(buf + offset, (unsigned int) length);
+      auto req = new uv_udp_send_t;
+
+      req->data = (void *) ctx;
+
+      err = uv_udp_send(req, (uv_udp_t *) &this->handle, &buffer, 1, sockaddr, [](uv_udp_send_t *req, int status) {
+        auto ctx = reinterpret_cast<Peer::RequestContext*>(req->data);
+        delete req;
+        onSendRequestComplete(ctx, status);
+      });
 
-      if (this->isEphemeral()) {
-        this->close();
+      if (err < 0) {
+        delete req;
+        // batches after this one are never queued
+        ctx->pending -= batches - i - 1;
+        onSendRequestComplete(ctx, err);
+        break;
       }
-
-      delete ctx;
-      delete req;
     }
   }
 
@@ -492,6 +2148,42 @@ namespace SSC {
 
     this->addState(PEER_STATE_UDP_RECV_STARTED);
     this->receiveCallback = receiveCallback;
+    setReceiversReading(this, true);
+
+  #if defined(__linux__)
+    if (this->hasReceiveOffload || this->hasReceiveTimestamps) {
+      auto loop = this->core->getEventLoop();
+      uv_os_fd_t fd;
+      int err = 0;
+
+      if ((err = uv_fileno((uv_handle_t *) &this->handle, &fd))) {
+        return err;
+      }
+
+      // `uv_udp_recv_start()` does not surface the UDP_GRO and timestamp
+      // control messages, so poll a duplicate descriptor and `recvmsg()`
+      // from it instead
+      if ((fd = dup(fd)) < 0) {
+        return uv_translate_sys_error(errno);
+      }
+
+      this->receiveOffloadPoll = new uv_poll_t;
+      this->receiveOffloadPoll->data = (void *) this;
+
+      if ((err = uv_poll_init(loop, this->receiveOffloadPoll, fd))) {
+        delete this->receiveOffloadPoll;
+        this->receiveOffloadPoll = nullptr;
+        ::close(fd);
+        return err;
+      }
+
+      return uv_poll_start(
+        this->receiveOffloadPoll,
+        UV_READABLE,
+        onReceiveOffloadPoll
+      );
+    }
+  #endif
 
     auto allocate = [](uv_handle_t *handle, size_t size, uv_buf_t *buf) {
       if (size > 0) {
@@ -514,7 +2206,7 @@ namespace SSC {
         return;
       }
 
-      peer->receiveCallback(nread, buf, addr);
+      onReceive(peer, nread, buf, addr, 0);
     };
 
     return uv_udp_recv_start((uv_udp_t *) &this->handle, allocate, receive);
@@ -525,13 +2217,39 @@ namespace SSC {
 
     if (this->hasState(PEER_STATE_UDP_RECV_STARTED)) {
       this->removeState(PEER_STATE_UDP_RECV_STARTED);
+      setReceiversReading(this, false);
       Lock lock(this->core->loopMutex);
-      err = uv_udp_recv_stop((uv_udp_t *) &this->handle);
+
+      if (this->receiveOffloadPoll != nullptr) {
+        closeReceiveOffloadPoll(this);
+      } else {
+        err = uv_udp_recv_stop((uv_udp_t *) &this->handle);
+      }
     }
 
     return err;
   }
 
+  // the handle of `peer` closed, the `onclose` callbacks may hold the last
+  // reference to it
+  static void onPeerClosed (Peer *peer) {
+    std::vector<std::function<void()>> callbacks;
+
+    do {
+      Lock lock(peer->mutex);
+      peer->addState(PEER_STATE_CLOSED);
+      callbacks.swap(peer->onclose);
+    } while (0);
+
+    for (const auto &onclose : callbacks) {
+      onclose();
+    }
+
+    // drops the registry reference, `peer` is freed here or with
+    // `callbacks` unless a caller still holds one from `Core::getPeer()`
+    peer->core->peers.remove(peer->id, peer);
+  }
+
   int Peer::resume () {
     int err = 0;
 
@@ -565,7 +2283,18 @@ namespace SSC {
       this->addState(PEER_STATE_UDP_PAUSED);
       if (this->isBound()) {
         Lock lock(this->mutex);
-        uv_close((uv_handle_t *) &this->handle, nullptr);
+        this->closeReceivers();
+        uv_close((uv_handle_t *) &this->handle, [](uv_handle_t *handle) {
+          auto peer = (Peer *) handle->data;
+          if (peer != nullptr) {
+            peer->addState(PEER_STATE_CLOSED);
+
+            // `close()` was called while the handle was closing
+            if (peer->onclose.size() > 0) {
+              onPeerClosed(peer);
+            }
+          }
+        });
       } else if (this->isConnected()) {
         // TODO
       }
@@ -580,22 +2309,60 @@ namespace SSC {
 
   void Peer::close (std::function<void()> onclose) {
     if (this->isClosed()) {
-      this->core->removePeer(this->id);
-      onclose();
+      this->core->peers.remove(this->id, this);
+      if (onclose != nullptr) {
+        onclose();
+      }
       return;
     }
 
-    if (onclose != nullptr) {
+    do {
       Lock lock(this->mutex);
-      this->onclose.push_back(onclose);
-    }
+      // never empty while closing, a handle closed by `pause()` then
+      // finishes the close once it closed
+      this->onclose.push_back(onclose != nullptr ? onclose : []() {});
+    } while (0);
 
     if (this->isClosing()) {
       return;
     }
 
+    if (this->type == PEER_TYPE_TCP) {
+      Lock lock(this->mutex);
+      this->cancelWrites();
+      this->connectionCallback = nullptr;
+      this->readCallback = nullptr;
+      // in flight writes fail with `UV_ECANCELED` before the close callback
+      uv_close((uv_handle_t*) &this->handle, [](uv_handle_t *handle) {
+        auto peer = (Peer *) handle->data;
+        if (peer != nullptr) {
+          peer->removeState((peer_state_t) (
+            PEER_STATE_TCP_BOUND |
+            PEER_STATE_TCP_CONNECTED |
+            PEER_STATE_TCP_LISTENING |
+            PEER_STATE_TCP_READ_STARTED |
+            PEER_STATE_TCP_SHUTDOWN
+          ));
+
+          onPeerClosed(peer);
+        }
+      });
+    }
+
     if (this->type == PEER_TYPE_UDP) {
       Lock lock(this->mutex);
+      this->cancelSendQueue();
+      this->bufferTuner.enabled = false;
+      this->onBufferTuning = nullptr;
+
+      for (const auto& entry : std::map(this->pings)) {
+        failPendingPing(this, entry.first, UV_ECANCELED);
+      }
+
+      closeTimer(this->pacingTimer);
+      closeTimer(this->bufferTuningTimer);
+      this->closeReceivers();
+      closeReceiveOffloadPoll(this);
       // reset state and set to CLOSED
       uv_close((uv_handle_t*) &this->handle, [](uv_handle_t *handle) {
         auto peer = (Peer *) handle->data;
@@ -606,11 +2373,7 @@ namespace SSC {
             PEER_STATE_UDP_RECV_STARTED
           ));
 
-          for (const auto &onclose : peer->onclose) {
-            onclose();
-          }
-
-          delete peer;
+          onPeerClosed(peer);
         }
       });
     }
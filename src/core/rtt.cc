@@ -0,0 +1,68 @@
+#include "rtt.hh"
+
+#include <cstring>
+
+namespace SSC {
+  static inline uint64_t readUInt64 (const unsigned char *bytes) {
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < 8; ++i) {
+      value = (value << 8) | bytes[i];
+    }
+
+    return value;
+  }
+
+  static inline void writeUInt64 (unsigned char *bytes, uint64_t value) {
+    for (size_t i = 8; i > 0; --i) {
+      bytes[i - 1] = (unsigned char) value;
+      value >>= 8;
+    }
+  }
+
+  void RTTEstimator::update (uint64_t rtt, uint64_t now) {
+    if (this->samples == 0) {
+      this->srtt = rtt;
+      this->rttvar = rtt / 2;
+      this->minRTT = rtt;
+    } else {
+      auto delta = this->srtt > rtt ? this->srtt - rtt : rtt - this->srtt;
+      this->rttvar = (3 * this->rttvar + delta) / 4;
+      this->srtt = (7 * this->srtt + rtt) / 8;
+      this->minRTT = std::min(this->minRTT, rtt);
+    }
+
+    this->latestRTT = rtt;
+    this->updatedAt = now;
+    this->samples++;
+  }
+
+  bool RTTProbe::decode (const char *bytes, size_t size, RTTProbe &probe) {
+    auto header = (const unsigned char *) bytes;
+
+    if (
+      bytes == nullptr ||
+      size != BYTES ||
+      memcmp(header, MAGIC_BYTES_PREFIX, 4) != 0
+    ) {
+      return false;
+    }
+
+    probe.type = header[4];
+    probe.nonce = readUInt64(header + 5);
+    probe.timestamp = readUInt64(header + 13);
+    probe.delay = readUInt64(header + 21);
+
+    return probe.type == PING || probe.type == PONG;
+  }
+
+  void RTTProbe::encode (char *bytes) const {
+    auto header = (unsigned char *) bytes;
+
+    memcpy(header, MAGIC_BYTES_PREFIX, 4);
+    header[4] = this->type;
+    writeUInt64(header + 5, this->nonce);
+    writeUInt64(header + 13, this->timestamp);
+    writeUInt64(header + 21, this->delay);
+  }
+}
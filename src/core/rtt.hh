@@ -0,0 +1,52 @@
+#ifndef SSC_CORE_RTT_HH
+#define SSC_CORE_RTT_HH
+
+#include "../common.hh"
+
+namespace SSC {
+  /**
+   * Smoothed round trip time to a remote address, estimated from answered
+   * probes like TCP does (RFC 6298). Times are in microseconds. Not
+   * synchronized, callers hold the lock of the owning peer.
+   */
+  class RTTEstimator {
+    public:
+      uint64_t srtt = 0;
+      uint64_t rttvar = 0;
+      uint64_t latestRTT = 0;
+      uint64_t minRTT = 0;
+      uint64_t samples = 0;
+      uint64_t updatedAt = 0;
+
+      void update (uint64_t rtt, uint64_t now);
+  };
+
+  /**
+   * A native RTT probe, answered by peers with receive timestamps enabled
+   * without a round trip through the webview. A ping carries the time it
+   * was sent and a pong echoes it with how long the responder held the
+   * ping, so the RTT only depends on the clock of the pinging peer. Times
+   * are nanoseconds since the epoch, taken by the kernel where supported.
+   */
+  struct RTTProbe {
+    // the 2nd, 4th, 5th, and 11th, prime numbers
+    static constexpr unsigned char MAGIC_BYTES_PREFIX[] = { 0x03, 0x07, 0x0b, 0x1f };
+    // magic, type, nonce, timestamp, delay
+    static constexpr size_t BYTES = 4 + 1 + 8 + 8 + 8;
+
+    enum Type : uint8_t {
+      PING = 1,
+      PONG = 2
+    };
+
+    uint8_t type = PING;
+    uint64_t nonce = 0;
+    uint64_t timestamp = 0;
+    uint64_t delay = 0;
+
+    static bool decode (const char *bytes, size_t size, RTTProbe &probe);
+    void encode (char *bytes) const;
+  };
+}
+
+#endif
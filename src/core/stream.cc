@@ -0,0 +1,1118 @@
+#include "core.hh"
+
+#include <cstring>
+
+namespace SSC {
+  constexpr uint8_t STREAM_FRAME_TYPE_DATA = 1;
+  constexpr uint8_t STREAM_FRAME_TYPE_ACK = 2;
+  constexpr uint8_t STREAM_FRAME_FLAG_FIN = 1 << 0;
+  // an ACK carries a bit per segment of the receive window after the
+  // acknowledged one as its payload, set for segments already received
+  constexpr uint32_t STREAM_SACK_BITS = Core::Stream::RECEIVE_WINDOW;
+
+  struct StreamFrame {
+    uint8_t type = 0;
+    uint8_t flags = 0;
+    uint64_t id = 0;
+    uint32_t seq = 0;
+    uint32_t window = 0;
+    const char *payload = nullptr;
+    size_t size = 0;
+  };
+
+  static inline uint64_t readUInt (const unsigned char *bytes, size_t size) {
+    uint64_t value = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+      value = (value << 8) | bytes[i];
+    }
+
+    return value;
+  }
+
+  static inline void writeUInt (unsigned char *bytes, size_t size, uint64_t value) {
+    for (size_t i = size; i > 0; --i) {
+      bytes[i - 1] = (unsigned char) value;
+      value >>= 8;
+    }
+  }
+
+  static void encodeStreamFrame (char *bytes, const StreamFrame &frame) {
+    auto header = (unsigned char *) bytes;
+
+    memcpy(header, Core::Stream::FRAME_MAGIC_BYTES_PREFIX, 4);
+    header[4] = frame.type;
+    header[5] = frame.flags;
+    writeUInt(header + 6, 8, frame.id);
+    writeUInt(header + 14, 4, frame.seq);
+    writeUInt(header + 18, 4, frame.window);
+    writeUInt(header + 22, 2, frame.size);
+  }
+
+  static bool decodeStreamFrame (const char *bytes, size_t size, StreamFrame &frame) {
+    auto header = (const unsigned char *) bytes;
+
+    if (
+      size < Core::Stream::FRAME_HEADER_BYTES ||
+      memcmp(header, Core::Stream::FRAME_MAGIC_BYTES_PREFIX, 4) != 0
+    ) {
+      return false;
+    }
+
+    frame.type = header[4];
+    frame.flags = header[5];
+    frame.id = readUInt(header + 6, 8);
+    frame.seq = (uint32_t) readUInt(header + 14, 4);
+    frame.window = (uint32_t) readUInt(header + 18, 4);
+    frame.size = (size_t) readUInt(header + 22, 2);
+    frame.payload = bytes + Core::Stream::FRAME_HEADER_BYTES;
+
+    return (
+      frame.size <= Core::Stream::SEGMENT_BYTES &&
+      frame.size <= size - Core::Stream::FRAME_HEADER_BYTES
+    );
+  }
+
+#if SSC_FAULT_INJECTION
+  static inline double randomRate () {
+    return (double) (rand64() % 1000000) / 1000000.0;
+  }
+#endif
+
+  static JSON::Object::Entries ERR_STREAM_NOT_FOUND (
+    const String& source,
+    uint64_t id
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"code", "NOT_FOUND_ERR"},
+        {"type", "NotFoundError"},
+        {"message", "No stream with specified id"}
+      }}
+    };
+  }
+
+  static JSON::Object::Entries ERR_STREAM (
+    const String& source,
+    uint64_t id,
+    const String& code,
+    const String& message
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"code", code},
+        {"message", message}
+      }}
+    };
+  }
+
+  /**
+   * A frame buffer from the stream buffer pool, holding a data segment or
+   * an ACK. Sends hold a reference so the buffer outlives retransmissions
+   * still queued in the kernel after the segment was acknowledged.
+   */
+  struct Core::Stream::Segment {
+    Stream *stream = nullptr;
+    char *bytes = nullptr;
+    size_t size = 0;
+    uint32_t seq = 0;
+    bool fin = false;
+    bool acked = false;
+    int transmissions = 0;
+    uint64_t sentAt = 0;
+    // microseconds, when the last transmission reached the socket, samples
+    // the RTT for congestion control without the time spent being paced
+    uint64_t submittedAt = 0;
+    // counted in the bytes in flight of the peer congestion controller
+    bool inFlight = false;
+    // position among all transmissions of the stream, orders sends for
+    // loss detection where the millisecond clock cannot
+    uint64_t sentOrder = 0;
+
+    Segment (Stream *stream) {
+      this->stream = stream;
+      this->bytes = stream->acquireBuffer();
+    }
+
+    ~Segment () {
+      this->stream->releaseBuffer(this->bytes);
+    }
+
+    size_t getFrameSize () const {
+      return FRAME_HEADER_BYTES + this->size;
+    }
+  };
+
+  struct Core::Stream::Connection {
+    struct PendingWrite {
+      uint32_t lastSeq = 0;
+      size_t size = 0;
+      String seq;
+      Module::Callback cb;
+    };
+
+    struct PendingRead {
+      size_t size = 0;
+      String seq;
+      Module::Callback cb;
+    };
+
+    uint64_t id = 0;
+    Stream *stream = nullptr;
+    std::shared_ptr<Peer> peer = nullptr;
+    OpenOptions options;
+
+    uv_timer_t retransmitTimer;
+    uv_timer_t ackTimer;
+    uv_timer_t delayTimer;
+    // keeps the connection alive until its timers are closed
+    std::shared_ptr<Connection> self = nullptr;
+    int pendingHandleCloses = 0;
+    bool removed = false;
+
+    // sender state, `sendBuffer` holds segments from `sendUnacked` up
+    std::deque<std::shared_ptr<Segment>> sendBuffer;
+    std::deque<PendingWrite> writes;
+    std::shared_ptr<Segment> heldBack = nullptr;
+    uint32_t sendUnacked = 0;
+    uint32_t sendNext = 0;
+    uint32_t nextSeq = 0;
+    uint32_t remoteWindow = RECEIVE_WINDOW;
+    uint64_t transmissions = 0;
+    uint64_t highestAckedOrder = 0;
+    double srtt = 0;
+    double rttvar = 0;
+    bool hasRTT = false;
+    uint64_t rto = INITIAL_RTO;
+
+    // incoming frames held back by the `delay` option and when they are due
+    std::deque<std::pair<uint64_t, Vector<char>>> delayed;
+
+    // receiver state, `readable` holds in order segments not read yet
+    std::map<uint32_t, std::shared_ptr<Segment>> outOfOrder;
+    std::deque<std::shared_ptr<Segment>> readable;
+    std::deque<PendingRead> reads;
+    uint32_t receiveNext = 0;
+    uint32_t advertisedWindow = RECEIVE_WINDOW;
+    size_t readOffset = 0;
+    size_t readableBytes = 0;
+    int unackedSegments = 0;
+    bool remoteFin = false;
+
+    // close state, `finSeq` is the sequence of the FIN segment
+    bool closing = false;
+    bool finAcked = false;
+    uint32_t finSeq = 0;
+    String closeSeq;
+    Module::Callback closeCallback = nullptr;
+
+    struct {
+      uint64_t bytesWritten = 0;
+      uint64_t bytesRead = 0;
+      uint64_t segmentsSent = 0;
+      uint64_t segmentsReceived = 0;
+      uint64_t retransmits = 0;
+      uint64_t duplicates = 0;
+      uint64_t dropped = 0;
+      uint64_t reordered = 0;
+    } stats;
+
+    Connection (Stream *stream, uint64_t id, OpenOptions options) {
+      auto loop = stream->core->getEventLoop();
+
+      this->id = id;
+      this->stream = stream;
+      this->options = options;
+
+      uv_timer_init(loop, &this->retransmitTimer);
+      uv_timer_init(loop, &this->ackTimer);
+      uv_timer_init(loop, &this->delayTimer);
+      this->retransmitTimer.data = (void *) this;
+      this->ackTimer.data = (void *) this;
+      this->delayTimer.data = (void *) this;
+    }
+
+    uint64_t now () {
+      return uv_now(this->stream->core->getEventLoop());
+    }
+
+    uint32_t getReceiveWindow () {
+      auto buffered = (uint32_t) this->readable.size();
+      return buffered >= RECEIVE_WINDOW ? 0 : RECEIVE_WINDOW - buffered;
+    }
+
+    uint32_t getSendWindow () {
+      return std::min(SEND_WINDOW, this->remoteWindow);
+    }
+
+    bool hasSegmentsInFlight () {
+      return this->sendNext != this->sendUnacked;
+    }
+
+    bool hasCongestionWindow () {
+      auto segment = this->sendBuffer[this->sendNext - this->sendUnacked];
+      Lock lock(this->peer->mutex);
+      return this->peer->congestion.canSend(segment->getFrameSize());
+    }
+
+    void send (std::shared_ptr<Segment> segment) {
+      auto size = segment->getFrameSize();
+      auto port = this->options.port;
+      auto address = this->options.address;
+      auto transmission = segment->transmissions;
+
+      // the callback reference keeps the buffer alive until it was sent
+      this->peer->send(segment->bytes, size, port, address, [segment, transmission](auto status, auto post) {
+        if (status == 0 && segment->transmissions == transmission) {
+          segment->submittedAt = uv_hrtime() / 1000;
+        }
+      });
+    }
+
+    void transmit (std::shared_ptr<Segment> segment) {
+      segment->sentAt = this->now();
+      segment->sentOrder = ++this->transmissions;
+      segment->transmissions++;
+      segment->submittedAt = 0;
+      this->stats.segmentsSent++;
+
+      do {
+        Lock lock(this->peer->mutex);
+
+        if (!segment->inFlight) {
+          segment->inFlight = true;
+          this->peer->congestion.onSend(segment->getFrameSize());
+        }
+      } while (0);
+
+      #if SSC_FAULT_INJECTION
+      if (this->options.dropRate > 0 && randomRate() < this->options.dropRate) {
+        this->stats.dropped++;
+        return;
+      }
+
+      if (
+        this->heldBack == nullptr &&
+        this->options.reorderRate > 0 &&
+        randomRate() < this->options.reorderRate
+      ) {
+        this->stats.reordered++;
+        this->heldBack = segment;
+        return;
+      }
+      #endif
+
+      this->send(segment);
+      this->sendHeldBack();
+    }
+
+    void sendHeldBack () {
+      if (this->heldBack != nullptr) {
+        auto segment = this->heldBack;
+        this->heldBack = nullptr;
+        this->send(segment);
+      }
+    }
+
+    void sendAck () {
+      auto segment = std::make_shared<Segment>(this->stream);
+      auto window = this->getReceiveWindow();
+      auto sack = (unsigned char *) segment->bytes + FRAME_HEADER_BYTES;
+
+      memset(sack, 0, STREAM_SACK_BITS / 8);
+
+      for (const auto& entry : this->outOfOrder) {
+        auto offset = entry.first - this->receiveNext - 1;
+
+        if (offset >= STREAM_SACK_BITS) {
+          break;
+        }
+
+        sack[offset / 8] |= 1 << (offset % 8);
+        segment->size = offset / 8 + 1;
+      }
+
+      encodeStreamFrame(segment->bytes, StreamFrame {
+        STREAM_FRAME_TYPE_ACK,
+        0,
+        this->options.streamId,
+        this->receiveNext,
+        window,
+        nullptr,
+        segment->size
+      });
+
+      this->advertisedWindow = window;
+      this->unackedSegments = 0;
+      uv_timer_stop(&this->ackTimer);
+      this->send(segment);
+    }
+
+    void scheduleAck () {
+      if (++this->unackedSegments >= 2) {
+        return this->sendAck();
+      }
+
+      if (!uv_is_active((uv_handle_t *) &this->ackTimer)) {
+        uv_timer_start(&this->ackTimer, [](uv_timer_t *handle) {
+          auto connection = (Connection *) handle->data;
+          connection->sendAck();
+        }, DELAYED_ACK_TIMEOUT, 0);
+      }
+    }
+
+    void armRetransmitTimer () {
+      uint64_t timeout = 0;
+
+      if (this->hasSegmentsInFlight() || this->sendNext != this->nextSeq) {
+        timeout = this->rto;
+      } else if (this->finAcked) {
+        timeout = LINGER_TIMEOUT;
+      } else {
+        uv_timer_stop(&this->retransmitTimer);
+        return;
+      }
+
+      if (!uv_is_active((uv_handle_t *) &this->retransmitTimer)) {
+        uv_timer_start(&this->retransmitTimer, [](uv_timer_t *handle) {
+          auto connection = (Connection *) handle->data;
+          connection->onRetransmitTimeout();
+        }, timeout, 0);
+      }
+    }
+
+    void flush () {
+      while (
+        this->sendNext != this->nextSeq &&
+        this->sendNext - this->sendUnacked < this->getSendWindow() &&
+        this->hasCongestionWindow()
+      ) {
+        this->transmit(this->sendBuffer[this->sendNext - this->sendUnacked]);
+        this->sendNext++;
+      }
+
+      this->armRetransmitTimer();
+    }
+
+    void onRetransmitTimeout () {
+      auto now = this->now();
+      bool expired = false;
+
+      if (this->finAcked && !this->hasSegmentsInFlight()) {
+        return this->remove();
+      }
+
+      this->sendHeldBack();
+
+      for (uint32_t seq = this->sendUnacked; seq != this->sendNext; ++seq) {
+        auto segment = this->sendBuffer[seq - this->sendUnacked];
+
+        if (segment->acked || now - segment->sentAt < this->rto) {
+          continue;
+        }
+
+        if (segment->transmissions >= MAX_TRANSMISSIONS) {
+          return this->fail("ETIMEDOUT", "Stream timed out waiting for acknowledgements");
+        }
+
+        this->stats.retransmits++;
+        this->lose(segment);
+        this->transmit(segment);
+        expired = true;
+      }
+
+      // probe a closed receive window with the next segment, the
+      // receiver acknowledges it with its current window either way
+      if (
+        this->remoteWindow == 0 &&
+        !this->hasSegmentsInFlight() &&
+        this->sendNext != this->nextSeq
+      ) {
+        this->send(this->sendBuffer[this->sendNext - this->sendUnacked]);
+        expired = true;
+      }
+
+      if (expired) {
+        this->rto = std::min(this->rto * 2, MAX_RTO);
+      }
+
+      this->sendHeldBack();
+      // segments held back by the congestion window of a peer shared with
+      // other streams go out once their acknowledgements opened it
+      this->flush();
+    }
+
+    void sampleRTT (std::shared_ptr<Segment> segment) {
+      // Karn's algorithm, acknowledgements of retransmitted
+      // segments are ambiguous and not sampled
+      if (segment->transmissions != 1) {
+        return;
+      }
+
+      auto sample = (double) (this->now() - segment->sentAt);
+
+      if (!this->hasRTT) {
+        this->srtt = sample;
+        this->rttvar = sample / 2;
+        this->hasRTT = true;
+      } else {
+        this->rttvar = 0.75 * this->rttvar + 0.25 * std::abs(this->srtt - sample);
+        this->srtt = 0.875 * this->srtt + 0.125 * sample;
+      }
+
+      auto rto = (uint64_t) (this->srtt + std::max(1.0, 4 * this->rttvar));
+      this->rto = std::clamp(rto, MIN_RTO, MAX_RTO);
+    }
+
+    void acknowledge (std::shared_ptr<Segment> segment) {
+      if (!segment->acked) {
+        segment->acked = true;
+        this->sampleRTT(segment);
+        this->highestAckedOrder = std::max(this->highestAckedOrder, segment->sentOrder);
+      }
+
+      Lock lock(this->peer->mutex);
+
+      if (segment->inFlight) {
+        auto now = uv_hrtime() / 1000;
+        uint64_t rtt = 0;
+
+        if (segment->transmissions == 1 && segment->submittedAt > 0) {
+          rtt = std::max((uint64_t) 1, now - std::min(now, segment->submittedAt));
+        }
+
+        segment->inFlight = false;
+        this->peer->congestion.onAck(segment->getFrameSize(), rtt, now);
+      }
+    }
+
+    void lose (std::shared_ptr<Segment> segment) {
+      Lock lock(this->peer->mutex);
+
+      if (segment->inFlight) {
+        segment->inFlight = false;
+        this->peer->congestion.onLoss(segment->getFrameSize(), uv_hrtime() / 1000);
+      }
+    }
+
+    void onAck (const StreamFrame &frame) {
+      // acknowledgements beyond what was sent are bogus
+      if (frame.seq - this->sendUnacked > this->sendNext - this->sendUnacked) {
+        return;
+      }
+
+      while (this->sendUnacked != frame.seq) {
+        this->acknowledge(this->sendBuffer.front());
+        this->sendBuffer.pop_front();
+        this->sendUnacked++;
+      }
+
+      auto sack = (const unsigned char *) frame.payload;
+
+      for (uint32_t i = 0; i < frame.size * 8; ++i) {
+        auto seq = frame.seq + 1 + i;
+
+        if (seq - this->sendUnacked >= this->sendNext - this->sendUnacked) {
+          break;
+        }
+
+        if (sack[i / 8] & (1 << (i % 8))) {
+          this->acknowledge(this->sendBuffer[seq - this->sendUnacked]);
+        }
+      }
+
+      // segments sent well before one that was acknowledged are lost,
+      // retransmit them now instead of waiting for the timer
+      for (uint32_t seq = this->sendUnacked; seq != this->sendNext; ++seq) {
+        auto segment = this->sendBuffer[seq - this->sendUnacked];
+
+        if (
+          !segment->acked &&
+          segment->sentOrder + REORDER_THRESHOLD <= this->highestAckedOrder
+        ) {
+          this->stats.retransmits++;
+          this->lose(segment);
+          this->transmit(segment);
+        }
+      }
+
+      this->remoteWindow = frame.window;
+
+      while (this->writes.size() > 0) {
+        auto& write = this->writes.front();
+
+        if (write.lastSeq - this->sendUnacked < this->nextSeq - this->sendUnacked) {
+          break;
+        }
+
+        write.cb(write.seq, JSON::Object::Entries {
+          {"source", "stream.write"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(this->id)},
+            {"bytes", (uint64_t) write.size}
+          }}
+        }, Post{});
+
+        this->writes.pop_front();
+      }
+
+      if (this->closing && !this->finAcked && this->sendUnacked == this->nextSeq) {
+        this->finAcked = true;
+
+        if (this->closeCallback != nullptr) {
+          this->closeCallback(this->closeSeq, JSON::Object::Entries {
+            {"source", "stream.close"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(this->id)}
+            }}
+          }, Post{});
+
+          this->closeCallback = nullptr;
+        }
+
+        if (this->remoteFin) {
+          return this->remove();
+        }
+      }
+
+      // restart the timer for what is still in flight
+      uv_timer_stop(&this->retransmitTimer);
+      this->flush();
+    }
+
+    void onData (const StreamFrame &frame) {
+      auto window = this->getReceiveWindow();
+      auto offset = frame.seq - this->receiveNext;
+
+      this->stats.segmentsReceived++;
+
+      // duplicates (behind `receiveNext`) and segments beyond the window
+      // are dropped, acknowledging them again tells the sender where we are
+      if (offset >= window || this->outOfOrder.contains(frame.seq)) {
+        this->stats.duplicates++;
+        return this->sendAck();
+      }
+
+      auto segment = std::make_shared<Segment>(this->stream);
+
+      segment->seq = frame.seq;
+      segment->size = frame.size;
+      segment->fin = (frame.flags & STREAM_FRAME_FLAG_FIN) != 0;
+      memcpy(segment->bytes, frame.payload, frame.size);
+
+      this->outOfOrder.emplace(frame.seq, segment);
+
+      while (this->outOfOrder.size() > 0) {
+        auto entry = this->outOfOrder.begin();
+
+        if (entry->first != this->receiveNext) {
+          break;
+        }
+
+        auto next = entry->second;
+        this->outOfOrder.erase(entry);
+        this->receiveNext++;
+
+        if (next->fin) {
+          this->remoteFin = true;
+        } else if (next->size > 0) {
+          this->readableBytes += next->size;
+          this->readable.push_back(next);
+        }
+      }
+
+      // gaps and the end of the stream are acknowledged right away
+      if (offset != 0 || this->outOfOrder.size() > 0 || this->remoteFin) {
+        this->sendAck();
+      } else {
+        this->scheduleAck();
+      }
+
+      this->drain();
+
+      if (this->remoteFin && this->finAcked) {
+        this->remove();
+      }
+    }
+
+    void drain () {
+      while (this->reads.size() > 0 && (this->readableBytes > 0 || this->remoteFin)) {
+        auto request = std::move(this->reads.front());
+        this->reads.pop_front();
+
+        if (this->readableBytes == 0) {
+          request.cb(request.seq, JSON::Object::Entries {
+            {"source", "stream.read"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(this->id)},
+              {"EOF", true}
+            }}
+          }, Post{});
+
+          continue;
+        }
+
+        auto size = std::min(request.size, this->readableBytes);
+        auto headers = Headers {{
+          {"content-type" ,"application/octet-stream"},
+          {"content-length", (uint64_t) size}
+        }};
+
+        Post post;
+        post.id = rand64();
+        post.body = new char[size]{0};
+        post.length = (int) size;
+        post.headers = headers.str();
+
+        for (size_t copied = 0; copied < size;) {
+          auto segment = this->readable.front();
+          auto available = segment->size - this->readOffset;
+          auto length = std::min(available, size - copied);
+
+          memcpy(
+            post.body + copied,
+            segment->bytes + this->readOffset,
+            length
+          );
+
+          copied += length;
+          this->readOffset += length;
+
+          if (this->readOffset == segment->size) {
+            this->readable.pop_front();
+            this->readOffset = 0;
+          }
+        }
+
+        this->readableBytes -= size;
+        this->stats.bytesRead += size;
+
+        request.cb(request.seq, JSON::Object::Entries {
+          {"source", "stream.read"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(this->id)},
+            {"bytes", (uint64_t) size}
+          }}
+        }, post);
+      }
+
+      // tell a sender stalled on a small window that there is room again
+      if (
+        this->advertisedWindow < RECEIVE_WINDOW / 2 &&
+        this->getReceiveWindow() >= RECEIVE_WINDOW / 2
+      ) {
+        this->sendAck();
+      }
+    }
+
+    void onFrame (const StreamFrame &frame) {
+      if (frame.type == STREAM_FRAME_TYPE_ACK) {
+        this->onAck(frame);
+      } else if (frame.type == STREAM_FRAME_TYPE_DATA) {
+        this->onData(frame);
+      }
+    }
+
+    void delay (const char *bytes, size_t size) {
+      auto due = this->now() + this->options.delay;
+      this->delayed.push_back({ due, Vector<char>(bytes, bytes + size) });
+
+      if (!uv_is_active((uv_handle_t *) &this->delayTimer)) {
+        uv_timer_start(&this->delayTimer, [](uv_timer_t *handle) {
+          auto connection = (Connection *) handle->data;
+          connection->onDelayTimeout();
+        }, this->options.delay, 0);
+      }
+    }
+
+    void onDelayTimeout () {
+      auto now = this->now();
+
+      while (
+        !this->removed &&
+        this->delayed.size() > 0 &&
+        this->delayed.front().first <= now
+      ) {
+        auto bytes = std::move(this->delayed.front().second);
+        StreamFrame frame;
+
+        this->delayed.pop_front();
+
+        if (decodeStreamFrame(bytes.data(), bytes.size(), frame)) {
+          this->onFrame(frame);
+        }
+      }
+
+      if (!this->removed && this->delayed.size() > 0) {
+        auto timeout = this->delayed.front().first - now;
+        uv_timer_start(&this->delayTimer, [](uv_timer_t *handle) {
+          auto connection = (Connection *) handle->data;
+          connection->onDelayTimeout();
+        }, timeout, 0);
+      }
+    }
+
+    void enqueue (const char *bytes, size_t size, bool fin) {
+      auto segment = std::make_shared<Segment>(this->stream);
+
+      segment->seq = this->nextSeq++;
+      segment->size = size;
+      segment->fin = fin;
+
+      encodeStreamFrame(segment->bytes, StreamFrame {
+        STREAM_FRAME_TYPE_DATA,
+        fin ? STREAM_FRAME_FLAG_FIN : (uint8_t) 0,
+        this->options.streamId,
+        segment->seq,
+        0,
+        nullptr,
+        size
+      });
+
+      if (size > 0) {
+        memcpy(segment->bytes + FRAME_HEADER_BYTES, bytes, size);
+      }
+
+      this->sendBuffer.push_back(segment);
+    }
+
+    void fail (const String& code, const String& message) {
+      for (auto& write : this->writes) {
+        write.cb(write.seq, ERR_STREAM("stream.write", this->id, code, message), Post{});
+      }
+
+      for (auto& read : this->reads) {
+        read.cb(read.seq, ERR_STREAM("stream.read", this->id, code, message), Post{});
+      }
+
+      if (this->closeCallback != nullptr) {
+        auto json = ERR_STREAM("stream.close", this->id, code, message);
+        this->closeCallback(this->closeSeq, json, Post{});
+      }
+
+      this->writes.clear();
+      this->reads.clear();
+      this->closeCallback = nullptr;
+      this->remove();
+    }
+
+    void remove () {
+      if (this->removed) {
+        return;
+      }
+
+      // the stream may be removed from its own callbacks, so outstanding
+      // requests are failed before anything is released
+      if (this->writes.size() > 0 || this->reads.size() > 0) {
+        return this->fail("ECONNRESET", "Stream was closed");
+      }
+
+      this->removed = true;
+      this->self = this->stream->getConnection(this->id);
+      this->pendingHandleCloses = 3;
+      this->delayed.clear();
+
+      do {
+        Lock lock(this->peer->mutex);
+
+        for (const auto& segment : this->sendBuffer) {
+          if (segment->inFlight) {
+            segment->inFlight = false;
+            this->peer->congestion.onDiscard(segment->getFrameSize());
+          }
+        }
+      } while (0);
+
+      for (auto timer : { &this->retransmitTimer, &this->ackTimer, &this->delayTimer }) {
+        uv_timer_stop(timer);
+        uv_close((uv_handle_t *) timer, [](uv_handle_t *handle) {
+          auto connection = (Connection *) handle->data;
+
+          if (--connection->pendingHandleCloses == 0) {
+            connection->self = nullptr;
+          }
+        });
+      }
+
+      this->stream->remove(this);
+    }
+  };
+
+  char * Core::Stream::acquireBuffer () {
+    if (this->buffers.size() > 0) {
+      auto buffer = this->buffers.back();
+      this->buffers.pop_back();
+      return buffer;
+    }
+
+    return new char[FRAME_BYTES]{0};
+  }
+
+  void Core::Stream::releaseBuffer (char *buffer) {
+    if (this->buffers.size() < MAX_POOLED_BUFFERS) {
+      this->buffers.push_back(buffer);
+    } else {
+      delete [] buffer;
+    }
+  }
+
+  std::shared_ptr<Core::Stream::Connection> Core::Stream::getConnection (uint64_t id) {
+    if (!this->connections.contains(id)) {
+      return nullptr;
+    }
+
+    return this->connections.at(id);
+  }
+
+  void Core::Stream::receive (
+    uint64_t peerId,
+    ssize_t nread,
+    const uv_buf_t *buf,
+    const struct sockaddr *addr,
+    uint64_t timestamp
+  ) {
+    StreamFrame frame;
+
+    if (
+      nread > 0 &&
+      addr != nullptr &&
+      decodeStreamFrame(buf->base, (size_t) nread, frame)
+    ) {
+      auto route = this->routes.find({ peerId, frame.id });
+      auto connection = route != this->routes.end()
+        ? this->getConnection(route->second)
+        : nullptr;
+
+      char address[17] = {0};
+      int port = 0;
+
+      parseAddress((struct sockaddr *) addr, &port, address);
+
+      if (
+        connection != nullptr &&
+        connection->options.port == port &&
+        connection->options.address == address
+      ) {
+        #if SSC_FAULT_INJECTION
+        if (connection->options.delay > 0) {
+          connection->delay(buf->base, (size_t) nread);
+        } else {
+          connection->onFrame(frame);
+        }
+        #else
+        connection->onFrame(frame);
+        #endif
+      }
+    }
+
+    if (buf != nullptr && buf->base != nullptr) {
+      delete [] buf->base;
+    }
+  }
+
+  void Core::Stream::remove (Connection *connection) {
+    auto peerId = connection->peer->id;
+
+    this->connections.erase(connection->id);
+    this->routes.erase({ peerId, connection->options.streamId });
+
+    if (--this->peers[peerId] == 0) {
+      this->peers.erase(peerId);
+      connection->peer->recvstop();
+    }
+  }
+
+  void Core::Stream::open (
+    const String seq,
+    uint64_t id,
+    Stream::OpenOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      if (
+        this->connections.contains(id) ||
+        this->routes.contains({ options.peerId, options.streamId })
+      ) {
+        auto json = ERR_STREAM("stream.open", id, "EEXIST", "Stream is already open");
+        return cb(seq, json, Post{});
+      }
+
+      auto peer = this->core->getPeer(options.peerId);
+
+      if (peer == nullptr || !peer->isUDP()) {
+        auto json = ERR_STREAM("stream.open", id, "ERR_SOCKET_DGRAM_NOT_RUNNING", "Not running");
+        return cb(seq, json, Post{});
+      }
+
+      if (!peer->isBound()) {
+        auto json = ERR_STREAM("stream.open", id, "ERR_SOCKET_DGRAM_NOT_BOUND", "Socket is not bound");
+        return cb(seq, json, Post{});
+      }
+
+      // the first stream on a peer takes over receiving on it
+      if (!this->peers.contains(options.peerId)) {
+        auto peerId = options.peerId;
+        auto err = peer->recvstart([this, peerId](auto nread, auto buf, auto addr, auto timestamp) {
+          this->receive(peerId, nread, buf, addr, timestamp);
+        });
+
+        if (err == UV_EALREADY) {
+          auto json = ERR_STREAM("stream.open", id, "EALREADY", "Socket is already receiving");
+          return cb(seq, json, Post{});
+        }
+
+        if (err < 0) {
+          auto json = ERR_STREAM("stream.open", id, "EINVAL", String(uv_strerror(err)));
+          return cb(seq, json, Post{});
+        }
+      }
+
+      auto connection = std::make_shared<Connection>(this, id, options);
+      connection->peer = peer;
+
+      this->peers[options.peerId]++;
+      this->connections[id] = connection;
+      this->routes[{ options.peerId, options.streamId }] = id;
+
+      cb(seq, JSON::Object::Entries {
+        {"source", "stream.open"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"peerId", std::to_string(options.peerId)},
+          {"streamId", std::to_string(options.streamId)},
+          {"address", options.address},
+          {"port", options.port}
+        }}
+      }, Post{});
+    });
+  }
+
+  void Core::Stream::write (
+    const String seq,
+    uint64_t id,
+    const char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    // `bytes` stay alive until the reply, which is after they were copied
+    this->core->dispatchEventLoop([=, this]() {
+      auto connection = this->getConnection(id);
+
+      if (connection == nullptr) {
+        return cb(seq, ERR_STREAM_NOT_FOUND("stream.write", id), Post{});
+      }
+
+      if (connection->closing) {
+        auto json = ERR_STREAM("stream.write", id, "EPIPE", "Stream is closing");
+        return cb(seq, json, Post{});
+      }
+
+      if (size == 0) {
+        return cb(seq, JSON::Object::Entries {
+          {"source", "stream.write"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"bytes", 0}
+          }}
+        }, Post{});
+      }
+
+      for (size_t offset = 0; offset < size; offset += SEGMENT_BYTES) {
+        connection->enqueue(bytes + offset, std::min(SEGMENT_BYTES, size - offset), false);
+      }
+
+      connection->stats.bytesWritten += size;
+      connection->writes.push_back(Connection::PendingWrite {
+        connection->nextSeq - 1,
+        size,
+        seq,
+        cb
+      });
+
+      connection->flush();
+    });
+  }
+
+  void Core::Stream::read (
+    const String seq,
+    uint64_t id,
+    size_t size,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto connection = this->getConnection(id);
+
+      if (connection == nullptr) {
+        return cb(seq, ERR_STREAM_NOT_FOUND("stream.read", id), Post{});
+      }
+
+      connection->reads.push_back(Connection::PendingRead { size, seq, cb });
+      connection->drain();
+    });
+  }
+
+  void Core::Stream::close (const String seq, uint64_t id, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto connection = this->getConnection(id);
+
+      if (connection == nullptr) {
+        return cb(seq, ERR_STREAM_NOT_FOUND("stream.close", id), Post{});
+      }
+
+      if (connection->closing) {
+        auto json = ERR_STREAM("stream.close", id, "EALREADY", "Stream is already closing");
+        return cb(seq, json, Post{});
+      }
+
+      // the FIN is sequenced after everything written, so it is
+      // acknowledged once the remote end received all of it
+      connection->closing = true;
+      connection->closeSeq = seq;
+      connection->closeCallback = cb;
+      connection->finSeq = connection->nextSeq;
+      connection->enqueue(nullptr, 0, true);
+      connection->flush();
+    });
+  }
+
+  void Core::Stream::getState (const String seq, uint64_t id, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto connection = this->getConnection(id);
+
+      if (connection == nullptr) {
+        return cb(seq, ERR_STREAM_NOT_FOUND("stream.getState", id), Post{});
+      }
+
+      const auto& stats = connection->stats;
+
+      cb(seq, JSON::Object::Entries {
+        {"source", "stream.getState"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"peerId", std::to_string(connection->options.peerId)},
+          {"streamId", std::to_string(connection->options.streamId)},
+          {"closing", connection->closing},
+          {"remoteClosed", connection->remoteFin},
+          {"inFlight", connection->sendNext - connection->sendUnacked},
+          {"queued", connection->nextSeq - connection->sendNext},
+          {"readable", (uint64_t) connection->readableBytes},
+          {"remoteWindow", connection->remoteWindow},
+          {"srtt", connection->srtt},
+          {"rto", connection->rto},
+          {"bytesWritten", stats.bytesWritten},
+          {"bytesRead", stats.bytesRead},
+          {"segmentsSent", stats.segmentsSent},
+          {"segmentsReceived", stats.segmentsReceived},
+          {"retransmits", stats.retransmits},
+          {"duplicates", stats.duplicates},
+          {"dropped", stats.dropped},
+          {"reordered", stats.reordered}
+        }}
+      }, Post{});
+    });
+  }
+}
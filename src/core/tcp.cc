@@ -0,0 +1,526 @@
+#include "core.hh"
+
+#include <cstring>
+
+namespace SSC {
+  static JSON::Object::Entries ERR_SOCKET_TCP_NOT_FOUND (
+    const String& source,
+    uint64_t id
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"type", "NotFoundError"},
+        {"code", "NOT_FOUND_ERR"},
+        {"message", "No TCP socket with specified id"}
+      }}
+    };
+  }
+
+  static JSON::Object::Entries ERR_SOCKET_TCP (
+    const String& source,
+    uint64_t id,
+    int status
+  ) {
+    return JSON::Object::Entries {
+      {"source", source},
+      {"err", JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"code", String(uv_err_name(status))},
+        {"message", String(uv_strerror(status))}
+      }}
+    };
+  }
+
+  static std::shared_ptr<Peer> getTCPPeer (Core *core, uint64_t id) {
+    auto peer = core->getPeer(id);
+
+    if (peer == nullptr || !peer->isTCP()) {
+      return nullptr;
+    }
+
+    return peer;
+  }
+
+  static void setSocketOptions (Peer *peer, const Core::TCP::SocketOptions& options) {
+    Lock lock(peer->mutex);
+    peer->options.tcp.noDelay = options.noDelay;
+    peer->options.tcp.keepAlive = options.keepAlive;
+    peer->options.tcp.keepAliveDelay = options.keepAliveDelay;
+  }
+
+  static JSON::Object::Entries getConnectionInfo (Peer *peer) {
+    auto local = peer->getLocalPeerInfo();
+    auto remote = peer->getRemotePeerInfo();
+
+    return JSON::Object::Entries {
+      {"id", std::to_string(peer->id)},
+      {"address", remote->address},
+      {"port", (int) remote->port},
+      {"family", remote->family},
+      {"localAddress", local->address},
+      {"localPort", (int) local->port}
+    };
+  }
+
+  Core::TCP::~TCP () {
+    for (auto buffer : this->buffers) {
+      delete [] buffer;
+    }
+  }
+
+  char * Core::TCP::acquireBuffer () {
+    if (this->buffers.size() > 0) {
+      auto buffer = this->buffers.back();
+      this->buffers.pop_back();
+      return buffer;
+    }
+
+    return new char[READ_BUFFER_SIZE];
+  }
+
+  void Core::TCP::releaseBuffer (char *buffer) {
+    if (this->buffers.size() < MAX_POOLED_BUFFERS) {
+      this->buffers.push_back(buffer);
+    } else {
+      delete [] buffer;
+    }
+  }
+
+  void Core::TCP::listen (
+    const String seq,
+    uint64_t id,
+    ListenOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = this->core->createPeer(PEER_TYPE_TCP, id);
+      int err = 0;
+
+      if (!peer->isTCP()) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.listen", id, UV_EINVAL), Post{});
+      }
+
+      if (peer->isBound() || peer->isConnected()) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.listen", id, UV_EALREADY), Post{});
+      }
+
+      setSocketOptions(peer.get(), options.socket);
+
+      if (
+        (err = peer->bind(options.address, options.port)) ||
+        (err = peer->listen(options.backlog, [=](int status) {
+          if (status < 0) {
+            return cb("-1", ERR_SOCKET_TCP("tcp.listen", id, status), Post{});
+          }
+
+          // accepted with `tcp.accept`, the next connection is reported
+          // once this one was
+          auto json = JSON::Object::Entries {
+            {"source", "tcp.listen"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(id)},
+              {"event", "connection"}
+            }}
+          };
+
+          cb("-1", json, Post{});
+        }))
+      ) {
+        peer->close();
+        return cb(seq, ERR_SOCKET_TCP("tcp.listen", id, err), Post{});
+      }
+
+      auto info = peer->getLocalPeerInfo();
+      auto json = JSON::Object::Entries {
+        {"source", "tcp.listen"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"event", "listening"},
+          {"address", info->address},
+          {"port", (int) info->port},
+          {"family", info->family}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::TCP::accept (
+    const String seq,
+    uint64_t serverId,
+    uint64_t id,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto server = getTCPPeer(this->core, serverId);
+      int err = 0;
+
+      if (server == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.accept", serverId), Post{});
+      }
+
+      if (this->core->hasPeer(id)) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.accept", id, UV_EEXIST), Post{});
+      }
+
+      auto client = this->core->createPeer(PEER_TYPE_TCP, id);
+
+      if ((err = server->accept(client.get()))) {
+        client->close();
+        return cb(seq, ERR_SOCKET_TCP("tcp.accept", id, err), Post{});
+      }
+
+      auto data = getConnectionInfo(client.get());
+      data["serverId"] = std::to_string(serverId);
+
+      auto json = JSON::Object::Entries {
+        {"source", "tcp.accept"},
+        {"data", data}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::TCP::connect (
+    const String seq,
+    uint64_t id,
+    ConnectOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = this->core->createPeer(PEER_TYPE_TCP, id);
+      int err = 0;
+
+      if (!peer->isTCP()) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.connect", id, UV_EINVAL), Post{});
+      }
+
+      if (peer->isBound() || peer->isConnected()) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.connect", id, UV_EISCONN), Post{});
+      }
+
+      setSocketOptions(peer.get(), options.socket);
+
+      err = peer->connect(options.address, options.port, [=](int status, Post) {
+        if (status < 0) {
+          peer->close();
+          return cb(seq, ERR_SOCKET_TCP("tcp.connect", id, status), Post{});
+        }
+
+        auto json = JSON::Object::Entries {
+          {"source", "tcp.connect"},
+          {"data", getConnectionInfo(peer.get())}
+        };
+
+        cb(seq, json, Post{});
+      });
+
+      if (err < 0) {
+        peer->close();
+        cb(seq, ERR_SOCKET_TCP("tcp.connect", id, err), Post{});
+      }
+    });
+  }
+
+  void Core::TCP::write (
+    const String seq,
+    uint64_t id,
+    char *bytes,
+    size_t size,
+    Module::Callback cb
+  ) {
+    // `bytes` stay alive until the reply, so they are written in place
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = getTCPPeer(this->core, id);
+
+      if (peer == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.write", id), Post{});
+      }
+
+      peer->write(bytes, size, [=](int status, Post) {
+        if (status < 0) {
+          return cb(seq, ERR_SOCKET_TCP("tcp.write", id, status), Post{});
+        }
+
+        auto json = JSON::Object::Entries {
+          {"source", "tcp.write"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(id)},
+            {"bytes", (uint64_t) size}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      });
+    });
+  }
+
+  void Core::TCP::readStart (const String seq, uint64_t id, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = getTCPPeer(this->core, id);
+      int err = 0;
+
+      if (peer == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.readStart", id), Post{});
+      }
+
+      err = peer->readstart([=, this](ssize_t nread, const uv_buf_t *buf) {
+        if (nread > 0) {
+          Post post;
+          post.id = rand64();
+          post.length = (size_t) nread;
+
+          // a mostly full buffer is handed over, smaller reads are copied
+          // so a pooled buffer is not held for a few bytes
+          if ((size_t) nread >= READ_BUFFER_SIZE / 2) {
+            post.body = buf->base;
+          } else {
+            post.body = new char[nread];
+            memcpy(post.body, buf->base, nread);
+            this->releaseBuffer(buf->base);
+          }
+
+          auto headers = Headers {{
+            {"content-type" ,"application/octet-stream"},
+            {"content-length", post.length}
+          }};
+
+          post.headers = headers.str();
+
+          auto json = JSON::Object::Entries {
+            {"source", "tcp.readStart"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(id)},
+              {"bytes", std::to_string(post.length)}
+            }}
+          };
+
+          return cb("-1", json, post);
+        }
+
+        if (buf != nullptr && buf->base != nullptr) {
+          this->releaseBuffer(buf->base);
+        }
+
+        if (nread == UV_EOF) {
+          auto json = JSON::Object::Entries {
+            {"source", "tcp.readStart"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(id)},
+              {"EOF", true}
+            }}
+          };
+
+          cb("-1", json, Post{});
+        } else if (nread < 0) {
+          cb("-1", ERR_SOCKET_TCP("tcp.readStart", id, (int) nread), Post{});
+        }
+      });
+
+      if (err < 0) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.readStart", id, err), Post{});
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "tcp.readStart"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::TCP::readStop (const String seq, uint64_t id, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = getTCPPeer(this->core, id);
+      int err = 0;
+
+      if (peer == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.readStop", id), Post{});
+      }
+
+      if ((err = peer->readstop())) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.readStop", id, err), Post{});
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "tcp.readStop"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::TCP::setKeepAlive (
+    const String seq,
+    uint64_t id,
+    bool enabled,
+    unsigned int delay,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = getTCPPeer(this->core, id);
+      int err = 0;
+
+      if (peer == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.setKeepAlive", id), Post{});
+      }
+
+      if ((err = peer->setKeepAlive(enabled, delay))) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.setKeepAlive", id, err), Post{});
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "tcp.setKeepAlive"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"keepAlive", enabled},
+          {"keepAliveDelay", delay}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::TCP::setNoDelay (
+    const String seq,
+    uint64_t id,
+    bool enabled,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = getTCPPeer(this->core, id);
+      int err = 0;
+
+      if (peer == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.setNoDelay", id), Post{});
+      }
+
+      if ((err = peer->setNoDelay(enabled))) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.setNoDelay", id, err), Post{});
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "tcp.setNoDelay"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"noDelay", enabled}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::TCP::shutdown (const String seq, uint64_t id, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = getTCPPeer(this->core, id);
+      int err = 0;
+
+      if (peer == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.shutdown", id), Post{});
+      }
+
+      err = peer->shutdown([=](int status, Post) {
+        if (status < 0) {
+          return cb(seq, ERR_SOCKET_TCP("tcp.shutdown", id, status), Post{});
+        }
+
+        auto json = JSON::Object::Entries {
+          {"source", "tcp.shutdown"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(id)}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      });
+
+      if (err < 0) {
+        cb(seq, ERR_SOCKET_TCP("tcp.shutdown", id, err), Post{});
+      }
+    });
+  }
+
+  void Core::TCP::close (const String seq, uint64_t id, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = getTCPPeer(this->core, id);
+
+      if (peer == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.close", id), Post{});
+      }
+
+      if (peer->isClosing()) {
+        return cb(seq, ERR_SOCKET_TCP("tcp.close", id, UV_EALREADY), Post{});
+      }
+
+      peer->close([=]() {
+        auto json = JSON::Object::Entries {
+          {"source", "tcp.close"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(id)}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      });
+    });
+  }
+
+  void Core::TCP::getState (const String seq, uint64_t id, Module::Callback cb) {
+    this->core->dispatchEventLoop([=, this]() {
+      auto peer = getTCPPeer(this->core, id);
+
+      if (peer == nullptr) {
+        return cb(seq, ERR_SOCKET_TCP_NOT_FOUND("tcp.getState", id), Post{});
+      }
+
+      Lock lock(peer->mutex);
+      auto local = peer->getLocalPeerInfo();
+      auto remote = peer->getRemotePeerInfo();
+      auto& options = peer->options.tcp;
+      auto& counters = peer->counters;
+      auto json = JSON::Object::Entries {
+        {"source", "tcp.getState"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(id)},
+          {"type", "tcp"},
+          {"listening", peer->hasState(PEER_STATE_TCP_LISTENING)},
+          {"connected", peer->isConnected()},
+          {"reading", peer->hasState(PEER_STATE_TCP_READ_STARTED)},
+          {"shutdown", peer->hasState(PEER_STATE_TCP_SHUTDOWN)},
+          {"closing", peer->isClosing()},
+          {"localAddress", local->address},
+          {"localPort", (int) local->port},
+          {"address", remote->address},
+          {"port", (int) remote->port},
+          {"noDelay", options.noDelay},
+          {"keepAlive", options.keepAlive},
+          {"keepAliveDelay", options.keepAliveDelay},
+          {"writeQueue", JSON::Object::Entries {
+            {"bytes", (uint64_t) peer->writeQueueBytes},
+            {"count", (uint64_t) peer->writeQueue.size()},
+            {"inFlight", (uint64_t) peer->writesInFlight}
+          }},
+          {"writes", counters.packetsSent.load()},
+          {"bytesWritten", counters.bytesSent.load()},
+          {"reads", counters.packetsReceived.load()},
+          {"bytesRead", counters.bytesReceived.load()},
+          {"errors", counters.sendErrors.load() + counters.receiveErrors.load()}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+}
@@ -0,0 +1,77 @@
+#include "tuner.hh"
+
+namespace SSC {
+  const char* ReceiveBufferTuner::getActionName (Action action) {
+    switch (action) {
+      case GROW: return "grow";
+      case SHRINK: return "shrink";
+      default: return "none";
+    }
+  }
+
+  void ReceiveBufferTuner::reset (const Sample& sample) {
+    this->last = sample;
+    this->idleSamples = 0;
+    this->cappedSize = 0;
+    this->grows = 0;
+    this->shrinks = 0;
+  }
+
+  ReceiveBufferTuner::Decision ReceiveBufferTuner::update (const Sample& sample) {
+    Decision decision;
+
+    // counters only go up, a lower value is a reset socket
+    auto drops = sample.drops >= this->last.drops ? sample.drops - this->last.drops : 0;
+    auto packets = sample.packets >= this->last.packets ? sample.packets - this->last.packets : 0;
+
+    this->last = sample;
+
+    decision.size = sample.size;
+    decision.drops = drops;
+
+    if (!this->enabled || sample.size == 0) {
+      return decision;
+    }
+
+    decision.occupancy = (double) sample.queued / sample.size;
+
+    if (drops > 0 || decision.occupancy > GROW_OCCUPANCY) {
+      this->idleSamples = 0;
+
+      auto limit = this->getLimit();
+      if (sample.size < limit) {
+        decision.action = GROW;
+        decision.size = std::min(sample.size * 2, limit);
+        this->grows++;
+      }
+
+      return decision;
+    }
+
+    if (packets > 0) {
+      this->idleSamples = 0;
+      return decision;
+    }
+
+    if (++this->idleSamples >= IDLE_SAMPLES && sample.size > this->minSize) {
+      this->idleSamples = 0;
+      decision.action = SHRINK;
+      decision.size = std::max(sample.size / 2, this->minSize);
+      this->shrinks++;
+    }
+
+    return decision;
+  }
+
+  void ReceiveBufferTuner::onCapped (size_t size) {
+    this->cappedSize = size;
+  }
+
+  size_t ReceiveBufferTuner::getLimit () const {
+    if (this->cappedSize > 0 && this->cappedSize < this->maxSize) {
+      return this->cappedSize;
+    }
+
+    return this->maxSize;
+  }
+}
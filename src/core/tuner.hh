@@ -0,0 +1,73 @@
+#ifndef SSC_CORE_TUNER_HH
+#define SSC_CORE_TUNER_HH
+
+#include "../common.hh"
+
+namespace SSC {
+  /**
+   * Receive buffer auto-tuning for a peer. Sampled every `interval`
+   * milliseconds, the tuner doubles the socket receive buffer when the
+   * kernel dropped datagrams or the receive queue was more than
+   * `GROW_OCCUPANCY` full, up to `maxSize`, and halves it down to `minSize`
+   * after `IDLE_SAMPLES` samples in a row without traffic, so idle sockets
+   * give the memory back. A grow the kernel capped (`rmem_max` on Linux)
+   * is remembered and the buffer is not grown past it again.
+   *
+   * Sizes are the ones the kernel reports for `SO_RCVBUF`, which on Linux
+   * are twice the requested size. Not synchronized, callers hold the lock
+   * of the owning peer.
+   */
+  class ReceiveBufferTuner {
+    public:
+      static constexpr size_t DEFAULT_MAX_SIZE = 8 * 1024 * 1024;
+      static constexpr uint64_t DEFAULT_INTERVAL = 1000;
+      static constexpr double GROW_OCCUPANCY = 0.75;
+      static constexpr size_t IDLE_SAMPLES = 10;
+
+      enum Action {
+        NONE,
+        GROW,
+        SHRINK
+      };
+
+      struct Sample {
+        // running totals of kernel drops and received datagrams
+        uint64_t drops = 0;
+        uint64_t packets = 0;
+        // bytes waiting in the receive queue, `0` where not known
+        size_t queued = 0;
+        size_t size = 0;
+      };
+
+      struct Decision {
+        Action action = NONE;
+        size_t size = 0;
+        // since the previous sample
+        uint64_t drops = 0;
+        double occupancy = 0;
+      };
+
+      bool enabled = false;
+      size_t minSize = 0;
+      size_t maxSize = DEFAULT_MAX_SIZE;
+      uint64_t interval = DEFAULT_INTERVAL;
+      uint64_t grows = 0;
+      uint64_t shrinks = 0;
+
+      static const char* getActionName (Action action);
+
+      void reset (const Sample& sample);
+      Decision update (const Sample& sample);
+      // the kernel set `size` for a grow to more than that
+      void onCapped (size_t size);
+      // `maxSize`, or lower where the kernel capped a grow
+      size_t getLimit () const;
+
+    private:
+      Sample last;
+      size_t idleSamples = 0;
+      size_t cappedSize = 0;
+  };
+}
+
+#endif
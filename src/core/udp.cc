@@ -1,5 +1,7 @@
 #include "core.hh"
 
+#include <cstring>
+
 namespace SSC {
   static JSON::Object::Entries ERR_SOCKET_ALREADY_BOUND (
     const String& source,
@@ -91,6 +93,495 @@ namespace SSC {
     };
   }
 
+  static String getSendQueuePolicyName (peer_send_queue_policy_t policy) {
+    switch (policy) {
+      case PEER_SEND_QUEUE_POLICY_REJECT: return "reject";
+      case PEER_SEND_QUEUE_POLICY_DROP_OLDEST: return "drop-oldest";
+      case PEER_SEND_QUEUE_POLICY_BLOCK: return "block";
+    }
+
+    return "";
+  }
+
+#if SSC_BENCHMARKS
+  // sends kept in flight by the runs comparing sends with and without GSO
+  constexpr size_t UDP_BENCHMARK_SENDS_IN_FLIGHT = 8;
+
+  struct UDPBenchmarkRun {
+    // sockets reading the port
+    size_t receivers = 1;
+    // flooded with sends of `segments` datagrams from a peer bound with a
+    // segment size instead of by the sender threads
+    bool segmented = false;
+    // whether those sends may use GSO, or go out one datagram at a time
+    bool offload = false;
+  };
+
+  struct UDPBenchmarkContext {
+    Core *core = nullptr;
+    Core::UDP::BenchmarkOptions options;
+    String seq;
+    Core::Module::Callback cb;
+    Vector<UDPBenchmarkRun> runs;
+    size_t run = 0;
+    uint64_t peerId = 0;
+    uint64_t senderId = 0;
+    int port = 0;
+    uint64_t startedAt = 0;
+    uint64_t stoppedAt = 0;
+    std::atomic<bool> sending = false;
+    Vector<std::thread> senders;
+    // segmented sends still in flight, only touched on the loop
+    size_t inflight = 0;
+    Vector<char> payload;
+    uv_timer_t timer;
+    JSON::Array::Entries results;
+    JSON::Array::Entries segmentation;
+  };
+
+  static void startBenchmarkRun (UDPBenchmarkContext *ctx);
+
+  static void finishBenchmark (UDPBenchmarkContext *ctx, JSON::Any err) {
+    auto json = JSON::Object::Entries {
+      {"source", "udp.benchmark"}
+    };
+
+    if (err.type != JSON::Type::Null) {
+      json["err"] = err;
+    } else {
+      json["data"] = JSON::Object::Entries {
+        {"senders", (uint64_t) ctx->options.senders},
+        {"size", (uint64_t) ctx->options.size},
+        {"segments", (uint64_t) ctx->options.segments},
+        {"duration", ctx->options.duration},
+        {"results", ctx->results},
+        {"segmentation", ctx->segmentation}
+      };
+    }
+
+    ctx->cb(ctx->seq, json, Post{});
+
+    uv_close((uv_handle_t *) &ctx->timer, [](uv_handle_t *handle) {
+      delete (UDPBenchmarkContext *) handle->data;
+    });
+  }
+
+  static void sendBenchmarkSegments (UDPBenchmarkContext *ctx, Peer *sender) {
+    ctx->inflight++;
+    sender->submitSend(
+      ctx->payload.data(),
+      ctx->payload.size(),
+      ctx->port,
+      "127.0.0.1",
+      [ctx, sender](int status, Post post) {
+        ctx->inflight--;
+
+        if (ctx->sending && status >= 0) {
+          sendBenchmarkSegments(ctx, sender);
+        }
+      }
+    );
+  }
+
+  static void finishBenchmarkRun (uv_timer_t *timer) {
+    auto ctx = (UDPBenchmarkContext *) timer->data;
+    auto& run = ctx->runs[ctx->run];
+
+    if (ctx->sending) {
+      ctx->sending = false;
+      ctx->stoppedAt = uv_hrtime();
+    }
+
+    // the callbacks of segmented sends point at `ctx`, let them drain
+    if (ctx->inflight > 0) {
+      uv_timer_start(&ctx->timer, finishBenchmarkRun, 1, 0);
+      return;
+    }
+
+    auto seconds = (double) (ctx->stoppedAt - ctx->startedAt) / 1e9;
+    auto peer = ctx->core->getPeer(ctx->peerId);
+
+    for (auto& thread : ctx->senders) {
+      thread.join();
+    }
+
+    ctx->senders.clear();
+
+    if (run.segmented) {
+      auto sender = ctx->core->getPeer(ctx->senderId);
+
+      if (sender != nullptr) {
+        auto datagrams = sender->counters.packetsSent.load();
+        auto bytes = sender->counters.bytesSent.load();
+
+        ctx->segmentation.push_back(JSON::Object::Entries {
+          {"segmentationOffload", sender->hasSegmentationOffload},
+          {"datagrams", datagrams},
+          {"received", peer != nullptr ? peer->counters.packetsReceived.load() : 0},
+          {"datagramsPerSecond", datagrams / seconds},
+          {"megabytesPerSecond", bytes / seconds / 1e6}
+        });
+
+        sender->close();
+      }
+    } else if (peer != nullptr) {
+      auto packets = peer->counters.packetsReceived.load();
+      auto bytes = peer->counters.bytesReceived.load();
+
+      ctx->results.push_back(JSON::Object::Entries {
+        {"receivers", (uint64_t) peer->receivers.size() + 1},
+        {"packets", packets},
+        {"drops", peer->getReceiveDrops()},
+        {"packetsPerSecond", packets / seconds},
+        {"megabytesPerSecond", bytes / seconds / 1e6}
+      });
+    }
+
+    if (peer != nullptr) {
+      peer->close();
+    }
+
+    if (++ctx->run < ctx->runs.size()) {
+      return startBenchmarkRun(ctx);
+    }
+
+    finishBenchmark(ctx, nullptr);
+  }
+
+  static void startBenchmarkRun (UDPBenchmarkContext *ctx) {
+    auto& run = ctx->runs[ctx->run];
+    auto peer = ctx->core->createPeer(PEER_TYPE_UDP, rand64(), true);
+    int err = 0;
+
+    ctx->peerId = peer->id;
+    peer->options.udp.receivers = run.receivers;
+
+    if (
+      (err = peer->bind("127.0.0.1", 0, false)) ||
+      (err = peer->recvstart([](auto nread, auto buf, auto addr, auto timestamp) {
+        if (buf != nullptr && buf->base != nullptr) {
+          delete [] buf->base;
+        }
+      }))
+    ) {
+      peer->close();
+      return finishBenchmark(ctx, JSON::Object::Entries {
+        {"message", String(uv_strerror(err))}
+      });
+    }
+
+    auto port = peer->getLocalPeerInfo()->port;
+    auto size = ctx->options.size;
+
+    ctx->port = port;
+    ctx->sending = true;
+    ctx->startedAt = uv_hrtime();
+
+    if (run.segmented) {
+      auto sender = ctx->core->createPeer(PEER_TYPE_UDP, rand64(), true);
+      ctx->senderId = sender->id;
+
+      if (
+        (err = sender->setSegmentSize(size)) ||
+        (err = sender->bind("127.0.0.1", 0, false))
+      ) {
+        ctx->sending = false;
+        sender->close();
+        peer->close();
+        return finishBenchmark(ctx, JSON::Object::Entries {
+          {"message", String(uv_strerror(err))}
+        });
+      }
+
+      // how sends go out where the kernel has no UDP_SEGMENT
+      if (!run.offload) {
+        sender->hasSegmentationOffload = false;
+      }
+
+      for (size_t i = 0; i < UDP_BENCHMARK_SENDS_IN_FLIGHT; ++i) {
+        sendBenchmarkSegments(ctx, sender.get());
+      }
+
+      uv_timer_start(&ctx->timer, finishBenchmarkRun, ctx->options.duration, 0);
+      return;
+    }
+
+    for (size_t i = 0; i < ctx->options.senders; ++i) {
+      ctx->senders.emplace_back([ctx, port, size]() {
+        // a loop of its own so the socket never touches the Core loop
+        uv_loop_t loop;
+        uv_udp_t handle;
+        struct sockaddr_in addr;
+        Vector<char> payload(size, 0);
+        auto buf = uv_buf_init(payload.data(), (unsigned int) size);
+
+        uv_loop_init(&loop);
+        uv_udp_init(&loop, &handle);
+        uv_ip4_addr("127.0.0.1", port, &addr);
+
+        while (ctx->sending) {
+          if (uv_udp_try_send(&handle, &buf, 1, (struct sockaddr *) &addr) == UV_EAGAIN) {
+            std::this_thread::yield();
+          }
+        }
+
+        uv_close((uv_handle_t *) &handle, nullptr);
+        uv_run(&loop, UV_RUN_DEFAULT);
+        uv_loop_close(&loop);
+      });
+    }
+
+    uv_timer_start(&ctx->timer, finishBenchmarkRun, ctx->options.duration, 0);
+  }
+
+  void Core::UDP::benchmark (
+    const String seq,
+    BenchmarkOptions options,
+    Module::Callback cb
+  ) {
+    if (
+      options.receivers == 0 ||
+      options.receivers > UDP_MAX_RECEIVERS ||
+      options.senders == 0 ||
+      options.size == 0 ||
+      options.size > UDP_MAX_PAYLOAD_SIZE ||
+      options.segments > UDP_MAX_SEGMENTS ||
+      options.size * options.segments > UDP_MAX_PAYLOAD_SIZE
+    ) {
+      auto json = JSON::Object::Entries {
+        {"source", "udp.benchmark"},
+        {"err", JSON::Object::Entries {
+          {"code", "EINVAL"},
+          {"message", "Invalid benchmark parameters"}
+        }}
+      };
+
+      return cb(seq, json, Post{});
+    }
+
+    this->core->dispatchEventLoop([=, this]() {
+      auto ctx = new UDPBenchmarkContext;
+
+      ctx->core = this->core;
+      ctx->options = options;
+      ctx->seq = seq;
+      ctx->cb = cb;
+      ctx->runs = {
+        UDPBenchmarkRun { 1 },
+        UDPBenchmarkRun { options.receivers }
+      };
+
+      if (options.segments > 0) {
+        ctx->payload.resize(options.size * options.segments, 0);
+        ctx->runs.push_back(UDPBenchmarkRun { 1, true, false });
+        ctx->runs.push_back(UDPBenchmarkRun { 1, true, true });
+      }
+
+      uv_timer_init(this->core->getEventLoop(), &ctx->timer);
+      ctx->timer.data = (void *) ctx;
+
+      startBenchmarkRun(ctx);
+    });
+  }
+
+  // `std::map` behind one recursive mutex, how `Core::peers` was kept
+  // before the `PeerRegistry`, to compare against
+  struct LockedPeerMap {
+    std::recursive_mutex mutex;
+    std::map<uint64_t, PeerRegistry::Entry> entries;
+
+    PeerRegistry::Entry get (uint64_t id) {
+      std::lock_guard lock(this->mutex);
+      auto it = this->entries.find(id);
+      return it != this->entries.end() ? it->second : nullptr;
+    }
+
+    PeerRegistry::Entry getOrCreate (uint64_t id, PeerRegistry::Factory create) {
+      std::lock_guard lock(this->mutex);
+      auto it = this->entries.find(id);
+
+      if (it != this->entries.end()) {
+        return it->second;
+      }
+
+      return this->entries.emplace(id, create()).first->second;
+    }
+
+    PeerRegistry::Entry remove (uint64_t id) {
+      std::lock_guard lock(this->mutex);
+      auto it = this->entries.find(id);
+
+      if (it == this->entries.end()) {
+        return nullptr;
+      }
+
+      auto entry = std::move(it->second);
+      this->entries.erase(it);
+      return entry;
+    }
+  };
+
+  struct PeersBenchmarkContext {
+    uv_work_t req;
+    Core::UDP::PeersBenchmarkOptions options;
+    JSON::Array::Entries results;
+    String seq;
+    Core::Module::Callback cb;
+  };
+
+  // lookups per second of `threads` threads sharing `peers`, with a peer
+  // removed and created again every `lookups` lookups
+  template <typename Peers>
+  static double measurePeerLookups (
+    Peers& peers,
+    const Vector<uint64_t>& ids,
+    size_t threads,
+    const Core::UDP::PeersBenchmarkOptions& options
+  ) {
+    // the entries own a byte instead of a `Peer`, which needs the Core loop,
+    // but copying them still counts references like a peer does
+    auto create = []() {
+      return PeerRegistry::Entry(std::make_shared<char>(0), nullptr);
+    };
+
+    for (auto id : ids) {
+      peers.getOrCreate(id, create);
+    }
+
+    std::atomic<bool> running = true;
+    std::atomic<uint64_t> operations = 0;
+    Vector<std::thread> workers;
+    auto started = uv_hrtime();
+
+    for (size_t i = 0; i < threads; ++i) {
+      workers.emplace_back([&, seed = rand64() | 1]() {
+        auto state = seed;
+        uint64_t count = 0;
+
+        while (running.load(std::memory_order_relaxed)) {
+          // xorshift64, `rand64()` would contend on its own state
+          state ^= state << 13;
+          state ^= state >> 7;
+          state ^= state << 17;
+
+          auto id = ids[state % ids.size()];
+
+          if (++count % options.lookups == 0) {
+            peers.remove(id);
+            peers.getOrCreate(id, create);
+          } else {
+            peers.get(id);
+          }
+        }
+
+        operations += count;
+      });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(options.duration));
+    running = false;
+
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    auto seconds = (double) (uv_hrtime() - started) / 1e9;
+
+    for (auto id : ids) {
+      peers.remove(id);
+    }
+
+    return operations / seconds;
+  }
+
+  static void runPeersBenchmark (PeersBenchmarkContext *ctx) {
+    auto& options = ctx->options;
+    Vector<uint64_t> ids(options.peers);
+
+    for (auto& id : ids) {
+      id = rand64();
+    }
+
+    for (auto threads : { (size_t) 1, options.threads }) {
+      PeerRegistry registry;
+      LockedPeerMap map;
+
+      auto sharded = measurePeerLookups(registry, ids, threads, options);
+      auto locked = measurePeerLookups(map, ids, threads, options);
+
+      ctx->results.push_back(JSON::Object::Entries {
+        {"threads", (uint64_t) threads},
+        {"registry", sharded},
+        {"map", locked}
+      });
+
+      if (options.threads == 1) {
+        break;
+      }
+    }
+  }
+
+  void Core::UDP::benchmarkPeers (
+    const String seq,
+    PeersBenchmarkOptions options,
+    Module::Callback cb
+  ) {
+    if (
+      options.peers == 0 ||
+      options.threads == 0 ||
+      options.threads > 64 ||
+      options.lookups == 0
+    ) {
+      auto json = JSON::Object::Entries {
+        {"source", "udp.benchmarkPeers"},
+        {"err", JSON::Object::Entries {
+          {"code", "EINVAL"},
+          {"message", "Invalid benchmark parameters"}
+        }}
+      };
+
+      return cb(seq, json, Post{});
+    }
+
+    this->core->dispatchEventLoop([=, this]() {
+      auto loop = this->core->getEventLoop();
+      auto ctx = new PeersBenchmarkContext;
+
+      ctx->req.data = ctx;
+      ctx->options = options;
+      ctx->seq = seq;
+      ctx->cb = cb;
+
+      auto done = [](uv_work_t *req, int status) {
+        auto ctx = reinterpret_cast<PeersBenchmarkContext*>(req->data);
+
+        ctx->cb(ctx->seq, JSON::Object::Entries {
+          {"source", "udp.benchmarkPeers"},
+          {"data", JSON::Object::Entries {
+            {"peers", (uint64_t) ctx->options.peers},
+            {"lookups", (uint64_t) ctx->options.lookups},
+            {"duration", ctx->options.duration},
+            {"results", ctx->results}
+          }}
+        }, Post{});
+
+        delete ctx;
+      };
+
+      // the lookups run on threads of their own, keep waiting for them off
+      // the loop
+      auto err = uv_queue_work(loop, &ctx->req, [](uv_work_t *req) {
+        runPeersBenchmark(reinterpret_cast<PeersBenchmarkContext*>(req->data));
+      }, done);
+
+      if (err < 0) {
+        runPeersBenchmark(ctx);
+        done(&ctx->req, 0);
+      }
+    });
+  }
+#endif
+
   void Core::UDP::bind (
     const String seq,
     uint64_t peerId,
@@ -98,15 +589,28 @@ namespace SSC {
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
-      if (this->core->hasPeer(peerId)) {
-        if (this->core->getPeer(peerId)->isBound()) {
-          auto json = ERR_SOCKET_ALREADY_BOUND("udp.bind", peerId);
-          return cb(seq, json, Post{});
-        }
+      auto peer = this->core->createPeer(PEER_TYPE_UDP, peerId);
+
+      if (peer->isBound()) {
+        auto json = ERR_SOCKET_ALREADY_BOUND("udp.bind", peerId);
+        return cb(seq, json, Post{});
       }
 
-      auto peer = this->core->createPeer(PEER_TYPE_UDP, peerId);
-      auto err = peer->bind(options.address, options.port, options.reuseAddr);
+      auto err = peer->setSegmentSize(options.segmentSize);
+
+      if (err == 0) {
+        err = peer->setReceiveTimestamps(options.timestamps);
+      }
+
+      if (err == 0) {
+        Lock lock(peer->mutex);
+        peer->options.udp.receivers = options.receivers;
+        peer->options.udp.steering = options.steering;
+      }
+
+      if (err == 0) {
+        err = peer->bind(options.address, options.port, options.reuseAddr);
+      }
 
       if (err < 0) {
         auto json = JSON::Object::Entries {
@@ -141,7 +645,8 @@ namespace SSC {
           {"port", (int) info->port},
           {"event" , "listening"},
           {"family", info->family},
-          {"address", info->address}
+          {"address", info->address},
+          {"receivers", (uint64_t) peer->receivers.size() + 1}
         }}
       };
 
@@ -211,12 +716,13 @@ namespace SSC {
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
-      if (!this->core->hasPeer(peerId)) {
+      auto peer = this->core->getPeer(peerId);
+
+      if (peer == nullptr) {
         auto json = ERR_SOCKET_DGRAM_NOT_CONNECTED("udp.disconnect", peerId);
         return cb(seq, json, Post{});
       }
 
-      auto peer = this->core->getPeer(peerId);
       auto err = peer->disconnect();
 
       if (err < 0) {
@@ -243,12 +749,13 @@ namespace SSC {
   }
 
   void Core::UDP::getPeerName (String seq, uint64_t peerId, Module::Callback cb) {
-    if (!this->core->hasPeer(peerId)) {
+    auto peer = this->core->getPeer(peerId);
+
+    if (peer == nullptr) {
       auto json = ERR_SOCKET_DGRAM_NOT_CONNECTED("udp.getPeerName", peerId);
       return cb(seq, json, Post{});
     }
 
-    auto peer = this->core->getPeer(peerId);
     auto info = peer->getRemotePeerInfo();
 
     if (info->err < 0) {
@@ -277,12 +784,13 @@ namespace SSC {
   }
 
   void Core::UDP::getSockName (String seq, uint64_t peerId, Callback cb) {
-    if (!this->core->hasPeer(peerId)) {
+    auto peer = this->core->getPeer(peerId);
+
+    if (peer == nullptr) {
       auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.getSockName", peerId);
       return cb(seq, json, Post{});
     }
 
-    auto peer = this->core->getPeer(peerId);
     auto info = peer->getLocalPeerInfo();
 
     if (info->err < 0) {
@@ -310,23 +818,49 @@ namespace SSC {
     cb(seq, json, Post{});
   }
 
+  // times in milliseconds
+  static JSON::Array getRTTEstimates (Peer *peer) {
+    JSON::Array::Entries estimates;
+
+    for (const auto& entry : peer->rtt) {
+      auto& estimator = entry.second;
+      auto separator = entry.first.rfind(':');
+
+      estimates.push_back(JSON::Object::Entries {
+        {"address", entry.first.substr(0, separator)},
+        {"port", std::stoi(entry.first.substr(separator + 1))},
+        {"srtt", estimator.srtt / 1000.0},
+        {"rttvar", estimator.rttvar / 1000.0},
+        {"latestRTT", estimator.latestRTT / 1000.0},
+        {"minRTT", estimator.minRTT / 1000.0},
+        {"samples", estimator.samples}
+      });
+    }
+
+    return estimates;
+  }
+
   void Core::UDP::getState (
     const String seq,
     uint64_t peerId,
     Module::Callback cb
   ) {
-    if (!this->core->hasPeer(peerId)) {
+    auto peer = this->core->getPeer(peerId);
+
+    if (peer == nullptr) {
       auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.getState", peerId);
       return cb(seq, json, Post{});
     }
 
-    auto peer = this->core->getPeer(peerId);
-
     if (!peer->isUDP()) {
       auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.getState", peerId);
       return cb(seq, json, Post{});
     }
 
+    Lock lock(peer->mutex);
+    auto& limits = peer->options.udp.sendQueue;
+    auto& congestion = peer->congestion;
+    auto& tuner = peer->bufferTuner;
     auto json = JSON::Object::Entries {
       {"source", "udp.getState"},
       {"data", JSON::Object::Entries {
@@ -337,31 +871,209 @@ namespace SSC {
         {"closed", peer->isClosed()},
         {"closing", peer->isClosing()},
         {"connected", peer->isConnected()},
-        {"ephemeral", peer->isEphemeral()}
+        {"ephemeral", peer->isEphemeral()},
+        {"segmentSize", (int) peer->options.udp.segmentSize},
+        {"segmentationOffload", peer->hasSegmentationOffload},
+        {"receiveOffload", peer->hasReceiveOffload},
+        {"sendQueue", JSON::Object::Entries {
+          {"size", (uint64_t) peer->getSendQueueSize()},
+          {"count", (uint64_t) peer->getSendQueueCount()},
+          // held back by the policy or pacing, not yet handed to libuv
+          {"heldBack", (uint64_t) peer->sendQueue.size()},
+          {"maxBytes", (uint64_t) limits.maxBytes},
+          {"maxCount", (uint64_t) limits.maxCount},
+          {"policy", getSendQueuePolicyName(limits.policy)}
+        }},
+        // times in milliseconds, sizes in bytes and rates in bytes per second
+        {"congestion", JSON::Object::Entries {
+          {"enabled", congestion.enabled},
+          {"cwnd", (uint64_t) congestion.cwnd},
+          {"ssthresh", (uint64_t) congestion.ssthresh},
+          {"bytesInFlight", (uint64_t) congestion.bytesInFlight},
+          {"pacingRate", congestion.getPacingRate()},
+          {"maxPacingRate", congestion.maxPacingRate},
+          {"srtt", congestion.srtt / 1000.0},
+          {"rttvar", congestion.rttvar / 1000.0},
+          {"latestRTT", congestion.latestRTT / 1000.0},
+          {"minRTT", congestion.baseDelay / 1000.0},
+          {"queuingDelay", congestion.getQueuingDelay() / 1000.0},
+          {"losses", congestion.losses}
+        }},
+        {"receivers", (uint64_t) peer->receivers.size() + 1},
+        {"steering", peer->hasReceiveSteering ? "cpu" : "hash"},
+        {"timestamps", peer->options.udp.timestamps},
+        {"kernelTimestamps", peer->hasReceiveTimestamps},
+        {"rtt", getRTTEstimates(peer.get())},
+        {"bufferTuning", JSON::Object::Entries {
+          {"enabled", tuner.enabled},
+          {"size", (uint64_t) peer->getReceiveBufferSize()},
+          {"queued", (uint64_t) peer->getReceiveQueueSize()},
+          {"minSize", (uint64_t) tuner.minSize},
+          {"maxSize", (uint64_t) tuner.maxSize},
+          {"limit", (uint64_t) tuner.getLimit()},
+          {"interval", tuner.interval},
+          {"grows", tuner.grows},
+          {"shrinks", tuner.shrinks}
+        }},
+        {"stats", JSON::Object::Entries {
+          {"packetsSent", peer->counters.packetsSent.load()},
+          {"bytesSent", peer->counters.bytesSent.load()},
+          {"packetsReceived", peer->counters.packetsReceived.load()},
+          {"bytesReceived", peer->counters.bytesReceived.load()},
+          {"sendErrors", peer->counters.sendErrors.load()},
+          {"receiveErrors", peer->counters.receiveErrors.load()},
+          {"receiveDrops", peer->getReceiveDrops()}
+        }}
       }}
     };
 
     cb(seq, json, Post{});
   }
 
-  void Core::UDP::send (
-    String seq,
+  void Core::UDP::stats (
+    const String seq,
+    StatsOptions options,
+    Module::Callback cb
+  ) {
+    // one row of `fields` per peer, so thousands of peers stay compact
+    static const char *counters[] = {
+      "packetsSent",
+      "bytesSent",
+      "packetsReceived",
+      "bytesReceived",
+      "sendErrors",
+      "receiveErrors",
+      "receiveDrops"
+    };
+
+    static constexpr size_t COUNTERS = sizeof(counters) / sizeof(counters[0]);
+
+    struct Row {
+      uint64_t id;
+      uint64_t values[COUNTERS];
+    };
+
+    Vector<Row> rows;
+    uint64_t totals[COUNTERS] = {0};
+
+    this->core->peers.forEach([&](const auto& peer) {
+      if (!peer->isUDP()) {
+        return;
+      }
+
+      auto& counters = peer->counters;
+      auto row = Row { peer->id, {
+        counters.packetsSent.load(),
+        counters.bytesSent.load(),
+        counters.packetsReceived.load(),
+        counters.bytesReceived.load(),
+        counters.sendErrors.load(),
+        counters.receiveErrors.load(),
+        peer->getReceiveDrops()
+      }};
+
+      for (size_t i = 0; i < COUNTERS; ++i) {
+        totals[i] += row.values[i];
+      }
+
+      rows.push_back(row);
+    });
+
+    auto rank = [&](const Row &row) -> uint64_t {
+      const auto& values = row.values;
+
+      if (options.sort == "packets") {
+        return values[0] + values[2];
+      }
+
+      if (options.sort == "errors") {
+        return values[4] + values[5];
+      }
+
+      if (options.sort == "drops") {
+        return values[6];
+      }
+
+      return values[1] + values[3];
+    };
+
+    // busiest first
+    std::stable_sort(rows.begin(), rows.end(), [&](const Row &a, const Row &b) {
+      return rank(a) > rank(b);
+    });
+
+    if (options.limit > 0 && rows.size() > options.limit) {
+      rows.resize(options.limit);
+    }
+
+    JSON::Array::Entries peers;
+
+    for (const auto& row : rows) {
+      JSON::Array::Entries values = { std::to_string(row.id) };
+
+      for (auto value : row.values) {
+        values.push_back(value);
+      }
+
+      peers.push_back(values);
+    }
+
+    JSON::Array::Entries fields = { "id" };
+    JSON::Object::Entries total;
+
+    for (size_t i = 0; i < COUNTERS; ++i) {
+      fields.push_back(counters[i]);
+      total[counters[i]] = totals[i];
+    }
+
+    auto json = JSON::Object::Entries {
+      {"source", "udp.stats"},
+      {"data", JSON::Object::Entries {
+        {"fields", fields},
+        {"peers", peers},
+        {"total", total}
+      }}
+    };
+
+    cb(seq, json, Post{});
+  }
+
+  void Core::UDP::rtt (
+    const String seq,
     uint64_t peerId,
-    UDP::SendOptions options,
+    UDP::RTTOptions options,
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this] {
-      auto peer = this->core->createPeer(PEER_TYPE_UDP, peerId, options.ephemeral);
-      auto size = options.size; // @TODO(jwerle): validate MTU
-      auto port = options.port;
-      auto bytes = options.bytes;
+      auto peer = this->core->getPeer(peerId);
+
+      if (peer == nullptr) {
+        auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.rtt", peerId);
+        return cb(seq, json, Post{});
+      }
+
+      if (options.address.size() == 0) {
+        Lock lock(peer->mutex);
+        auto json = JSON::Object::Entries {
+          {"source", "udp.rtt"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(peerId)},
+            {"rtt", getRTTEstimates(peer.get())}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
       auto address = options.address;
-      peer->send(bytes, size, port, address, [=](auto status, auto post) {
+      auto port = options.port;
+      auto err = peer->ping(address, port, options.timeout, [=](int status, uint64_t rtt, RTTEstimator estimate) {
         if (status < 0) {
           auto json = JSON::Object::Entries {
-            {"source", "udp.send"},
+            {"source", "udp.rtt"},
             {"err", JSON::Object::Entries {
               {"id", std::to_string(peerId)},
+              {"code", String(uv_err_name(status))},
               {"message", String(uv_strerror(status))}
             }}
           };
@@ -370,26 +1082,811 @@ namespace SSC {
         }
 
         auto json = JSON::Object::Entries {
-          {"source", "udp.send"},
+          {"source", "udp.rtt"},
           {"data", JSON::Object::Entries {
             {"id", std::to_string(peerId)},
-            {"status", status}
+            {"address", address},
+            {"port", port},
+            {"rtt", rtt / 1000.0},
+            {"srtt", estimate.srtt / 1000.0},
+            {"rttvar", estimate.rttvar / 1000.0},
+            {"minRTT", estimate.minRTT / 1000.0},
+            {"samples", estimate.samples}
           }}
         };
 
         cb(seq, json, Post{});
       });
+
+      if (err < 0) {
+        auto json = JSON::Object::Entries {
+          {"source", "udp.rtt"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(peerId)},
+            {"code", "EINVAL"},
+            {"message", "Socket was not bound with timestamps enabled"}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      }
     });
   }
 
-  void Core::UDP::readStart (String seq, uint64_t peerId, Module::Callback cb) {
-    if (!this->core->hasPeer(peerId)) {
-      auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.readStart", peerId);
+  void Core::UDP::send (
+    String seq,
+    uint64_t peerId,
+    UDP::SendOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this] {
+      auto peer = this->core->createPeer(PEER_TYPE_UDP, peerId, options.ephemeral);
+      auto size = options.size; // @TODO(jwerle): validate MTU
+      auto port = options.port;
+      auto bytes = options.bytes;
+      auto address = options.address;
+      peer->send(bytes, size, port, address, [=](auto status, auto post) {
+        if (status < 0) {
+          auto json = JSON::Object::Entries {
+            {"source", "udp.send"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(peerId)},
+              {"message", String(uv_strerror(status))}
+            }}
+          };
+
+          return cb(seq, json, Post{});
+        }
+
+        auto json = JSON::Object::Entries {
+          {"source", "udp.send"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(peerId)},
+            {"status", status}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      });
+    });
+  }
+
+  void Core::UDP::sendMany (
+    String seq,
+    uint64_t peerId,
+    UDP::SendManyOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this] {
+      struct SendManyContext {
+        JSON::Array::Entries results;
+        size_t pending = 0;
+      };
+
+      // an ephemeral peer is closed once all sends completed, not after
+      // the first one as `Peer::send()` would, and only if it was created
+      // for them, a bound or connected socket with this id stays open
+      auto ephemeral = options.ephemeral && !this->core->hasPeer(peerId);
+      auto peer = this->core->createPeer(PEER_TYPE_UDP, peerId);
+      auto ctx = std::make_shared<SendManyContext>();
+      auto count = options.destinations.size();
+
+      ctx->results.resize(count);
+      ctx->pending = count;
+
+      auto reply = [=]() {
+        auto json = JSON::Object::Entries {
+          {"source", "udp.sendMany"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(peerId)},
+            {"results", ctx->results}
+          }}
+        };
+
+        if (ephemeral) {
+          peer->close();
+        }
+
+        cb(seq, json, Post{});
+      };
+
+      if (count == 0) {
+        return reply();
+      }
+
+      // every destination shares `options.bytes`, which stays alive until
+      // the reply as the IPC message owning it is released after it
+      for (size_t i = 0; i < count; ++i) {
+        auto destination = options.destinations[i];
+        auto size = options.size;
+        auto bytes = options.bytes;
+
+        peer->send(bytes, size, destination.port, destination.address, [=](auto status, auto post) {
+          auto result = JSON::Object::Entries {
+            {"address", destination.address},
+            {"port", destination.port},
+            {"status", status}
+          };
+
+          if (status < 0) {
+            result["code"] = String(uv_err_name(status));
+            result["message"] = String(uv_strerror(status));
+          }
+
+          ctx->results[i] = result;
+
+          if (--ctx->pending == 0) {
+            reply();
+          }
+        });
+      }
+    });
+  }
+
+  void Core::UDP::sendBlock (
+    String seq,
+    uint64_t peerId,
+    UDP::SendBlockOptions options,
+    Module::Callback cb
+  ) {
+    struct SendBlockContext {
+      Vector<char> frames;
+      Vector<size_t> sizes;
+      size_t pending = 0;
+      int status = 0;
+    };
+
+    auto ctx = std::make_shared<SendBlockContext>();
+    auto blockId = this->nextBlockId++;
+    Vector<SSC::FEC::Packet> packets;
+    size_t offset = 0;
+
+    for (auto size : options.sizes) {
+      packets.push_back(SSC::FEC::Packet { options.bytes + offset, size });
+      offset += size;
+    }
+
+    if (!SSC::FEC::encodeBlock(blockId, packets, options.parityCount, ctx->frames, ctx->sizes)) {
+      auto json = JSON::Object::Entries {
+        {"source", "udp.sendBlock"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(peerId)},
+          {"code", "ETOOBIG"},
+          {"message", "Block has too many or too big packets"}
+        }}
+      };
+
       return cb(seq, json, Post{});
     }
 
+    this->core->dispatchEventLoop([=, this] {
+      // an ephemeral peer is closed once all frames were sent, and only
+      // if it was created for them, a bound socket with this id stays open
+      auto ephemeral = options.ephemeral && !this->core->hasPeer(peerId);
+      auto peer = this->core->createPeer(PEER_TYPE_UDP, peerId);
+      auto bytes = ctx->frames.data();
+
+      ctx->pending = ctx->sizes.size();
+
+      for (auto size : ctx->sizes) {
+        auto onsend = [=](int status, Post post) {
+          if (status < 0 && ctx->status == 0) {
+            ctx->status = status;
+          }
+
+          if (--ctx->pending > 0) {
+            return;
+          }
+
+          if (ephemeral) {
+            peer->close();
+          }
+
+          if (ctx->status < 0) {
+            auto json = JSON::Object::Entries {
+              {"source", "udp.sendBlock"},
+              {"err", JSON::Object::Entries {
+                {"id", std::to_string(peerId)},
+                {"message", String(uv_strerror(ctx->status))}
+              }}
+            };
+
+            return cb(seq, json, Post{});
+          }
+
+          auto json = JSON::Object::Entries {
+            {"source", "udp.sendBlock"},
+            {"data", JSON::Object::Entries {
+              {"id", std::to_string(peerId)},
+              {"blockId", (uint64_t) blockId},
+              {"dataCount", (uint64_t) options.sizes.size()},
+              {"parityCount", (uint64_t) options.parityCount},
+              {"bytes", (uint64_t) ctx->frames.size()}
+            }}
+          };
+
+          cb(seq, json, Post{});
+        };
+
+        #if SSC_FAULT_INJECTION
+        if (options.dropRate > 0 && (double) (rand64() % 1000000) / 1000000.0 < options.dropRate) {
+          onsend(0, Post{});
+        } else {
+          peer->send(bytes, size, options.port, options.address, onsend);
+        }
+        #else
+        peer->send(bytes, size, options.port, options.address, onsend);
+        #endif
+
+        bytes += size;
+      }
+    });
+  }
+
+  /**
+   * State of a `udp.sendFile` transfer. The file is read in batches of
+   * datagrams into buffers that take turns, so a batch is read while the
+   * previous one is still being sent and at most `BATCHES` batches are
+   * ever queued on the peer, however large the file is.
+   */
+  struct SendFileContext {
+    static constexpr size_t BATCHES = 2;
+    static constexpr size_t CHUNKS_PER_BATCH = 16;
+    // milliseconds between progress events
+    static constexpr uint64_t PROGRESS_INTERVAL = 100;
+
+    struct Batch {
+      SendFileContext *ctx = nullptr;
+      uv_fs_t req;
+      uv_buf_t iov[CHUNKS_PER_BATCH];
+      Vector<char> bytes;
+      size_t pending = 0;
+      bool busy = false;
+    };
+
+    Core *core = nullptr;
+    std::shared_ptr<Peer> peer = nullptr;
+    uint64_t peerId = 0;
+    String seq;
+    Core::UDP::SendFileOptions options;
+    Core::Module::Callback cb;
+    uv_file fd = 0;
+    // the peer was created for this transfer and is closed after it
+    bool ephemeral = false;
+    Batch batches[BATCHES];
+    // file offset of the next read and where to stop, `0` at end of file
+    size_t offset = 0;
+    size_t end = 0;
+    size_t bytes = 0;
+    size_t datagrams = 0;
+    uint64_t progressAt = 0;
+    // nesting of callbacks, sends and reads may complete synchronously
+    // and only the outermost callback may finish the transfer
+    size_t depth = 0;
+    bool reading = false;
+    bool ended = false;
+    bool finished = false;
+    int status = 0;
+
+    void read ();
+    void onRead (Batch *batch, ssize_t result);
+    void onSend (Batch *batch, size_t size, int status);
+    void progress ();
+    void leave ();
+    void finish ();
+  };
+
+  void SendFileContext::read () {
+    Batch *batch = nullptr;
+
+    if (this->reading || this->ended || this->status < 0) {
+      return;
+    }
+
+    for (auto& candidate : this->batches) {
+      if (!candidate.busy) {
+        batch = &candidate;
+        break;
+      }
+    }
+
+    if (batch == nullptr) {
+      return;
+    }
+
+    auto chunkSize = this->options.chunkSize;
+    auto size = chunkSize * CHUNKS_PER_BATCH;
+
+    if (this->end > 0) {
+      size = std::min(size, this->end - this->offset);
+    }
+
+    auto chunks = (size + chunkSize - 1) / chunkSize;
+
+    for (size_t i = 0; i < chunks; ++i) {
+      auto length = std::min(chunkSize, size - i * chunkSize);
+      batch->iov[i] = uv_buf_init(batch->bytes.data() + i * chunkSize, (unsigned int) length);
+    }
+
+    batch->busy = true;
+    batch->req.data = (void *) batch;
+    this->reading = true;
+
+    auto loop = this->core->getEventLoop();
+    auto err = uv_fs_read(loop, &batch->req, this->fd, batch->iov, (unsigned int) chunks, this->offset, [](uv_fs_t *req) {
+      auto batch = static_cast<Batch *>(req->data);
+      auto ctx = batch->ctx;
+      auto result = req->result;
+      uv_fs_req_cleanup(req);
+      ctx->depth++;
+      ctx->onRead(batch, result);
+      ctx->leave();
+    });
+
+    if (err < 0) {
+      this->onRead(batch, err);
+    }
+  }
+
+  void SendFileContext::onRead (Batch *batch, ssize_t result) {
+    this->reading = false;
+
+    if (result <= 0) {
+      if (result < 0 && this->status == 0) {
+        this->status = (int) result;
+      }
+
+      batch->busy = false;
+      this->ended = true;
+      return;
+    }
+
+    this->offset += result;
+
+    if (this->end > 0 && this->offset >= this->end) {
+      this->ended = true;
+    }
+
+    auto chunkSize = this->options.chunkSize;
+    auto chunks = ((size_t) result + chunkSize - 1) / chunkSize;
+
+    // sends may complete before this returns, all of them are counted
+    // first so the batch is not released while still being sent
+    batch->pending = chunks;
+
+    for (size_t i = 0; i < chunks; ++i) {
+      auto size = std::min(chunkSize, (size_t) result - i * chunkSize);
+      auto bytes = batch->bytes.data() + i * chunkSize;
+
+      this->peer->send(bytes, size, this->options.port, this->options.address, [=, this](int status, Post post) {
+        this->depth++;
+        this->onSend(batch, size, status);
+        this->leave();
+      });
+    }
+
+    this->read();
+  }
+
+  void SendFileContext::onSend (Batch *batch, size_t size, int status) {
+    if (status < 0) {
+      if (this->status == 0) {
+        this->status = status;
+      }
+    } else {
+      this->bytes += size;
+      this->datagrams++;
+    }
+
+    if (--batch->pending > 0) {
+      return;
+    }
+
+    batch->busy = false;
+    this->progress();
+    this->read();
+  }
+
+  void SendFileContext::progress () {
+    auto now = uv_now(this->core->getEventLoop());
+
+    if (now - this->progressAt < PROGRESS_INTERVAL) {
+      return;
+    }
+
+    this->progressAt = now;
+
+    auto json = JSON::Object::Entries {
+      {"source", "udp.sendFile"},
+      {"data", JSON::Object::Entries {
+        {"id", std::to_string(this->peerId)},
+        {"fd", std::to_string(this->options.fd)},
+        {"bytes", (uint64_t) this->bytes},
+        {"length", (uint64_t) (this->end > 0 ? this->end - this->options.offset : 0)}
+      }}
+    };
+
+    this->cb("-1", json, Post{});
+  }
+
+  void SendFileContext::leave () {
+    if (--this->depth == 0) {
+      this->finish();
+    }
+  }
+
+  void SendFileContext::finish () {
+    if (this->finished || this->reading || !(this->ended || this->status < 0)) {
+      return;
+    }
+
+    for (const auto& batch : this->batches) {
+      if (batch.busy) {
+        return;
+      }
+    }
+
+    this->finished = true;
+
+    if (this->ephemeral) {
+      this->peer->close();
+    }
+
+    if (this->status < 0) {
+      auto json = JSON::Object::Entries {
+        {"source", "udp.sendFile"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(this->peerId)},
+          {"fd", std::to_string(this->options.fd)},
+          {"bytes", (uint64_t) this->bytes},
+          {"message", String(uv_strerror(this->status))}
+        }}
+      };
+
+      this->cb(this->seq, json, Post{});
+    } else {
+      auto json = JSON::Object::Entries {
+        {"source", "udp.sendFile"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(this->peerId)},
+          {"fd", std::to_string(this->options.fd)},
+          {"bytes", (uint64_t) this->bytes},
+          {"datagrams", (uint64_t) this->datagrams}
+        }}
+      };
+
+      this->cb(this->seq, json, Post{});
+    }
+
+    delete this;
+  }
+
+  void Core::UDP::sendFile (
+    String seq,
+    uint64_t peerId,
+    UDP::SendFileOptions options,
+    Module::Callback cb
+  ) {
+    if (options.chunkSize == 0 || options.chunkSize > UDP_MAX_PAYLOAD_SIZE) {
+      auto json = JSON::Object::Entries {
+        {"source", "udp.sendFile"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(peerId)},
+          {"code", "EINVAL"},
+          {"message", "Chunk size must be between 1 and 65507 bytes"}
+        }}
+      };
+
+      return cb(seq, json, Post{});
+    }
+
+    this->core->dispatchEventLoop([=, this] {
+      auto desc = this->core->fs.getDescriptor(options.fd);
+
+      if (desc == nullptr || !desc->isFile()) {
+        auto json = JSON::Object::Entries {
+          {"source", "udp.sendFile"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(peerId)},
+            {"fd", std::to_string(options.fd)},
+            {"code", "ENOTOPEN"},
+            {"type", "NotFoundError"},
+            {"message", "No open file descriptor found with that id"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // chunks are read straight into the buffers they are sent from,
+      // file bytes never leave the event loop
+      auto ctx = new SendFileContext();
+
+      ctx->core = this->core;
+      ctx->ephemeral = options.ephemeral && !this->core->hasPeer(peerId);
+      ctx->peer = this->core->createPeer(PEER_TYPE_UDP, peerId);
+      ctx->peerId = peerId;
+      ctx->seq = seq;
+      ctx->options = options;
+      ctx->cb = cb;
+      ctx->fd = desc->fd;
+      ctx->offset = options.offset;
+      ctx->end = options.length > 0 ? options.offset + options.length : 0;
+
+      for (auto& batch : ctx->batches) {
+        batch.ctx = ctx;
+        batch.bytes.resize(options.chunkSize * SendFileContext::CHUNKS_PER_BATCH);
+      }
+
+      ctx->depth++;
+      ctx->read();
+      ctx->leave();
+    });
+  }
+
+  void Core::UDP::sendPacket (
+    String seq,
+    uint64_t peerId,
+    UDP::SendPacketOptions options,
+    Module::Callback cb
+  ) {
+    if (options.packet.messageLength > StreamRelay::PACKET_MESSAGE_BYTES) {
+      auto json = JSON::Object::Entries {
+        {"source", "udp.sendPacket"},
+        {"err", JSON::Object::Entries {
+          {"id", std::to_string(peerId)},
+          {"code", "ETOOBIG"},
+          {"message", "Packet message is too big"}
+        }}
+      };
+
+      return cb(seq, json, Post{});
+    }
+
+    this->core->dispatchEventLoop([=, this] {
+      auto peer = this->core->createPeer(PEER_TYPE_UDP, peerId, options.ephemeral);
+      auto bytes = new char[StreamRelay::PACKET_BYTES]{0};
+      auto size = StreamRelay::encodePacket(
+        options.packet,
+        bytes,
+        StreamRelay::PACKET_BYTES
+      );
+
+      peer->send(bytes, size, options.port, options.address, [=](auto status, auto post) {
+        delete [] bytes;
+
+        if (status < 0) {
+          auto json = JSON::Object::Entries {
+            {"source", "udp.sendPacket"},
+            {"err", JSON::Object::Entries {
+              {"id", std::to_string(peerId)},
+              {"message", String(uv_strerror(status))}
+            }}
+          };
+
+          return cb(seq, json, Post{});
+        }
+
+        auto json = JSON::Object::Entries {
+          {"source", "udp.sendPacket"},
+          {"data", JSON::Object::Entries {
+            {"id", std::to_string(peerId)},
+            {"bytes", (uint64_t) size},
+            {"status", status}
+          }}
+        };
+
+        cb(seq, json, Post{});
+      });
+    });
+  }
+
+  void Core::UDP::setBufferTuning (
+    const String seq,
+    uint64_t peerId,
+    UDP::BufferTuningOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this] {
+      auto peer = this->core->getPeer(peerId);
+
+      if (peer == nullptr) {
+        auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.setBufferTuning", peerId);
+        return cb(seq, json, Post{});
+      }
+
+      if (options.minSize > 0 && options.maxSize > 0 && options.minSize > options.maxSize) {
+        auto json = JSON::Object::Entries {
+          {"source", "udp.setBufferTuning"},
+          {"err", JSON::Object::Entries {
+            {"id", std::to_string(peerId)},
+            {"code", "EINVAL"},
+            {"message", "Minimum buffer size is larger than the maximum"}
+          }}
+        };
+
+        return cb(seq, json, Post{});
+      }
+
+      // each decision is a 'data' event, like received datagrams
+      peer->setBufferTuning(
+        options.enabled,
+        options.minSize,
+        options.maxSize,
+        options.interval,
+        [cb](JSON::Object::Entries data) {
+          auto json = JSON::Object::Entries {
+            {"source", "udp.setBufferTuning"},
+            {"data", data}
+          };
+
+          cb("-1", json, Post{});
+        }
+      );
+
+      Lock lock(peer->mutex);
+      auto& tuner = peer->bufferTuner;
+      auto json = JSON::Object::Entries {
+        {"source", "udp.setBufferTuning"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(peerId)},
+          {"enabled", tuner.enabled},
+          {"size", (uint64_t) peer->getReceiveBufferSize()},
+          {"minSize", (uint64_t) tuner.minSize},
+          {"maxSize", (uint64_t) tuner.maxSize},
+          {"interval", tuner.interval}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::UDP::setCongestionControl (
+    const String seq,
+    uint64_t peerId,
+    UDP::CongestionControlOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this] {
+      auto peer = this->core->getPeer(peerId);
+
+      if (peer == nullptr) {
+        auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.setCongestionControl", peerId);
+        return cb(seq, json, Post{});
+      }
+
+      peer->setCongestionControl(options.enabled, options.maxPacingRate);
+
+      auto json = JSON::Object::Entries {
+        {"source", "udp.setCongestionControl"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(peerId)},
+          {"enabled", options.enabled},
+          {"maxPacingRate", options.maxPacingRate}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  void Core::UDP::setSendQueueLimits (
+    const String seq,
+    uint64_t peerId,
+    UDP::SendQueueOptions options,
+    Module::Callback cb
+  ) {
+    this->core->dispatchEventLoop([=, this] {
+      auto peer = this->core->getPeer(peerId);
+
+      if (peer == nullptr) {
+        auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.setSendQueueLimits", peerId);
+        return cb(seq, json, Post{});
+      }
+
+      do {
+        Lock lock(peer->mutex);
+        auto& limits = peer->options.udp.sendQueue;
+        limits.maxBytes = options.maxBytes;
+        limits.maxCount = options.maxCount;
+        limits.policy = options.policy;
+      } while (0);
+
+      // raised limits may let held back sends through, and sends held
+      // back under the old policy are failed like new ones would be
+      if (options.policy == PEER_SEND_QUEUE_POLICY_REJECT) {
+        peer->cancelSendQueue();
+      } else {
+        peer->flushSendQueue();
+      }
+
+      auto json = JSON::Object::Entries {
+        {"source", "udp.setSendQueueLimits"},
+        {"data", JSON::Object::Entries {
+          {"id", std::to_string(peerId)},
+          {"maxBytes", (uint64_t) options.maxBytes},
+          {"maxCount", (uint64_t) options.maxCount},
+          {"policy", getSendQueuePolicyName(options.policy)}
+        }}
+      };
+
+      cb(seq, json, Post{});
+    });
+  }
+
+  // delivers a received datagram or FEC block packet, `bytes` are owned
+  // by the `Post` after this
+  static void onReadStartMessage (
+    uint64_t peerId,
+    const Core::UDP::ReadStartOptions& options,
+    char *bytes,
+    size_t size,
+    const char *address,
+    int port,
+    uint64_t timestamp,
+    JSON::Any fec,
+    Core::Module::Callback cb
+  ) {
+    auto data = JSON::Object::Entries {
+      {"id", std::to_string(peerId)},
+      {"port", port},
+      {"address", address},
+      // milliseconds since the epoch
+      {"timestamp", timestamp / 1e6}
+    };
+
+    Post post;
+    post.id = rand64();
+    post.body = bytes;
+    post.length = (int) size;
+
+    StreamRelay::Packet packet;
+
+    // deliver the decoded headers as JSON and only the packet message
+    // as the body, other datagrams are delivered untouched
+    if (
+      options.decodePackets &&
+      StreamRelay::decodePacket(bytes, size, packet)
+    ) {
+      memmove(bytes, packet.message, packet.messageLength);
+      post.length = (int) packet.messageLength;
+      data["packet"] = StreamRelay::getPacketHeaders(packet);
+    }
+
+    if (fec.type != JSON::Type::Null) {
+      data["fec"] = fec;
+    }
+
+    auto headers = Headers {{
+      {"content-type" ,"application/octet-stream"},
+      {"content-length", post.length}
+    }};
+
+    post.headers = headers.str();
+    data["bytes"] = std::to_string(post.length);
+
+    auto json = JSON::Object::Entries {
+      {"source", "udp.readStart"},
+      {"data", data}
+    };
+
+    cb("-1", json, post);
+  }
+
+  void Core::UDP::readStart (
+    String seq,
+    uint64_t peerId,
+    UDP::ReadStartOptions options,
+    Module::Callback cb
+  ) {
     auto peer = this->core->getPeer(peerId);
 
+    if (peer == nullptr) {
+      auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.readStart", peerId);
+      return cb(seq, json, Post{});
+    }
+
     if (peer->isClosed()) {
       auto json = ERR_SOCKET_DGRAM_CLOSED("udp.readStart", peerId);
       return cb(seq, json, Post{});
@@ -423,7 +1920,8 @@ namespace SSC {
       return cb(seq, json, Post{});
     }
 
-    auto err = peer->recvstart([=](auto nread, auto buf, auto addr) {
+    auto decoder = std::make_shared<SSC::FEC::BlockDecoder>();
+    auto err = peer->recvstart([=](auto nread, auto buf, auto addr, auto timestamp) {
       if (nread == UV_EOF) {
         auto json = JSON::Object::Entries {
           {"source", "udp.readStart"},
@@ -436,32 +1934,37 @@ namespace SSC {
         cb("-1", json, Post{});
       } else if (nread > 0) {
         char address[17] = {0};
-        Post post;
+        SSC::FEC::Frame frame;
         int port;
 
         parseAddress((struct sockaddr *) addr, &port, address);
 
-        auto headers = Headers {{
-          {"content-type" ,"application/octet-stream"},
-          {"content-length", nread}
-        }};
-
-        post.id = rand64();
-        post.body = buf->base;
-        post.length = (int) nread;
-        post.headers = headers.str();
-
-        auto json = JSON::Object::Entries {
-          {"source", "udp.readStart"},
-          {"data", JSON::Object::Entries {
-            {"id", std::to_string(peerId)},
-            {"port", port},
-            {"bytes", std::to_string(post.length)},
-            {"address", address}
-          }}
-        };
+        if (
+          options.fec &&
+          SSC::FEC::decodeFrame(buf->base, (size_t) nread, frame)
+        ) {
+          Vector<SSC::FEC::BlockDecoder::Output> packets;
+          auto source = String(address) + ":" + std::to_string(port);
+
+          decoder->receive(source, frame, packets);
+          delete [] buf->base;
+
+          for (const auto& packet : packets) {
+            auto size = packet.bytes.size();
+            auto bytes = new char[size + 1]{0};
+
+            memcpy(bytes, packet.bytes.data(), size);
+            onReadStartMessage(peerId, options, bytes, size, address, port, timestamp, JSON::Object::Entries {
+              {"blockId", (uint64_t) packet.blockId},
+              {"index", (uint64_t) packet.index},
+              {"recovered", packet.recovered}
+            }, cb);
+          }
+
+          return;
+        }
 
-        cb("-1", json, post);
+        onReadStartMessage(peerId, options, buf->base, (size_t) nread, address, port, timestamp, nullptr, cb);
       }
     });
 
@@ -495,13 +1998,13 @@ namespace SSC {
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this] {
-      if (!this->core->hasPeer(peerId)) {
+      auto peer = this->core->getPeer(peerId);
+
+      if (peer == nullptr) {
         auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.readStop", peerId);
         return cb(seq, json, Post{});
       }
 
-      auto peer = this->core->getPeer(peerId);
-
       if (peer->isClosed()) {
         auto json = ERR_SOCKET_DGRAM_CLOSED("udp.readStop", peerId);
         return cb(seq, json, Post{});
@@ -555,13 +2058,13 @@ namespace SSC {
     Module::Callback cb
   ) {
     this->core->dispatchEventLoop([=, this]() {
-      if (!this->core->hasPeer(peerId)) {
+      auto peer = this->core->getPeer(peerId);
+
+      if (peer == nullptr) {
         auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.close", peerId);
         return cb(seq, json, Post{});
       }
 
-      auto peer = this->core->getPeer(peerId);
-
       if (!peer->isUDP()) {
         auto json = ERR_SOCKET_DGRAM_NOT_RUNNING("udp.close", peerId);
         return cb(seq, json, Post{});
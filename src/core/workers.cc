@@ -0,0 +1,144 @@
+#include "core.hh"
+
+namespace SSC {
+  Core::Workers::~Workers () {
+    this->stop();
+  }
+
+  size_t Core::Workers::size () const {
+    // the loop and UI threads keep a CPU to themselves
+    auto concurrency = std::thread::hardware_concurrency();
+    return concurrency > 1 ? concurrency - 1 : 1;
+  }
+
+  void Core::Workers::start () {
+    auto count = this->size();
+
+    for (size_t i = 0; i < count; ++i) {
+      this->workers.push_back(std::make_unique<Worker>());
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      this->threads.emplace_back([this, i]() {
+        this->run(i);
+      });
+    }
+  }
+
+  void Core::Workers::stop () {
+    do {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stopping = true;
+    } while (0);
+
+    // queued tasks still run before the workers exit
+    this->condition.notify_all();
+
+    for (auto& thread : this->threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+
+    this->threads.clear();
+  }
+
+  bool Core::Workers::submit (
+    Work work,
+    EventLoopDispatchCallback done,
+    Priority priority
+  ) {
+    if (work == nullptr || this->stopping) {
+      return false;
+    }
+
+    std::call_once(this->started, [this]() {
+      this->start();
+    });
+
+    auto count = this->workers.size();
+    auto first = this->next++ % count;
+    auto queued = false;
+
+    // the next worker in turn, or the first one with room
+    for (size_t i = 0; i < count && !queued; ++i) {
+      auto& worker = this->workers[(first + i) % count];
+      Lock lock(worker->mutex);
+
+      if (worker->queued < MAX_QUEUED_TASKS) {
+        worker->queues[(size_t) priority].push_back(Task { work, done });
+        worker->queued++;
+        queued = true;
+      }
+    }
+
+    if (!queued) {
+      return false;
+    }
+
+    do {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->pending++;
+    } while (0);
+
+    this->condition.notify_one();
+    return true;
+  }
+
+  bool Core::Workers::take (size_t index, Task& task) {
+    auto count = this->workers.size();
+
+    // higher priorities first, from this worker's own queue before the others
+    for (size_t level = PRIORITIES; level-- > 0;) {
+      for (size_t i = 0; i < count; ++i) {
+        auto& worker = this->workers[(index + i) % count];
+        Lock lock(worker->mutex);
+        auto& queue = worker->queues[level];
+
+        if (queue.size() == 0) {
+          continue;
+        }
+
+        // own tasks are taken oldest first, stolen ones newest first
+        if (i == 0) {
+          task = std::move(queue.front());
+          queue.pop_front();
+        } else {
+          task = std::move(queue.back());
+          queue.pop_back();
+        }
+
+        worker->queued--;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void Core::Workers::run (size_t index) {
+    while (true) {
+      Task task;
+
+      if (this->take(index, task)) {
+        this->pending--;
+        task.work();
+
+        if (task.done != nullptr) {
+          this->core->dispatchEventLoop(task.done);
+        }
+
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(this->mutex);
+      this->condition.wait(lock, [this]() {
+        return this->stopping || this->pending > 0;
+      });
+
+      if (this->stopping && this->pending == 0) {
+        return;
+      }
+    }
+  }
+}
@@ -3,6 +3,8 @@
 #include "../window/window.hh"
 #include "../ipc/ipc.hh"
 
+#include <future>
+
 //
 // A cross platform MAIN macro that
 // magically gives us argc and argv.
@@ -34,6 +36,100 @@ void signalHandler (int signal) {
   }
 }
 
+//
+// Output and exit of a backend process go through its gate. The gate holds
+// them back while the process is a prewarmed spare (see `cmd_prewarm`),
+// and drops them once the process was replaced.
+//
+class BackendGate {
+  public:
+    enum class State { spare, active, retired };
+
+    using Clock = std::chrono::steady_clock;
+
+    BackendGate (State state) : state(state) {}
+
+    // Delivers now when the process is active, once it is swapped in
+    // while it is a spare, or never once it was replaced.
+    void pass (std::function<void()> deliver) {
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->warmStartTime < 0) {
+          this->warmStartTime = elapsed(this->started);
+        }
+
+        if (this->state == State::retired) {
+          return;
+        }
+
+        if (this->state == State::spare || this->activating) {
+          this->held.push_back(deliver);
+          return;
+        }
+      }
+
+      deliver();
+    }
+
+    // Delivers what was held back in order, output that arrives meanwhile
+    // is queued behind it.
+    void activate () {
+      Vector<std::function<void()>> held;
+
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->state = State::active;
+        this->activating = true;
+      }
+
+      while (true) {
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          if (this->held.size() == 0) {
+            this->activating = false;
+            return;
+          }
+
+          held.swap(this->held);
+        }
+
+        for (const auto& deliver : held) {
+          deliver();
+        }
+
+        held.clear();
+      }
+    }
+
+    void retire () {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->state = State::retired;
+      this->held.clear();
+    }
+
+    // milliseconds from the start of the process to its first output,
+    // `-1` if it wrote nothing yet
+    int64_t getWarmStartTime () {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      return this->warmStartTime;
+    }
+
+    static int64_t elapsed (Clock::time_point since) {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - since
+      ).count();
+    }
+
+  private:
+    std::mutex mutex;
+    State state;
+    bool activating = false;
+    Vector<std::function<void()>> held;
+    Clock::time_point started = Clock::now();
+    int64_t warmStartTime = -1;
+};
+
 SSC::String getNavigationError (const String &cwd, const String &value) {
   if (!value.starts_with("file://")) {
     return SSC::String("only file:// protocol is allowed for the file navigation. Got url ") + value;
@@ -220,6 +316,7 @@ MAIN {
 
       if (processToKill == process) {
         process = nullptr;
+        app.core->channel.close();
       }
 
       delete processToKill;
@@ -294,111 +391,294 @@ MAIN {
   // # Backend -> Main
   // Launch the backend process and connect callbacks to the stdio and stderr pipes.
   //
-  auto onStdOut = [&](SSC::String const &out) {
+  auto onBackendMessage = [&](SSC::String const &out) {
     //
     // ## Dispatch
     // Messages from the backend process may be sent to the render process. If they
     // are parsable commands, try to do something with them, otherwise they are
     // just stdout and we can write the data to the pipe.
     //
-    app.dispatch([&, out] {
-      IPC::Message message(out);
+    IPC::Message message(out);
 
-      auto value = message.get("value");
-      auto seq = message.get("seq");
+    auto value = message.get("value");
+    auto seq = message.get("seq");
 
-      if (message.index > 0 && message.name.size() == 0) {
-        // @TODO: print warning
-        return;
-      }
+    if (message.index > 0 && message.name.size() == 0) {
+      // @TODO: print warning
+      return;
+    }
 
-      if (message.index > SSC_MAX_WINDOWS) {
-        // @TODO: print warning
-        return;
-      }
+    if (message.index > SSC_MAX_WINDOWS) {
+      // @TODO: print warning
+      return;
+    }
 
-      if (message.name == "send") {
-        if (message.index >= 0) {
-          auto window = windowManager.getWindow(message.index);
-          if (window) {
+    if (message.name == "send") {
+      if (message.index >= 0) {
+        auto window = windowManager.getWindow(message.index);
+        if (window) {
+          window->eval(getEmitToRenderProcessJavaScript(
+            decodeURIComponent(message.get("event")),
+            value
+          ));
+        }
+      } else {
+        for (auto w : windowManager.windows) {
+          if (w != nullptr) {
+            auto window = windowManager.getWindow(w->opts.index);
             window->eval(getEmitToRenderProcessJavaScript(
               decodeURIComponent(message.get("event")),
               value
             ));
           }
-        } else {
-          for (auto w : windowManager.windows) {
-            if (w != nullptr) {
-              auto window = windowManager.getWindow(w->opts.index);
-              window->eval(getEmitToRenderProcessJavaScript(
-                decodeURIComponent(message.get("event")),
-                value
-              ));
-            }
-          }
         }
-        return;
       }
+      return;
+    }
 
-      auto window = windowManager.getOrCreateWindow(message.index);
-
-      if (!window) {
-        auto defaultWindow = windowManager.getWindow(0);
+    auto window = windowManager.getOrCreateWindow(message.index);
 
-        if (defaultWindow) {
-          window = defaultWindow;
-        }
+    if (!window) {
+      auto defaultWindow = windowManager.getWindow(0);
 
-        // @TODO: print warning
+      if (defaultWindow) {
+        window = defaultWindow;
       }
 
-      if (message.name == "heartbeat") {
-        if (seq.size() > 0) {
-          auto result = SSC::IPC::Result(message.seq, message, "heartbeat");
-          window->resolvePromise(seq, OK_STATE, result.str());
-        }
+      // @TODO: print warning
+    }
 
-        return;
+    if (message.name == "heartbeat") {
+      if (seq.size() > 0) {
+        auto result = SSC::IPC::Result(message.seq, message, "heartbeat");
+        window->resolvePromise(seq, OK_STATE, result.str());
       }
 
-      if (message.name == "resolve") {
-        window->resolvePromise(seq, message.get("state"), encodeURIComponent(value));
-        return;
-      }
+      return;
+    }
 
-      if (message.name == "config") {
-        auto key = message.get("key");
-        window->resolvePromise(seq, OK_STATE, app.appData[key]);
-        return;
-      }
+    if (message.name == "resolve") {
+      window->resolvePromise(seq, message.get("state"), encodeURIComponent(value));
+      return;
+    }
 
-      if (message.name == "process.exit") {
-        for (auto w : windowManager.windows) {
-          if (w != nullptr) {
-            auto window = windowManager.getWindow(w->opts.index);
-            window->resolvePromise(message.seq, OK_STATE, value);
-          }
+    if (message.name == "config") {
+      auto key = message.get("key");
+      window->resolvePromise(seq, OK_STATE, app.appData[key]);
+      return;
+    }
+
+    if (message.name == "process.exit") {
+      for (auto w : windowManager.windows) {
+        if (w != nullptr) {
+          auto window = windowManager.getWindow(w->opts.index);
+          window->resolvePromise(message.seq, OK_STATE, value);
         }
-        return;
       }
+      return;
+    }
+  };
+
+  auto onStdOut = [&](SSC::String const &out) {
+    app.dispatch([&, out] {
+      onBackendMessage(out);
     });
   };
 
-  createProcess = createProcessTemplate(
-    cmd,
-    argvForward.str(),
-    cwd,
-    onStdOut,
-    onStdErr,
-    [&](SSC::String const &code) {
-      for (auto w : windowManager.windows) {
-        if (w != nullptr) {
+  //
+  // Frames from the backend over the channel are decoded on the Core loop
+  // and dispatched once per read. The body of a `send` frame is given to
+  // the render processes as bytes, other frames are handled like stdout.
+  //
+  auto onChannelFrames = [&](Vector<Core::Channel::Frame>& frames) {
+    app.dispatch([&, frames] {
+      for (const auto& frame : frames) {
+        IPC::Message message(frame.uri);
+
+        if (frame.size == 0 || message.name != "send") {
+          onBackendMessage(frame.uri);
+          continue;
+        }
+
+        auto json = JSON::Object::Entries {
+          {"source", "channel.send"},
+          {"data", JSON::Object::Entries {
+            {"event", message.get("event")},
+            {"index", message.index}
+          }}
+        };
+
+        auto headers = Headers {{
+          {"content-type" ,"application/octet-stream"},
+          {"content-length", frame.size}
+        }};
+
+        Vector<SSC::WindowManager::ManagedWindow*> windows;
+
+        for (auto w : windowManager.windows) {
+          if (w == nullptr) continue;
+          if (message.index >= 0 && w->opts.index != message.index) continue;
+
           auto window = windowManager.getWindow(w->opts.index);
-          window->eval(getEmitToRenderProcessJavaScript("backend-exit", code));
+          if (window) windows.push_back(window);
         }
+
+        // every post shares the frame bytes, freed with the last of them
+        for (auto window : windows) {
+          Post post;
+          post.id = rand64();
+          post.body = frame.bytes.get();
+          post.length = frame.size;
+          post.headers = headers.str();
+          post.storage = std::shared_ptr<char>(frame.bytes, frame.bytes.get());
+
+          window->bridge->router.send("-1", JSON::Object(json).str(), post);
+        }
+      }
+    });
+  };
+
+  auto onExit = [&](SSC::String const &code) {
+    for (auto w : windowManager.windows) {
+      if (w != nullptr) {
+        auto window = windowManager.getWindow(w->opts.index);
+        window->eval(getEmitToRenderProcessJavaScript("backend-exit", code));
+      }
+    }
+  };
+
+  auto createBackendProcess = [&](std::shared_ptr<BackendGate> gate) {
+    return new Process(
+      cmd,
+      argvForward.str(),
+      cwd,
+      [&, gate](SSC::String const &out) { gate->pass([&, out] { onStdOut(out); }); },
+      [&, gate](SSC::String const &err) { gate->pass([&, err] { onStdErr(err); }); },
+      [&, gate](SSC::String const &code) { gate->pass([&, code] { onExit(code); }); }
+    );
+  };
+
+  std::shared_ptr<BackendGate> processGate;
+
+  //
+  // # Prewarming
+  // With `cmd_prewarm` a spare backend is started next to the running one.
+  // A restart swaps it in instead of starting a new process, the replaced
+  // process is stopped in the background and a new spare is started.
+  //
+  Process* spare = nullptr;
+  std::shared_ptr<BackendGate> spareGate;
+
+  // replaced processes being stopped, waited for at shutdown
+  Vector<std::future<void>> stoppers;
+
+  // times in milliseconds, `-1` until measured
+  struct {
+    uint64_t coldStarts = 0;
+    uint64_t swaps = 0;
+    double lastColdStartTime = -1;
+    double lastSwapTime = -1;
+    double totalSwapTime = 0;
+    // from the start of the last swapped in spare to its first output
+    int64_t lastWarmStartTime = -1;
+  } backendStats;
+
+  auto channel = app.appData[platform.os + "_cmd_channel"];
+  auto prewarm = app.appData[platform.os + "_cmd_prewarm"] == "true";
+
+  // the descriptors of a channel are given to the process it is opened for
+  if (prewarm && (channel == "true" || channel == "socket" || channel == "shm")) {
+    debug("cmd_prewarm has no effect with cmd_channel");
+    prewarm = false;
+  }
+
+  auto startSpare = [&]() {
+    if (!prewarm || spare != nullptr) {
+      return;
+    }
+
+    spareGate = std::make_shared<BackendGate>(BackendGate::State::spare);
+    spare = createBackendProcess(spareGate);
+
+    if (spare->open() <= 0) {
+      spareGate->retire();
+      delete spare;
+      spare = nullptr;
+      spareGate = nullptr;
+    }
+  };
+
+  auto stopInBackground = [&](Process* processToStop) {
+    std::erase_if(stoppers, [](auto& stopper) {
+      return stopper.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+
+    stoppers.push_back(std::async(std::launch::async, [processToStop] {
+      processToStop->kill(processToStop->getPID());
+      processToStop->wait();
+      delete processToStop;
+    }));
+  };
+
+  createProcess = [&](bool force) {
+    using Clock = std::chrono::steady_clock;
+    auto started = Clock::now();
+    auto elapsed = [&] {
+      return std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+    };
+
+    // a spare that exited on its own is of no use
+    if (spare != nullptr && spare->closed) {
+      spareGate->retire();
+      stopInBackground(spare);
+      spare = nullptr;
+      spareGate = nullptr;
+    }
+
+    if (spare != nullptr) {
+      if (process != nullptr) {
+        processGate->retire();
+        stopInBackground(process);
       }
+
+      process = spare;
+      processGate = spareGate;
+      spare = nullptr;
+      spareGate = nullptr;
+      processGate->activate();
+
+      backendStats.swaps++;
+      backendStats.lastSwapTime = elapsed();
+      backendStats.totalSwapTime += backendStats.lastSwapTime;
+      backendStats.lastWarmStartTime = processGate->getWarmStartTime();
+      return;
     }
-  );
+
+    if (process != nullptr && force) {
+      killProcess(process);
+    }
+
+    processGate = std::make_shared<BackendGate>(BackendGate::State::active);
+    process = createBackendProcess(processGate);
+
+    auto err = -1;
+
+    if (channel == "true" || channel == "socket") {
+      err = app.core->channel.open(onChannelFrames);
+    } else if (channel == "shm") {
+      err = app.core->channel.openSharedMemory(onChannelFrames);
+    }
+
+    if (err >= 0) {
+      process->argv += app.core->channel.getBackendArguments();
+    }
+
+    process->open();
+    app.core->channel.closeRemoteDescriptors();
+
+    backendStats.coldStarts++;
+    backendStats.lastColdStartTime = elapsed();
+  };
 
   //
   // # Render -> Main
@@ -430,7 +710,7 @@ MAIN {
       if (cmd.size() > 0) {
         if (process == nullptr || force) {
           createProcess(force);
-          process->open();
+          startSpare();
         }
       #ifdef _WIN32
         size_t last_pos = 0;
@@ -462,10 +742,39 @@ MAIN {
       return;
     }
 
+    if (message.name == "diagnostics.backend") {
+      auto seq = message.get("seq");
+      auto averageSwapTime = backendStats.swaps > 0
+        ? backendStats.totalSwapTime / backendStats.swaps
+        : -1.0;
+
+      const JSON::Object json = JSON::Object::Entries {
+        { "running", process != nullptr },
+        { "prewarm", prewarm },
+        { "spare", spare == nullptr ? JSON::Any(nullptr) : JSON::Any(JSON::Object::Entries {
+          { "pid", (uint64_t) spare->getPID() },
+          { "warmStartTime", spareGate->getWarmStartTime() }
+        })},
+        { "coldStarts", backendStats.coldStarts },
+        { "swaps", backendStats.swaps },
+        { "lastColdStartTime", backendStats.lastColdStartTime },
+        { "lastSwapTime", backendStats.lastSwapTime },
+        { "averageSwapTime", averageSwapTime },
+        { "lastWarmStartTime", backendStats.lastWarmStartTime }
+      };
+
+      window->resolvePromise(seq, OK_STATE, json);
+      return;
+    }
+
     if (message.name == "process.write") {
       auto seq = message.get("seq");
       if (cmd.size() > 0 && process != nullptr) {
-        process->write(out);
+        if (app.core->channel.isOpen()) {
+          app.core->channel.write(out, nullptr, 0);
+        } else {
+          process->write(out);
+        }
       }
       window->resolvePromise(seq, OK_STATE, SSC::JSON::null);
       return;
@@ -946,6 +1255,20 @@ MAIN {
       auto pid = process->getPID();
       process->kill(pid);
     }
+
+    if (spare != nullptr) {
+      spareGate->retire();
+      spare->kill(spare->getPID());
+      spare->wait();
+      delete spare;
+      spare = nullptr;
+      spareGate = nullptr;
+    }
+
+    for (auto& stopper : stoppers) {
+      stopper.wait();
+    }
+
     windowManager.destroy();
     app_ptr->kill();
     exit(code);
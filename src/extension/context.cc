@@ -9,9 +9,7 @@ sapi_context_t* sapi_context_create (
     return nullptr;
   }
 
-  auto context = retained || parent == nullptr
-    ? new sapi_context_t(parent)
-    : parent->memory.alloc<sapi_context_t>();
+  auto context = new sapi_context_t(parent);
 
   if (retained || parent == nullptr) {
     context->retained = true;
@@ -19,11 +17,15 @@ sapi_context_t* sapi_context_create (
 
   if (parent != nullptr) {
     context->context = parent;
+    context->storage = SSC::Extension::Context::Storage::Child;
     context->extension = parent->extension;
     context->router = parent->router;
     context->config = parent->config;
     context->data = parent->data;
     context->policies = parent->policies;
+
+    SSC::Lock lock(parent->children.mutex);
+    parent->children.contexts.insert(context);
   }
 
   return context;
@@ -71,7 +73,7 @@ void sapi_context_release (sapi_context_t* ctx) {
     return;
   }
   ctx->release();
-  delete ctx;
+  SSC::Extension::Context::dispose(ctx);
 }
 
 uv_loop_t* sapi_context_get_loop (const sapi_context_t* ctx) {
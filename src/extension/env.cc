@@ -27,7 +27,7 @@ const char* sapi_env_get (
     return nullptr;
   }
 
-  auto pointer = ctx->memory.alloc<char>(value.size());
+  auto pointer = ctx->memory.alloc<char>(value.size() + 1);
   return reinterpret_cast<const char*>(
     memcpy(pointer, value.c_str(), value.size())
   );
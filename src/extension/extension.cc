@@ -134,8 +134,126 @@ namespace SSC {
   }
 
   void Extension::Context::release () {
+    std::set<Context*> children;
     this->retained = false;
+
+    do {
+      Lock lock(this->children.mutex);
+      children.swap(this->children.contexts);
+    } while (0);
+
+    // children are owned by their parent, unless they were retained
+    for (auto child : children) {
+      if (child->retained) {
+        child->context = nullptr;
+        child->storage = Storage::Heap;
+      } else {
+        child->context = nullptr;
+        child->release();
+        delete reinterpret_cast<sapi_context_t*>(child);
+      }
+    }
+
+    // request contexts keep their chunks for the next message
+    if (this->storage == Storage::Pool) {
+      this->memory.reset();
+      return;
+    }
+
     this->memory.release();
+
+    Lock lock(this->requests.mutex);
+    for (auto context : this->requests.contexts) {
+      delete reinterpret_cast<sapi_context_t*>(context);
+    }
+
+    // requests in flight outlive their route and are deleted once replied to
+    for (auto context : this->requests.active) {
+      context->context = nullptr;
+      context->storage = Storage::Heap;
+    }
+
+    this->requests.contexts.clear();
+    this->requests.active.clear();
+  }
+
+  Extension::Context* Extension::Context::acquire () {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<Context*> abandoned;
+    Context* context = nullptr;
+
+    do {
+      Lock lock(this->requests.mutex);
+
+      // a route that never replies would otherwise hold its context forever
+      for (auto it = this->requests.active.begin(); it != this->requests.active.end();) {
+        auto request = *it;
+        if (!request->retained && now - request->acquired > RequestPool::MAX_REQUEST_AGE) {
+          abandoned.push_back(request);
+          it = this->requests.active.erase(it);
+        } else {
+          ++it;
+        }
+      }
+
+      if (this->requests.contexts.size() > 0) {
+        context = this->requests.contexts.back();
+        this->requests.contexts.pop_back();
+      }
+    } while (0);
+
+    for (auto request : abandoned) {
+      request->release();
+      delete reinterpret_cast<sapi_context_t*>(request);
+    }
+
+    if (context == nullptr) {
+      context = new sapi_context_t(reinterpret_cast<sapi_context_t*>(this));
+      context->context = this;
+      context->storage = Storage::Pool;
+    }
+
+    // policies of the route may have changed since the context was pooled
+    context->policies = this->policies;
+    context->acquired = now;
+
+    Lock lock(this->requests.mutex);
+    this->requests.active.insert(context);
+    return context;
+  }
+
+  void Extension::Context::dispose (Context* context) {
+    if (context == nullptr) return;
+
+    if (context->storage == Storage::Heap) {
+      delete reinterpret_cast<sapi_context_t*>(context);
+    } else if (context->storage == Storage::Child) {
+      auto parent = context->context;
+
+      if (parent != nullptr) {
+        Lock lock(parent->children.mutex);
+        parent->children.contexts.erase(context);
+      }
+
+      delete reinterpret_cast<sapi_context_t*>(context);
+    } else if (context->storage == Storage::Pool) {
+      auto parent = context->context;
+
+      context->internal = nullptr;
+      context->state = State::None;
+      context->error = Error {};
+
+      do {
+        Lock lock(parent->requests.mutex);
+        parent->requests.active.erase(context);
+        if (parent->requests.contexts.size() < RequestPool::MAX_IDLE_CONTEXTS) {
+          parent->requests.contexts.push_back(context);
+          return;
+        }
+      } while (0);
+
+      delete reinterpret_cast<sapi_context_t*>(context);
+    }
   }
 
   Extension::Context* Extension::getContext (const String& name) {
@@ -188,15 +306,114 @@ namespace SSC {
     this->release();
   }
 
-  void Extension::Context::Memory::release () {
+  void* Extension::Context::Memory::allocate (size_t size, size_t alignment) {
+    Lock lock(this->mutex);
+
+    while (this->current < this->chunks.size()) {
+      auto& chunk = this->chunks[this->current];
+      auto address = reinterpret_cast<uintptr_t>(chunk.bytes) + chunk.used;
+      auto padding = (alignment - address % alignment) % alignment;
+
+      if (chunk.used + padding + size <= chunk.size) {
+        chunk.used += padding + size;
+        return chunk.bytes + chunk.used - size;
+      }
+
+      this->current++;
+    }
+
+    // chunks double up to `MAX_CHUNK_SIZE`, larger objects get their own
+    auto last = this->chunks.size() > 0 ? this->chunks.back().size : 0;
+    auto chunk = Chunk {};
+    chunk.size = std::min(MAX_CHUNK_SIZE, std::max(CHUNK_SIZE, last * 2));
+
+    if (size + alignment > chunk.size) {
+      chunk.size = size + alignment;
+    }
+
+    chunk.bytes = new unsigned char[chunk.size];
+
+    auto address = reinterpret_cast<uintptr_t>(chunk.bytes);
+    auto padding = (alignment - address % alignment) % alignment;
+
+    chunk.used = padding + size;
+    this->chunks.push_back(chunk);
+    this->current = this->chunks.size() - 1;
+
+    return chunk.bytes + padding;
+  }
+
+  void Extension::Context::Memory::finalize (
+    void* pointer,
+    void (*callback)(void*)
+  ) {
+    auto finalizer = new (this->allocate(
+      sizeof(Finalizer),
+      alignof(Finalizer)
+    )) Finalizer { callback, pointer, nullptr };
+
     Lock lock(this->mutex);
-    if (this->pool.size() > 0) {
-      for (const auto& releaseCallback: this->pool) {
-        releaseCallback();
+    finalizer->next = this->finalizers;
+    this->finalizers = finalizer;
+  }
+
+  void Extension::Context::Memory::reset () {
+    Finalizer* finalizer = nullptr;
+
+    do {
+      Lock lock(this->mutex);
+      finalizer = this->finalizers;
+      this->finalizers = nullptr;
+    } while (0);
+
+    // objects are destroyed in reverse order of allocation
+    while (finalizer != nullptr) {
+      auto next = finalizer->next;
+      finalizer->callback(finalizer->pointer);
+      finalizer = next;
+    }
+
+    Lock lock(this->mutex);
+    size_t retained = 0;
+    size_t count = 0;
+
+    // keep the regular chunks for the next request, up to `MAX_CHUNK_SIZE` * 4
+    for (auto& chunk : this->chunks) {
+      if (chunk.size <= MAX_CHUNK_SIZE && retained + chunk.size <= MAX_CHUNK_SIZE * 4) {
+        retained += chunk.size;
+        chunk.used = 0;
+        this->chunks[count++] = chunk;
+      } else {
+        delete [] chunk.bytes;
       }
+    }
+
+    this->chunks.resize(count);
+    this->current = 0;
+  }
+
+  void Extension::Context::Memory::release () {
+    this->reset();
 
-      this->pool.clear();
+    Lock lock(this->mutex);
+    for (const auto& chunk : this->chunks) {
+      delete [] chunk.bytes;
     }
+
+    this->chunks.clear();
+  }
+
+  void Extension::Context::Memory::push (std::function<void()> callback) {
+    using Callback = std::function<void()>;
+    auto memory = new (this->allocate(sizeof(Callback), alignof(Callback))) Callback(
+      std::move(callback)
+    );
+
+    this->finalize(memory, [](void* pointer) {
+      auto callback = reinterpret_cast<Callback*>(pointer);
+      (*callback)();
+      callback->~Callback();
+    });
   }
 
   String Extension::getExtensionsDirectory (const String& name) {
@@ -208,11 +425,6 @@ namespace SSC {
   #endif
   }
 
-  void Extension::Context::Memory::push (std::function<void()> callback) {
-    Lock lock(this->mutex);
-    this->pool.push_back(callback);
-  }
-
   Extension::Extension (const String& name, const Initializer initializer)
     : name(name), initializer(initializer)
   {
@@ -38,33 +38,72 @@ namespace SSC {
           {}
         };
 
+        // bump-pointer arena for the objects handed out to an extension
+        // during a request, rewound with `reset()` once it is replied
         struct Memory {
-          std::vector<std::function<void()>> pool;
+          static constexpr size_t CHUNK_SIZE = 4 * 1024;
+          static constexpr size_t MAX_CHUNK_SIZE = 64 * 1024;
+
+          struct Chunk {
+            unsigned char* bytes = nullptr;
+            size_t size = 0;
+            size_t used = 0;
+          };
+
+          // destructors of non-trivial objects, stored in the arena itself
+          struct Finalizer {
+            void (*callback)(void*) = nullptr;
+            void* pointer = nullptr;
+            Finalizer* next = nullptr;
+          };
+
+          std::vector<Chunk> chunks;
+          size_t current = 0;
+          Finalizer* finalizers = nullptr;
           Mutex mutex;
 
+          Memory () = default;
+          Memory (const Memory&) = delete;
           ~Memory ();
+
+          void* allocate (size_t size, size_t alignment);
+          void finalize (void* pointer, void (*callback)(void*));
+          void reset ();
           void release ();
           void push (std::function<void()> callback);
+
+          template <typename T, typename... Args> T* create (Args&&... args) {
+            auto memory = new (this->allocate(sizeof(T), alignof(T))) T(
+              std::forward<Args>(args)...
+            );
+
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+              this->finalize(memory, [](void* pointer) {
+                reinterpret_cast<T*>(pointer)->~T();
+              });
+            }
+
+            return memory;
+          }
+
           template <typename T, typename C, typename... Args> T* alloc (
             C* ctx,
             Args... args
           ) {
-            auto memory = new T(args...);
+            auto memory = this->create<T>(args...);
             memory->context = ctx;
-            push([memory]() { delete memory; });
             return memory;
           }
 
           template <typename T, typename... Args> T* alloc (Args... args) {
-            auto memory = new T(args...);
-            push([memory]() { delete memory; });
-            return memory;
+            return this->create<T>(args...);
           }
 
-          template <typename T> T* alloc (unsigned int size) {
-            auto memory = new T[size]{0};
-            push([memory]() { delete [] memory; });
-            return memory;
+          // zero filled array of `size` elements
+          template <typename T> T* alloc (size_t size) {
+            static_assert(std::is_trivially_destructible_v<T>);
+            auto memory = this->allocate(sizeof(T) * size, alignof(T));
+            return reinterpret_cast<T*>(memset(memory, 0, sizeof(T) * size));
           }
         };
 
@@ -76,7 +115,34 @@ namespace SSC {
         void *internal = nullptr;
         const void *data = nullptr;
 
+        // how a context is disposed of once it is released
+        enum class Storage {
+          Heap = 0, // deleted
+          Child = 1, // deleted, or destroyed with its parent if not retained
+          Pool = 2 // returned to the request pool of its parent
+        };
+
+        // request contexts of a mapped route, idle ones are reused across
+        // messages and the ones in flight are reaped if never replied to
+        struct RequestPool {
+          static constexpr size_t MAX_IDLE_CONTEXTS = 64;
+          static constexpr auto MAX_REQUEST_AGE = std::chrono::minutes(5);
+          std::vector<Context*> contexts;
+          std::set<Context*> active;
+          Mutex mutex;
+        };
+
+        // contexts created with this context as their parent
+        struct Children {
+          std::set<Context*> contexts;
+          Mutex mutex;
+        };
+
         Memory memory;
+        RequestPool requests;
+        Children children;
+        Storage storage = Storage::Heap;
+        std::chrono::steady_clock::time_point acquired;
         State state = State::None;
         Error error;
         std::atomic<bool> retained = false;
@@ -92,6 +158,8 @@ namespace SSC {
 
         void retain ();
         void release ();
+        Context* acquire ();
+        static void dispose (Context* context);
 
         void setPolicy (const String& name, bool allowed);
         const Policy& getPolicy (const String& name) const;
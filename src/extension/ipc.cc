@@ -38,9 +38,14 @@ bool sapi_ipc_router_map (
       message.buffer.bytes,
       message.buffer.size
     );
-    context->internal = context->memory.alloc<SSC::IPC::Router::ReplyCallback>(reply);
+    // records on the router's copies of the message if the bytes are taken
+    msg.buffer.transferred = message.buffer.transferred;
+    // scratch memory of a message is rewound when it is replied to
+    auto request = reinterpret_cast<sapi_context_t*>(context->acquire());
+    request->data = data;
+    request->internal = request->memory.alloc<SSC::IPC::Router::ReplyCallback>(reply);
     callback(
-      context,
+      request,
       (sapi_ipc_message_t*) &msg,
       reinterpret_cast<const sapi_ipc_router_t*>(&router)
     );
@@ -136,7 +141,7 @@ bool sapi_ipc_reply (const sapi_ipc_result_t* result) {
   // if retained, then then caller must eventually call `sapi_context_release()`
   if (!context->retained) {
     context->release();
-    delete context;
+    SSC::Extension::Context::dispose(context);
   }
 
   return success;
@@ -322,6 +327,62 @@ const char* sapi_ipc_message_get (
   return value.c_str();
 }
 
+const unsigned char* sapi_ipc_message_get_bytes (
+  const sapi_ipc_message_t* message
+) {
+  return message
+    ? reinterpret_cast<const unsigned char*>(message->buffer.bytes)
+    : nullptr;
+}
+
+unsigned int sapi_ipc_message_get_bytes_size (
+  const sapi_ipc_message_t* message
+) {
+  return message && message->buffer.bytes ? message->buffer.size : 0;
+}
+
+unsigned char* sapi_ipc_message_take_bytes (
+  sapi_context_t* ctx,
+  sapi_ipc_message_t* message,
+  unsigned int* size
+) {
+  if (size != nullptr) *size = 0;
+  if (ctx == nullptr || ctx->router == nullptr || message == nullptr) {
+    return nullptr;
+  }
+
+  auto bytes = message->buffer.bytes;
+  auto length = message->buffer.size;
+
+  if (bytes == nullptr || length == 0) {
+    return nullptr;
+  }
+
+  // only bytes the router would free after the reply can be taken, once,
+  // others (such as the bytes of a native buffer) are shared and copied
+  if (message->buffer.transferred != nullptr) {
+    if (message->buffer.transferred->exchange(true)) {
+      return nullptr;
+    }
+  } else {
+    auto copy = new char[length]{0};
+    memcpy(copy, bytes, length);
+    bytes = copy;
+  }
+
+  message->buffer.bytes = nullptr;
+  message->buffer.size = 0;
+
+  if (size != nullptr) *size = (unsigned int) length;
+  return reinterpret_cast<unsigned char*>(bytes);
+}
+
+void sapi_ipc_bytes_free (void* bytes) {
+  if (bytes != nullptr) {
+    delete [] static_cast<char*>(bytes);
+  }
+}
+
 void sapi_ipc_result_set_seq (sapi_ipc_result_t* result, const char* seq) {
   if (result && seq) {
     result->seq = seq;
@@ -478,6 +539,26 @@ void sapi_ipc_result_set_bytes (
     auto pointer = const_cast<char*>(reinterpret_cast<const char*>(bytes));
     result->post.length = size;
     result->post.body = pointer;
+    result->post.storage = nullptr;
+  }
+}
+
+void sapi_ipc_result_set_bytes_owned (
+  sapi_ipc_result_t* result,
+  unsigned int size,
+  unsigned char* bytes,
+  sapi_ipc_bytes_free_callback_t free_callback
+) {
+  if (result && size && bytes) {
+    auto pointer = reinterpret_cast<char*>(bytes);
+    result->post.length = size;
+    result->post.body = pointer;
+    // copies of the post share the bytes, freed when the last one is gone
+    result->post.storage = std::shared_ptr<char>(pointer, [free_callback](auto pointer) {
+      if (free_callback != nullptr) {
+        free_callback(pointer);
+      }
+    });
   }
 }
 
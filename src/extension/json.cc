@@ -51,29 +51,38 @@ sapi_json_any_t* sapi_json_raw_from (
 }
 
 const char * sapi_json_stringify (const sapi_json_any_t* json) {
+  // `context` follows the concrete value type, not `SSC::JSON::Any`
+  sapi_context_t* context = nullptr;
   SSC::String string;
   switch (sapi_json_typeof(json)) {
     case SAPI_JSON_TYPE_NULL:
+      context = reinterpret_cast<const sapi_json_null_t*>(json)->context;
       string = "null";
       break;
 
     case SAPI_JSON_TYPE_OBJECT:
+      context = reinterpret_cast<const sapi_json_object_t*>(json)->context;
       string = reinterpret_cast<const SSC::JSON::Object*>(json)->str();
       break;
 
     case SAPI_JSON_TYPE_ARRAY:
+      context = reinterpret_cast<const sapi_json_array_t*>(json)->context;
       string = reinterpret_cast<const SSC::JSON::Array*>(json)->str();
       break;
     case SAPI_JSON_TYPE_BOOLEAN:
+      context = reinterpret_cast<const sapi_json_boolean_t*>(json)->context;
       string = reinterpret_cast<const SSC::JSON::Boolean*>(json)->str();
       break;
     case SAPI_JSON_TYPE_NUMBER:
+      context = reinterpret_cast<const sapi_json_number_t*>(json)->context;
       string = reinterpret_cast<const SSC::JSON::Number*>(json)->str();
       break;
     case SAPI_JSON_TYPE_STRING:
+      context = reinterpret_cast<const sapi_json_string_t*>(json)->context;
       string = reinterpret_cast<const SSC::JSON::String*>(json)->str();
       break;
     case SAPI_JSON_TYPE_RAW:
+      context = reinterpret_cast<const sapi_json_raw_t*>(json)->context;
       string = reinterpret_cast<const SSC::JSON::Raw*>(json)->str();
       break;
 
@@ -84,8 +93,8 @@ const char * sapi_json_stringify (const sapi_json_any_t* json) {
 
   auto length = string.size();
 
-  if (length > 0) {
-    auto bytes = json->context->memory.alloc<char>(length);
+  if (length > 0 && context != nullptr) {
+    auto bytes = context->memory.alloc<char>(length + 1);
     if (bytes != nullptr) {
       memcpy(bytes, string.c_str(), length);
     }
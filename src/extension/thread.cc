@@ -0,0 +1,65 @@
+#include "extension.hh"
+
+bool sapi_thread_pool_submit (
+  sapi_context_t* ctx,
+  const void* data,
+  sapi_thread_pool_work_callback_t work_callback,
+  sapi_thread_pool_done_callback_t done_callback
+) {
+  return sapi_thread_pool_submit_with_priority(
+    ctx,
+    SAPI_THREAD_POOL_PRIORITY_NORMAL,
+    data,
+    work_callback,
+    done_callback
+  );
+}
+
+bool sapi_thread_pool_submit_with_priority (
+  sapi_context_t* ctx,
+  sapi_thread_pool_priority_t priority,
+  const void* data,
+  sapi_thread_pool_work_callback_t work_callback,
+  sapi_thread_pool_done_callback_t done_callback
+) {
+  if (ctx == nullptr || work_callback == nullptr) return false;
+  if (ctx->router == nullptr) return false;
+  if (ctx->router->bridge == nullptr) return false;
+  if (ctx->router->bridge->core == nullptr) return false;
+
+  if (!ctx->isAllowed("thread_pool_submit")) {
+    sapi_debug(ctx, "'thread_pool_submit' is not allowed.");
+    return false;
+  }
+
+  if (
+    priority < SAPI_THREAD_POOL_PRIORITY_LOW ||
+    priority > SAPI_THREAD_POOL_PRIORITY_HIGH
+  ) {
+    return false;
+  }
+
+  SSC::EventLoopDispatchCallback done = nullptr;
+
+  if (done_callback != nullptr) {
+    done = [ctx, data, done_callback]() {
+      done_callback(ctx, data);
+    };
+  }
+
+  return ctx->router->bridge->core->workers.submit(
+    [ctx, data, work_callback]() {
+      work_callback(ctx, data);
+    },
+    done,
+    static_cast<SSC::Core::Workers::Priority>(priority)
+  );
+}
+
+unsigned int sapi_thread_pool_get_size (const sapi_context_t* ctx) {
+  if (ctx == nullptr) return 0;
+  if (ctx->router == nullptr) return 0;
+  if (ctx->router->bridge == nullptr) return 0;
+  if (ctx->router->bridge->core == nullptr) return 0;
+  return ctx->router->bridge->core->workers.size();
+}
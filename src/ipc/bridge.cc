@@ -53,6 +53,25 @@ static JSON::Any validateMessageParameters (
   return nullptr;
 }
 
+// parses a comma separated list of sizes or indices, empty is an empty list
+static bool parseSizeList (const String& value, Vector<size_t>& sizes) {
+  sizes.clear();
+
+  if (value.size() == 0) {
+    return true;
+  }
+
+  for (const auto& entry : split(value, ',')) {
+    try {
+      sizes.push_back(std::stoull(trim(entry)));
+    } catch (...) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 static struct { Mutex mutex; String value = ""; } cwdstate;
 
 static void setcwd (String cwd) {
@@ -110,19 +129,35 @@ static String getcwd () {
 
 #define CLEANUP_AFTER_INVOKE_CALLBACK(router, message, result) {               \
   if (!router->hasMappedBuffer(message.index, message.seq)) {                  \
-    if (message.buffer.bytes != nullptr) {                                     \
+    if (                                                                       \
+      message.buffer.transferred != nullptr &&                                 \
+      message.buffer.transferred->load()                                       \
+    ) {                                                                        \
+      message.buffer.bytes = nullptr;                                          \
+    } else if (message.buffer.bytes != nullptr) {                              \
       delete [] message.buffer.bytes;                                          \
       message.buffer.bytes = nullptr;                                          \
     }                                                                          \
   }                                                                            \
                                                                                \
-  if (!router->core->hasPostBody(result.post.body)) {                          \
+  if (                                                                         \
+    result.post.storage == nullptr &&                                          \
+    !router->core->hasPostBody(result.post.body)                               \
+  ) {                                                                          \
     if (result.post.body != nullptr) {                                         \
       delete [] result.post.body;                                              \
     }                                                                          \
   }                                                                            \
 }
 
+// bytes of a native buffer are owned by `Core::Buffers`, not the message
+#define RELEASE_RETAINED_BUFFER(message, retained) {                           \
+  if (retained.storage != nullptr) {                                           \
+    message.buffer.bytes = nullptr;                                            \
+    retained.storage = nullptr;                                                \
+  }                                                                            \
+}
+
 void initRouterTable (Router *router) {
   static auto userConfig = SSC::getUserConfig();
 #if defined(__APPLE__)
@@ -216,6 +251,70 @@ void initRouterTable (Router *router) {
     );
   });
 
+  /**
+   * Creates a native buffer from the message bytes, replacing a buffer
+   * with the same id. Other routes read it in place of message bytes when
+   * given its id as `bufferId`, so bytes sent or written many times are
+   * uploaded once. The least recently used buffers are evicted when the
+   * buffers hold more than `maxBytes` (see `buffer.setLimits`).
+   * @param id Handle ID of the buffer
+   * @param bytes The buffer bytes
+   */
+  router->map("buffer.alloc", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->buffers.create(
+      message.seq,
+      id,
+      message.buffer.bytes,
+      message.buffer.size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Appends the message bytes to a native buffer. Bytes shared with slices
+   * or pending calls are copied first, so they never see the change.
+   * @param id Handle ID of the buffer
+   * @param bytes The bytes to append
+   */
+  router->map("buffer.append", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->buffers.append(
+      message.seq,
+      id,
+      message.buffer.bytes,
+      message.buffer.size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Returns the number of native buffers, the bytes they hold and the
+   * number of buffers evicted so far.
+   */
+  router->map("buffer.getState", [](auto message, auto router, auto reply) {
+    router->core->buffers.getState(
+      message.seq,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
   /**
    * Maps a message buffer bytes to an index + sequence.
    *
@@ -231,262 +330,178 @@ void initRouterTable (Router *router) {
   });
 
   /**
-   * Look up an IP address by `hostname`.
-   * @param hostname Host name to lookup
-   * @param family IP address family to resolve [default = 0 (AF_UNSPEC)]
-   * @see getaddrinfo(3)
+   * Releases a native buffer. Pending calls reading it finish first.
+   * @param id Handle ID of the buffer
    */
-  router->map("dns.lookup", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"hostname"});
+  router->map("buffer.release", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    int family = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(family, "family", std::stoi, "0");
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->dns.lookup(
+    router->core->buffers.release(
       message.seq,
-      Core::DNS::LookupOptions { message.get("hostname"), family },
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
-  router->map("extension.stats", [](auto message, auto router, auto reply) {
-    auto extensions = Extension::all();
-    int loaded = 0;
-
-    for (const auto& tuple : extensions) {
-      if (tuple.second != nullptr) {
-        loaded++;
-      }
-    }
-
-    auto json = JSON::Object::Entries {
-      {"source", "extension.stats"},
-      {"data", JSON::Object::Entries {
-        {"abi", SOCKET_RUNTIME_EXTENSION_ABI_VERSION},
-        {"loaded", loaded}
-      }}
-    };
+  /**
+   * Sets the bytes native buffers may hold before the least recently used
+   * ones are evicted.
+   * @param maxBytes Maximum bytes of buffers held (default: 64 MiB)
+   */
+  router->map("buffer.setLimits", [](auto message, auto router, auto reply) {
+    size_t maxBytes = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(
+      maxBytes,
+      "maxBytes",
+      std::stoull,
+      std::to_string(Core::Buffers::DEFAULT_MAX_BYTES)
+    );
 
-    reply(Result { message.seq, message, json });
+    router->core->buffers.setLimits(
+      message.seq,
+      maxBytes,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Load a named native extension.
-   * @param name
-   * @param allow
+   * Creates a native buffer of a range of another one, sharing its bytes.
+   * @param id Handle ID of the new buffer
+   * @param source Handle ID of the buffer to slice
+   * @param offset Offset of the range (default: 0)
+   * @param size Bytes in the range (default: to the end of the buffer)
    */
-  router->map("extension.load", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"name"});
+  router->map("buffer.slice", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "source"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    auto name = message.get("name");
-
-    if (!Extension::load(name)) {
-      #if defined(_WIN32)
-      auto error = FormatError(GetLastError(), "bridge");
-      #else
-      auto error = String(dlerror());
-      #endif
-
-      std::cout << "Load extension error: " << error << std::endl;
-
-      return reply(Result::Err { message, JSON::Object::Entries {
-        {"message", "Failed to load extension: '" + name + "': " + error}
-      }});
-    }
-
-    auto extension = Extension::get(name);
-    auto allowed = split(message.get("allow"), ',');
-    auto context = Extension::getContext(name);
-    auto ctx = context->memory.template alloc<Extension::Context>(context, router);
-
-    for (const auto& value : allowed) {
-      auto policy = trim(value);
-      ctx->setPolicy(policy, true);
-    }
-
-    Extension::setRouterContext(name, router, ctx);
-
-    /// init context
-    if (!Extension::initialize(ctx, name, nullptr)) {
-      if (ctx->state == Extension::Context::State::Error) {
-        auto json = JSON::Object::Entries {
-          {"source", "extension.load"},
-          {"extension", name},
-          {"err", JSON::Object::Entries {
-            {"code", ctx->error.code},
-            {"name", ctx->error.name},
-            {"message", ctx->error.message},
-            {"location", ctx->error.location},
-          }}
-        };
-
-        reply(Result { message.seq, message, json });
-      } else {
-        auto json = JSON::Object::Entries {
-          {"source", "extension.load"},
-          {"extension", name},
-          {"err", JSON::Object::Entries {
-            {"message", "Failed to initialize extension: '" + name + "'"},
-          }}
-        };
+    uint64_t id;
+    uint64_t source;
+    size_t offset = 0;
+    size_t size = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(source, "source", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoull, "0");
 
-        reply(Result { message.seq, message, json });
-      }
+    if (message.has("size")) {
+      REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoull);
     } else {
-      auto json = JSON::Object::Entries {
-        {"source", "extension.load"},
-        {"data", JSON::Object::Entries {
-         {"abi", (uint64_t) extension->abi},
-         {"name", extension->name},
-         {"version", extension->version},
-         {"description", extension->description}
-        }}
-      };
+      Core::Buffers::Handle handle;
 
-      reply(Result { message.seq, message, json });
+      if (router->core->buffers.get(source, handle) && offset <= handle.size) {
+        size = handle.size - offset;
+      }
     }
+
+    router->core->buffers.slice(
+      message.seq,
+      id,
+      source,
+      offset,
+      size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Unload a named native extension.
-   * @param name
+   * Creates a bounded stream-relay packet cache. Creating a cache that
+   * exists returns its state.
+   * @param id Handle ID of the cache
+   * @param maxBytes Maximum bytes of packets held (default: 16 MiB, 0 is unlimited)
+   * @param maxCount Maximum packets held (default: 14489, 0 is unlimited)
    */
-  router->map("extension.unload", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"name"});
+  router->map("cache.create", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    auto name = message.get("name");
-
-    if (!Extension::isLoaded(name)) {
-      return reply(Result::Err { message, JSON::Object::Entries {
-      #if defined(_WIN32)
-        {"message", "Extension '" + name + "' is not loaded"}
-      #else
-        {"message", "Extension '" + name + "' is not loaded" + String(dlerror())}
-      #endif
-      }});
-    }
-
-    auto extension = Extension::get(name);
-    auto ctx = Extension::getRouterContext(name, router);
-
-    if (Extension::unload(ctx, name, extension->contexts.size() == 1)) {
-      Extension::removeRouterContext(name, router);
-      auto json = JSON::Object::Entries {
-        {"source", "extension.unload"},
-        {"extension", name},
-        {"data", JSON::Object::Entries {}}
-      };
-      return reply(Result { message.seq, message, json });
-    }
-
-    if (ctx->state == Extension::Context::State::Error) {
-      auto json = JSON::Object::Entries {
-        {"source", "extension.unload"},
-        {"extension", name},
-        {"err", JSON::Object::Entries {
-          {"code", ctx->error.code},
-          {"name", ctx->error.name},
-          {"message", ctx->error.message},
-          {"location", ctx->error.location},
-        }}
-      };
-
-      reply(Result { message.seq, message, json });
-    } else {
-      auto json = JSON::Object::Entries {
-        {"source", "extension.unload"},
-        {"extension", name},
-        {"err", JSON::Object::Entries {
-          {"message", "Failed to unload extension: '" + name + "'"},
-        }}
-      };
+    StreamRelay::PacketCache::Options options;
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(
+      options.maxBytes,
+      "maxBytes",
+      std::stoull,
+      std::to_string(StreamRelay::PacketCache::DEFAULT_MAX_BYTES)
+    );
+    REQUIRE_AND_GET_MESSAGE_VALUE(
+      options.maxCount,
+      "maxCount",
+      std::stoull,
+      std::to_string(StreamRelay::PacketCache::DEFAULT_MAX_COUNT)
+    );
 
-      reply(Result { message.seq, message, json });
-    }
+    router->core->cache.create(
+      message.seq,
+      id,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Checks if current user can access file at `path` with `mode`.
-   * @param path
-   * @param mode
-   * @see access(2)
+   * Deletes a packet from a cache.
+   * @param id Handle ID of the cache
+   * @param packetId Hex encoded packet ID
    */
-  router->map("fs.access", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path", "mode"});
+  router->map("cache.delete", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "packetId"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    int mode = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.access(
+    router->core->cache.remove(
       message.seq,
-      message.get("path"),
-      mode,
+      id,
+      message.get("packetId"),
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Returns a mapping of file system constants.
+   * Destroys a cache and the packets it holds.
+   * @param id Handle ID of the cache
    */
-  router->map("fs.constants", [](auto message, auto router, auto reply) {
-    router->core->fs.constants(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
-  });
-
-  /**
-   * Changes `mode` of file at `path`.
-   * @param path
-   * @param mode
-   * @see chmod(2)
-   */
-  router->map("fs.chmod", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path", "mode"});
+  router->map("cache.destroy", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    int mode = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.chmod(
+    router->core->cache.destroy(
       message.seq,
-      message.get("path"),
-      mode,
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * @TODO
-   * @see chown(2)
-   */
-  router->map("fs.chown", [](auto message, auto router, auto reply) {
-    // TODO
-  });
-
-  /**
-   * Closes underlying file descriptor handle.
-   * @param id
-   * @see close(2)
+   * Gets the encoded bytes of a packet in a cache.
+   * @param id Handle ID of the cache
+   * @param packetId Hex encoded packet ID
    */
-  router->map("fs.close", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("cache.get", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "packetId"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
@@ -495,15 +510,19 @@ void initRouterTable (Router *router) {
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.close(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+    router->core->cache.get(
+      message.seq,
+      id,
+      message.get("packetId"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Closes underlying directory descriptor handle.
-   * @param id
-   * @see closedir(3)
+   * Gets the size and limits of a cache.
+   * @param id Handle ID of the cache
    */
-  router->map("fs.closedir", [](auto message, auto router, auto reply) {
+  router->map("cache.getState", [](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
@@ -513,17 +532,21 @@ void initRouterTable (Router *router) {
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.closedir(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+    router->core->cache.getState(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Closes an open file or directory descriptor handle.
-   * @param id
-   * @see close(2)
-   * @see closedir(3)
+   * Checks if a cache holds a packet. Packets never inserted are answered
+   * by a Bloom filter without touching the cache index.
+   * @param id Handle ID of the cache
+   * @param packetId Hex encoded packet ID
    */
-  router->map("fs.closeOpenDescriptor", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("cache.has", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "packetId"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
@@ -532,625 +555,2062 @@ void initRouterTable (Router *router) {
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.closeOpenDescriptor(
+    router->core->cache.has(
       message.seq,
       id,
+      message.get("packetId"),
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Closes all open file and directory descriptors, optionally preserving
-   * explicitly retrained descriptors.
-   * @param preserveRetained (default: true)
-   * @see close(2)
-   * @see closedir(3)
-   */
-  router->map("fs.closeOpenDescriptors", [](auto message, auto router, auto reply) {
-    router->core->fs.closeOpenDescriptor(
-      message.seq,
-      message.get("preserveRetained") != "false",
-      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
-    );
-  });
-
-  /**
-   * Copy file at path `src` to path `dest`.
-   * @param src
-   * @param dest
-   * @param flags
-   * @see copyfile(3)
+   * Inserts an encoded packet, given as the message bytes, into a cache.
+   * Only publish packets are inserted and a full cache evicts the packet
+   * with the highest clock first.
+   * @param id Handle ID of the cache
+   * @param bytes The encoded packet
    */
-  router->map("fs.copyFile", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"src", "dest"});
+  router->map("cache.insert", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    int flags = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(flags, "flags", std::stoi);
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->fs.copyFile(
+    router->core->cache.insert(
       message.seq,
-      message.get("src"),
-      message.get("dest"),
-      flags,
+      id,
+      message.buffer.bytes,
+      message.buffer.size,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
+#if SSC_BENCHMARKS
   /**
-   * Computes stats for an open file descriptor.
-   * @param id
-   * @see stat(2)
-   * @see fstat(2)
+   * Compares the backend channel to the stdout path, sending `messages`
+   * binary payloads as URI encoded lines over a pipe, as frames over a
+   * socket pair and through a shared memory ring, all read on the Core loop.
+   * @param messages Messages per run (default: 10000)
+   * @param size Bytes per message payload (default: 256)
    */
-  router->map("fs.fstat", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
-
-    if (err.type != JSON::Type::Null) {
-      return reply(Result::Err { message, err });
-    }
-
-    uint64_t id;
-    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+  router->map("channel.benchmark", [](auto message, auto router, auto reply) {
+    Core::Channel::BenchmarkOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.messages, "messages", std::stoull, "10000");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.size, "size", std::stoull, "256");
 
-    router->core->fs.fstat(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+    router->core->channel.benchmark(
+      message.seq,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
+#endif
 
   /**
-   * Returns all open file or directory descriptors.
+   * Returns whether the backend channel is open and its frame counters.
    */
-  router->map("fs.getOpenDescriptors", [](auto message, auto router, auto reply) {
-    router->core->fs.getOpenDescriptors(
+  router->map("channel.getState", [](auto message, auto router, auto reply) {
+    router->core->channel.getState(
       message.seq,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Computes stats for a symbolic link at `path`.
-   * @param path
-   * @see stat(2)
-   * @see lstat(2)
+   * Writes the message bytes to the backend over the channel, as the body
+   * of an `ipc://process.write` frame.
+   * @param event The event name given to the backend
+   * @param bytes The payload
    */
-  router->map("fs.lstat", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path"});
+  router->map("channel.write", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"event"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.lstat(
+    auto uri = (
+      "ipc://process.write?index=" + std::to_string(message.index) +
+      "&event=" + encodeURIComponent(message.get("event"))
+    );
+
+    router->core->channel.write(
       message.seq,
-      message.get("path"),
+      uri,
+      message.buffer.bytes,
+      message.buffer.size,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Creates a directory at `path` with an optional mode.
-   * @param path
-   * @param mode
-   * @see mkdir(2)
+   * Opens a message sealed with `crypto.seal`, the decrypt-verify-decrypt
+   * flow of `open()` in `api/stream-relay/encryption.js`. The opened bytes
+   * are the response body. Runs on the Core worker thread pool.
+   * @param publicKey Base64 encoded Ed25519 public key of the receiver
+   * @param secretKey Base64 encoded Ed25519 secret key of the receiver
+   * @param bytes The sealed message
    */
-  router->map("fs.mkdir", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path", "mode"});
+  router->map("crypto.open", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"publicKey", "secretKey"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    int mode = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+    Crypto::Bytes publicKey;
+    Crypto::Bytes secretKey;
 
-    router->core->fs.mkdir(
+    if (!Crypto::decodeBase64(message.get("publicKey"), publicKey)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'publicKey' given in parameters"}
+      }});
+    }
+
+    if (!Crypto::decodeBase64(message.get("secretKey"), secretKey)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'secretKey' given in parameters"}
+      }});
+    }
+
+    router->core->crypto.open(
       message.seq,
-      message.get("path"),
-      mode,
+      publicKey,
+      secretKey,
+      message.buffer.bytes,
+      message.buffer.size,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Opens a file descriptor at `path` for `id` with `flags` and `mode`
-   * @param id
-   * @param path
-   * @param flags
-   * @param mode
-   * @see open(2)
+   * Seals a message for a receiver with the encrypt-sign-encrypt flow of
+   * `seal()` in `api/stream-relay/encryption.js`. The sealed bytes are the
+   * response body. Runs on the Core worker thread pool.
+   * @param publicKey Base64 encoded Ed25519 public key of the receiver
+   * @param secretKey Base64 encoded Ed25519 secret key signing the message
+   * @param bytes The message to seal
    */
-  router->map("fs.open", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {
-      "id",
-      "path",
-      "flags",
-      "mode"
-    });
+  router->map("crypto.seal", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"publicKey", "secretKey"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    uint64_t id;
-    int mode = 0;
-    int flags = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
-    REQUIRE_AND_GET_MESSAGE_VALUE(flags, "flags", std::stoi);
+    Crypto::Bytes publicKey;
+    Crypto::Bytes secretKey;
 
-    router->core->fs.open(
+    if (!Crypto::decodeBase64(message.get("publicKey"), publicKey)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'publicKey' given in parameters"}
+      }});
+    }
+
+    if (!Crypto::decodeBase64(message.get("secretKey"), secretKey)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'secretKey' given in parameters"}
+      }});
+    }
+
+    router->core->crypto.seal(
       message.seq,
-      id,
-      message.get("path"),
-      flags,
-      mode,
+      publicKey,
+      secretKey,
+      message.buffer.bytes,
+      message.buffer.size,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Opens a directory descriptor at `path` for `id` with `flags` and `mode`
-   * @param id
-   * @param path
-   * @see opendir(3)
+   * Computes the hex encoded SHA-256 digest of the message bytes.
+   * @param bytes The bytes to hash
    */
-  router->map("fs.opendir", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id", "path"});
-
-    if (err.type != JSON::Type::Null) {
-      return reply(Result::Err { message, err });
-    }
-
-    uint64_t id;
-    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-
-    router->core->fs.opendir(
+  router->map("crypto.sha256", [](auto message, auto router, auto reply) {
+    router->core->crypto.sha256(
       message.seq,
-      id,
-      message.get("path"),
+      message.buffer.bytes,
+      message.buffer.size,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Reads `size` bytes at `offset` from the underlying file descriptor.
-   * @param id
-   * @param size
-   * @param offset
-   * @see read(2)
+   * Computes a base64 encoded Ed25519 detached signature of the message
+   * bytes, like `crypto_sign_detached()`.
+   * @param secretKey Base64 encoded Ed25519 secret key
+   * @param bytes The bytes to sign
    */
-  router->map("fs.read", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id", "size", "offset"});
+  router->map("crypto.sign", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"secretKey"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    uint64_t id;
-    int size = 0;
-    int offset = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoi);
-    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
+    Crypto::Bytes secretKey;
 
-    router->core->fs.read(
+    if (!Crypto::decodeBase64(message.get("secretKey"), secretKey)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'secretKey' given in parameters"}
+      }});
+    }
+
+    router->core->crypto.sign(
       message.seq,
-      id,
-      size,
-      offset,
+      secretKey,
+      message.buffer.bytes,
+      message.buffer.size,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Reads next `entries` of from the underlying directory descriptor.
-   * @param id
-   * @param entries (default: 256)
+   * Verifies an Ed25519 detached signature of the message bytes, like
+   * `crypto_sign_verify_detached()`.
+   * @param publicKey Base64 encoded Ed25519 public key
+   * @param signature Base64 encoded signature
+   * @param bytes The signed bytes
    */
-  router->map("fs.readdir", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("crypto.verify", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"publicKey", "signature"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    uint64_t id;
-    int entries = 0;
-    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(entries, "entries", std::stoi);
+    Core::Crypto::VerifyOptions options;
 
-    router->core->fs.readdir(
+    if (!Crypto::decodeBase64(message.get("publicKey"), options.publicKey)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'publicKey' given in parameters"}
+      }});
+    }
+
+    if (!Crypto::decodeBase64(message.get("signature"), options.signature)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'signature' given in parameters"}
+      }});
+    }
+
+    options.offset = 0;
+    options.size = message.buffer.size;
+
+    router->core->crypto.verify(
       message.seq,
-      id,
-      entries,
+      options,
+      message.buffer.bytes,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Marks a file or directory descriptor as retained.
-   * @param id
+   * Verifies many Ed25519 detached signatures in one call, spread over the
+   * Core worker thread pool. The signed messages are concatenated in the
+   * message bytes and `sizes` slices them in order. Replies with a boolean
+   * per signature, malformed keys or signatures are `false`.
+   * @param publicKeys Comma separated base64 encoded Ed25519 public keys
+   * @param signatures Comma separated base64 encoded signatures
+   * @param sizes Comma separated byte sizes of each signed message
+   * @param bytes The concatenated signed messages
    */
-  router->map("fs.retainOpenDescriptor", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("crypto.verifyMany", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"publicKeys", "signatures", "sizes"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    uint64_t id;
-    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    auto publicKeys = split(message.get("publicKeys"), ',');
+    auto signatures = split(message.get("signatures"), ',');
+    auto sizes = split(message.get("sizes"), ',');
 
-    router->core->fs.retainOpenDescriptor(
-      message.seq,
-      id,
-      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
-    );
-  });
+    if (publicKeys.size() != signatures.size() || publicKeys.size() != sizes.size()) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Expecting as many 'publicKeys', 'signatures', and 'sizes'"}
+      }});
+    }
 
-  /**
-   * Renames file at path `src` to path `dest`.
+    Vector<Core::Crypto::VerifyOptions> options(sizes.size());
+    size_t offset = 0;
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      try {
+        options[i].size = std::stoull(sizes[i]);
+      } catch (...) {
+        return reply(Result::Err { message, JSON::Object::Entries {
+          {"message", "Invalid 'sizes' given in parameters"}
+        }});
+      }
+
+      // a malformed key or signature only fails its own verification
+      Crypto::decodeBase64(publicKeys[i], options[i].publicKey);
+      Crypto::decodeBase64(signatures[i], options[i].signature);
+      options[i].offset = offset;
+      offset += options[i].size;
+    }
+
+    if (offset > message.buffer.size) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters, exceeds message bytes"}
+      }});
+    }
+
+    router->core->crypto.verifyMany(
+      message.seq,
+      options,
+      message.buffer.bytes,
+      message.buffer.size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+#if SSC_BENCHMARKS
+  /**
+   * Measures how fast the output of a child process is read and split into
+   * messages, handed out as views into the read buffer and as strings.
+   * @param bytes Bytes of output the child process writes (default: 1 GB)
+   * @param size Bytes per line or binary frame (default: 1024)
+   * @param binary Frame the output with length prefixes instead of newlines
+   */
+  router->map("diagnostics.benchmarkProcessOutput", [](auto message, auto router, auto reply) {
+    Core::Diagnostics::ProcessOutputBenchmarkOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.bytes, "bytes", std::stoull, "1073741824");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.size, "size", std::stoull, "1024");
+    options.binary = message.get("binary") == "true";
+
+    router->core->diagnostics.benchmarkProcessOutput(
+      message.seq,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+#endif
+
+  /**
+   * Look up an IP address by `hostname`.
+   * @param hostname Host name to lookup
+   * @param family IP address family to resolve [default = 0 (AF_UNSPEC)]
+   * @see getaddrinfo(3)
+   */
+  router->map("dns.lookup", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"hostname"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    int family = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(family, "family", std::stoi, "0");
+
+    router->core->dns.lookup(
+      message.seq,
+      Core::DNS::LookupOptions { message.get("hostname"), family },
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  router->map("extension.stats", [](auto message, auto router, auto reply) {
+    auto extensions = Extension::all();
+    int loaded = 0;
+
+    for (const auto& tuple : extensions) {
+      if (tuple.second != nullptr) {
+        loaded++;
+      }
+    }
+
+    auto json = JSON::Object::Entries {
+      {"source", "extension.stats"},
+      {"data", JSON::Object::Entries {
+        {"abi", SOCKET_RUNTIME_EXTENSION_ABI_VERSION},
+        {"loaded", loaded}
+      }}
+    };
+
+    reply(Result { message.seq, message, json });
+  });
+
+  /**
+   * Load a named native extension.
+   * @param name
+   * @param allow
+   */
+  router->map("extension.load", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"name"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    auto name = message.get("name");
+
+    if (!Extension::load(name)) {
+      #if defined(_WIN32)
+      auto error = FormatError(GetLastError(), "bridge");
+      #else
+      auto error = String(dlerror());
+      #endif
+
+      std::cout << "Load extension error: " << error << std::endl;
+
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Failed to load extension: '" + name + "': " + error}
+      }});
+    }
+
+    auto extension = Extension::get(name);
+    auto allowed = split(message.get("allow"), ',');
+    auto context = Extension::getContext(name);
+    auto ctx = context->memory.template alloc<Extension::Context>(context, router);
+
+    for (const auto& value : allowed) {
+      auto policy = trim(value);
+      ctx->setPolicy(policy, true);
+    }
+
+    Extension::setRouterContext(name, router, ctx);
+
+    /// init context
+    if (!Extension::initialize(ctx, name, nullptr)) {
+      if (ctx->state == Extension::Context::State::Error) {
+        auto json = JSON::Object::Entries {
+          {"source", "extension.load"},
+          {"extension", name},
+          {"err", JSON::Object::Entries {
+            {"code", ctx->error.code},
+            {"name", ctx->error.name},
+            {"message", ctx->error.message},
+            {"location", ctx->error.location},
+          }}
+        };
+
+        reply(Result { message.seq, message, json });
+      } else {
+        auto json = JSON::Object::Entries {
+          {"source", "extension.load"},
+          {"extension", name},
+          {"err", JSON::Object::Entries {
+            {"message", "Failed to initialize extension: '" + name + "'"},
+          }}
+        };
+
+        reply(Result { message.seq, message, json });
+      }
+    } else {
+      auto json = JSON::Object::Entries {
+        {"source", "extension.load"},
+        {"data", JSON::Object::Entries {
+         {"abi", (uint64_t) extension->abi},
+         {"name", extension->name},
+         {"version", extension->version},
+         {"description", extension->description}
+        }}
+      };
+
+      reply(Result { message.seq, message, json });
+    }
+  });
+
+  /**
+   * Unload a named native extension.
+   * @param name
+   */
+  router->map("extension.unload", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"name"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    auto name = message.get("name");
+
+    if (!Extension::isLoaded(name)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+      #if defined(_WIN32)
+        {"message", "Extension '" + name + "' is not loaded"}
+      #else
+        {"message", "Extension '" + name + "' is not loaded" + String(dlerror())}
+      #endif
+      }});
+    }
+
+    auto extension = Extension::get(name);
+    auto ctx = Extension::getRouterContext(name, router);
+
+    if (Extension::unload(ctx, name, extension->contexts.size() == 1)) {
+      Extension::removeRouterContext(name, router);
+      auto json = JSON::Object::Entries {
+        {"source", "extension.unload"},
+        {"extension", name},
+        {"data", JSON::Object::Entries {}}
+      };
+      return reply(Result { message.seq, message, json });
+    }
+
+    if (ctx->state == Extension::Context::State::Error) {
+      auto json = JSON::Object::Entries {
+        {"source", "extension.unload"},
+        {"extension", name},
+        {"err", JSON::Object::Entries {
+          {"code", ctx->error.code},
+          {"name", ctx->error.name},
+          {"message", ctx->error.message},
+          {"location", ctx->error.location},
+        }}
+      };
+
+      reply(Result { message.seq, message, json });
+    } else {
+      auto json = JSON::Object::Entries {
+        {"source", "extension.unload"},
+        {"extension", name},
+        {"err", JSON::Object::Entries {
+          {"message", "Failed to unload extension: '" + name + "'"},
+        }}
+      };
+
+      reply(Result { message.seq, message, json });
+    }
+  });
+
+#if SSC_BENCHMARKS
+  /**
+   * Measures FEC encode and reconstruct throughput (MB/s of data packets)
+   * for every kernel this CPU supports, reconstructing as many lost packets
+   * as there are parity packets.
+   * @param dataCount Data packets per block (default: 32)
+   * @param parityCount Parity packets per block (default: 8)
+   * @param shardSize Bytes per packet (default: 1200)
+   * @param duration Milliseconds per kernel and operation (default: 200)
+   */
+  router->map("fec.benchmark", [](auto message, auto router, auto reply) {
+    Core::FEC::BenchmarkOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.dataCount, "dataCount", std::stoull, "32");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.parityCount, "parityCount", std::stoull, "8");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.shardSize, "shardSize", std::stoull, "1200");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.duration, "duration", std::stoull, "200");
+
+    router->core->fec.benchmark(
+      message.seq,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+#endif
+
+  /**
+   * Computes Reed-Solomon parity packets for a block of data packets. The
+   * data packets are concatenated in the message bytes and `sizes` slices
+   * them in order. Replies with the parity packets concatenated, each
+   * `shardSize` bytes.
+   * @param sizes Comma separated byte sizes of each data packet
+   * @param parityCount Number of parity packets, at most 256 packets per block
+   * @param bytes The concatenated data packets
+   */
+  router->map("fec.encode", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"sizes", "parityCount"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    Core::FEC::EncodeOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.parityCount, "parityCount", std::stoull);
+
+    if (!parseSizeList(message.get("sizes"), options.sizes)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters"}
+      }});
+    }
+
+    router->core->fec.encode(
+      message.seq,
+      options,
+      message.buffer.bytes,
+      message.buffer.size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Recovers the lost data packets of a block from any `dataCount` of its
+   * data and parity packets. The received packets are concatenated in the
+   * message bytes, `indices` gives their position in the block (parity
+   * packets follow the data packets) and `sizes` their byte sizes. Replies
+   * with the recovered data packets concatenated and their `indices` and
+   * `sizes`.
+   * @param dataCount Number of data packets in the block
+   * @param parityCount Number of parity packets in the block
+   * @param indices Comma separated block indices of the given packets
+   * @param sizes Comma separated byte sizes of the given packets
+   * @param bytes The concatenated packets
+   */
+  router->map("fec.reconstruct", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"dataCount", "parityCount"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    Core::FEC::ReconstructOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.dataCount, "dataCount", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.parityCount, "parityCount", std::stoull);
+
+    if (!parseSizeList(message.get("indices"), options.indices)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'indices' given in parameters"}
+      }});
+    }
+
+    if (!parseSizeList(message.get("sizes"), options.sizes)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters"}
+      }});
+    }
+
+    router->core->fec.reconstruct(
+      message.seq,
+      options,
+      message.buffer.bytes,
+      message.buffer.size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Checks if current user can access file at `path` with `mode`.
+   * @param path
+   * @param mode
+   * @see access(2)
+   */
+  router->map("fs.access", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path", "mode"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    int mode = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+
+    router->core->fs.access(
+      message.seq,
+      message.get("path"),
+      mode,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Returns a mapping of file system constants.
+   */
+  router->map("fs.constants", [](auto message, auto router, auto reply) {
+    router->core->fs.constants(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Changes `mode` of file at `path`.
+   * @param path
+   * @param mode
+   * @see chmod(2)
+   */
+  router->map("fs.chmod", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path", "mode"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    int mode = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+
+    router->core->fs.chmod(
+      message.seq,
+      message.get("path"),
+      mode,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * @TODO
+   * @see chown(2)
+   */
+  router->map("fs.chown", [](auto message, auto router, auto reply) {
+    // TODO
+  });
+
+  /**
+   * Closes underlying file descriptor handle.
+   * @param id
+   * @see close(2)
+   */
+  router->map("fs.close", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.close(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Closes underlying directory descriptor handle.
+   * @param id
+   * @see closedir(3)
+   */
+  router->map("fs.closedir", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.closedir(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Closes an open file or directory descriptor handle.
+   * @param id
+   * @see close(2)
+   * @see closedir(3)
+   */
+  router->map("fs.closeOpenDescriptor", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.closeOpenDescriptor(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Closes all open file and directory descriptors, optionally preserving
+   * explicitly retrained descriptors.
+   * @param preserveRetained (default: true)
+   * @see close(2)
+   * @see closedir(3)
+   */
+  router->map("fs.closeOpenDescriptors", [](auto message, auto router, auto reply) {
+    router->core->fs.closeOpenDescriptor(
+      message.seq,
+      message.get("preserveRetained") != "false",
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Copy file at path `src` to path `dest`.
+   * @param src
+   * @param dest
+   * @param flags
+   * @see copyfile(3)
+   */
+  router->map("fs.copyFile", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"src", "dest"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    int flags = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(flags, "flags", std::stoi);
+
+    router->core->fs.copyFile(
+      message.seq,
+      message.get("src"),
+      message.get("dest"),
+      flags,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Computes stats for an open file descriptor.
+   * @param id
+   * @see stat(2)
+   * @see fstat(2)
+   */
+  router->map("fs.fstat", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.fstat(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Returns all open file or directory descriptors.
+   */
+  router->map("fs.getOpenDescriptors", [](auto message, auto router, auto reply) {
+    router->core->fs.getOpenDescriptors(
+      message.seq,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Computes stats for a symbolic link at `path`.
+   * @param path
+   * @see stat(2)
+   * @see lstat(2)
+   */
+  router->map("fs.lstat", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.lstat(
+      message.seq,
+      message.get("path"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Creates a directory at `path` with an optional mode.
+   * @param path
+   * @param mode
+   * @see mkdir(2)
+   */
+  router->map("fs.mkdir", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path", "mode"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    int mode = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+
+    router->core->fs.mkdir(
+      message.seq,
+      message.get("path"),
+      mode,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Opens a file descriptor at `path` for `id` with `flags` and `mode`
+   * @param id
+   * @param path
+   * @param flags
+   * @param mode
+   * @see open(2)
+   */
+  router->map("fs.open", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {
+      "id",
+      "path",
+      "flags",
+      "mode"
+    });
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    int mode = 0;
+    int flags = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(mode, "mode", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(flags, "flags", std::stoi);
+
+    router->core->fs.open(
+      message.seq,
+      id,
+      message.get("path"),
+      flags,
+      mode,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Opens a directory descriptor at `path` for `id` with `flags` and `mode`
+   * @param id
+   * @param path
+   * @see opendir(3)
+   */
+  router->map("fs.opendir", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.opendir(
+      message.seq,
+      id,
+      message.get("path"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Reads `size` bytes at `offset` from the underlying file descriptor.
+   * @param id
+   * @param size
+   * @param offset
+   * @see read(2)
+   */
+  router->map("fs.read", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "size", "offset"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    int size = 0;
+    int offset = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
+
+    router->core->fs.read(
+      message.seq,
+      id,
+      size,
+      offset,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Reads next `entries` of from the underlying directory descriptor.
+   * @param id
+   * @param entries (default: 256)
+   */
+  router->map("fs.readdir", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    int entries = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(entries, "entries", std::stoi);
+
+    router->core->fs.readdir(
+      message.seq,
+      id,
+      entries,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Marks a file or directory descriptor as retained.
+   * @param id
+   */
+  router->map("fs.retainOpenDescriptor", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->fs.retainOpenDescriptor(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Renames file at path `src` to path `dest`.
    * @param src
    * @param dest
    * @see rename(2)
    */
-  router->map("fs.rename", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"src", "dest"});
+  router->map("fs.rename", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"src", "dest"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.rename(
+      message.seq,
+      message.get("src"),
+      message.get("dest"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Removes file at `path`.
+   * @param path
+   * @see rmdir(2)
+   */
+  router->map("fs.rmdir", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.rmdir(
+      message.seq,
+      message.get("path"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Computes stats for a file at `path`.
+   * @param path
+   * @see stat(2)
+   */
+  router->map("fs.stat", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.stat(
+      message.seq,
+      message.get("path"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Removes a file or empty directory at `path`.
+   * @param path
+   * @see unlink(2)
+   */
+  router->map("fs.unlink", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"path"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    router->core->fs.unlink(
+      message.seq,
+      message.get("path"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Writes buffer at `message.buffer.bytes` of size `message.buffers.size`
+   * at `offset` for an opened file handle.
+   * @param id Handle ID for an open file descriptor
+   * @param offset The offset to start writing at
+   * @param bufferId Handle ID of a native buffer to write instead of the message bytes
+   * @see write(2)
+   */
+  router->map("fs.write", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "offset"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    if (message.buffer.bytes == nullptr || message.buffer.size == 0) {
+      auto err = JSON::Object::Entries {{ "message", "Missing buffer in message" }};
+      return reply(Result::Err { message, err });
+    }
+
+
+    uint64_t id;
+    int offset = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
+
+    router->core->fs.write(
+      message.seq,
+      id,
+      message.buffer.bytes,
+      message.buffer.size,
+      offset,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * A private API for artifically setting the current cached CWD value.
+   * This is only useful on platforms that need to set this value from an
+   * external source, like Android or ChromeOS.
+   */
+  router->map("internal.setcwd", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"value"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result { message.seq, message, err });
+    }
+
+    setcwd(message.value);
+    reply(Result { message.seq, message, JSON::Object{} });
+  });
+
+  /**
+   * Log `value to stdout` with platform dependent logger.
+   * @param value
+   */
+  router->map("log", [](auto message, auto router, auto reply) {
+    auto value = message.value.c_str();
+  #if defined(__APPLE__)
+    NSLog(@"%s", value);
+    os_log_with_type(SSC_OS_LOG_BUNDLE, OS_LOG_TYPE_INFO, "%{public}s", value);
+  #elif defined(__ANDROID__)
+    __android_log_print(ANDROID_LOG_DEBUG, "", "%s", value);
+  #else
+    printf("%s\n", value);
+  #endif
+  });
+
+  /**
+   * Read or modify the `SEND_BUFFER` or `RECV_BUFFER` for a peer socket.
+   * @param id Handle ID for the buffer to read/modify
+   * @param size If given, the size to set in the buffer [default = 0]
+   * @param buffer The buffer to read/modify (SEND_BUFFER, RECV_BUFFER) [default = 0 (SEND_BUFFER)]
+   */
+  router->map("os.bufferSize", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    int buffer = 0;
+    int size = 0;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(buffer, "buffer", std::stoi, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoi, "0");
+
+    router->core->os.bufferSize(
+      message.seq,
+      id,
+      size,
+      buffer,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Returns a mapping of network interfaces.
+   */
+  router->map("os.networkInterfaces", [](auto message, auto router, auto reply) {
+    router->core->os.networkInterfaces(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Returns an array of CPUs available to the process.
+   */
+  router->map("os.cpus", [](auto message, auto router, auto reply) {
+    router->core->os.cpus(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  router->map("os.rusage", [](auto message, auto router, auto reply) {
+    router->core->os.rusage(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  router->map("os.uptime", [](auto message, auto router, auto reply) {
+    router->core->os.uptime(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  router->map("os.uname", [](auto message, auto router, auto reply) {
+    router->core->os.uname(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  router->map("os.hrtime", [](auto message, auto router, auto reply) {
+    router->core->os.hrtime(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  router->map("os.availableMemory", [](auto message, auto router, auto reply) {
+    router->core->os.availableMemory(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+  });
+
+  /**
+   * Simply returns `pong`.
+   */
+  router->map("ping", [](auto message, auto router, auto reply) {
+    auto result = Result { message.seq, message };
+    result.data = "pong";
+    reply(result);
+  });
+
+  /**
+   * Handles platform events.
+   * @param value The event name [domcontentloaded]
+   * @param data Optional data associated with the platform event.
+   */
+  router->map("platform.event", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"value"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result { message.seq, message, err });
+    }
+
+    if (!router->isReady) router->isReady = true;
+
+    router->core->platform.event(
+      message.seq,
+      message.value,
+      message.get("data"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Requests a notification with `title` and `body` to be shown.
+   * @param title
+   * @param body
+   */
+  router->map("platform.notify", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"body", "title"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result { message.seq, message, err });
+    }
+
+    router->core->platform.notify(
+      message.seq,
+      message.get("title"),
+      message.get("body"),
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Requests a URL to be opened externally.
+   * @param value
+   */
+  router->map("platform.openExternal", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"value"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result { message.seq, message, err });
+    }
+
+    router->core->platform.openExternal(
+      message.seq,
+      message.value,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Return Socket Runtime primordials.
+   */
+  router->map("platform.primordials", [](auto message, auto router, auto reply) {
+    std::regex platform_pattern("^mac$", std::regex_constants::icase);
+    auto platformRes = std::regex_replace(platform.os, platform_pattern, "darwin");
+    auto arch = std::regex_replace(platform.arch, std::regex("x86_64"), "x64");
+    arch = std::regex_replace(arch, std::regex("x86"), "ia32");
+    arch = std::regex_replace(arch, std::regex("arm(?!64).*"), "arm");
+    auto json = JSON::Object::Entries {
+      {"source", "platform.primordials"},
+      {"data", JSON::Object::Entries {
+        {"arch", arch},
+        {"cwd", getcwd()},
+        {"platform", platformRes},
+        {"version", JSON::Object::Entries {
+          {"full", SSC::VERSION_FULL_STRING},
+          {"short", SSC::VERSION_STRING},
+          {"hash", SSC::VERSION_HASH_STRING}}
+        }
+      }}
+    };
+    reply(Result { message.seq, message, json });
+  });
+
+  /**
+   * Returns pending post data typically returned in the response of an
+   * `ipc://post` IPC call intercepted by an XHR request.
+   * @param id The id of the post data.
+   */
+  router->map("post", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    if (!router->core->hasPost(id)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"id", std::to_string(id)},
+        {"message", "Post not found for given 'id'"}
+      }});
+    }
+
+    auto result = Result { message.seq, message };
+    result.post = router->core->getPost(id);
+    reply(result);
+    router->core->removePost(id);
+  });
+
+  /**
+   * Prints incoming message value to stdout.
+   */
+  router->map("stdout", [](auto message, auto router, auto reply) {
+  #if defined(__APPLE__)
+    os_log_with_type(SSC_OS_LOG_BUNDLE, OS_LOG_TYPE_INFO, "%{public}s", message.value.c_str());
+  #endif
+    stdWrite(message.value, false);
+  });
+
+  /**
+   * Prints incoming message value to stderr.
+   */
+  router->map("stderr", [](auto message, auto router, auto reply) {
+  #if defined(__APPLE__)
+    os_log_with_type(SSC_OS_LOG_BUNDLE, OS_LOG_TYPE_ERROR, "%{public}s", message.value.c_str());
+  #endif
+    stdWrite(message.value, true);
+  });
+
+  /**
+   * Closes a stream. Everything written is delivered before the remote end
+   * reads the end of the stream, the reply is sent once it acknowledged it.
+   * @param id Handle ID of the stream
+   */
+  router->map("stream.close", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.rename(
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->stream.close(
       message.seq,
-      message.get("src"),
-      message.get("dest"),
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Removes file at `path`.
-   * @param path
-   * @see rmdir(2)
+   * Returns the state of a stream: segments in flight, the RTT estimate,
+   * and retransmission counters.
+   * @param id Handle ID of the stream
    */
-  router->map("fs.rmdir", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path"});
+  router->map("stream.getState", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.rmdir(
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->stream.getState(
       message.seq,
-      message.get("path"),
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Computes stats for a file at `path`.
-   * @param path
-   * @see stat(2)
+   * Opens a reliable, ordered stream to a remote address over a bound UDP
+   * socket, which must not be reading with `udp.readStart`. The remote end
+   * opens a stream with the same `streamId` and this socket's address.
+   * @param id Handle ID of the stream
+   * @param peerId Handle ID of the bound UDP socket
+   * @param streamId Identifies the stream on the wire (default: id)
+   * @param address The remote address
+   * @param port The remote port
+   * @param dropRate Share of data frames to drop, `SSC_FAULT_INJECTION` builds only (default: 0)
+   * @param reorderRate Share of data frames to reorder, `SSC_FAULT_INJECTION` builds only (default: 0)
+   * @param delay Milliseconds to hold back incoming frames, `SSC_FAULT_INJECTION` builds only (default: 0)
    */
-  router->map("fs.stat", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path"});
+  router->map("stream.open", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "peerId", "address", "port"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.stat(
+    Core::Stream::OpenOptions options;
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.peerId, "peerId", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.streamId, "streamId", std::stoull, std::to_string(id));
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    #if SSC_FAULT_INJECTION
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.dropRate, "dropRate", std::stod, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.reorderRate, "reorderRate", std::stod, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.delay, "delay", std::stoull, "0");
+    #else
+    if (message.has("dropRate") || message.has("reorderRate") || message.has("delay")) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"code", "ENOTSUP"},
+        {"message", "Fault injection is not built into this runtime"}
+      }});
+    }
+    #endif
+
+    options.address = message.get("address");
+
+    router->core->stream.open(
       message.seq,
-      message.get("path"),
+      id,
+      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Removes a file or empty directory at `path`.
-   * @param path
-   * @see unlink(2)
+   * Reads up to `size` bytes from a stream. The bytes are the response body,
+   * a read waits for data and replies with `EOF` at the end of the stream.
+   * @param id Handle ID of the stream
+   * @param size The most bytes to read (default: 1048576)
    */
-  router->map("fs.unlink", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"path"});
+  router->map("stream.read", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    size_t size;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoull, "1048576");
+
+    if (size == 0) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'size' given in parameters"}
+      }});
+    }
+
+    router->core->stream.read(
+      message.seq,
+      id,
+      size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Writes the message bytes to a stream. The reply is sent once the remote
+   * end acknowledged all of them.
+   * @param id Handle ID of the stream
+   * @param bytes The bytes to write
+   */
+  router->map("stream.write", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->stream.write(
+      message.seq,
+      id,
+      message.buffer.bytes,
+      message.buffer.size,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Accepts the pending connection of a listening TCP socket, reported
+   * with a "connection" event of `tcp.listen`.
+   * @param serverId Handle ID of the listening socket
+   * @param id Handle ID for the accepted connection
+   */
+  router->map("tcp.accept", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"serverId", "id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t serverId;
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(serverId, "serverId", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->tcp.accept(
+      message.seq,
+      serverId,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Closes a TCP socket. Queued writes fail with ECANCELED.
+   * @param id Handle ID of the TCP socket
+   */
+  router->map("tcp.close", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->tcp.close(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Connects a TCP socket.
+   * @param id Handle ID of the TCP socket
+   * @param port Port to connect to
+   * @param address The address to connect to (default: 127.0.0.1)
+   * @param noDelay Disable Nagle's algorithm (TCP_NODELAY) (default: false)
+   * @param keepAlive Enable keepalive probes (default: false)
+   * @param keepAliveDelay Seconds idle before the first probe (default: 60)
+   */
+  router->map("tcp.connect", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "port"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    Core::TCP::ConnectOptions options;
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.socket.keepAliveDelay, "keepAliveDelay", std::stoul, "60");
+
+    options.address = message.get("address", "127.0.0.1");
+    options.socket.noDelay = message.get("noDelay") == "true";
+    options.socket.keepAlive = message.get("keepAlive") == "true";
+
+    router->core->tcp.connect(
+      message.seq,
+      id,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Returns the state, socket options, write queue and traffic counters
+   * of a TCP socket.
+   * @param id Handle ID of the TCP socket
+   */
+  router->map("tcp.getState", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->tcp.getState(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Binds a TCP socket and listens for connections, reported with
+   * "connection" events to accept with `tcp.accept`.
+   * @param id Handle ID of the TCP socket
+   * @param port Port to listen on
+   * @param address The address to listen on (default: 0.0.0.0)
+   * @param backlog Maximum pending connections (default: 511)
+   * @param noDelay Disable Nagle's algorithm on accepted connections (default: false)
+   * @param keepAlive Enable keepalive probes on accepted connections (default: false)
+   * @param keepAliveDelay Seconds idle before the first probe (default: 60)
+   */
+  router->map("tcp.listen", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "port"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    Core::TCP::ListenOptions options;
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.backlog, "backlog", std::stoi, "511");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.socket.keepAliveDelay, "keepAliveDelay", std::stoul, "60");
+
+    options.address = message.get("address", "0.0.0.0");
+    options.socket.noDelay = message.get("noDelay") == "true";
+    options.socket.keepAlive = message.get("keepAlive") == "true";
+
+    router->core->tcp.listen(
+      message.seq,
+      id,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Starts reading a connected TCP socket. Reads are delivered as "data"
+   * events with the bytes as body, the end of the stream with `EOF` set.
+   * @param id Handle ID of the TCP socket
+   */
+  router->map("tcp.readStart", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->tcp.readStart(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Stops reading a TCP socket.
+   * @param id Handle ID of the TCP socket
+   */
+  router->map("tcp.readStop", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->tcp.readStop(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Enables or disables keepalive probes on a TCP socket.
+   * @param id Handle ID of the TCP socket
+   * @param enabled Enable keepalive probes (default: true)
+   * @param delay Seconds idle before the first probe (default: 60)
+   */
+  router->map("tcp.setKeepAlive", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    unsigned int delay;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(delay, "delay", std::stoul, "60");
+
+    router->core->tcp.setKeepAlive(
+      message.seq,
+      id,
+      message.get("enabled", "true") == "true",
+      delay,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Enables or disables Nagle's algorithm (TCP_NODELAY) on a TCP socket.
+   * @param id Handle ID of the TCP socket
+   * @param enabled Send small writes right away (default: true)
+   */
+  router->map("tcp.setNoDelay", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->tcp.setNoDelay(
+      message.seq,
+      id,
+      message.get("enabled", "true") == "true",
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
+
+  /**
+   * Shuts down the write side of a TCP socket once queued writes were
+   * written.
+   * @param id Handle ID of the TCP socket
+   */
+  router->map("tcp.shutdown", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    router->core->fs.unlink(
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->tcp.shutdown(
       message.seq,
-      message.get("path"),
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Writes buffer at `message.buffer.bytes` of size `message.buffers.size`
-   * at `offset` for an opened file handle.
-   * @param id Handle ID for an open file descriptor
-   * @param offset The offset to start writing at
-   * @see write(2)
+   * Writes the message bytes to a connected TCP socket. Writes made while
+   * others are in flight are written together in one batch. The reply is
+   * sent once the bytes were written.
+   * @param id Handle ID of the TCP socket
+   * @param bytes The bytes to write
    */
-  router->map("fs.write", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id", "offset"});
+  router->map("tcp.write", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    if (message.buffer.bytes == nullptr || message.buffer.size == 0) {
-      auto err = JSON::Object::Entries {{ "message", "Missing buffer in message" }};
-      return reply(Result::Err { message, err });
-    }
-
-
     uint64_t id;
-    int offset = 0;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(offset, "offset", std::stoi);
 
-    router->core->fs.write(
+    router->core->tcp.write(
       message.seq,
       id,
       message.buffer.bytes,
       message.buffer.size,
-      offset,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
+#if SSC_BENCHMARKS
   /**
-   * A private API for artifically setting the current cached CWD value.
-   * This is only useful on platforms that need to set this value from an
-   * external source, like Android or ChromeOS.
+   * Measures loopback receive throughput of a bound port read by one socket
+   * and then by `receivers` sockets, flooded by `senders` threads. Then
+   * compares sends of `segments` datagrams from a peer bound with a segment
+   * size, one datagram at a time and with GSO, in `segmentation`.
+   * @param receivers Sockets reading the port in the second run (default: 4)
+   * @param senders Threads sending to the port (default: 4)
+   * @param size Bytes per datagram (default: 1200)
+   * @param segments Datagrams per segmented send, 0 skips the comparison
+   * (default: 16)
+   * @param duration Milliseconds per run (default: 1000)
    */
-  router->map("internal.setcwd", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"value"});
-
-    if (err.type != JSON::Type::Null) {
-      return reply(Result { message.seq, message, err });
-    }
-
-    setcwd(message.value);
-    reply(Result { message.seq, message, JSON::Object{} });
+  router->map("udp.benchmark", [](auto message, auto router, auto reply) {
+    Core::UDP::BenchmarkOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.receivers, "receivers", std::stoull, "4");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.senders, "senders", std::stoull, "4");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.size, "size", std::stoull, "1200");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.segments, "segments", std::stoull, "16");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.duration, "duration", std::stoull, "1000");
+
+    router->core->udp.benchmark(
+      message.seq,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Log `value to stdout` with platform dependent logger.
-   * @param value
+   * Compares peer lookups in the sharded peer registry with a single
+   * locked map, from one thread and then from `threads` threads. Replies
+   * with lookups per second for each.
+   * @param peers Peers looked up at random (default: 1024)
+   * @param threads Threads looking peers up in the second run (default: 8)
+   * @param lookups Lookups per peer removed and created again (default: 16)
+   * @param duration Milliseconds per registry and run (default: 200)
    */
-  router->map("log", [](auto message, auto router, auto reply) {
-    auto value = message.value.c_str();
-  #if defined(__APPLE__)
-    NSLog(@"%s", value);
-    os_log_with_type(SSC_OS_LOG_BUNDLE, OS_LOG_TYPE_INFO, "%{public}s", value);
-  #elif defined(__ANDROID__)
-    __android_log_print(ANDROID_LOG_DEBUG, "", "%s", value);
-  #else
-    printf("%s\n", value);
-  #endif
+  router->map("udp.benchmarkPeers", [](auto message, auto router, auto reply) {
+    Core::UDP::PeersBenchmarkOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.peers, "peers", std::stoull, "1024");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.threads, "threads", std::stoull, "8");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.lookups, "lookups", std::stoull, "16");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.duration, "duration", std::stoull, "200");
+
+    router->core->udp.benchmarkPeers(
+      message.seq,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
+#endif
 
   /**
-   * Read or modify the `SEND_BUFFER` or `RECV_BUFFER` for a peer socket.
-   * @param id Handle ID for the buffer to read/modify
-   * @param size If given, the size to set in the buffer [default = 0]
-   * @param buffer The buffer to read/modify (SEND_BUFFER, RECV_BUFFER) [default = 0 (SEND_BUFFER)]
+   * Binds an UDP socket to a specified port, and optionally a host
+   * address (default: 0.0.0.0).
+   * @param id Handle ID of underlying socket
+   * @param port Port to bind the UDP socket to
+   * @param address The address to bind the UDP socket to (default: 0.0.0.0)
+   * @param reuseAddr Reuse underlying UDP socket address (default: false)
+   * @param segmentSize Split sends larger than this into datagrams of this
+   * size, using UDP GSO/GRO where supported (default: 0, disabled)
+   * @param timestamps Timestamp received datagrams in the kernel where
+   * supported and answer `udp.rtt` probes (default: false)
+   * @param receivers Sockets reading the port, each on a thread of its own,
+   * with `SO_REUSEPORT` on Linux (default: 1)
+   * @param steering How datagrams are spread over the receivers, "hash"
+   * keeps a flow on one receiver and "cpu" reads them on the CPU the kernel
+   * received them on (default: "hash")
    */
-  router->map("os.bufferSize", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("udp.bind", [](auto message, auto router, auto reply) {
+    Core::UDP::BindOptions options;
+    auto err = validateMessageParameters(message, {"id", "port"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
     uint64_t id;
-    int buffer = 0;
-    int size = 0;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(buffer, "buffer", std::stoi, "0");
-    REQUIRE_AND_GET_MESSAGE_VALUE(size, "size", std::stoi, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.segmentSize, "segmentSize", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.receivers, "receivers", std::stoull, "1");
 
-    router->core->os.bufferSize(
+    auto steering = message.get("steering", "hash");
+
+    if (steering == "hash") {
+      options.steering = PEER_RECEIVE_STEERING_HASH;
+    } else if (steering == "cpu") {
+      options.steering = PEER_RECEIVE_STEERING_CPU;
+    } else {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'steering' given in parameters"}
+      }});
+    }
+
+    options.reuseAddr = message.get("reuseAddr") == "true";
+    options.timestamps = message.get("timestamps") == "true";
+    options.address = message.get("address", "0.0.0.0");
+
+    router->core->udp.bind(
       message.seq,
       id,
-      size,
-      buffer,
+      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Returns a mapping of network interfaces.
+   * Close socket handle and underlying UDP socket.
+   * @param id Handle ID of underlying socket
    */
-  router->map("os.networkInterfaces", [](auto message, auto router, auto reply) {
-    router->core->os.networkInterfaces(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
-  });
+  router->map("udp.close", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
-  /**
-   * Returns an array of CPUs available to the process.
-   */
-  router->map("os.cpus", [](auto message, auto router, auto reply) {
-    router->core->os.cpus(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
-  });
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
 
-  router->map("os.rusage", [](auto message, auto router, auto reply) {
-    router->core->os.rusage(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
-  });
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-  router->map("os.uptime", [](auto message, auto router, auto reply) {
-    router->core->os.uptime(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+    router->core->udp.close(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
   });
 
-  router->map("os.uname", [](auto message, auto router, auto reply) {
-    router->core->os.uname(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
-  });
+  /**
+   * Connects an UDP socket to a specified port, and optionally a host
+   * address (default: 0.0.0.0).
+   * @param id Handle ID of underlying socket
+   * @param port Port to connect the UDP socket to
+   * @param address The address to connect the UDP socket to (default: 0.0.0.0)
+   */
+  router->map("udp.connect", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "port"});
 
-  router->map("os.hrtime", [](auto message, auto router, auto reply) {
-    router->core->os.hrtime(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
-  });
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
 
-  router->map("os.availableMemory", [](auto message, auto router, auto reply) {
-    router->core->os.availableMemory(message.seq, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
-  });
+    Core::UDP::ConnectOptions options;
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
 
-  /**
-   * Simply returns `pong`.
-   */
-  router->map("ping", [](auto message, auto router, auto reply) {
-    auto result = Result { message.seq, message };
-    result.data = "pong";
-    reply(result);
+    options.address = message.get("address", "0.0.0.0");
+
+    router->core->udp.connect(
+      message.seq,
+      id,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Handles platform events.
-   * @param value The event name [domcontentloaded]
-   * @param data Optional data associated with the platform event.
+   * Disconnects a connected socket handle and underlying UDP socket.
+   * @param id Handle ID of underlying socket
    */
-  router->map("platform.event", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"value"});
+  router->map("udp.disconnect", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
-      return reply(Result { message.seq, message, err });
+      return reply(Result::Err { message, err });
     }
 
-    if (!router->isReady) router->isReady = true;
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->platform.event(
+    router->core->udp.disconnect(
       message.seq,
-      message.value,
-      message.get("data"),
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Requests a notification with `title` and `body` to be shown.
-   * @param title
-   * @param body
+   * Returns connected peer socket address information.
+   * @param id Handle ID of underlying socket
    */
-  router->map("platform.notify", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"body", "title"});
+  router->map("udp.getPeerName", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
-      return reply(Result { message.seq, message, err });
+      return reply(Result::Err { message, err });
     }
 
-    router->core->platform.notify(
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->udp.getPeerName(
       message.seq,
-      message.get("title"),
-      message.get("body"),
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Requests a URL to be opened externally.
-   * @param value
+   * Returns local socket address information.
+   * @param id Handle ID of underlying socket
    */
-  router->map("platform.openExternal", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"value"});
+  router->map("udp.getSockName", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
-      return reply(Result { message.seq, message, err });
+      return reply(Result::Err { message, err });
     }
 
-    router->core->platform.openExternal(
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->udp.getSockName(
       message.seq,
-      message.value,
+      id,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Return Socket Runtime primordials.
+   * Returns socket state information.
+   * @param id Handle ID of underlying socket
    */
-  router->map("platform.primordials", [](auto message, auto router, auto reply) {
-    std::regex platform_pattern("^mac$", std::regex_constants::icase);
-    auto platformRes = std::regex_replace(platform.os, platform_pattern, "darwin");
-    auto arch = std::regex_replace(platform.arch, std::regex("x86_64"), "x64");
-    arch = std::regex_replace(arch, std::regex("x86"), "ia32");
-    arch = std::regex_replace(arch, std::regex("arm(?!64).*"), "arm");
-    auto json = JSON::Object::Entries {
-      {"source", "platform.primordials"},
-      {"data", JSON::Object::Entries {
-        {"arch", arch},
-        {"cwd", getcwd()},
-        {"platform", platformRes},
-        {"version", JSON::Object::Entries {
-          {"full", SSC::VERSION_FULL_STRING},
-          {"short", SSC::VERSION_STRING},
-          {"hash", SSC::VERSION_HASH_STRING}}
-        }
-      }}
-    };
-    reply(Result { message.seq, message, json });
+  router->map("udp.getState", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
+
+    if (err.type != JSON::Type::Null) {
+      return reply(Result::Err { message, err });
+    }
+
+    uint64_t id;
+    REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+
+    router->core->udp.getState(
+      message.seq,
+      id,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Returns pending post data typically returned in the response of an
-   * `ipc://post` IPC call intercepted by an XHR request.
-   * @param id The id of the post data.
+   * Initializes socket handle to start receiving data from the underlying
+   * socket and route through the IPC bridge to the WebView.
+   * @param id Handle ID of underlying socket
+   * @param decodePackets Deliver stream-relay packet headers decoded and only the packet message as bytes (default: false)
+   * @param fec Reassemble blocks sent with `udp.sendBlock` and recover lost packets (default: false)
    */
-  router->map("post", [](auto message, auto router, auto reply) {
+  router->map("udp.readStart", [](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
+    Core::UDP::ReadStartOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    if (!router->core->hasPost(id)) {
-      return reply(Result::Err { message, JSON::Object::Entries {
-        {"id", std::to_string(id)},
-        {"message", "Post not found for given 'id'"}
-      }});
-    }
-
-    auto result = Result { message.seq, message };
-    result.post = router->core->getPost(id);
-    reply(result);
-    router->core->removePost(id);
-  });
-
-  /**
-   * Prints incoming message value to stdout.
-   */
-  router->map("stdout", [](auto message, auto router, auto reply) {
-  #if defined(__APPLE__)
-    os_log_with_type(SSC_OS_LOG_BUNDLE, OS_LOG_TYPE_INFO, "%{public}s", message.value.c_str());
-  #endif
-    stdWrite(message.value, false);
-  });
+    options.decodePackets = message.get("decodePackets") == "true";
+    options.fec = message.get("fec") == "true";
 
-  /**
-   * Prints incoming message value to stderr.
-   */
-  router->map("stderr", [](auto message, auto router, auto reply) {
-  #if defined(__APPLE__)
-    os_log_with_type(SSC_OS_LOG_BUNDLE, OS_LOG_TYPE_ERROR, "%{public}s", message.value.c_str());
-  #endif
-    stdWrite(message.value, true);
+    router->core->udp.readStart(
+      message.seq,
+      id,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Binds an UDP socket to a specified port, and optionally a host
-   * address (default: 0.0.0.0).
+   * Stops socket handle from receiving data from the underlying
+   * socket and routing through the IPC bridge to the WebView.
    * @param id Handle ID of underlying socket
-   * @param port Port to bind the UDP socket to
-   * @param address The address to bind the UDP socket to (default: 0.0.0.0)
-   * @param reuseAddr Reuse underlying UDP socket address (default: false)
    */
-  router->map("udp.bind", [](auto message, auto router, auto reply) {
-    Core::UDP::BindOptions options;
-    auto err = validateMessageParameters(message, {"id", "port"});
+  router->map("udp.readStop", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
@@ -1158,58 +2618,78 @@ void initRouterTable (Router *router) {
 
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
 
-    options.reuseAddr = message.get("reuseAddr") == "true";
-    options.address = message.get("address", "0.0.0.0");
-
-    router->core->udp.bind(
+    router->core->udp.readStop(
       message.seq,
       id,
-      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Close socket handle and underlying UDP socket.
+   * Measures the round trip time to a remote socket with a native probe,
+   * answered without going through its WebView. Both sockets are bound
+   * with `timestamps` enabled and receiving. Without an address, replies
+   * with the estimates of the remote addresses probed so far.
    * @param id Handle ID of underlying socket
+   * @param port Port of the remote socket
+   * @param address Address of the remote socket (default: none)
+   * @param timeout Milliseconds to wait for an answer (default: 1000)
    */
-  router->map("udp.close", [](auto message, auto router, auto reply) {
+  router->map("udp.rtt", [](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
+    Core::UDP::RTTOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.timeout, "timeout", std::stoull, "1000");
 
-    router->core->udp.close(message.seq, id, RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply));
+    options.address = message.get("address");
+
+    router->core->udp.rtt(
+      message.seq,
+      id,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
   });
 
   /**
-   * Connects an UDP socket to a specified port, and optionally a host
-   * address (default: 0.0.0.0).
+   * Broadcasts a datagram on the socket. For connectionless sockets, the
+   * destination port and address must be specified. Connected sockets, on the
+   * other hand, will use their associated remote endpoint, so the port and
+   * address arguments must not be set.
    * @param id Handle ID of underlying socket
-   * @param port Port to connect the UDP socket to
-   * @param address The address to connect the UDP socket to (default: 0.0.0.0)
+   * @param port The port to send data to
+   * @param size The size of the bytes to send
+   * @param bytes A pointer to the bytes to send
+   * @param bufferId Handle ID of a native buffer to send instead of `bytes`
+   * @param address The address to send to (default: 0.0.0.0)
+   * @param ephemeral Indicates that the socket handle, if created is ephemeral and should eventually be destroyed
    */
-  router->map("udp.connect", [](auto message, auto router, auto reply) {
+  router->map("udp.send", [](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id", "port"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    Core::UDP::ConnectOptions options;
+    Core::UDP::SendOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
     REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
 
+    options.size = message.buffer.size;
+    options.bytes = message.buffer.bytes;
     options.address = message.get("address", "0.0.0.0");
+    options.ephemeral = message.get("ephemeral") == "true";
 
-    router->core->udp.connect(
+    router->core->udp.send(
       message.seq,
       id,
       options,
@@ -1218,169 +2698,382 @@ void initRouterTable (Router *router) {
   });
 
   /**
-   * Disconnects a connected socket handle and underlying UDP socket.
+   * Sends a block of datagrams with Reed-Solomon parity datagrams, so a
+   * receiver with `udp.readStart` and `fec` set recovers up to
+   * `parityCount` lost datagrams of the block without a retransmission.
+   * The datagrams are concatenated in the message bytes and `sizes` slices
+   * them in order.
    * @param id Handle ID of underlying socket
+   * @param port The port to send data to
+   * @param address The address to send to (default: 0.0.0.0)
+   * @param sizes Comma separated byte sizes of each datagram
+   * @param parityCount Number of parity datagrams, at most 256 datagrams per block (default: 0)
+   * @param dropRate Share of datagrams not sent, `SSC_FAULT_INJECTION` builds only (default: 0)
+   * @param bytes The concatenated datagrams
+   * @param ephemeral Indicates that the socket handle, if created is ephemeral and should eventually be destroyed
    */
-  router->map("udp.disconnect", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("udp.sendBlock", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "port", "sizes"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
+    Core::UDP::SendBlockOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.parityCount, "parityCount", std::stoull, "0");
+    #if SSC_FAULT_INJECTION
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.dropRate, "dropRate", std::stod, "0");
+    #else
+    if (message.has("dropRate")) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"code", "ENOTSUP"},
+        {"message", "Fault injection is not built into this runtime"}
+      }});
+    }
+    #endif
 
-    router->core->udp.disconnect(
+    size_t size = 0;
+
+    if (!parseSizeList(message.get("sizes"), options.sizes)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters"}
+      }});
+    }
+
+    for (auto value : options.sizes) {
+      size += value;
+    }
+
+    if (size > message.buffer.size) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sizes' given in parameters, exceeds message bytes"}
+      }});
+    }
+
+    options.bytes = message.buffer.bytes;
+    options.address = message.get("address", "0.0.0.0");
+    options.ephemeral = message.get("ephemeral") == "true";
+
+    router->core->udp.sendBlock(
       message.seq,
       id,
+      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Returns connected peer socket address information.
+   * Sends a file opened with `fs.open` as a sequence of datagrams, read
+   * and sent natively so the file bytes never cross the IPC boundary.
+   * Sends honor the send queue limits and pacing of the socket. Progress
+   * is emitted as `udp.sendFile` events with the bytes sent so far.
    * @param id Handle ID of underlying socket
+   * @param fd ID of the open file descriptor
+   * @param port The port to send data to
+   * @param address The address to send to (default: 0.0.0.0)
+   * @param offset File offset to start from (default: 0)
+   * @param length Bytes to send, `0` sends up to the end of the file (default: 0)
+   * @param chunkSize Bytes per datagram (default: 1200)
+   * @param ephemeral Indicates that the socket handle, if created is ephemeral and should eventually be destroyed
    */
-  router->map("udp.getPeerName", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("udp.sendFile", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "fd", "port"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
+    Core::UDP::SendFileOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.fd, "fd", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.offset, "offset", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.length, "length", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.chunkSize, "chunkSize", std::stoull, "1200");
 
-    router->core->udp.getPeerName(
+    options.address = message.get("address", "0.0.0.0");
+    options.ephemeral = message.get("ephemeral") == "true";
+
+    router->core->udp.sendFile(
       message.seq,
       id,
+      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Returns local socket address information.
+   * Sends the same datagram to many destinations with a single call. The
+   * bytes are uploaded once and shared by every send, and the per
+   * destination status is reported in a single reply.
    * @param id Handle ID of underlying socket
+   * @param destinations Comma separated list of `address:port` pairs
+   * @param bytes A pointer to the bytes to send
+   * @param ephemeral Indicates that the socket handle, if created is ephemeral and should eventually be destroyed
    */
-  router->map("udp.getSockName", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("udp.sendMany", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "destinations"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
+    Core::UDP::SendManyOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
 
-    router->core->udp.getSockName(
+    for (const auto& value : split(message.get("destinations"), ',')) {
+      auto destination = trim(value);
+      auto separator = destination.rfind(':');
+      Core::UDP::Destination entry;
+
+      if (separator == String::npos) {
+        return reply(Result::Err { message, JSON::Object::Entries {
+          {"message", "Invalid 'destinations' given in parameters"}
+        }});
+      }
+
+      try {
+        entry.address = destination.substr(0, separator);
+        entry.port = std::stoi(destination.substr(separator + 1));
+      } catch (...) {
+        return reply(Result::Err { message, JSON::Object::Entries {
+          {"message", "Invalid 'destinations' given in parameters"}
+        }});
+      }
+
+      options.destinations.push_back(entry);
+    }
+
+    options.size = message.buffer.size;
+    options.bytes = message.buffer.bytes;
+    options.ephemeral = message.get("ephemeral") == "true";
+
+    router->core->udp.sendMany(
       message.seq,
       id,
+      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Returns socket state information.
+   * Encodes a stream-relay packet from its fields and broadcasts it on the
+   * socket. The packet message is given as the message bytes.
    * @param id Handle ID of underlying socket
+   * @param port The port to send data to
+   * @param address The address to send to (default: 0.0.0.0)
+   * @param type The packet type (default: 0)
+   * @param hops The packet hop count (default: 0)
+   * @param clock The packet clock (default: 0)
+   * @param index The packet index (default: -1)
+   * @param packetId Hex encoded packet ID
+   * @param clusterId Hex encoded cluster ID
+   * @param previousId Hex encoded previous packet ID
+   * @param nextId Hex encoded next packet ID
+   * @param to Base64 encoded public key of the recipient
+   * @param usr1 User data, at most 32 bytes
+   * @param ephemeral Indicates that the socket handle, if created is ephemeral and should eventually be destroyed
    */
-  router->map("udp.getState", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id"});
+  router->map("udp.sendPacket", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id", "port"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
+    Core::UDP::SendPacketOptions options;
+    auto& packet = options.packet;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(packet.type, "type", std::stoi, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(packet.hops, "hops", std::stoul, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(packet.clock, "clock", std::stoul, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(packet.index, "index", std::stoi, "-1");
+
+    for (const auto& entry : Vector<std::pair<String, StreamRelay::Packet::ID*>> {
+      {"packetId", &packet.packetId},
+      {"clusterId", &packet.clusterId},
+      {"previousId", &packet.previousId},
+      {"nextId", &packet.nextId}
+    }) {
+      if (!StreamRelay::parsePacketID(message.get(entry.first), *entry.second)) {
+        return reply(Result::Err { message, JSON::Object::Entries {
+          {"message", "Invalid '" + entry.first + "' given in parameters"}
+        }});
+      }
+    }
 
-    router->core->udp.getState(
+    if (!StreamRelay::parsePacketPublicKey(message.get("to"), packet.to)) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'to' given in parameters"}
+      }});
+    }
+
+    auto usr1 = message.get("usr1");
+    memcpy(
+      packet.usr1.data(),
+      usr1.data(),
+      std::min(usr1.size(), packet.usr1.size())
+    );
+
+    packet.message = message.buffer.bytes;
+    packet.messageLength = message.buffer.size;
+
+    options.address = message.get("address", "0.0.0.0");
+    options.ephemeral = message.get("ephemeral") == "true";
+
+    router->core->udp.sendPacket(
       message.seq,
       id,
+      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Initializes socket handle to start receiving data from the underlying
-   * socket and route through the IPC bridge to the WebView.
+   * Enables receive buffer auto-tuning on a socket. The receive buffer
+   * grows when the kernel drops datagrams or the receive queue fills up
+   * and shrinks while the socket is idle. Each change is a 'data' event.
    * @param id Handle ID of underlying socket
+   * @param enabled Whether the receive buffer is tuned (default: true)
+   * @param minSize Smallest receive buffer in bytes (default: 0, the current size)
+   * @param maxSize Largest receive buffer in bytes, the kernel may cap it lower (default: 0, 8 MiB)
+   * @param interval Milliseconds between samples of the socket (default: 1000)
    */
-  router->map("udp.readStart", [](auto message, auto router, auto reply) {
+  router->map("udp.setBufferTuning", [](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
+    Core::UDP::BufferTuningOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.minSize, "minSize", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.maxSize, "maxSize", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.interval, "interval", std::stoull, "1000");
 
-    router->core->udp.readStart(
+    options.enabled = message.get("enabled") != "false";
+
+    router->core->udp.setBufferTuning(
       message.seq,
       id,
+      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Stops socket handle from receiving data from the underlying
-   * socket and routing through the IPC bridge to the WebView.
+   * Enables congestion control and pacing for sends on a socket. Streams
+   * opened on the socket keep within the congestion window and feed it
+   * RTT and loss, all sends are paced.
    * @param id Handle ID of underlying socket
+   * @param enabled Whether sends are congestion controlled and paced (default: true)
+   * @param maxPacingRate Maximum bytes per second sent (default: 0, unlimited)
    */
-  router->map("udp.readStop", [](auto message, auto router, auto reply) {
+  router->map("udp.setCongestionControl", [](auto message, auto router, auto reply) {
     auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
+    Core::UDP::CongestionControlOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.maxPacingRate, "maxPacingRate", std::stod, "0");
 
-    router->core->udp.readStop(
+    options.enabled = message.get("enabled") != "false";
+
+    router->core->udp.setCongestionControl(
       message.seq,
       id,
+      options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
 
   /**
-   * Broadcasts a datagram on the socket. For connectionless sockets, the
-   * destination port and address must be specified. Connected sockets, on the
-   * other hand, will use their associated remote endpoint, so the port and
-   * address arguments must not be set.
+   * Sets limits on the bytes and datagrams queued for sending on a socket
+   * and what happens to sends over the limit.
    * @param id Handle ID of underlying socket
-   * @param port The port to send data to
-   * @param size The size of the bytes to send
-   * @param bytes A pointer to the bytes to send
-   * @param address The address to send to (default: 0.0.0.0)
-   * @param ephemeral Indicates that the socket handle, if created is ephemeral and should eventually be destroyed
+   * @param maxBytes Maximum bytes queued for sending (default: 0, unlimited)
+   * @param maxCount Maximum datagrams queued for sending (default: 0, unlimited)
+   * @param policy One of 'reject' (fail with EAGAIN), 'drop-oldest' or 'block' (default: 'reject')
    */
-  router->map("udp.send", [](auto message, auto router, auto reply) {
-    auto err = validateMessageParameters(message, {"id", "port"});
+  router->map("udp.setSendQueueLimits", [](auto message, auto router, auto reply) {
+    auto err = validateMessageParameters(message, {"id"});
 
     if (err.type != JSON::Type::Null) {
       return reply(Result::Err { message, err });
     }
 
-    Core::UDP::SendOptions options;
+    Core::UDP::SendQueueOptions options;
     uint64_t id;
     REQUIRE_AND_GET_MESSAGE_VALUE(id, "id", std::stoull);
-    REQUIRE_AND_GET_MESSAGE_VALUE(options.port, "port", std::stoi);
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.maxBytes, "maxBytes", std::stoull, "0");
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.maxCount, "maxCount", std::stoull, "0");
 
-    options.size = message.buffer.size;
-    options.bytes = message.buffer.bytes;
-    options.address = message.get("address", "0.0.0.0");
-    options.ephemeral = message.get("ephemeral") == "true";
+    auto policy = message.get("policy", "reject");
 
-    router->core->udp.send(
+    if (policy == "reject") {
+      options.policy = PEER_SEND_QUEUE_POLICY_REJECT;
+    } else if (policy == "drop-oldest") {
+      options.policy = PEER_SEND_QUEUE_POLICY_DROP_OLDEST;
+    } else if (policy == "block") {
+      options.policy = PEER_SEND_QUEUE_POLICY_BLOCK;
+    } else {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'policy' given in parameters"}
+      }});
+    }
+
+    router->core->udp.setSendQueueLimits(
       message.seq,
       id,
       options,
       RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
     );
   });
+
+  /**
+   * Returns the traffic counters of every UDP socket in one response, a row
+   * of `fields` values per socket, busiest first, and their totals.
+   * `receiveDrops` counts datagrams the kernel dropped because the socket
+   * receive buffer was full (Linux only).
+   * @param sort One of 'bytes', 'packets', 'errors' or 'drops' (default: 'bytes')
+   * @param limit Maximum sockets reported (default: 0, every socket)
+   */
+  router->map("udp.stats", [](auto message, auto router, auto reply) {
+    Core::UDP::StatsOptions options;
+    REQUIRE_AND_GET_MESSAGE_VALUE(options.limit, "limit", std::stoull, "0");
+
+    options.sort = message.get("sort", "bytes");
+
+    if (
+      options.sort != "bytes" &&
+      options.sort != "packets" &&
+      options.sort != "errors" &&
+      options.sort != "drops"
+    ) {
+      return reply(Result::Err { message, JSON::Object::Entries {
+        {"message", "Invalid 'sort' given in parameters"}
+      }});
+    }
+
+    router->core->udp.stats(
+      message.seq,
+      options,
+      RESULT_CALLBACK_FROM_CORE_CALLBACK(message, reply)
+    );
+  });
 }
 
 static void registerSchemeHandler (Router *router) {
@@ -1403,13 +3096,29 @@ static void registerSchemeHandler (Router *router) {
       auto body = result.post.body != nullptr ? result.post.body : json.c_str();
 
       char* data = nullptr;
+      GInputStream* stream = nullptr;
+
+      if (result.post.storage != nullptr) {
+        // the response reads owned post bytes in place, holding a copy of
+        // the post until the stream is done with them
+        auto bytes = g_bytes_new_with_free_func(
+          body,
+          size,
+          [](gpointer userData) { delete static_cast<Post*>(userData); },
+          new Post(result.post)
+        );
+
+        stream = g_memory_input_stream_new_from_bytes(bytes);
+        g_bytes_unref(bytes);
+      } else {
+        if (size > 0) {
+          data = new char[size]{0};
+          memcpy(data, body, size);
+        }
 
-      if (size > 0) {
-        data = new char[size]{0};
-        memcpy(data, body, size);
+        stream = g_memory_input_stream_new_from_data(data, size, nullptr);
       }
 
-      auto stream = g_memory_input_stream_new_from_data(data, size, nullptr);
       auto response = webkit_uri_scheme_response_new(stream, size);
 
       if (result.post.body) {
@@ -1674,7 +3383,26 @@ static void registerSchemeHandler (Router *router) {
     auto json = result.str();
     auto size = result.post.body != nullptr ? result.post.length : json.size();
     auto body = result.post.body != nullptr ? result.post.body : json.c_str();
-    auto data = [NSData dataWithBytes: body length: size];
+    NSData* data = nullptr;
+
+    if (result.post.storage != nullptr) {
+      // owned post bytes are read in place, the deallocator holds a copy
+      // of the post until the response is done with them
+      auto post = result.post;
+      data = [[NSData alloc]
+        initWithBytesNoCopy: (void*) body
+                     length: size
+                deallocator: ^(void* bytes, NSUInteger length) {
+          (void) post;
+        }
+      ];
+    #if !__has_feature(objc_arc)
+      [data autorelease];
+    #endif
+    } else {
+      data = [NSData dataWithBytes: body length: size];
+    }
+
     auto  headers = [NSMutableDictionary dictionary];
 
     headers[@"access-control-allow-origin"] = @"*";
@@ -1809,6 +3537,12 @@ namespace SSC::IPC {
     return this->route(uri, bytes, size, nullptr);
   }
 
+  bool Bridge::route (const String& uri, MessageBuffer buffer) {
+    return this->router.invoke(uri, buffer, [this](auto result) {
+      this->router.send(result.seq, result.str(), result.post);
+    });
+  }
+
   bool Bridge::route (
     const String& uri,
     const char* bytes,
@@ -1935,6 +3669,24 @@ namespace SSC::IPC {
     const char *bytes,
     size_t size,
     ResultCallback callback
+  ) {
+    MessageBuffer buffer;
+
+    if (bytes != nullptr && size > 0) {
+      // alloc and copy `bytes` into `buffer.bytes` - caller owns `bytes`
+      // `buffer.bytes` is free'd in CLEANUP_AFTER_INVOKE_CALLBACK
+      buffer.bytes = new char[size]{0};
+      buffer.size = size;
+      memcpy(buffer.bytes, bytes, size);
+    }
+
+    return this->invoke(uri, buffer, callback);
+  }
+
+  bool Router::invoke (
+    const String& uri,
+    MessageBuffer buffer,
+    ResultCallback callback
   ) {
     auto message = Message { uri };
     auto name = message.name;
@@ -1953,6 +3705,10 @@ namespace SSC::IPC {
       } else if (this->table.find(name) != this->table.end()) {
         ctx = this->table.at(name);
       } else {
+        if (buffer.bytes != nullptr) {
+          delete [] buffer.bytes;
+        }
+
         return false;
       }
     } while (0);
@@ -1962,14 +3718,45 @@ namespace SSC::IPC {
       // decorate message with buffer if buffer was previously
       // mapped with `ipc://buffer.map`, which we do on Linux
       if (this->hasMappedBuffer(msg.index, msg.seq)) {
+        if (buffer.bytes != nullptr) {
+          delete [] buffer.bytes;
+        }
+
         msg.buffer = this->getMappedBuffer(msg.index, msg.seq);
         this->removeMappedBuffer(msg.index, msg.seq);
-      } else if (bytes != nullptr && size > 0) {
-        // alloc and copy `bytes` into `msg.buffer.bytes - caller owns `bytes`
-        // `msg.buffer.bytes` is free'd in CLEANUP_AFTER_INVOKE_CALLBACK
-        msg.buffer.bytes = new char[size]{0};
-        msg.buffer.size = size;
-        memcpy(msg.buffer.bytes, bytes, size);
+      } else if (buffer.bytes != nullptr && buffer.size > 0) {
+        // `msg.buffer.bytes` is free'd in CLEANUP_AFTER_INVOKE_CALLBACK,
+        // unless a route takes them
+        msg.buffer = buffer;
+        msg.buffer.transferred = std::make_shared<std::atomic<bool>>(false);
+      } else if (buffer.bytes != nullptr) {
+        delete [] buffer.bytes;
+      }
+
+      // a `bufferId` stands in for message bytes uploaded earlier with
+      // `buffer.alloc`, read in place and held until the route replied
+      Core::Buffers::Handle retained;
+
+      if (msg.buffer.bytes == nullptr && msg.has("bufferId")) {
+        uint64_t bufferId = 0;
+
+        try {
+          bufferId = std::stoull(msg.get("bufferId"));
+        } catch (...) {}
+
+        if (!this->core->buffers.get(bufferId, retained)) {
+          callback(Result::Err { msg, JSON::Object::Entries {
+            {"bufferId", msg.get("bufferId")},
+            {"code", "NOT_FOUND_ERR"},
+            {"type", "NotFoundError"},
+            {"message", "No buffer with specified id"}
+          }});
+
+          return true;
+        }
+
+        msg.buffer.bytes = retained.data();
+        msg.buffer.size = retained.size;
       }
 
       // named listeners
@@ -1989,21 +3776,24 @@ namespace SSC::IPC {
       } while (0);
 
       if (ctx.async) {
-        auto dispatched = this->dispatch([ctx, msg, callback, this]() mutable {
-          ctx.callback(msg, this, [msg, callback, this](const auto result) mutable {
+        auto dispatched = this->dispatch([ctx, msg, callback, retained, this]() mutable {
+          ctx.callback(msg, this, [msg, callback, retained, this](const auto result) mutable {
             callback(result);
+            RELEASE_RETAINED_BUFFER(msg, retained);
             CLEANUP_AFTER_INVOKE_CALLBACK(this, msg, result);
           });
         });
 
         if (!dispatched) {
+          RELEASE_RETAINED_BUFFER(msg, retained);
           CLEANUP_AFTER_INVOKE_CALLBACK(this, msg, Result{});
         }
 
         return dispatched;
       } else {
-        ctx.callback(msg, this, [msg, callback, this](const auto result) mutable {
+        ctx.callback(msg, this, [msg, callback, retained, this](const auto result) mutable {
           callback(result);
+          RELEASE_RETAINED_BUFFER(msg, retained);
           CLEANUP_AFTER_INVOKE_CALLBACK(this, msg, result);
         });
 
@@ -2011,6 +3801,10 @@ namespace SSC::IPC {
       }
     }
 
+    if (buffer.bytes != nullptr) {
+      delete [] buffer.bytes;
+    }
+
     return false;
   }
 
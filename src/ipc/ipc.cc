@@ -26,6 +26,7 @@ namespace SSC::IPC {
   Message::Message (const Message& message) {
     this->buffer.bytes = message.buffer.bytes;
     this->buffer.size = message.buffer.size;
+    this->buffer.transferred = message.buffer.transferred;
     this->value = message.value;
     this->index = message.index;
     this->name = message.name;
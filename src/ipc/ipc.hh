@@ -58,6 +58,9 @@ namespace SSC::IPC {
   struct MessageBuffer {
     size_t size = 0;
     char* bytes = nullptr;
+    // shared by the copies of a message whose bytes the router frees after
+    // the reply, set once a route takes ownership of them instead
+    std::shared_ptr<std::atomic<bool>> transferred = nullptr;
     MessageBuffer(char* bytes, size_t size)
         : size(size), bytes(bytes) { }
   #ifdef _WIN32
@@ -192,6 +195,7 @@ namespace SSC::IPC {
       void removeMappedBuffer (int index, const Message::Seq seq);
       void setMappedBuffer(int index, const Message::Seq seq, MessageBuffer msg_buf);
 
+
       void preserveCurrentTable ();
 
       uint64_t listen (const String& name, MessageCallback callback);
@@ -211,6 +215,12 @@ namespace SSC::IPC {
         size_t size,
         ResultCallback callback
       );
+      // takes `buffer.bytes`, allocated with `new char[]`, without a copy
+      bool invoke (
+        const String& msg,
+        MessageBuffer buffer,
+        ResultCallback callback
+      );
   };
 
   class Bridge {
@@ -227,6 +237,7 @@ namespace SSC::IPC {
         size_t size,
         Router::ResultCallback
       );
+      bool route (const String& msg, MessageBuffer buffer);
   };
 
   inline String getResolveToMainProcessMessage (
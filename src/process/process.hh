@@ -9,18 +9,53 @@
 #define WEXITSTATUS(w) (((w) & 0xff00) >> 8)
 #endif
 
+#include <chrono>
+#include <cstring>
+#include <string_view>
+
 #include "../common.hh"
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+
+extern char **environ;
+#endif
+
 namespace SSC {
   struct ExecOutput {
     SSC::String output;
     int exitCode = 0;
+    // Set when the command was killed after `ExecOptions::timeout`.
+    bool timedOut = false;
   };
 
+  // Called with a message read from stdout or stderr, a view into the read
+  // buffer that is only valid during the call.
+  using OutputCallback = std::function<void(std::string_view)>;
+
   // Additional parameters to Process constructors.
   struct ProcessConfig {
     // Buffer size for reading stdout and stderr. Default is 131072 (128 kB).
+    // Grows to fit a single message larger than it.
     std::size_t buffer_size = 131072;
+
+    // How stdout and stderr are split into messages: at newlines, which are
+    // not part of the message, or as binary frames with a 4 byte big endian
+    // length in front of each. Default is lines.
+    enum class Framing {
+      lines = 0,
+      binary = 1
+    };
+    Framing framing{Framing::lines};
+
+    // Called instead of `read_stdout` and `read_stderr` when set, without
+    // copying messages into strings.
+    OutputCallback read_stdout_view = nullptr;
+    OutputCallback read_stderr_view = nullptr;
+
     // Set to true to inherit file descriptors from parent process. Default is false.
     // On Windows: has no effect unless read_stdout==nullptr, read_stderr==nullptr and open_stdin==false.
     bool inherit_file_descriptors = false;
@@ -47,53 +82,438 @@ namespace SSC {
     ShowWindow show_window{ShowWindow::show_default};
   };
 
-  inline ExecOutput exec (SSC::String command) {
-    command = command + " 2>&1";
+  // Splits the output of a process into messages as it is read. Reads go
+  // straight into the buffer returned by `data()`, which is never cleared,
+  // and messages are handed out as views into it. Only a trailing partial
+  // message is moved to the front of the buffer to make room.
+  class ProcessOutputReader {
+    public:
+      // binary frames larger than this end the output
+      static constexpr std::size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+      static constexpr std::size_t FRAME_HEADER_SIZE = 4;
+
+      ProcessOutputReader (
+        ProcessConfig::Framing framing,
+        std::size_t size,
+        OutputCallback callback
+      ) :
+        framing(framing),
+        capacity(size > FRAME_HEADER_SIZE ? size : FRAME_HEADER_SIZE),
+        buffer(new char[capacity]),
+        callback(std::move(callback))
+      {}
+
+      // Where the next read goes, `available()` bytes long.
+      char* data () noexcept {
+        return this->buffer.get() + this->end;
+      }
+
+      std::size_t available () const noexcept {
+        return this->capacity - this->end;
+      }
 
-    ExecOutput eo;
-    FILE* pipe;
-    size_t count;
-    int exitCode = 0;
-    const int bufsize = 128;
-    std::array<char, 128> buffer;
+      // Hands out the messages completed by `size` bytes read into `data()`.
+      void commit (std::size_t size) {
+        if (this->failed) {
+          return;
+        }
+
+        this->end += size;
+
+        if (this->framing == ProcessConfig::Framing::binary) {
+          this->frames();
+        } else {
+          this->lines();
+        }
+
+        if (this->start == this->end) {
+          this->start = this->end = this->scanned = 0;
+        } else if (this->available() < this->capacity / 4 || this->needed > this->capacity) {
+          this->compact();
+        }
+      }
+
+      // Hands out a last line without a newline once the output ended.
+      void flush () {
+        if (
+          !this->failed &&
+          this->framing == ProcessConfig::Framing::lines &&
+          this->end > this->start
+        ) {
+          this->callback(std::string_view(this->buffer.get() + this->start, this->end - this->start));
+        }
+
+        this->start = this->end = this->scanned = 0;
+      }
+
+    private:
+      ProcessConfig::Framing framing;
+      std::size_t capacity;
+      std::unique_ptr<char[]> buffer;
+      OutputCallback callback;
+      // unread messages are between `start` and `end`, `scanned` is where
+      // the search for the next newline continues
+      std::size_t start = 0;
+      std::size_t end = 0;
+      std::size_t scanned = 0;
+      // bytes the partial binary frame at `start` needs in total
+      std::size_t needed = 0;
+      bool failed = false;
+
+      void lines () {
+        auto bytes = this->buffer.get();
+
+        while (this->scanned < this->end) {
+          auto newline = static_cast<char*>(
+            memchr(bytes + this->scanned, '\n', this->end - this->scanned)
+          );
+
+          if (newline == nullptr) {
+            this->scanned = this->end;
+            break;
+          }
+
+          auto offset = static_cast<std::size_t>(newline - bytes);
+          this->callback(std::string_view(bytes + this->start, offset - this->start));
+          this->start = this->scanned = offset + 1;
+        }
+      }
+
+      void frames () {
+        auto bytes = reinterpret_cast<const unsigned char*>(this->buffer.get());
+
+        while (this->end - this->start >= FRAME_HEADER_SIZE) {
+          auto header = bytes + this->start;
+          std::size_t size = (
+            (static_cast<std::size_t>(header[0]) << 24) |
+            (static_cast<std::size_t>(header[1]) << 16) |
+            (static_cast<std::size_t>(header[2]) << 8) |
+            static_cast<std::size_t>(header[3])
+          );
+
+          if (size > MAX_FRAME_SIZE) {
+            this->failed = true;
+            this->start = this->end = this->scanned = this->needed = 0;
+            return;
+          }
+
+          if (this->end - this->start < FRAME_HEADER_SIZE + size) {
+            this->needed = FRAME_HEADER_SIZE + size;
+            return;
+          }
+
+          this->callback(std::string_view(
+            this->buffer.get() + this->start + FRAME_HEADER_SIZE,
+            size
+          ));
+
+          this->start += FRAME_HEADER_SIZE + size;
+        }
+
+        this->needed = 0;
+      }
+
+      // moves the partial message to the front, growing the buffer if it
+      // does not fit a message
+      void compact () {
+        auto pending = this->end - this->start;
+        auto size = this->capacity;
+
+        while (size < this->needed || size - pending < size / 4) {
+          size *= 2;
+        }
+
+        if (size != this->capacity) {
+          auto buffer = std::unique_ptr<char[]>(new char[size]);
+          memcpy(buffer.get(), this->buffer.get() + this->start, pending);
+          this->buffer = std::move(buffer);
+          this->capacity = size;
+        } else if (this->start > 0) {
+          memmove(this->buffer.get(), this->buffer.get() + this->start, pending);
+        }
+
+        this->scanned = this->scanned > this->start ? this->scanned - this->start : 0;
+        this->start = 0;
+        this->end = pending;
+      }
+  };
+
+  // Additional parameters to `exec()`.
+  struct ExecOptions {
+    // Called with each line of output as it is read, on the calling thread.
+    // Lines of commands running at the same time are interleaved.
+    OutputCallback onOutput = nullptr;
+    // Milliseconds until a command is killed, with the commands it started.
+    // Default is 0, which waits for it to exit. Has no effect on Windows.
+    uint64_t timeout = 0;
+    // Commands running at the same time. Default is 0, the number of CPUs.
+    unsigned int concurrency = 0;
+  };
+
+  // Bytes read from the output of a command at once.
+  constexpr std::size_t EXEC_READ_BUFFER_SIZE = 64 * 1024;
+
+#if !defined(_WIN32)
+  // A command started by `exec()` and the pipe its output is read from.
+  struct ExecChild {
+    std::size_t index = 0;
+    pid_t pid = -1;
+    int fd = -1;
+    std::chrono::steady_clock::time_point deadline;
+    std::unique_ptr<ProcessOutputReader> reader;
+  };
+
+  // Starts `/bin/sh -c "<command> 2>&1"` with stdout on a pipe, the way
+  // `popen()` does but without forking the calling process.
+  inline bool spawnExecChild (const SSC::String& command, const ExecOptions& options, ExecChild& child) {
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attributes;
+    short flags = 0;
+    int fds[2];
+
+  #if defined(__APPLE__)
+    if (pipe(fds) != 0) {
+      return false;
+    }
+  #else
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+      return false;
+    }
+  #endif
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attributes);
+
+  #if defined(__APPLE__)
+    // pipes of commands started at the same time must not leak into each
+    // other, or their output would never end
+    flags |= POSIX_SPAWN_CLOEXEC_DEFAULT;
+    posix_spawn_file_actions_addinherit_np(&actions, STDIN_FILENO);
+    posix_spawn_file_actions_addinherit_np(&actions, STDERR_FILENO);
+  #endif
+
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+
+    // a process group of its own, so the timeout kills what it started too
+    if (options.timeout > 0) {
+      flags |= POSIX_SPAWN_SETPGROUP;
+      posix_spawnattr_setpgroup(&attributes, 0);
+    }
+
+    posix_spawnattr_setflags(&attributes, flags);
+
+    auto script = command + " 2>&1";
+    char* const argv[] = {
+      const_cast<char*>("/bin/sh"),
+      const_cast<char*>("-c"),
+      const_cast<char*>(script.c_str()),
+      nullptr
+    };
+
+    auto status = posix_spawn(&child.pid, "/bin/sh", &actions, &attributes, argv, environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    close(fds[1]);
 
-    #ifdef _WIN32
+    if (status != 0) {
+      close(fds[0]);
+      return false;
+    }
+
+    child.fd = fds[0];
+    return true;
+  }
+#endif
+
+  // Runs independent commands at the same time, through `/bin/sh` with
+  // stderr in their output, or `cmd.exe` on Windows. The results are in
+  // the order of `commands`.
+  inline Vector<ExecOutput> exec (const Vector<SSC::String>& commands, const ExecOptions& options = {}) {
+    Vector<ExecOutput> results(commands.size());
+
+  #if defined(_WIN32)
+    auto buffer = std::unique_ptr<char[]>(new char[EXEC_READ_BUFFER_SIZE]);
+
+    for (std::size_t i = 0; i < commands.size(); ++i) {
       //
       // https://docs.microsoft.com/en-us/cpp/c-runtime-library/reference/popen-wpopen?view=msvc-160
       // _popen works fine in a console application... ok fine that's all we need it for... thanks.
       //
-      pipe = _popen((const char*) command.c_str(), "rt");
-    #else
-      pipe = popen((const char*) command.c_str(), "r");
-    #endif
-
-    if (pipe == NULL) {
-      std::cout << "error: unable to open the command" << std::endl;
-      exit(1);
+      auto pipe = _popen((const char*) (commands[i] + " 2>&1").c_str(), "rt");
+      std::unique_ptr<ProcessOutputReader> reader;
+      size_t count;
+
+      if (pipe == NULL) {
+        results[i].output = "error: unable to open the command";
+        results[i].exitCode = -1;
+        continue;
+      }
+
+      if (options.onOutput != nullptr) {
+        reader.reset(new ProcessOutputReader(
+          ProcessConfig::Framing::lines,
+          EXEC_READ_BUFFER_SIZE,
+          options.onOutput
+        ));
+      }
+
+      do {
+        auto data = reader ? reader->data() : buffer.get();
+        auto size = reader ? reader->available() : EXEC_READ_BUFFER_SIZE;
+
+        if ((count = fread(data, 1, size, pipe)) > 0) {
+          results[i].output.append(data, count);
+
+          if (reader) {
+            reader->commit(count);
+          }
+        }
+      } while (count > 0);
+
+      if (reader) {
+        reader->flush();
+      }
+
+      auto exitCode = _pclose(pipe);
+
+      if (!WIFEXITED(exitCode) || exitCode != 0) {
+        auto status = WEXITSTATUS(exitCode);
+        if (status && exitCode) {
+          exitCode = status;
+        }
+      }
+
+      results[i].exitCode = exitCode;
     }
+  #else
+    using Clock = std::chrono::steady_clock;
+
+    auto buffer = std::unique_ptr<char[]>(new char[EXEC_READ_BUFFER_SIZE]);
+    auto concurrency = options.concurrency > 0
+      ? options.concurrency
+      : std::max(1u, std::thread::hardware_concurrency());
 
-    do {
-      if ((count = fread(buffer.data(), 1, bufsize, pipe)) > 0) {
-        eo.output.insert(eo.output.end(), std::begin(buffer), std::next(std::begin(buffer), count));
+    Vector<ExecChild> running;
+    Vector<pollfd> pollfds;
+    std::size_t next = 0;
+
+    auto finish = [&](ExecChild& child) {
+      int status = 0;
+
+      if (child.reader) {
+        child.reader->flush();
       }
-    } while (count > 0);
 
-    #ifdef _WIN32
-      exitCode = _pclose(pipe);
-    #else
-      exitCode = pclose(pipe);
-    #endif
+      close(child.fd);
+
+      while (waitpid(child.pid, &status, 0) < 0 && errno == EINTR);
+
+      if (WIFEXITED(status)) {
+        results[child.index].exitCode = WEXITSTATUS(status);
+      } else if (WIFSIGNALED(status)) {
+        results[child.index].exitCode = 128 + WTERMSIG(status);
+      } else {
+        results[child.index].exitCode = status;
+      }
+    };
 
-    if (!WIFEXITED(exitCode) || exitCode != 0) {
-      auto status = WEXITSTATUS(exitCode);
-      if (status && exitCode) {
-        exitCode = status;
+    while (next < commands.size() || running.size() > 0) {
+      while (next < commands.size() && running.size() < concurrency) {
+        ExecChild child;
+        child.index = next++;
+
+        if (!spawnExecChild(commands[child.index], options, child)) {
+          results[child.index].output = "error: unable to open the command";
+          results[child.index].exitCode = -1;
+          continue;
+        }
+
+        if (options.onOutput != nullptr) {
+          child.reader.reset(new ProcessOutputReader(
+            ProcessConfig::Framing::lines,
+            EXEC_READ_BUFFER_SIZE,
+            options.onOutput
+          ));
+        }
+
+        if (options.timeout > 0) {
+          child.deadline = Clock::now() + std::chrono::milliseconds(options.timeout);
+        }
+
+        running.push_back(std::move(child));
+      }
+
+      if (running.size() == 0) {
+        break;
+      }
+
+      int timeout = -1;
+      auto now = Clock::now();
+
+      pollfds.clear();
+
+      for (const auto& child : running) {
+        pollfds.push_back(pollfd { child.fd, POLLIN, 0 });
+
+        if (options.timeout > 0) {
+          auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            child.deadline - now
+          ).count();
+
+          remaining = std::max(remaining, (decltype(remaining)) 0);
+
+          if (timeout < 0 || remaining < timeout) {
+            timeout = (int) remaining;
+          }
+        }
+      }
+
+      if (poll(pollfds.data(), static_cast<nfds_t>(pollfds.size()), timeout) < 0) {
+        continue;
+      }
+
+      now = Clock::now();
+
+      for (std::size_t i = running.size(); i-- > 0;) {
+        auto& child = running[i];
+        bool done = false;
+
+        if (pollfds[i].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL)) {
+          auto data = child.reader ? child.reader->data() : buffer.get();
+          auto size = child.reader ? child.reader->available() : EXEC_READ_BUFFER_SIZE;
+          auto n = ::read(child.fd, data, size);
+
+          if (n > 0) {
+            results[child.index].output.append(data, n);
+
+            if (child.reader) {
+              child.reader->commit(static_cast<std::size_t>(n));
+            }
+          } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+            done = true;
+          }
+        }
+
+        if (!done && options.timeout > 0 && now >= child.deadline) {
+          ::kill(-child.pid, SIGKILL);
+          results[child.index].timedOut = true;
+          done = true;
+        }
+
+        if (done) {
+          finish(child);
+          running.erase(running.begin() + i);
+        }
       }
     }
+  #endif
 
-    eo.exitCode = exitCode;
+    return results;
+  }
 
-    return eo;
+  inline ExecOutput exec (const SSC::String& command, const ExecOptions& options = {}) {
+    return exec(Vector<SSC::String> { command }, options)[0];
   }
 
   // Platform independent class for creating processes.
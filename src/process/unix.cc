@@ -1,5 +1,4 @@
 #include <algorithm>
-#include <bitset>
 #include <cstdlib>
 #include <cstring>
 #include <fcntl.h>
@@ -16,8 +15,6 @@
 
 namespace SSC {
 
-static StringStream initial;
-
 Process::Data::Data() noexcept : id(-1) {}
 Process::Process(
   const String &command,
@@ -32,7 +29,8 @@ Process::Process(
   open_stdin(true),
   read_stdout(std::move(read_stdout)),
   read_stderr(std::move(read_stderr)),
-  on_exit(std::move(on_exit))
+  on_exit(std::move(on_exit)),
+  config(config)
 {
   this->command = command;
   this->argv = argv;
@@ -61,11 +59,11 @@ Process::id_type Process::open(const std::function<int()> &function) noexcept {
     stdin_fd = std::unique_ptr<fd_type>(new fd_type);
   }
 
-  if (read_stdout) {
+  if (read_stdout || config.read_stdout_view) {
     stdout_fd = std::unique_ptr<fd_type>(new fd_type);
   }
 
-  if (read_stderr) {
+  if (read_stderr || config.read_stderr_view) {
     stderr_fd = std::unique_ptr<fd_type>(new fd_type);
   }
 
@@ -232,24 +230,37 @@ void Process::read() noexcept {
 
   stdout_stderr_thread = std::thread([this] {
     std::vector<pollfd> pollfds;
-    std::bitset<2> fd_is_stdout;
+    std::vector<std::unique_ptr<ProcessOutputReader>> readers;
 
     if (stdout_fd) {
-      fd_is_stdout.set(pollfds.size());
       pollfds.emplace_back();
       pollfds.back().fd = fcntl(*stdout_fd, F_SETFL, fcntl(*stdout_fd, F_GETFL) | O_NONBLOCK) == 0 ? *stdout_fd : -1;
       pollfds.back().events = POLLIN;
+      readers.emplace_back(new ProcessOutputReader(config.framing, config.buffer_size, [this](auto message) {
+        std::lock_guard<std::mutex> lock(stdout_mutex);
+        if (config.read_stdout_view) {
+          config.read_stdout_view(message);
+        } else {
+          read_stdout(SSC::String(message));
+        }
+      }));
     }
 
     if (stderr_fd) {
       pollfds.emplace_back();
       pollfds.back().fd = fcntl(*stderr_fd, F_SETFL, fcntl(*stderr_fd, F_GETFL) | O_NONBLOCK) == 0 ? *stderr_fd : -1;
       pollfds.back().events = POLLIN;
+      readers.emplace_back(new ProcessOutputReader(config.framing, config.buffer_size, [this](auto message) {
+        std::lock_guard<std::mutex> lock(stderr_mutex);
+        if (config.read_stderr_view) {
+          config.read_stderr_view(message);
+        } else {
+          read_stderr(SSC::String(message));
+        }
+      }));
     }
 
-    auto buffer = std::unique_ptr<char[]>(new char[config.buffer_size]);
     bool any_open = !pollfds.empty();
-    SSC::StringStream ss;
 
     while (any_open && (poll(pollfds.data(), static_cast<nfds_t>(pollfds.size()), -1) > 0 || errno == EINTR)) {
       any_open = false;
@@ -257,42 +268,21 @@ void Process::read() noexcept {
       for (size_t i = 0; i < pollfds.size(); ++i) {
         if (!(pollfds[i].fd >= 0)) continue;
 
+        auto& reader = readers[i];
+
+        // `POLLHUP` comes with `POLLIN` while there is output left to read
         if (pollfds[i].revents & POLLIN) {
-          memset(buffer.get(), 0, config.buffer_size);
-          const ssize_t n = ::read(pollfds[i].fd, buffer.get(), config.buffer_size);
+          const ssize_t n = ::read(pollfds[i].fd, reader->data(), reader->available());
 
           if (n > 0) {
-            if (fd_is_stdout[i]) {
-              std::lock_guard<std::mutex> lock(stdout_mutex);
-              auto b = SSC::String(buffer.get());
-              auto parts = splitc(b, '\n');
-
-              if (parts.size() > 1) {
-                for (int i = 0; i < parts.size() - 1; i++) {
-                  ss << parts[i];
-
-                  SSC::String s(ss.str());
-                  read_stdout(s);
-
-                  ss.str(SSC::String());
-                  ss.clear();
-                  ss.copyfmt(initial);
-                }
-                ss << parts[parts.size() - 1];
-              } else {
-                ss << b;
-              }
-            } else {
-              std::lock_guard<std::mutex> lock(stderr_mutex);
-              read_stderr(SSC::String(buffer.get()));
-            }
-          } else if (n < 0 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+            reader->commit(static_cast<size_t>(n));
+          } else if (n == 0 || (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            reader->flush();
             pollfds[i].fd = -1;
             continue;
           }
-        }
-
-        if (pollfds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        } else if (pollfds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+          reader->flush();
           pollfds[i].fd = -1;
           continue;
         }
@@ -29,8 +29,6 @@ SSC::String FormatError(DWORD error, SSC::String source) {
 }
 #endif
 
-const static SSC::StringStream initial;
-
 Process::Data::Data() noexcept : id(0) {}
 
 Process::Process(
@@ -46,7 +44,8 @@ Process::Process(
   open_stdin(true),
   read_stdout(std::move(read_stdout)),
   read_stderr(std::move(read_stderr)),
-  on_exit(std::move(on_exit))
+  on_exit(std::move(on_exit)),
+  config(config)
 {
   this->command = command;
   this->argv = argv;
@@ -90,11 +89,11 @@ Process::id_type Process::open(const SSC::String &command, const SSC::String &pa
     stdin_fd = std::unique_ptr<fd_type>(new fd_type(nullptr));
   }
 
-  if (read_stdout) {
+  if (read_stdout || config.read_stdout_view) {
     stdout_fd = std::unique_ptr<fd_type>(new fd_type(nullptr));
   }
 
-  if (read_stderr) {
+  if (read_stderr || config.read_stderr_view) {
     stderr_fd = std::unique_ptr<fd_type>(new fd_type(nullptr));
   }
 
@@ -247,51 +246,52 @@ void Process::read() noexcept {
   if (stdout_fd) {
     stdout_thread = std::thread([this]() {
       DWORD n;
-
-      std::unique_ptr<char[]> buffer(new char[config.buffer_size]);
-      SSC::StringStream ss;
+      ProcessOutputReader reader(config.framing, config.buffer_size, [this](auto message) {
+        std::lock_guard<std::mutex> lock(stdout_mutex);
+        if (config.read_stdout_view) {
+          config.read_stdout_view(message);
+        } else {
+          read_stdout(SSC::String(message));
+        }
+      });
 
       for (;;) {
-        memset(buffer.get(), 0, config.buffer_size);
-        BOOL bSuccess = ReadFile(*stdout_fd, static_cast<CHAR *>(buffer.get()), static_cast<DWORD>(config.buffer_size), &n, nullptr);
+        BOOL bSuccess = ReadFile(*stdout_fd, static_cast<CHAR *>(reader.data()), static_cast<DWORD>(reader.available()), &n, nullptr);
 
         if (!bSuccess || n == 0) {
           break;
         }
 
-        auto b = SSC::String(buffer.get());
-        auto parts = splitc(b, '\n');
-
-        if (parts.size() > 1) {
-          std::lock_guard<std::mutex> lock(stdout_mutex);
-
-          for (int i = 0; i < parts.size() - 1; i++) {
-            ss << parts[i];
-            SSC::String s(ss.str());
-            read_stdout(s);
-            ss.str(SSC::String());
-            ss.clear();
-            ss.copyfmt(initial);
-          }
-          ss << parts[parts.size() - 1];
-        } else {
-          ss << b;
-        }
+        reader.commit(n);
       }
+
+      reader.flush();
     });
   }
 
   if (stderr_fd) {
     stderr_thread = std::thread([this]() {
       DWORD n;
-      std::unique_ptr<char[]> buffer(new char[config.buffer_size]);
+      ProcessOutputReader reader(config.framing, config.buffer_size, [this](auto message) {
+        std::lock_guard<std::mutex> lock(stderr_mutex);
+        if (config.read_stderr_view) {
+          config.read_stderr_view(message);
+        } else {
+          read_stderr(SSC::String(message));
+        }
+      });
 
       for (;;) {
-        BOOL bSuccess = ReadFile(*stderr_fd, static_cast<CHAR *>(buffer.get()), static_cast<DWORD>(config.buffer_size), &n, nullptr);
-        if (!bSuccess || n == 0) break;
-        std::lock_guard<std::mutex> lock(stderr_mutex);
-        read_stderr(SSC::String(buffer.get()));
+        BOOL bSuccess = ReadFile(*stderr_fd, static_cast<CHAR *>(reader.data()), static_cast<DWORD>(reader.available()), &n, nullptr);
+
+        if (!bSuccess || n == 0) {
+          break;
+        }
+
+        reader.commit(n);
       }
+
+      reader.flush();
     });
   }
 }
@@ -172,14 +172,14 @@ namespace SSC {
           g_bytes_unref(bytes);
         }
 
-        if (!window->bridge->route(str, buf, bufsize)) {
+        // the router owns `buf` from here and frees it, no copy is made
+        if (!window->bridge->route(str, IPC::MessageBuffer(buf, bufsize))) {
           if (window->onMessage != nullptr) {
             window->onMessage(str);
           }
         }
 
         g_free(valueString);
-        delete [] buf;
       }),
       this
     );
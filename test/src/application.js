@@ -1,5 +1,5 @@
 import { test } from 'socket:test'
-import { primordials } from 'socket:ipc'
+import ipc, { primordials } from 'socket:ipc'
 import application from 'socket:application'
 import { ApplicationWindow } from 'socket:window'
 import { readFile } from 'socket:fs/promises'
@@ -669,6 +669,14 @@ if (!['android', 'ios', 'win32'].includes(process.platform)) {
     t.ok(doesRestart, 'emits a backend:ready event')
   })
 
+  test('diagnostics.backend', async (t) => {
+    const { data } = await ipc.send('diagnostics.backend')
+    t.equal(data.running, true, 'backend is running')
+    t.equal(typeof data.prewarm, 'boolean', 'reports whether a spare is kept')
+    t.ok(data.coldStarts + data.swaps >= 2, 'counts every backend start')
+    if (!data.prewarm) t.equal(data.spare, null, 'has no spare without prewarm')
+  })
+
   test('window.send to backend and back to current window', async (t) => {
     const currentWindow = await application.getCurrentWindow()
     const value = { firstname: 'Rick', secondname: 'Sanchez' }
@@ -0,0 +1,42 @@
+import { test } from 'socket:test'
+import Buffer from 'socket:buffer'
+import ipc from 'socket:ipc'
+
+test('channel.benchmark compares frames and rings to stdout lines', async (t) => {
+  const messages = 2000
+  const size = 512
+  const { err, data } = await ipc.send('channel.benchmark', { messages, size })
+
+  // only built into runtimes built with `SSC_BENCHMARKS=1`
+  if (/not found/i.test(err?.message)) {
+    return t.comment('channel.benchmark is not built into this runtime, skipping')
+  }
+
+  t.ifError(err, 'channel.benchmark')
+
+  for (const name of ['stdio', 'channel', 'shm']) {
+    const run = data?.runs?.[name]
+    t.equal(run?.messages, messages, `${name} delivers every message`)
+    t.equal(run?.bytes, messages * size, `${name} delivers every byte`)
+    t.comment(`${name}: ${Math.round(run?.messagesPerSecond)} messages/s, ${Math.round(run?.bytesPerSecond)} bytes/s`)
+  }
+
+  t.ok(
+    data?.runs?.channel.wireBytes < data?.runs?.stdio.wireBytes,
+    'frames carry binary payloads without URI encoding'
+  )
+
+  const invalid = await ipc.send('channel.benchmark', { messages: 0 })
+  t.equal(invalid.err?.code, 'EINVAL', 'channel.benchmark rejects invalid parameters')
+})
+
+test('channel.write fails without a backend channel', async (t) => {
+  const { data: state } = await ipc.send('channel.getState')
+
+  if (state?.open) {
+    return t.comment('the backend channel is open, skipping')
+  }
+
+  const result = await ipc.write('channel.write', { event: 'test' }, Buffer.from('hello'))
+  t.equal(result.err?.code, 'ENOTCONN', 'channel.write reports the channel is not connected')
+})
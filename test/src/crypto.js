@@ -1,6 +1,8 @@
 import { test } from 'socket:test'
 import crypto from 'socket:crypto'
 import Buffer from 'socket:buffer'
+import ipc from 'socket:ipc'
+import { Encryption } from 'socket:stream-relay/encryption'
 
 test('crypto', async (t) => {
   t.equal(crypto.webcrypto, window.crypto, 'crypto.webcrypto is window.crypto')
@@ -28,3 +30,154 @@ test('crypto.rand64', (t) => {
   t.ok(randoms.every(b => typeof b === 'bigint'), 'crypto.rand64 returns a bigint')
   t.ok(randoms.some(b => b !== randoms[9]), 'crypto.rand64 returns a different bigint each time')
 })
+
+test('crypto.* native sign, verify, seal and open', async (t) => {
+  await crypto.ready
+
+  const { sodium } = crypto
+  const alice = new Encryption()
+  const publicKey = Buffer.from(alice.publicKey).toString('base64')
+  const secretKey = Buffer.from(alice.privateKey).toString('base64')
+  const message = crypto.randomBytes(1024)
+
+  const signed = await ipc.write('crypto.sign', { secretKey }, message)
+  const signature = Buffer.from(signed.data?.signature ?? '', 'base64')
+  t.ok(
+    signature.equals(Buffer.from(sodium.crypto_sign_detached(message, alice.privateKey))),
+    'crypto.sign matches crypto_sign_detached'
+  )
+
+  const verified = await ipc.write('crypto.verify', {
+    publicKey,
+    signature: signature.toString('base64')
+  }, message)
+  t.equal(verified.data?.verified, true, 'crypto.verify accepts a valid signature')
+
+  const messages = Array.from({ length: 100 }, () => crypto.randomBytes(256))
+  const signatures = messages.map((m) => Buffer.from(sodium.crypto_sign_detached(m, alice.privateKey)))
+  // tamper with one signature, it alone should fail
+  signatures[42][0] ^= 1
+
+  const started = Date.now()
+  const many = await ipc.write('crypto.verifyMany', {
+    publicKeys: messages.map(() => publicKey).join(','),
+    signatures: signatures.map((s) => s.toString('base64')).join(','),
+    sizes: messages.map((m) => m.length).join(',')
+  }, Buffer.concat(messages))
+  t.comment(`crypto.verifyMany: ${messages.length} signatures in ${Date.now() - started}ms`)
+
+  const results = many.data?.results ?? []
+  t.equal(results.length, messages.length, 'crypto.verifyMany returns a result per signature')
+  t.ok(results.every((ok, i) => ok === (i !== 42)), 'crypto.verifyMany only rejects the tampered signature')
+
+  const sealed = await ipc.write('crypto.seal', { publicKey, secretKey }, message, {
+    responseType: 'arraybuffer'
+  })
+  t.ok(
+    alice.open(Buffer.from(sealed.data), publicKey).equals(message),
+    'crypto.seal output opens with Encryption#open()'
+  )
+
+  const opened = await ipc.write('crypto.open', { publicKey, secretKey }, alice.seal(message, publicKey), {
+    responseType: 'arraybuffer'
+  })
+  t.ok(Buffer.from(opened.data).equals(message), 'crypto.open opens Encryption#seal() output')
+
+  const hashed = await ipc.write('crypto.sha256', {}, message)
+  const digest = await crypto.createDigest('SHA-256', message)
+  t.equal(hashed.data?.hash, digest.toString('hex'), 'crypto.sha256 matches crypto.createDigest')
+})
+
+// FIPS 180-2 and RFC 8032 section 7.1 test vectors
+const SHA256_VECTORS = [
+  ['', 'e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855'],
+  ['abc', 'ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad'],
+  [
+    'abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq',
+    '248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1'
+  ],
+  [
+    'abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu',
+    'cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1'
+  ],
+  ['a'.repeat(1000000), 'cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0']
+]
+
+const ED25519_VECTORS = [
+  {
+    secretKey: '9d61b19deffd5a60ba844af492ec2cc44449c5697b326919703bac031cae7f60',
+    publicKey: 'd75a980182b10ab7d54bfed3c964073a0ee172f3daa62325af021a68f707511a',
+    message: '',
+    signature: 'e5564300c360ac729086e2cc806e828a84877f1eb8e5d974d873e065224901555fb8821590a33bacc61e39701cf9b46bd25bf5f0595bbe24655141438e7a100b'
+  },
+  {
+    secretKey: '4ccd089b28ff96da9db6c346ec114e0f5b8a319f35aba624da8cf6ed4fb8a6fb',
+    publicKey: '3d4017c3e843895a92b70aa74d1b7ebc9c982ccf2ec4968cc0cd55f12af4660c',
+    message: '72',
+    signature: '92a009a9f0d4cab8720e820b5f642540a2b27b5416503f8fb3762223ebdb69da085ac1e43e15996e458f3613d0f11d8c387b2eaeb4302aeeb00d291612bb0c00'
+  },
+  {
+    secretKey: 'c5aa8df43f9f837bedb7442f31dcb7b166d38535076f094b85ce3a2e0b4458f7',
+    publicKey: 'fc51cd8e6218a1a38da47ed00230f0580816ed13ba3303ac5deb911548908025',
+    message: 'af82',
+    signature: '6291d657deec24024827e69c3abe01a30ce548a284743a445e3680d7db5ac3ac18ff9b538d16f290ae67f760984dc6594a7c15e9716ed28dc027beceea1ec40a'
+  },
+  {
+    secretKey: '833fe62409237b9d62ec77587520911e9a759cec1d19755b7da901b96dca3d42',
+    publicKey: 'ec172b93ad5e563bf4932c70e1245034c35467ef2efd4d64ebf819683467e2bf',
+    message: 'ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f',
+    signature: 'dc2a4459e7369633a52b1bf277839a00201009a3efbf3ecb69bea2186c26b58909351fc9ac90b3ecfdfbc7c66431e0303dca179c138ac17ad9bef1177331a704'
+  }
+]
+
+// sealed by libsodium with `seal()` of `api/stream-relay/encryption.js` for
+// the first RFC 8032 key pair, opening it runs X25519, BLAKE2b and
+// XSalsa20-Poly1305 against their reference implementation
+const SEALED_VECTOR = {
+  message: 'socket runtime known answer',
+  sealed: 'OGhKQi9ox+AcJuNmGjRFtew1Ej2wDr02FJ43tGi7yjGEldAsmTyTgfXS4pWfgyRaWbiaGJwWsA1p3Jt/tA63cgKU/Azeggf/Fwck3/TJ0qKpvPdFxWvvAlcIjq+jS9Lcp3VPGmgMINXOlyWfnRObZanvYPI0SlQOkK7VGeRAqW551jZ6Tbsm704ISH17hPKfJ1bv+zYJb7P7fDq/9og3xFhVRACVN5k9OHFTgZgKzzxGpV2QTNd2athElQ=='
+}
+
+test('crypto.* native primitives match known answers', async (t) => {
+  for (const [input, hash] of SHA256_VECTORS) {
+    const hashed = await ipc.write('crypto.sha256', {}, Buffer.from(input))
+    t.equal(hashed.data?.hash, hash, `crypto.sha256 of ${input.length} bytes`)
+  }
+
+  for (const [i, vector] of ED25519_VECTORS.entries()) {
+    const message = Buffer.from(vector.message, 'hex')
+    const publicKey = Buffer.from(vector.publicKey, 'hex').toString('base64')
+    const secretKey = Buffer.from(vector.secretKey + vector.publicKey, 'hex').toString('base64')
+
+    const signed = await ipc.write('crypto.sign', { secretKey }, message)
+    const signature = Buffer.from(signed.data?.signature ?? '', 'base64')
+    t.equal(signature.toString('hex'), vector.signature, `crypto.sign RFC 8032 test ${i + 1}`)
+
+    const verified = await ipc.write('crypto.verify', {
+      publicKey,
+      signature: signature.toString('base64')
+    }, message)
+    t.equal(verified.data?.verified, true, `crypto.verify RFC 8032 test ${i + 1}`)
+
+    signature[63] ^= 0x10
+    const rejected = await ipc.write('crypto.verify', {
+      publicKey,
+      signature: signature.toString('base64')
+    }, message)
+    t.equal(rejected.data?.verified, false, `crypto.verify rejects a modified RFC 8032 test ${i + 1} signature`)
+  }
+
+  const [{ publicKey, secretKey }] = ED25519_VECTORS
+  const opened = await ipc.write('crypto.open', {
+    publicKey: Buffer.from(publicKey, 'hex').toString('base64'),
+    secretKey: Buffer.from(secretKey + publicKey, 'hex').toString('base64')
+  }, Buffer.from(SEALED_VECTOR.sealed, 'base64'), {
+    responseType: 'arraybuffer'
+  })
+
+  t.equal(
+    Buffer.from(opened.data ?? []).toString(),
+    SEALED_VECTOR.message,
+    'crypto.open opens a message sealed by libsodium'
+  )
+})
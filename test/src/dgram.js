@@ -5,7 +5,13 @@ import console from 'socket:console'
 import crypto from 'socket:crypto'
 import Buffer from 'socket:buffer'
 import dgram from 'socket:dgram'
+import diagnostics from 'socket:diagnostics'
+import fs from 'socket:fs/promises'
+import ipc from 'socket:ipc'
+import os from 'socket:os'
+import path from 'socket:path'
 import util from 'socket:util'
+import { Packet, FRAME_BYTES, decode as decodePacket } from 'socket:stream-relay/packets'
 
 // node compat
 /*
@@ -321,6 +327,974 @@ test('client ~> server (~512 messages)', async (t) => {
   ])
 })
 
+test('client ~> server segmented sends (segmentSize)', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const TIMEOUT = 1024
+  const SEGMENT_SIZE = 1024
+  const address = '127.0.0.1'
+  const buffer = crypto.randomBytes(SEGMENT_SIZE * 64)
+  const server = dgram.createSocket({ type: 'udp4', segmentSize: SEGMENT_SIZE })
+  const client = dgram.createSocket({ type: 'udp4', segmentSize: SEGMENT_SIZE })
+  const port = 30002
+  const messages = []
+
+  await new Promise((resolve) => {
+    let timeout = setTimeout(ontimeout, TIMEOUT)
+    let then = 0
+
+    function ontimeout () {
+      t.fail(`Not all segments received (${messages.length} received)`)
+      resolve()
+    }
+
+    server.bind(port, address, () => {
+      server.on('message', (message) => {
+        clearTimeout(timeout)
+        timeout = setTimeout(ontimeout, TIMEOUT)
+        messages.push(message)
+
+        if (messages.length * SEGMENT_SIZE === buffer.length) {
+          const elapsed = Math.max(1, Date.now() - then)
+          clearTimeout(timeout)
+          t.ok(true, `all ${messages.length} segments received`)
+          t.comment(`${Math.round(buffer.length / elapsed)} KB/s over loopback`)
+          resolve()
+        }
+      })
+
+      client.connect(port, address, (err) => {
+        if (err) return t.ifError(err)
+        then = Date.now()
+        client.send(buffer)
+      })
+    })
+  })
+
+  t.ok(
+    messages.every((message) => message.length === SEGMENT_SIZE),
+    'every segment is segmentSize bytes'
+  )
+
+  t.ok(
+    Buffer.compare(Buffer.concat(messages), buffer) === 0,
+    'segments reassemble in order to the sent buffer'
+  )
+
+  const { data: state } = await ipc.send('udp.getState', { id: client.id })
+  t.equal(state?.segmentSize, SEGMENT_SIZE, 'udp.getState reports the segment size')
+
+  // UDP_SEGMENT is Linux only (>= 4.18), other platforms send per segment
+  if (process.platform === 'linux') {
+    t.equal(state?.segmentationOffload, true, 'sends are segmented by the kernel')
+  } else {
+    t.equal(state?.segmentationOffload, false, 'sends are segmented in userspace')
+  }
+
+  await Promise.all([
+    util.promisify(server.close.bind(server))(),
+    util.promisify(client.close.bind(client))()
+  ])
+})
+
+test('udp send queue limits', async (t) => {
+  const socket = dgram.createSocket('udp4')
+
+  await new Promise((resolve) => socket.bind(0, '127.0.0.1', resolve))
+
+  t.equal(socket.getSendQueueSize(), 0, 'send queue size is 0 when idle')
+  t.equal(socket.getSendQueueCount(), 0, 'send queue count is 0 when idle')
+
+  const limits = await socket.setSendQueueLimits({
+    maxBytes: 64 * 1024,
+    maxCount: 32,
+    policy: 'drop-oldest'
+  })
+
+  t.equal(limits.policy, 'drop-oldest', 'send queue policy is set')
+  t.equal(limits.maxCount, 32, 'send queue maxCount is set')
+
+  try {
+    await socket.setSendQueueLimits({ policy: 'unknown' })
+    t.fail('invalid policy should throw')
+  } catch (err) {
+    t.ok(/policy/.test(err.message), 'invalid policy throws')
+  }
+
+  await util.promisify(socket.close.bind(socket))()
+})
+
+test('udp send queue policies hold back, drop or reject sends', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const server = dgram.createSocket('udp4')
+  const client = dgram.createSocket('udp4')
+  let received = 0
+
+  server.on('message', () => received++)
+  await new Promise((resolve) => server.bind(30022, address, resolve))
+  await new Promise((resolve) => client.bind(0, address, resolve))
+
+  // `udp.sendMany` sends back to back in one loop turn, libuv counts the
+  // first send as queued until its callback ran
+  const sendMany = async (count) => {
+    const { err, data } = await ipc.write('udp.sendMany', {
+      id: client.id,
+      destinations: Array(count).fill(`${address}:30022`).join(',')
+    }, Buffer.from('queued'))
+
+    t.ifError(err, `udp.sendMany ${count} sends`)
+    return data?.results ?? []
+  }
+
+  await client.setSendQueueLimits({ maxCount: 1, policy: 'reject' })
+  const rejected = await sendMany(2)
+  t.ok(rejected[0]?.status >= 0, 'reject: the first send goes out')
+  t.equal(rejected[1]?.code, 'EAGAIN', 'reject: the second send fails with EAGAIN')
+
+  // the first send is already handed to libuv, the oldest held back send
+  // is dropped for the next one
+  await client.setSendQueueLimits({ maxCount: 1, policy: 'drop-oldest' })
+  const dropped = await sendMany(3)
+  t.ok(dropped[0]?.status >= 0, 'drop-oldest: the first send goes out')
+  t.equal(dropped[1]?.code, 'ECANCELED', 'drop-oldest: the held back send is canceled')
+  t.ok(dropped[2]?.status >= 0, 'drop-oldest: the newest send goes out')
+
+  await client.setSendQueueLimits({ maxCount: 1, policy: 'block' })
+  const blocked = await sendMany(3)
+  t.ok(blocked.every((result) => result.status >= 0), 'block: every send goes out once the one before it completed')
+
+  const { data: state } = await ipc.send('udp.getState', { id: client.id })
+  t.equal(state?.sendQueue?.heldBack, 0, 'udp.getState reports no held back sends')
+
+  await new Promise((resolve) => setTimeout(resolve, 100))
+  t.equal(received, 2 + 2 + 3, 'the server receives every send that was not rejected or dropped')
+
+  await Promise.all([client, server].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('udp sendMany to many destinations', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const payload = makePayloadString()
+  const ports = [30003, 30004, 30005]
+  const servers = ports.map(() => dgram.createSocket('udp4'))
+  const client = dgram.createSocket('udp4')
+
+  const received = Promise.all(servers.map((server, i) => {
+    return new Promise((resolve) => {
+      server.bind(ports[i], address)
+      server.once('message', (message) => resolve(Buffer.from(message).toString()))
+    })
+  }))
+
+  await Promise.all(servers.map((server) => new Promise((resolve) => {
+    server.once('listening', resolve)
+  })))
+
+  const results = await new Promise((resolve, reject) => {
+    const destinations = ports.map((port) => ({ port, address }))
+    client.sendMany(Buffer.from(payload), destinations, (err, results) => {
+      if (err) return reject(err)
+      resolve(results)
+    })
+  })
+
+  t.equal(results.length, ports.length, 'one result per destination')
+  t.ok(results.every((result) => result.status >= 0), 'every send succeeded')
+
+  const messages = await received
+  t.ok(messages.every((message) => message === payload), 'every destination received the payload')
+
+  await Promise.all([client, ...servers].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('udp.sendMany with ephemeral does not close a bound socket', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const server = dgram.createSocket('udp4')
+  const client = dgram.createSocket('udp4')
+  const messages = []
+
+  server.on('message', (message) => messages.push(Buffer.from(message).toString()))
+  await new Promise((resolve) => server.bind(30021, address, resolve))
+  await new Promise((resolve) => client.bind(0, address, resolve))
+
+  const result = await ipc.write('udp.sendMany', {
+    id: client.id,
+    destinations: `${address}:30021`,
+    ephemeral: true
+  }, Buffer.from('first'))
+
+  t.ifError(result.err, 'udp.sendMany')
+
+  await new Promise((resolve, reject) => {
+    client.send(Buffer.from('second'), 30021, address, (err) => err ? reject(err) : resolve())
+  })
+
+  await new Promise((resolve) => setTimeout(resolve, 50))
+  t.deepEqual(messages, ['first', 'second'], 'the bound socket still sends')
+
+  await Promise.all([client, server].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+function makeRandomPacket () {
+  const id = () => crypto.randomBytes(32).toString('hex')
+  const int = (max) => Math.floor(Math.random() * max)
+  return {
+    type: int(9),
+    version: 2,
+    hops: int(2 ** 31),
+    clock: int(2 ** 31),
+    index: int(1024) - 1,
+    packetId: id(),
+    clusterId: id(),
+    previousId: Math.random() > 0.5 ? id() : '',
+    nextId: Math.random() > 0.5 ? id() : '',
+    to: Buffer.from(crypto.randomBytes(32)).toString('base64'),
+    usr1: crypto.randomBytes(int(16)).toString('hex'),
+    message: crypto.randomBytes(int(512)).toString('hex')
+  }
+}
+
+function isSamePacketHeaders (actual, expected) {
+  const keys = [
+    'type', 'version', 'hops', 'clock', 'index', 'packetId', 'clusterId',
+    'previousId', 'nextId', 'to', 'usr1'
+  ]
+
+  return keys.every((key) => actual?.[key] === expected?.[key])
+}
+
+test('udp decodePackets matches the JS packet codec', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  await crypto.ready
+
+  const count = 64
+  const address = '127.0.0.1'
+  const server = dgram.createSocket({ type: 'udp4', decodePackets: true })
+  const client = dgram.createSocket('udp4')
+  const encoded = []
+
+  for (let i = 0; i < count; ++i) {
+    encoded.push(await Packet.encode(makeRandomPacket()))
+  }
+
+  const received = new Promise((resolve) => {
+    const messages = []
+    server.on('message', (message, rinfo) => {
+      messages.push({ message: Buffer.from(message), packet: rinfo.packet })
+      if (messages.length === count) resolve(messages)
+    })
+  })
+
+  await new Promise((resolve) => server.bind(30006, address, resolve))
+
+  const then = Date.now()
+  for (const buffer of encoded) {
+    client.send(buffer, 30006, address)
+  }
+
+  const messages = await received
+  const elapsed = Math.max(1, Date.now() - then)
+  t.comment(`native decode: ${Math.round(count / (elapsed / 1000))} packets/sec (loopback)`)
+
+  let mismatches = 0
+  for (const { message, packet } of messages) {
+    const buffer = encoded.find((b) => decodePacket(b).packetId === packet?.packetId)
+    const expected = buffer && decodePacket(buffer)
+    const length = buffer?.readUInt16BE(FRAME_BYTES - 2)
+    const body = buffer?.slice(FRAME_BYTES, FRAME_BYTES + length)
+
+    if (!expected || !isSamePacketHeaders(packet, expected) || !body.equals(message)) {
+      mismatches++
+    }
+  }
+
+  t.equal(mismatches, 0, `${count} random packets decode like the JS codec`)
+
+  const jsThen = Date.now()
+  for (const buffer of encoded) decodePacket(buffer)
+  const jsElapsed = Math.max(1, Date.now() - jsThen)
+  t.comment(`js decode: ${Math.round(count / (jsElapsed / 1000))} packets/sec`)
+
+  await Promise.all([client, server].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('udp sendPacket encodes like the JS packet codec', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  await crypto.ready
+
+  const address = '127.0.0.1'
+  const server = dgram.createSocket('udp4')
+  const client = dgram.createSocket('udp4')
+  const packet = makeRandomPacket()
+
+  const received = new Promise((resolve) => {
+    server.once('message', (message) => resolve(Buffer.from(message)))
+  })
+
+  await new Promise((resolve) => server.bind(30007, address, resolve))
+
+  await new Promise((resolve, reject) => {
+    client.sendPacket(packet, 30007, address, (err) => err ? reject(err) : resolve())
+  })
+
+  const buffer = await received
+  const expected = await Packet.encode(packet)
+
+  t.ok(buffer.equals(expected), 'natively encoded packet equals the JS encoded packet')
+  t.ok(
+    isSamePacketHeaders(decodePacket(buffer), decodePacket(expected)),
+    'natively encoded packet decodes like the JS encoded packet'
+  )
+
+  await Promise.all([client, server].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('stream.* reliable transfer over lossy loopback', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const streamId = crypto.rand64()
+  const writer = { id: crypto.rand64(), peerId: crypto.rand64(), port: 30008 }
+  const reader = { id: crypto.rand64(), peerId: crypto.rand64(), port: 30009 }
+  const data = crypto.randomBytes(4 * 1024 * 1024)
+
+  // bound without `udp.readStart`, the streams receive on these peers
+  for (const { peerId, port } of [writer, reader]) {
+    const bound = await ipc.send('udp.bind', { id: peerId, port, address })
+    t.ifError(bound.err, `udp.bind ${port}`)
+  }
+
+  const open = ({ id, peerId }, port, options) => ipc.send('stream.open', {
+    id,
+    peerId,
+    streamId,
+    address,
+    port,
+    ...options
+  })
+
+  const opened = await Promise.all([
+    open(writer, reader.port, { dropRate: 0.1, reorderRate: 0.1 }),
+    open(reader, writer.port)
+  ])
+
+  // simulated loss is only built into runtimes built with
+  // `SSC_FAULT_INJECTION=1`, other runtimes reject the options
+  const lossy = opened[0].err?.code !== 'ENOTSUP'
+
+  if (!lossy) {
+    t.comment('stream fault injection is not built into this runtime, transferring without loss')
+    opened[0] = await open(writer, reader.port)
+  }
+
+  t.ok(opened.every((result) => !result.err), 'stream.open on both ends')
+
+  const started = Date.now()
+  const written = ipc.write('stream.write', { id: writer.id }, data)
+  const chunks = []
+
+  while (true) {
+    const result = await ipc.request('stream.read', {
+      id: reader.id,
+      size: 1024 * 1024
+    }, { responseType: 'arraybuffer' })
+
+    // the end of the stream is a JSON reply without a body
+    if (result.err || result.data?.EOF) break
+    chunks.push(Buffer.from(result.data))
+  }
+
+  t.ifError((await written).err, 'stream.write resolves once everything was acknowledged')
+  t.ok(Buffer.concat(chunks).equals(data), 'reader receives every byte in order')
+
+  const state = await ipc.send('stream.getState', { id: writer.id })
+  if (lossy) {
+    t.ok(state.data?.retransmits > 0, 'lost segments were retransmitted')
+  }
+
+  t.comment(`stream: ${data.length} bytes in ${Date.now() - started}ms with ${state.data?.dropped} drops`)
+
+  const closed = await Promise.all([
+    ipc.send('stream.close', { id: writer.id }),
+    ipc.send('stream.close', { id: reader.id })
+  ])
+
+  t.ok(closed.every((result) => !result.err), 'stream.close on both ends')
+
+  for (const { peerId } of [writer, reader]) {
+    await ipc.send('udp.close', { id: peerId })
+  }
+})
+
+test('udp.setCongestionControl paces a stream over a delayed loopback', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const streamId = crypto.rand64()
+  const writer = { id: crypto.rand64(), peerId: crypto.rand64(), port: 30010 }
+  const reader = { id: crypto.rand64(), peerId: crypto.rand64(), port: 30011 }
+  const data = crypto.randomBytes(512 * 1024)
+  const maxPacingRate = 1024 * 1024
+
+  for (const { peerId, port } of [writer, reader]) {
+    const bound = await ipc.send('udp.bind', { id: peerId, port, address })
+    t.ifError(bound.err, `udp.bind ${port}`)
+  }
+
+  const enabled = await ipc.send('udp.setCongestionControl', {
+    id: writer.peerId,
+    maxPacingRate
+  })
+
+  t.ifError(enabled.err, 'udp.setCongestionControl')
+
+  const open = ({ id, peerId }, port, options) => ipc.send('stream.open', {
+    id,
+    peerId,
+    streamId,
+    address,
+    port,
+    ...options
+  })
+
+  // both ends hold back incoming frames, a 20ms round trip
+  let opened = await Promise.all([
+    open(writer, reader.port, { dropRate: 0.01, delay: 10 }),
+    open(reader, writer.port, { delay: 10 })
+  ])
+
+  // without `SSC_FAULT_INJECTION=1` the sends are still paced, over an
+  // undelayed loopback
+  const delayed = opened.every((result) => result.err?.code !== 'ENOTSUP')
+
+  if (!delayed) {
+    t.comment('stream fault injection is not built into this runtime, transferring without delay')
+    opened = await Promise.all([
+      open(writer, reader.port),
+      open(reader, writer.port)
+    ])
+  }
+
+  t.ok(opened.every((result) => !result.err), 'stream.open on both ends')
+
+  const started = Date.now()
+  const written = ipc.write('stream.write', { id: writer.id }, data)
+  const chunks = []
+
+  while (true) {
+    const result = await ipc.request('stream.read', {
+      id: reader.id,
+      size: 1024 * 1024
+    }, { responseType: 'arraybuffer' })
+
+    if (result.err || result.data?.EOF) break
+    chunks.push(Buffer.from(result.data))
+  }
+
+  const elapsed = Date.now() - started
+
+  t.ifError((await written).err, 'stream.write resolves')
+  t.ok(Buffer.concat(chunks).equals(data), 'reader receives every byte in order')
+  t.ok(elapsed >= 1000 * data.length / maxPacingRate * 0.8, 'sends are paced')
+
+  const { data: state } = await ipc.send('udp.getState', { id: writer.peerId })
+  const { congestion } = state ?? {}
+
+  t.equal(congestion?.enabled, true, 'congestion control is enabled')
+  t.ok(congestion?.cwnd > 0, 'udp.getState reports the congestion window')
+  t.ok(congestion?.pacingRate > 0 && congestion?.pacingRate <= maxPacingRate, 'pacing rate is capped')
+  if (delayed) {
+    t.ok(congestion?.minRTT >= 10, 'RTT estimates include the simulated delay')
+  }
+
+  t.equal(congestion?.bytesInFlight, 0, 'nothing is in flight once written')
+  t.comment(`congestion: ${JSON.stringify(congestion)} in ${elapsed}ms`)
+
+  await Promise.all([
+    ipc.send('stream.close', { id: writer.id }),
+    ipc.send('stream.close', { id: reader.id })
+  ])
+
+  for (const { peerId } of [writer, reader]) {
+    await ipc.send('udp.close', { id: peerId })
+  }
+})
+
+test('fec.encode and fec.reconstruct recover lost packets', async (t) => {
+  const packets = [0, 1, 2, 3, 4, 5, 6, 7].map((i) => crypto.randomBytes(100 + i * 50))
+  const sizes = packets.map((packet) => packet.byteLength)
+  const parityCount = 3
+
+  const encoded = await ipc.write('fec.encode', {
+    sizes: sizes.join(','),
+    parityCount
+  }, Buffer.concat(packets), { responseType: 'arraybuffer' })
+
+  t.ifError(encoded.err, 'fec.encode')
+
+  const parity = Buffer.from(encoded.data)
+  const shardSize = parity.byteLength / parityCount
+
+  t.ok(Number.isInteger(shardSize) && shardSize > Math.max(...sizes), 'parity packets hold the largest packet')
+
+  // lose as many data packets as there are parity packets
+  const lost = [1, 4, 6]
+  const indices = []
+  const given = []
+  const givenSizes = []
+
+  for (let i = 0; i < packets.length; ++i) {
+    if (lost.includes(i)) continue
+    indices.push(i)
+    given.push(packets[i])
+    givenSizes.push(sizes[i])
+  }
+
+  for (let i = 0; i < parityCount; ++i) {
+    indices.push(packets.length + i)
+    given.push(parity.subarray(i * shardSize, (i + 1) * shardSize))
+    givenSizes.push(shardSize)
+  }
+
+  const recovered = await ipc.write('fec.reconstruct', {
+    dataCount: packets.length,
+    parityCount,
+    indices: indices.join(','),
+    sizes: givenSizes.join(',')
+  }, Buffer.concat(given), { responseType: 'arraybuffer' })
+
+  t.ifError(recovered.err, 'fec.reconstruct')
+  t.ok(
+    Buffer.from(recovered.data).equals(Buffer.concat(lost.map((i) => packets[i]))),
+    'fec.reconstruct recovers the lost packets'
+  )
+
+  const insufficient = await ipc.write('fec.reconstruct', {
+    dataCount: packets.length,
+    parityCount,
+    indices: indices.slice(1).join(','),
+    sizes: givenSizes.slice(1).join(',')
+  }, Buffer.concat(given.slice(1)))
+
+  t.ok(insufficient.err, 'fec.reconstruct fails with fewer than dataCount packets')
+})
+
+test('udp.sendBlock recovers dropped datagrams on a fec socket', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const server = dgram.createSocket({ type: 'udp4', fec: true })
+  const client = dgram.createSocket('udp4')
+  const blocks = 8
+  const dataCount = 16
+  const parityCount = 4
+  const sent = new Map()
+  const received = new Map()
+  let recovered = 0
+
+  server.on('message', (message, rinfo) => {
+    if (!rinfo.fec) return
+    if (rinfo.fec.recovered) recovered++
+    received.set(`${rinfo.fec.blockId}:${rinfo.fec.index}`, Buffer.from(message))
+  })
+
+  await new Promise((resolve) => server.bind(30012, address, resolve))
+  await new Promise((resolve) => client.bind(0, address, resolve))
+
+  // simulated loss is only built into runtimes built with
+  // `SSC_FAULT_INJECTION=1`, `sendBlock()` itself never drops
+  let lossy = true
+  const sendBlock = async (messages) => {
+    if (lossy) {
+      const { err, data } = await ipc.write('udp.sendBlock', {
+        id: client.id,
+        port: 30012,
+        address,
+        sizes: messages.map((message) => message.byteLength).join(','),
+        parityCount,
+        dropRate: 0.05
+      }, Buffer.concat(messages))
+
+      if (err?.code !== 'ENOTSUP') {
+        if (err) throw err
+        return data
+      }
+
+      t.comment('udp fault injection is not built into this runtime, sending without loss')
+      lossy = false
+    }
+
+    return await new Promise((resolve, reject) => {
+      client.sendBlock(messages, 30012, address, { parityCount }, (err, data) => {
+        return err ? reject(err) : resolve(data)
+      })
+    })
+  }
+
+  for (let i = 0; i < blocks; ++i) {
+    const messages = []
+
+    for (let j = 0; j < dataCount; ++j) {
+      messages.push(crypto.randomBytes(100 + Math.floor(Math.random() * 1000)))
+    }
+
+    // a block loses a message only when more than `parityCount` of its
+    // datagrams are dropped
+    const result = await sendBlock(messages)
+
+    t.equal(result.dataCount, dataCount, `block ${i} has ${dataCount} data datagrams`)
+
+    for (let j = 0; j < dataCount; ++j) {
+      sent.set(`${result.blockId}:${j}`, messages[j])
+    }
+
+    await new Promise((resolve) => setTimeout(resolve, 10))
+  }
+
+  await new Promise((resolve) => setTimeout(resolve, 100))
+
+  let delivered = 0
+  for (const [key, message] of sent) {
+    if (received.get(key)?.equals(message)) delivered++
+  }
+
+  t.ok(delivered >= sent.size * 0.95, `${delivered} of ${sent.size} messages delivered`)
+
+  if (lossy) {
+    t.ok(recovered > 0, `${recovered} dropped messages recovered`)
+  }
+
+  // only built into runtimes built with `SSC_BENCHMARKS=1`
+  const { err, data } = await ipc.send('fec.benchmark', { duration: 100 })
+  if (/not found/i.test(err?.message)) {
+    t.comment('fec.benchmark is not built into this runtime, skipping')
+  } else {
+    for (const { kernel, encode, reconstruct } of data?.results ?? []) {
+      t.comment(`fec ${kernel}: encode ${encode} MB/s, reconstruct ${reconstruct} MB/s (32+8 x 1200)`)
+    }
+
+    t.ok(data?.results?.length > 0, 'fec.benchmark reports every supported kernel')
+  }
+
+  await Promise.all([client, server].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('udp sendFile sends a file without copying it into JS', async (t) => {
+  if (process.env.SSC_ANDROID_CI || process.platform === 'ios') return
+
+  const address = '127.0.0.1'
+  const filename = `${os.tmpdir()}${path.sep}dgram-send-file-${crypto.rand64()}.bin`
+  const data = crypto.randomBytes(256 * 1024)
+  const offset = 1000
+  const length = data.byteLength - 2 * offset
+  const chunkSize = 1024
+  const server = dgram.createSocket('udp4')
+  const client = dgram.createSocket('udp4')
+  const messages = []
+
+  await fs.writeFile(filename, data)
+  const handle = await fs.open(filename, 'r')
+
+  server.on('message', (message) => messages.push(Buffer.from(message)))
+
+  await new Promise((resolve) => server.bind(30013, address, resolve))
+  await new Promise((resolve) => client.bind(0, address, resolve))
+
+  // 1MB/s, so progress is reported along the way
+  const paced = await ipc.send('udp.setCongestionControl', {
+    id: client.id,
+    maxPacingRate: 1024 * 1024
+  })
+
+  t.ifError(paced.err, 'udp.setCongestionControl')
+
+  const progress = []
+  const result = await new Promise((resolve, reject) => {
+    client.sendFile(handle, 30013, address, {
+      offset,
+      length,
+      chunkSize,
+      onprogress: (bytes, total) => progress.push({ bytes, total })
+    }, (err, result) => err ? reject(err) : resolve(result))
+  })
+
+  t.equal(result.bytes, length, 'every byte in the range is sent')
+  t.equal(result.datagrams, Math.ceil(length / chunkSize), `one datagram per ${chunkSize} bytes`)
+  t.ok(progress.length > 0, 'progress is reported')
+  t.ok(progress.every(({ total }) => total === length), 'progress reports the length')
+
+  await new Promise((resolve) => setTimeout(resolve, 100))
+
+  t.ok(
+    Buffer.concat(messages).equals(data.subarray(offset, offset + length)),
+    'the server receives the file range in order'
+  )
+
+  const missing = await new Promise((resolve) => {
+    client.sendFile('0', 30013, address, (err) => resolve(err))
+  })
+
+  t.ok(missing, 'sendFile fails for a file that is not open')
+
+  await handle.close()
+  await fs.unlink(filename)
+
+  await Promise.all([client, server].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('udp.getState and udp.stats report traffic counters', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const count = 32
+  const payload = Buffer.from(makePayloadString())
+  const server = dgram.createSocket('udp4')
+  const client = dgram.createSocket('udp4')
+
+  const received = new Promise((resolve) => {
+    let messages = 0
+    server.on('message', () => ++messages === count && resolve())
+  })
+
+  await new Promise((resolve) => server.bind(30015, address, resolve))
+
+  for (let i = 0; i < count; ++i) {
+    await new Promise((resolve) => client.send(payload, 30015, address, resolve))
+  }
+
+  await received
+
+  const { data: clientState } = await ipc.send('udp.getState', { id: client.id })
+  const { data: serverState } = await ipc.send('udp.getState', { id: server.id })
+
+  t.equal(clientState?.stats?.packetsSent, count, 'packets sent are counted')
+  t.equal(clientState?.stats?.bytesSent, count * payload.byteLength, 'bytes sent are counted')
+  t.equal(serverState?.stats?.packetsReceived, count, 'packets received are counted')
+  t.equal(serverState?.stats?.bytesReceived, count * payload.byteLength, 'bytes received are counted')
+  t.equal(serverState?.stats?.receiveDrops, 0, 'no datagrams were dropped')
+
+  const { data: stats } = await ipc.send('udp.stats', { sort: 'bytes' })
+  const rows = stats?.peers?.map((row) => Object.fromEntries(
+    stats.fields.map((field, i) => [field, row[i]])
+  )) ?? []
+
+  const rank = (row) => row.bytesSent + row.bytesReceived
+
+  t.ok(rows.find((row) => row.id === String(client.id))?.packetsSent === count, 'udp.stats reports every socket')
+  t.ok(rows.every((row, i) => i === 0 || rank(rows[i - 1]) >= rank(row)), 'udp.stats sorts the busiest sockets first')
+  t.ok(stats?.total?.packetsSent >= count, 'udp.stats reports totals')
+
+  const { data: top } = await ipc.send('udp.stats', { sort: 'packets', limit: 1 })
+  t.equal(top?.peers?.length, 1, 'udp.stats limits the sockets reported')
+
+  await Promise.all([client, server].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('udp.setBufferTuning shrinks an idle receive buffer', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const server = dgram.createSocket('udp4')
+
+  await new Promise((resolve) => server.bind(30016, address, resolve))
+
+  const { data: before } = await ipc.send('udp.getState', { id: server.id })
+  const size = before?.bufferTuning?.size ?? 0
+  t.ok(size > 0, 'udp.getState reports the receive buffer size')
+
+  const decisions = []
+  const shrunk = new Promise((resolve) => {
+    diagnostics.channels.subscribe('udp.buffer.tune', function ontune (message) {
+      if (message.socket !== server) return
+      decisions.push(message)
+      if (message.action === 'shrink') {
+        diagnostics.channels.unsubscribe('udp.buffer.tune', ontune)
+        resolve(message)
+      }
+    })
+  })
+
+  try {
+    await server.setRecvBufferTuning({ minSize: 8 * 1024, maxSize: size, interval: 10 })
+    t.fail('a minimum larger than the maximum is accepted')
+  } catch (err) {
+    t.equal(err?.code, 'EINVAL', 'a minimum larger than the maximum is rejected')
+  }
+
+  const enabled = await server.setRecvBufferTuning({
+    minSize: Math.floor(size / 4),
+    maxSize: size * 4,
+    interval: 10
+  })
+
+  t.equal(enabled?.enabled, true, 'buffer tuning is enabled')
+
+  const decision = await Promise.race([
+    shrunk,
+    new Promise((resolve) => setTimeout(resolve, 2000, null))
+  ])
+
+  t.ok(decision, 'an idle receive buffer shrinks')
+  t.ok(decision?.size < decision?.previousSize, 'the receive buffer is smaller')
+  t.ok(decision?.size >= Math.floor(size / 4) - 1, 'the receive buffer is not smaller than the minimum')
+  t.ok(decisions.every((decision) => decision.action !== 'grow'), 'an idle receive buffer does not grow')
+  t.equal(server.getRecvBufferSize(), decision?.size, 'the socket tracks the tuned size')
+
+  const disabled = await server.setRecvBufferTuning(false)
+  t.equal(disabled?.enabled, false, 'buffer tuning is disabled')
+
+  const { data: after } = await ipc.send('udp.getState', { id: server.id })
+  t.ok(after?.bufferTuning?.shrinks >= 1, 'udp.getState reports the decisions')
+
+  await util.promisify(server.close.bind(server))()
+})
+
+test('udp.rtt measures the round trip time natively', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const server = dgram.createSocket({ type: 'udp4', timestamps: true })
+  const client = dgram.createSocket({ type: 'udp4', timestamps: true })
+  const other = dgram.createSocket('udp4')
+
+  await new Promise((resolve) => server.bind(30017, address, resolve))
+  await new Promise((resolve) => client.bind(30018, address, resolve))
+  await new Promise((resolve) => other.bind(30019, address, resolve))
+
+  const message = new Promise((resolve) => {
+    server.once('message', (message, rinfo) => resolve(rinfo))
+  })
+
+  const sentAt = Date.now()
+  await new Promise((resolve) => client.send('hello', 30017, address, resolve))
+
+  const rinfo = await message
+  t.ok(Math.abs(rinfo.timestamp - sentAt) < 1000, 'messages have a receive timestamp')
+
+  let result = null
+  for (let i = 0; i < 3; ++i) {
+    result = await client.ping(30017, address)
+  }
+
+  t.ok(result?.rtt >= 0 && result?.rtt < 1000, 'ping measures the round trip time')
+  t.equal(result?.samples, 3, 'ping updates the estimate')
+  t.ok(result?.srtt >= result?.minRTT, 'the smoothed estimate is not lower than the minimum')
+
+  const estimates = await client.getRTT()
+  t.equal(estimates?.[0]?.port, 30017, 'getRTT() reports the pinged sockets')
+
+  const { data: state } = await ipc.send('udp.getState', { id: client.id })
+  t.equal(state?.rtt?.[0]?.samples, 3, 'udp.getState reports the estimates')
+
+  try {
+    await client.ping(30019, address, { timeout: 100 })
+    t.fail('a socket without timestamps answers pings')
+  } catch (err) {
+    t.equal(err?.code, 'ETIMEDOUT', 'a socket without timestamps does not answer pings')
+  }
+
+  await Promise.all([client, server, other].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('udp receivers fan a bound port out over several sockets', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const server = dgram.createSocket({ type: 'udp4', receivers: 4 })
+  const client = dgram.createSocket('udp4')
+
+  await new Promise((resolve) => server.bind(30020, address, resolve))
+
+  const { data: state } = await ipc.send('udp.getState', { id: server.id })
+  if (process.platform === 'linux') {
+    t.equal(state?.receivers, 4, 'the port is read by 4 sockets')
+  } else {
+    t.equal(state?.receivers, 1, 'the port is read by 1 socket')
+  }
+
+  const count = 32
+  const received = new Set()
+  const done = new Promise((resolve) => {
+    server.on('message', (message) => {
+      received.add(String(message))
+      if (received.size === count) resolve()
+    })
+  })
+
+  for (let i = 0; i < count; ++i) {
+    await new Promise((resolve) => client.send(`message ${i}`, 30020, address, resolve))
+  }
+
+  await Promise.race([done, new Promise((resolve) => setTimeout(resolve, 1000))])
+  t.equal(received.size, count, 'messages from every receiver reach the socket')
+
+  // only built into runtimes built with `SSC_BENCHMARKS=1`
+  const { err, data } = await ipc.send('udp.benchmark', { duration: 100 })
+  if (/not found/i.test(err?.message)) {
+    t.comment('udp.benchmark is not built into this runtime, skipping')
+  } else {
+    for (const { receivers, packetsPerSecond, megabytesPerSecond, drops } of data?.results ?? []) {
+      t.comment(`udp ${receivers} receivers: ${Math.round(packetsPerSecond)} packets/s, ${megabytesPerSecond.toFixed(1)} MB/s, ${drops} drops`)
+    }
+
+    t.equal(data?.results?.length, 2, 'udp.benchmark reports one and several receivers')
+
+    for (const { segmentationOffload, datagramsPerSecond, megabytesPerSecond } of data?.segmentation ?? []) {
+      t.comment(`udp ${data.segments} segments ${segmentationOffload ? 'with' : 'without'} GSO: ${Math.round(datagramsPerSecond)} datagrams/s, ${megabytesPerSecond.toFixed(1)} MB/s`)
+    }
+
+    t.equal(data?.segmentation?.length, 2, 'udp.benchmark compares sends with and without GSO')
+    t.equal(data?.segmentation?.[0]?.segmentationOffload, false, 'the first segmented run sends one datagram at a time')
+    t.ok(data?.segmentation?.every(({ datagrams }) => datagrams > 0), 'every segmented run sends datagrams')
+  }
+
+  await Promise.all([client, server].map((socket) => {
+    return util.promisify(socket.close.bind(socket))()
+  }))
+})
+
+test('udp.benchmarkPeers looks peers up from many threads', async (t) => {
+  // only built into runtimes built with `SSC_BENCHMARKS=1`
+  const { err, data } = await ipc.send('udp.benchmarkPeers', { threads: 8, duration: 100 })
+  if (/not found/i.test(err?.message)) {
+    t.comment('udp.benchmarkPeers is not built into this runtime, skipping')
+    return
+  }
+
+  for (const { threads, registry, map } of data?.results ?? []) {
+    t.comment(`peers ${threads} threads: registry ${Math.round(registry)} lookups/s, locked map ${Math.round(map)} lookups/s`)
+  }
+
+  t.equal(data?.results?.length, 2, 'udp.benchmarkPeers reports one and several threads')
+  t.ok(data?.results?.every(({ registry }) => registry > 0), 'every run looks peers up')
+})
+
 test('connect + disconnect', async (t) => {
   await new Promise((resolve) => {
     const address = '127.0.0.1'
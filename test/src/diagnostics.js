@@ -1,2 +1,3 @@
 // import './diagnostics/channels.js'
+import './diagnostics/process.js'
 import './diagnostics/window.js'
@@ -0,0 +1,38 @@
+import process from 'socket:process'
+import test from 'socket:test'
+import ipc from 'socket:ipc'
+
+test('diagnostics.benchmarkProcessOutput reads lines and frames of a child process', async (t) => {
+  const invalid = await ipc.send('diagnostics.benchmarkProcessOutput', { size: 0 })
+
+  // only built into runtimes built with `SSC_BENCHMARKS=1`
+  if (/not found/i.test(invalid.err?.message)) {
+    return t.comment('diagnostics.benchmarkProcessOutput is not built into this runtime, skipping')
+  }
+
+  if (process.platform === 'ios' || process.platform === 'win32') {
+    t.equal(invalid.err?.code, 'ENOTSUP', 'not supported on this platform')
+    return
+  }
+
+  t.equal(invalid.err?.code, 'EINVAL', 'diagnostics.benchmarkProcessOutput rejects invalid parameters')
+
+  const bytes = 16 * 1024 * 1024
+
+  for (const binary of [false, true]) {
+    for (const size of [16, 4096]) {
+      const { err, data } = await ipc.send('diagnostics.benchmarkProcessOutput', { bytes, size, binary })
+      const framing = binary ? 'binary' : 'lines'
+
+      t.ifError(err, `diagnostics.benchmarkProcessOutput (${framing}, ${size})`)
+      t.equal(data?.framing, framing, 'framing is reported')
+
+      for (const name of ['views', 'strings']) {
+        const run = data?.runs?.[name]
+        t.equal(run?.messages, run?.expectedMessages, `${name} delivers every ${framing} message`)
+        t.equal(run?.bytes, run?.messages * size, `${name} delivers every byte`)
+        t.comment(`${framing} ${size} ${name}: ${Math.round(run?.bytesPerSecond)} bytes/s`)
+      }
+    }
+  }
+})
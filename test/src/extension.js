@@ -1,3 +1,4 @@
 import './extensions/simple.js'
 import './extensions/sqlite3.js'
+import './extensions/thread-pool.js'
 import './extensions/feature-policies.js'
@@ -1,6 +1,7 @@
 import extension from 'socket:extension'
 import test from 'socket:test'
 import ipc from 'socket:ipc'
+import Buffer from 'socket:buffer'
 
 test('extension.load(name) - simple', async (t) => {
   const stats = await extension.stats()
@@ -13,6 +14,17 @@ test('extension.load(name) - simple', async (t) => {
     t.equal(simple.description, 'a simple IPC ping extension', 'description === "a simple IPC ping extension"')
     t.equal(simple.version, '0.1.2', 'version === "0.1.2"')
     t.equal(result.data, 'hello world', 'ipc://simple.ping mapped')
+
+    const reversed = await ipc.write('simple.reverse', {}, Buffer.from('hello bytes'), {
+      responseType: 'arraybuffer'
+    })
+
+    t.ifError(reversed.err, 'ipc://simple.reverse mapped')
+    t.equal(
+      Buffer.from(reversed.data).toString(),
+      'setyb olleh',
+      'message bytes taken and returned as owned result bytes'
+    )
     t.ok(await simple.unload(), 'unload')
   } catch (err) {
     t.ifError(err)
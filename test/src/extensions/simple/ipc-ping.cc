@@ -14,9 +14,30 @@ void onping (
   sapi_ipc_reply(result);
 }
 
+void onreverse (
+  sapi_context_t* context,
+  sapi_ipc_message_t* message,
+  const sapi_ipc_router_t* router
+) {
+  unsigned int size = 0;
+  // the message bytes are ours now, reverse them in place and hand them back
+  unsigned char* bytes = sapi_ipc_message_take_bytes(context, message, &size);
+  sapi_ipc_result_t* result = sapi_ipc_result_create(context, message);
+
+  for (unsigned int i = 0; i < size / 2; ++i) {
+    const unsigned char byte = bytes[i];
+    bytes[i] = bytes[size - i - 1];
+    bytes[size - i - 1] = byte;
+  }
+
+  sapi_ipc_result_set_bytes_owned(result, size, bytes, sapi_ipc_bytes_free);
+  sapi_ipc_reply(result);
+}
+
 bool initialize (sapi_context_t* context, const void *data) {
   if (sapi_extension_is_allowed(context, "ipc_router_map")) {
     sapi_ipc_router_map(context, "simple.ping", onping, data);
+    sapi_ipc_router_map(context, "simple.reverse", onreverse, data);
   }
   return true;
 }
@@ -24,6 +45,7 @@ bool initialize (sapi_context_t* context, const void *data) {
 bool deinitialize (sapi_context_t* context, const void *data) {
   if (sapi_extension_is_allowed(context, "ipc_router_unmap")) {
     sapi_ipc_router_unmap(context, "simple.ping");
+    sapi_ipc_router_unmap(context, "simple.reverse");
   }
   return true;
 }
@@ -0,0 +1,240 @@
+#include <socket/extension.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+struct PoolTest;
+
+struct PoolTask {
+  PoolTest* test = nullptr;
+  int priority = SAPI_THREAD_POOL_PRIORITY_NORMAL;
+  unsigned int index = 0;
+};
+
+struct PoolTest {
+  sapi_context_t* context = nullptr;
+  sapi_ipc_result_t* result = nullptr;
+  std::vector<PoolTask> tasks;
+  std::mutex mutex;
+  std::condition_variable condition;
+  // the workers blocked, and how many of them were let go
+  unsigned int blocked = 0;
+  unsigned int released = 0;
+  // the blocked workers and the timer hold the test
+  unsigned int refs = 1;
+  // priorities in the order the tasks ran
+  std::vector<int> order;
+  std::set<std::thread::id> workers;
+  std::thread::id done;
+  unsigned int queued = 0;
+  bool full = false;
+  uv_timer_t timer;
+};
+
+static void unref (PoolTest* test) {
+  bool last = false;
+
+  do {
+    std::lock_guard<std::mutex> lock(test->mutex);
+    last = --test->refs == 0;
+  } while (0);
+
+  if (last) {
+    delete test;
+  }
+}
+
+static void block (sapi_context_t* context, const void* data) {
+  auto task = (const PoolTask*) data;
+  auto test = task->test;
+
+  do {
+    std::unique_lock<std::mutex> lock(test->mutex);
+    test->workers.insert(std::this_thread::get_id());
+    test->blocked++;
+    test->condition.notify_all();
+    test->condition.wait(lock, [task, test]() {
+      return task->index < test->released;
+    });
+  } while (0);
+
+  unref(test);
+}
+
+static void noop (sapi_context_t* context, const void* data) {}
+
+static void record (sapi_context_t* context, const void* data) {
+  auto task = (const PoolTask*) data;
+  auto test = task->test;
+  std::lock_guard<std::mutex> lock(test->mutex);
+  test->workers.insert(std::this_thread::get_id());
+  test->order.push_back(task->priority);
+
+  // the last task to run lets the other workers go
+  if (task->priority == SAPI_THREAD_POOL_PRIORITY_LOW) {
+    test->released = test->tasks.size();
+    test->condition.notify_all();
+  }
+}
+
+static void reply (uv_timer_t* timer) {
+  auto test = (PoolTest*) timer->data;
+  auto context = test->context;
+  auto json = sapi_json_object_create(context);
+  auto order = sapi_json_array_create(context);
+  // timers only run on the loop thread
+  bool loop = test->done == std::this_thread::get_id();
+  bool worker = false;
+
+  do {
+    std::lock_guard<std::mutex> lock(test->mutex);
+    worker = test->workers.contains(test->done);
+
+    for (auto priority : test->order) {
+      sapi_json_array_push(order, sapi_json_any(sapi_json_number_create(context, priority)));
+    }
+  } while (0);
+
+  sapi_json_object_set(json, "order", sapi_json_any(order));
+  sapi_json_object_set(json, "queued", sapi_json_any(sapi_json_number_create(context, test->queued)));
+  sapi_json_object_set(json, "full", sapi_json_any(sapi_json_boolean_create(context, test->full)));
+  sapi_json_object_set(json, "loop", sapi_json_any(sapi_json_boolean_create(context, loop && !worker)));
+  sapi_ipc_result_set_json_data(test->result, sapi_json_any(json));
+  sapi_ipc_reply(test->result);
+
+  uv_close((uv_handle_t*) timer, [](uv_handle_t* handle) {
+    unref((PoolTest*) handle->data);
+  });
+}
+
+static void done (sapi_context_t* context, const void* data) {
+  auto task = (const PoolTask*) data;
+  auto test = task->test;
+  test->done = std::this_thread::get_id();
+
+  // only valid on the loop thread, which the timer checks
+  uv_timer_init(sapi_context_get_loop(context), &test->timer);
+  test->timer.data = test;
+  uv_timer_start(&test->timer, reply, 0, 0);
+}
+
+static void fail (PoolTest* test, const char* message) {
+  auto context = test->context;
+  auto err = sapi_json_object_create(context);
+  sapi_json_object_set(err, "message", sapi_json_any(sapi_json_string_create(context, message)));
+  sapi_ipc_result_set_json_error(test->result, sapi_json_any(err));
+  sapi_ipc_reply(test->result);
+
+  do {
+    std::lock_guard<std::mutex> lock(test->mutex);
+    test->released = test->tasks.size();
+    test->condition.notify_all();
+  } while (0);
+
+  unref(test);
+}
+
+void onsubmit (
+  sapi_context_t* context,
+  sapi_ipc_message_t* message,
+  const sapi_ipc_router_t* router
+) {
+  auto size = sapi_thread_pool_get_size(context);
+  auto test = new PoolTest();
+  test->context = context;
+  test->result = sapi_ipc_result_create(context, message);
+  // a task to block each worker, then one for each priority
+  test->tasks.resize(size + 3);
+
+  for (unsigned int i = 0; i < size; ++i) {
+    auto task = &test->tasks[i];
+    *task = PoolTask { test, SAPI_THREAD_POOL_PRIORITY_HIGH, i };
+
+    do {
+      std::lock_guard<std::mutex> lock(test->mutex);
+      test->refs++;
+    } while (0);
+
+    if (!sapi_thread_pool_submit_with_priority(context, task->priority, task, block, nullptr)) {
+      unref(test);
+      return fail(test, "sapi_thread_pool_submit() failed");
+    }
+  }
+
+  do {
+    std::unique_lock<std::mutex> lock(test->mutex);
+    auto blocked = test->condition.wait_for(lock, std::chrono::seconds(5), [test, size]() {
+      return test->blocked == size;
+    });
+
+    if (!blocked) {
+      lock.unlock();
+      return fail(test, "The workers did not start");
+    }
+  } while (0);
+
+  // queued while every worker is busy, lowest priority first
+  const int priorities[] = {
+    SAPI_THREAD_POOL_PRIORITY_LOW,
+    SAPI_THREAD_POOL_PRIORITY_NORMAL,
+    SAPI_THREAD_POOL_PRIORITY_HIGH
+  };
+
+  for (unsigned int i = 0; i < 3; ++i) {
+    auto task = &test->tasks[size + i];
+    *task = PoolTask { test, priorities[i], size + i };
+
+    auto submitted = sapi_thread_pool_submit_with_priority(
+      context,
+      task->priority,
+      task,
+      record,
+      task->priority == SAPI_THREAD_POOL_PRIORITY_LOW ? done : nullptr
+    );
+
+    // nothing replies without the last task to run
+    if (!submitted && task->priority == SAPI_THREAD_POOL_PRIORITY_LOW) {
+      return fail(test, "sapi_thread_pool_submit_with_priority() failed");
+    }
+  }
+
+  // the queues are bounded, fill them up
+  while (test->queued < (1 << 24) && sapi_thread_pool_submit(context, test, noop, nullptr)) {
+    test->queued++;
+  }
+
+  test->full = !sapi_thread_pool_submit(context, test, noop, nullptr);
+
+  // one worker runs the queued tasks, by priority
+  do {
+    std::lock_guard<std::mutex> lock(test->mutex);
+    test->released = 1;
+    test->condition.notify_all();
+  } while (0);
+}
+
+bool initialize (sapi_context_t* context, const void *data) {
+  if (sapi_extension_is_allowed(context, "ipc_router_map")) {
+    sapi_ipc_router_map(context, "simple.threadPool.submit", onsubmit, data);
+  }
+  return true;
+}
+
+bool deinitialize (sapi_context_t* context, const void *data) {
+  if (sapi_extension_is_allowed(context, "ipc_router_unmap")) {
+    sapi_ipc_router_unmap(context, "simple.threadPool.submit");
+  }
+  return true;
+}
+
+SOCKET_RUNTIME_REGISTER_EXTENSION(
+  "simple-thread-pool", // name
+  initialize, // initializer
+  deinitialize, // deinitializer
+  "a simple thread pool extension", // description
+  "0.1.0" // version
+);
@@ -0,0 +1,22 @@
+import extension from 'socket:extension'
+import test from 'socket:test'
+import ipc from 'socket:ipc'
+
+test('extension.load(name) - thread pool', async (t) => {
+  let pool = null
+
+  try {
+    pool = await extension.load('simple-thread-pool')
+  } catch (err) {
+    return t.ifError(err)
+  }
+
+  const result = await ipc.request('simple.threadPool.submit', {})
+  if (result.err) return t.ifError(result.err)
+
+  t.deepEqual(result.data.order, [2, 1, 0], 'queued tasks run by priority')
+  t.ok(result.data.queued > 0, 'tasks are queued while the workers are busy')
+  t.ok(result.data.full, 'sapi_thread_pool_submit() is false when the queues are full')
+  t.ok(result.data.loop, 'done callbacks run on the loop')
+  t.ok(await pool.unload(), 'unload')
+})
@@ -9,6 +9,9 @@ import './os.js'
 import './process.js'
 import './path.js'
 import './dgram.js'
+import './tcp.js'
+import './channel.js'
+import './stream-relay.js'
 import './dns.js'
 import './crypto.js'
 import './util.js'
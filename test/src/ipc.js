@@ -145,3 +145,59 @@ test('ipc.send success', async (t) => {
   const { data } = response
   t.ok(typeof data === 'object', 'sendSync works')
 })
+
+test('buffer.* native buffers stand in for message bytes', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const { default: dgram } = await import('socket:dgram')
+  const { default: crypto } = await import('socket:crypto')
+
+  const address = '127.0.0.1'
+  const id = crypto.rand64()
+  const sliceId = crypto.rand64()
+  const payload = Buffer.from('hello, native buffers')
+  const server = dgram.createSocket('udp4')
+  const client = dgram.createSocket('udp4')
+  const messages = []
+
+  server.on('message', (message) => messages.push(Buffer.from(message).toString()))
+  await new Promise((resolve) => server.bind(30014, address, resolve))
+  await new Promise((resolve) => client.bind(0, address, resolve))
+
+  const allocated = await ipc.write('buffer.alloc', { id }, payload)
+  t.equal(allocated.data?.size, payload.byteLength, 'buffer.alloc uploads the bytes')
+
+  const sliced = await ipc.send('buffer.slice', { id: sliceId, source: id, offset: 7 })
+  t.equal(sliced.data?.size, payload.byteLength - 7, 'buffer.slice defaults to the end of the buffer')
+
+  const appended = await ipc.write('buffer.append', { id }, Buffer.from('!'))
+  t.equal(appended.data?.size, payload.byteLength + 1, 'buffer.append grows the buffer')
+
+  for (const bufferId of [id, id, sliceId]) {
+    const sent = await ipc.send('udp.send', { id: client.id, port: 30014, address, bufferId })
+    t.ifError(sent.err, 'udp.send accepts a bufferId in place of bytes')
+  }
+
+  await new Promise((resolve) => setTimeout(resolve, 50))
+
+  t.deepEqual(messages.sort(), [
+    'hello, native buffers!',
+    'hello, native buffers!',
+    'native buffers'
+  ].sort(), 'the buffers are sent, the slice does not see the append')
+
+  const state = await ipc.send('buffer.getState')
+  t.ok(state.data?.count >= 2, 'buffer.getState counts the buffers')
+
+  for (const bufferId of [id, sliceId]) {
+    const released = await ipc.send('buffer.release', { id: bufferId })
+    t.ifError(released.err, 'buffer.release')
+  }
+
+  const missing = await ipc.send('udp.send', { id: client.id, port: 30014, address, bufferId: id })
+  t.equal(missing.err?.type, 'NotFoundError', 'a released buffer can not be used')
+
+  await Promise.all([client, server].map((socket) => {
+    return new Promise((resolve) => socket.close(resolve))
+  }))
+})
@@ -0,0 +1,66 @@
+import { test } from 'socket:test'
+import crypto from 'socket:crypto'
+import Buffer from 'socket:buffer'
+import ipc from 'socket:ipc'
+import { Packet, PacketPublish, PacketPing } from 'socket:stream-relay/packets'
+
+async function makePacket (Type, clock) {
+  const packetId = crypto.randomBytes(32).toString('hex')
+  const message = Type === PacketPing
+    ? { requesterPeerId: packetId }
+    : crypto.randomBytes(64).toString('hex')
+
+  const packet = new Type({ packetId, clock, message })
+  return { packetId, buffer: await Packet.encode(packet) }
+}
+
+test('cache.* native packet cache', async (t) => {
+  await crypto.ready
+
+  const id = crypto.rand64()
+  const created = await ipc.send('cache.create', { id, maxCount: 3 })
+  t.ifError(created.err, 'cache.create')
+  t.equal(created.data?.maxCount, 3, 'cache.create honors maxCount')
+
+  const packets = []
+  for (const clock of [1, 9, 3]) {
+    const packet = await makePacket(PacketPublish, clock)
+    const result = await ipc.write('cache.insert', { id }, packet.buffer)
+    t.ok(result.data?.inserted, `publish packet with clock ${clock} inserted`)
+    packets.push(packet)
+  }
+
+  const ping = await makePacket(PacketPing, 0)
+  const rejected = await ipc.write('cache.insert', { id }, ping.buffer)
+  t.equal(rejected.data?.inserted, false, 'non publish packets are not inserted')
+
+  // a full cache evicts the highest clock like `defaultSiblingResolver`
+  const extra = await makePacket(PacketPublish, 4)
+  await ipc.write('cache.insert', { id }, extra.buffer)
+
+  const has = async (packetId) => {
+    const result = await ipc.send('cache.has', { id, packetId })
+    return result.data?.has
+  }
+
+  t.equal(await has(packets[1].packetId), false, 'highest clock was evicted')
+  t.equal(await has(packets[0].packetId), true, 'lower clocks are kept')
+  t.equal(await has(extra.packetId), true, 'new packet is cached')
+  t.equal(await has(ping.packetId), false, 'unknown packet is not found')
+
+  const got = await ipc.request('cache.get', {
+    id,
+    packetId: packets[2].packetId
+  }, { responseType: 'arraybuffer' })
+
+  t.ok(Buffer.from(got.data).equals(packets[2].buffer), 'cache.get returns the encoded packet')
+
+  const deleted = await ipc.send('cache.delete', { id, packetId: packets[2].packetId })
+  t.equal(deleted.data?.deleted, true, 'cache.delete removes the packet')
+
+  const state = await ipc.send('cache.getState', { id })
+  t.equal(state.data?.size, 2, 'cache.getState reports the size')
+
+  const destroyed = await ipc.send('cache.destroy', { id })
+  t.ifError(destroyed.err, 'cache.destroy')
+})
@@ -0,0 +1,124 @@
+import { test } from 'socket:test'
+import process from 'socket:process'
+import crypto from 'socket:crypto'
+import Buffer from 'socket:buffer'
+import ipc from 'socket:ipc'
+
+// collects the 'data' events of `tcp.*` routes for a socket
+function createTCPListener (id) {
+  const listener = {
+    chunks: [],
+    connections: 0,
+    ended: null,
+    onconnection: null
+  }
+
+  let onend = null
+  listener.ended = new Promise((resolve) => { onend = resolve })
+
+  listener.ondata = ({ detail }) => {
+    const { data, source } = detail.params
+    if (!data || BigInt(data.id) !== id) return
+
+    if (source === 'tcp.listen' && data.event === 'connection') {
+      listener.connections++
+      listener.onconnection?.()
+    }
+
+    if (source === 'tcp.readStart') {
+      if (data.EOF) {
+        onend(Buffer.concat(listener.chunks))
+      } else if (detail.data) {
+        listener.chunks.push(Buffer.from(detail.data))
+      }
+    }
+  }
+
+  globalThis.addEventListener('data', listener.ondata)
+  return listener
+}
+
+test('tcp.* transfers bytes over loopback', async (t) => {
+  if (process.env.SSC_ANDROID_CI) return
+
+  const address = '127.0.0.1'
+  const server = { id: crypto.rand64() }
+  const accepted = { id: crypto.rand64() }
+  const client = { id: crypto.rand64() }
+  const data = crypto.randomBytes(4 * 1024 * 1024)
+  const listeners = [server, accepted, client].map(({ id }) => createTCPListener(id))
+  const [serverListener, acceptedListener, clientListener] = listeners
+
+  const connection = new Promise((resolve) => {
+    serverListener.onconnection = resolve
+  })
+
+  const listening = await ipc.send('tcp.listen', {
+    id: server.id,
+    port: 30030,
+    address,
+    noDelay: true
+  })
+
+  t.ifError(listening.err, 'tcp.listen')
+  t.equal(listening.data?.port, 30030, 'tcp.listen reports the bound port')
+
+  const connected = ipc.send('tcp.connect', {
+    id: client.id,
+    port: 30030,
+    address,
+    keepAlive: true,
+    keepAliveDelay: 10
+  })
+
+  await connection
+  const result = await ipc.send('tcp.accept', { serverId: server.id, id: accepted.id })
+  t.ifError(result.err, 'tcp.accept')
+  t.ifError((await connected).err, 'tcp.connect')
+  t.equal(result.data?.port, (await connected).data?.localPort, 'the accepted connection is the client')
+
+  for (const { id } of [accepted, client]) {
+    t.ifError((await ipc.send('tcp.readStart', { id })).err, 'tcp.readStart')
+  }
+
+  // written in many small writes, which go out in batches
+  const started = Date.now()
+  const size = 16 * 1024
+  const writes = []
+  for (let offset = 0; offset < data.length; offset += size) {
+    writes.push(ipc.write('tcp.write', { id: client.id }, data.subarray(offset, offset + size)))
+  }
+
+  const written = await Promise.all(writes)
+  t.ok(written.every((result) => !result.err), 'tcp.write resolves every write')
+  t.ifError((await ipc.send('tcp.shutdown', { id: client.id })).err, 'tcp.shutdown')
+
+  const received = await acceptedListener.ended
+  t.ok(received.equals(data), 'the accepted connection receives every byte in order')
+  t.comment(`tcp: ${data.length} bytes in ${Date.now() - started}ms`)
+
+  await ipc.write('tcp.write', { id: accepted.id }, Buffer.from('bye'))
+  await ipc.send('tcp.shutdown', { id: accepted.id })
+
+  const reply = await clientListener.ended
+  t.equal(String(reply), 'bye', 'the client reads the reply')
+
+  const { data: state } = await ipc.send('tcp.getState', { id: client.id })
+  t.equal(state?.bytesWritten, data.length, 'tcp.getState counts written bytes')
+  t.equal(state?.keepAlive, true, 'tcp.getState reports socket options')
+  t.ok(state?.writes >= written.length, 'tcp.getState counts writes')
+
+  const { data: acceptedState } = await ipc.send('tcp.getState', { id: accepted.id })
+  t.equal(acceptedState?.noDelay, true, 'accepted connections inherit the listener options')
+
+  for (const { id } of [client, accepted, server]) {
+    t.ifError((await ipc.send('tcp.close', { id })).err, 'tcp.close')
+  }
+
+  for (const listener of listeners) {
+    globalThis.removeEventListener('data', listener.ondata)
+  }
+
+  const refused = await ipc.send('tcp.connect', { id: crypto.rand64(), port: 30031, address })
+  t.equal(refused.err?.code, 'ECONNREFUSED', 'tcp.connect fails without a listener')
+})